@@ -0,0 +1,533 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "alerts.h"
+#include "demand.h"
+
+typedef struct {
+    const char *name;
+    size_t offset;
+} AlertMetric;
+
+static const AlertMetric metrics[] = {
+    {"cpu.usage", offsetof(HistorySample, cpu_usage)},
+    {"memory.percentage", offsetof(HistorySample, memory_usage)},
+    {"gpu.usage", offsetof(HistorySample, gpu_usage)},
+    {"gpu.memory", offsetof(HistorySample, gpu_memory)},
+    {"gpu.temperature", offsetof(HistorySample, gpu_temperature)},
+    {"disk.read", offsetof(HistorySample, disk_read)},
+    {"disk.write", offsetof(HistorySample, disk_write)},
+    {"net.rx", offsetof(HistorySample, net_rx)},
+    {"net.tx", offsetof(HistorySample, net_tx)},
+    {"psi.cpu", offsetof(HistorySample, psi_cpu)},
+    {"psi.memory", offsetof(HistorySample, psi_memory)},
+    {"psi.io", offsetof(HistorySample, psi_io)},
+};
+
+static const char *state_names[] = {"ok", "pending", "firing"};
+
+static char *trim(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return s;
+}
+
+// "30s", "5m", "1h", без единицы - секунды
+static int parse_duration(const char *s, long *ms) {
+    char *end = NULL;
+    double v = strtod(s, &end);
+    if (end == s || v < 0) return -1;
+
+    double scale;
+    if (*end == '\0' || strcmp(end, "s") == 0) scale = 1000.0;
+    else if (strcmp(end, "ms") == 0) scale = 1.0;
+    else if (strcmp(end, "m") == 0 || strcmp(end, "min") == 0) scale = 60000.0;
+    else if (strcmp(end, "h") == 0) scale = 3600000.0;
+    else return -1;
+
+    *ms = (long)(v * scale);
+    return 0;
+}
+
+int alert_parse_rule(const char *line, AlertRule *rule) {
+    char copy[256];
+    char *save = NULL;
+
+    snprintf(copy, sizeof(copy), "%s", line);
+    char *comment = strchr(copy, '#');
+    if (comment) *comment = '\0';
+    char *text = trim(copy);
+    if (*text == '\0') return 0;
+
+    memset(rule, 0, sizeof(*rule));
+    rule->rate_unit_s = 1.0;
+
+    char *colon = strchr(text, ':');
+    if (colon) {
+        *colon = '\0';
+        char *name = trim(text);
+        if (*name == '\0' || strlen(name) >= sizeof(rule->name)) return -1;
+        snprintf(rule->name, sizeof(rule->name), "%s", name);
+        text = trim(colon + 1);
+    }
+    snprintf(rule->expr, sizeof(rule->expr), "%s", text);
+    if (rule->name[0] == '\0') snprintf(rule->name, sizeof(rule->name), "%.63s", rule->expr);
+
+    char *token = strtok_r(text, " \t", &save);
+    int found = 0;
+    for (size_t i = 0; token && i < sizeof(metrics) / sizeof(metrics[0]); i++) {
+        if (strcmp(token, metrics[i].name) == 0) {
+            rule->offset = metrics[i].offset;
+            found = 1;
+        }
+    }
+    if (!found) return -1;
+
+    token = strtok_r(NULL, " \t", &save);
+    if (token && strcmp(token, "rate") == 0) {
+        rule->rate = 1;
+        token = strtok_r(NULL, " \t", &save);
+    }
+
+    if (!token) return -1;
+    if (strcmp(token, ">") == 0) rule->op = ALERT_GT;
+    else if (strcmp(token, ">=") == 0) rule->op = ALERT_GE;
+    else if (strcmp(token, "<") == 0) rule->op = ALERT_LT;
+    else if (strcmp(token, "<=") == 0) rule->op = ALERT_LE;
+    else return -1;
+
+    token = strtok_r(NULL, " \t", &save);
+    if (!token) return -1;
+    char *end = NULL;
+    rule->threshold = strtod(token, &end);
+    if (end == token) return -1;
+    if (*end != '\0') {
+        // единица скорости - только у rate
+        if (!rule->rate) return -1;
+        if (strcmp(end, "/s") == 0) rule->rate_unit_s = 1.0;
+        else if (strcmp(end, "/min") == 0 || strcmp(end, "/m") == 0) rule->rate_unit_s = 60.0;
+        else if (strcmp(end, "/h") == 0) rule->rate_unit_s = 3600.0;
+        else return -1;
+    }
+
+    token = strtok_r(NULL, " \t", &save);
+    if (token) {
+        if (strcmp(token, "for") != 0) return -1;
+        token = strtok_r(NULL, " \t", &save);
+        if (!token || parse_duration(token, &rule->for_ms) != 0) return -1;
+        if (strtok_r(NULL, " \t", &save)) return -1;
+    }
+    return 1;
+}
+
+int alerts_init(AlertEngine *a) {
+    memset(a, 0, sizeof(*a));
+    a->retry_base_ms = ALERT_RETRY_BASE_MS;
+    if (gethostname(a->host, sizeof(a->host)) != 0) {
+        snprintf(a->host, sizeof(a->host), "localhost");
+    }
+    a->host[sizeof(a->host) - 1] = '\0';
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&a->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&a->mutex, NULL);
+    return 0;
+}
+
+int alerts_load(AlertEngine *a, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        AlertRule rule;
+        int r = alert_parse_rule(line, &rule);
+        if (r == 0) continue;
+        if (r < 0) {
+            fprintf(stderr, "%s:%d: expected [name:] metric [rate] op threshold[/s|/min] [for 30s]\n",
+                    path, line_no);
+            continue;
+        }
+        if (a->count >= MAX_ALERT_RULES) {
+            fprintf(stderr, "%s: more than %d rules, ignoring the rest\n", path, MAX_ALERT_RULES);
+            break;
+        }
+        a->rules[a->count++] = rule;
+    }
+    fclose(file);
+
+    if (a->count == 0) {
+        fprintf(stderr, "%s: no rules\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// http://host[:port][/path]
+int alerts_set_webhook(AlertEngine *a, const char *url) {
+    char port[8] = "80";
+
+    if (strncmp(url, "http://", 7) != 0) return -1;
+    const char *rest = url + 7;
+    const char *slash = strchr(rest, '/');
+    size_t authority = slash ? (size_t)(slash - rest) : strlen(rest);
+    if (authority == 0 || authority >= sizeof(a->http_host)) return -1;
+    snprintf(a->path, sizeof(a->path), "%s", slash ? slash : "/");
+
+    char host[200];
+    memcpy(host, rest, authority);
+    host[authority] = '\0';
+    snprintf(a->http_host, sizeof(a->http_host), "%s", host);
+    char *colon = strrchr(host, ':');
+    if (colon) {
+        if (colon == host || strlen(colon + 1) == 0 || strlen(colon + 1) >= sizeof(port)) return -1;
+        snprintf(port, sizeof(port), "%s", colon + 1);
+        *colon = '\0';
+    }
+
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port, &hints, &res) != 0 || !res) return -1;
+    memcpy(&a->addr, res->ai_addr, res->ai_addrlen);
+    a->addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    snprintf(a->target, sizeof(a->target), "%s", url);
+    return 0;
+}
+
+// Под mutex; полная очередь теряет самое старое событие
+static void push_locked(AlertEngine *a, const AlertEvent *e) {
+    if (a->queued == ALERT_QUEUE_SLOTS) {
+        a->head = (a->head + 1) % ALERT_QUEUE_SLOTS;
+        a->queued--;
+        __atomic_fetch_add(&a->dropped, 1, __ATOMIC_RELAXED);
+    }
+    a->queue[(a->head + a->queued) % ALERT_QUEUE_SLOTS] = *e;
+    a->queued++;
+    pthread_cond_signal(&a->cond);
+}
+
+static void emit_locked(AlertEngine *a, const AlertRule *r, int firing, long timestamp) {
+    printf("🔔 Alert %s: %s (%s = %.2f)\n", firing ? "firing" : "resolved",
+           r->name, r->expr, r->value);
+    __atomic_fetch_add(&a->events, 1, __ATOMIC_RELAXED);
+    if (a->target[0] == '\0') return;
+
+    AlertEvent e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.name, r->name, sizeof(e.name));
+    memcpy(e.expr, r->expr, sizeof(e.expr));
+    e.firing = firing;
+    e.value = r->value;
+    e.threshold = r->threshold;
+    e.timestamp = timestamp;
+    push_locked(a, &e);
+}
+
+static int matches(AlertOp op, double x, double threshold) {
+    switch (op) {
+        case ALERT_GT: return x > threshold;
+        case ALERT_GE: return x >= threshold;
+        case ALERT_LT: return x < threshold;
+        case ALERT_LE: return x <= threshold;
+    }
+    return 0;
+}
+
+void alerts_evaluate(AlertEngine *a, const HistorySample *sample, long now_ms, long timestamp) {
+    pthread_mutex_lock(&a->mutex);
+    for (int i = 0; i < a->count; i++) {
+        AlertRule *r = &a->rules[i];
+        double v = *(const double *)((const char *)sample + r->offset);
+
+        if (r->rate) {
+            if (!r->has_prev || now_ms <= r->prev_ms) {
+                r->prev = v;
+                r->prev_ms = now_ms;
+                r->has_prev = 1;
+                continue;
+            }
+            double rate = (v - r->prev) * 1000.0 / (now_ms - r->prev_ms) * r->rate_unit_s;
+            r->value = r->has_rate ? ALERT_RATE_ALPHA * rate + (1.0 - ALERT_RATE_ALPHA) * r->value : rate;
+            r->has_rate = 1;
+            r->prev = v;
+            r->prev_ms = now_ms;
+        } else {
+            r->value = v;
+        }
+
+        if (matches(r->op, r->value, r->threshold)) {
+            if (r->state == ALERT_OK) {
+                r->state = ALERT_PENDING;
+                r->since_ms = now_ms;
+            }
+            if (r->state == ALERT_PENDING && now_ms - r->since_ms >= r->for_ms) {
+                r->state = ALERT_FIRING;
+                r->changed = timestamp;
+                r->fired++;
+                emit_locked(a, r, 1, timestamp);
+            }
+        } else {
+            if (r->state == ALERT_FIRING) {
+                r->changed = timestamp;
+                emit_locked(a, r, 0, timestamp);
+            }
+            r->state = ALERT_OK;
+        }
+    }
+    pthread_mutex_unlock(&a->mutex);
+}
+
+static int take_locked(AlertEngine *a, AlertEvent *out) {
+    if (a->queued == 0) return 0;
+    *out = a->queue[a->head];
+    a->head = (a->head + 1) % ALERT_QUEUE_SLOTS;
+    a->queued--;
+    return 1;
+}
+
+int alerts_take(AlertEngine *a, AlertEvent *out) {
+    pthread_mutex_lock(&a->mutex);
+    int taken = take_locked(a, out);
+    pthread_mutex_unlock(&a->mutex);
+    return taken;
+}
+
+static void write_number(JsonWriter *w, double v) {
+    char buf[32];
+    if (!isfinite(v)) v = 0.0;
+    int n = snprintf(buf, sizeof(buf), "%.2f", v);
+    jw_raw(w, buf, n);
+}
+
+void write_alert_event_json(JsonWriter *w, const AlertEngine *a, const AlertEvent *e) {
+    jw_lit(w, "{\"rule\":");
+    jw_string(w, e->name);
+    jw_lit(w, ",\"expr\":");
+    jw_string(w, e->expr);
+    if (e->firing) jw_lit(w, ",\"state\":\"firing\"");
+    else jw_lit(w, ",\"state\":\"resolved\"");
+    jw_lit(w, ",\"value\":");
+    write_number(w, e->value);
+    jw_lit(w, ",\"threshold\":");
+    write_number(w, e->threshold);
+    jw_lit(w, ",\"timestamp\":");
+    jw_int(w, e->timestamp);
+    jw_lit(w, ",\"host\":");
+    jw_string(w, a->host);
+    jw_char(w, '}');
+}
+
+static int connect_timeout(const AlertEngine *a) {
+    int fd = socket(a->addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+
+    if (connect(fd, (const struct sockaddr *)&a->addr, a->addr_len) != 0) {
+        struct pollfd p = {.fd = fd, .events = POLLOUT};
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (errno != EINPROGRESS || poll(&p, 1, ALERT_HTTP_TIMEOUT_MS) != 1 ||
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    // дальше блокирующий ввод-вывод, но не дольше таймаута
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    struct timeval timeout = {.tv_sec = ALERT_HTTP_TIMEOUT_MS / 1000,
+                              .tv_usec = (ALERT_HTTP_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+static int send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// 0 - ответ 2xx
+static int post_event(AlertEngine *a, const AlertEvent *e) {
+    char body[512], head[512];
+    JsonWriter w;
+
+    jw_init_fixed(&w, body, sizeof(body));
+    write_alert_event_json(&w, a, e);
+    if (w.overflow) return -1;
+
+    int head_len = snprintf(head, sizeof(head),
+                            "POST %s HTTP/1.1\r\n"
+                            "Host: %s\r\n"
+                            "User-Agent: system-monitor\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Content-Length: %zu\r\n"
+                            "Connection: close\r\n"
+                            "\r\n",
+                            a->path, a->http_host, w.len);
+    if (head_len < 0 || head_len >= (int)sizeof(head)) return -1;
+
+    int fd = connect_timeout(a);
+    if (fd < 0) return -1;
+
+    char reply[64];
+    size_t got = 0;
+    int ok = send_all(fd, head, head_len) == 0 && send_all(fd, w.data, w.len) == 0;
+    while (ok && got < sizeof(reply) - 1) {
+        ssize_t n = recv(fd, reply + got, sizeof(reply) - 1 - got, 0);
+        if (n <= 0) break;
+        got += n;
+        if (memchr(reply, '\n', got)) break;
+    }
+    close(fd);
+    reply[got] = '\0';
+
+    int status = 0;
+    if (!ok || sscanf(reply, "HTTP/1.%*d %d", &status) != 1) return -1;
+    return status >= 200 && status < 300 ? 0 : -1;
+}
+
+static void *alerts_thread(void *arg) {
+    AlertEngine *a = arg;
+    AlertEvent e;
+
+    pthread_mutex_lock(&a->mutex);
+    for (;;) {
+        long now = demand_now_ms();
+        if (a->running && (a->queued == 0 || a->queue[a->head].next_try_ms > now)) {
+            if (a->queued == 0) {
+                pthread_cond_wait(&a->cond, &a->mutex);
+            } else {
+                long wake = a->queue[a->head].next_try_ms;
+                struct timespec deadline = {.tv_sec = wake / 1000, .tv_nsec = (wake % 1000) * 1000000L};
+                pthread_cond_timedwait(&a->cond, &a->mutex, &deadline);
+            }
+            continue;
+        }
+        if (!take_locked(a, &e)) break;
+        pthread_mutex_unlock(&a->mutex);
+
+        int ok = post_event(a, &e) == 0;
+
+        pthread_mutex_lock(&a->mutex);
+        if (ok) {
+            __atomic_fetch_add(&a->sent, 1, __ATOMIC_RELAXED);
+        } else if (a->running && ++e.attempts < ALERT_RETRY_MAX) {
+            // повтор остается в голове: порядок событий сохраняется
+            __atomic_fetch_add(&a->retries, 1, __ATOMIC_RELAXED);
+            e.next_try_ms = demand_now_ms() + (a->retry_base_ms << (e.attempts - 1));
+            if (a->queued == ALERT_QUEUE_SLOTS) {
+                __atomic_fetch_add(&a->dropped, 1, __ATOMIC_RELAXED);
+            } else {
+                a->head = (a->head + ALERT_QUEUE_SLOTS - 1) % ALERT_QUEUE_SLOTS;
+                a->queue[a->head] = e;
+                a->queued++;
+            }
+        } else {
+            __atomic_fetch_add(&a->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&a->mutex);
+    return NULL;
+}
+
+int alerts_start(AlertEngine *a) {
+    if (a->target[0] == '\0') return 0;
+    a->running = 1;
+    if (pthread_create(&a->thread, NULL, alerts_thread, a) != 0) {
+        perror("pthread_create");
+        a->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+// Оставшиеся события отправляются по разу, без повторов
+void alerts_stop(AlertEngine *a) {
+    if (!a->running) return;
+
+    pthread_mutex_lock(&a->mutex);
+    a->running = 0;
+    pthread_cond_signal(&a->cond);
+    pthread_mutex_unlock(&a->mutex);
+    pthread_join(a->thread, NULL);
+}
+
+void alerts_free(AlertEngine *a) {
+    pthread_mutex_destroy(&a->mutex);
+    pthread_cond_destroy(&a->cond);
+}
+
+void write_alerts_json(JsonWriter *w, AlertEngine *a, long now_ms) {
+    pthread_mutex_lock(&a->mutex);
+    jw_lit(w, "{\"rules\":[");
+    for (int i = 0; i < a->count; i++) {
+        const AlertRule *r = &a->rules[i];
+        if (i) jw_char(w, ',');
+        jw_lit(w, "{\"name\":");
+        jw_string(w, r->name);
+        jw_lit(w, ",\"expr\":");
+        jw_string(w, r->expr);
+        jw_lit(w, ",\"state\":");
+        jw_string(w, state_names[r->state]);
+        jw_lit(w, ",\"value\":");
+        write_number(w, r->value);
+        jw_lit(w, ",\"threshold\":");
+        write_number(w, r->threshold);
+        jw_lit(w, ",\"for_ms\":");
+        jw_int(w, r->for_ms);
+        jw_lit(w, ",\"active_ms\":");
+        jw_int(w, r->state == ALERT_OK ? 0 : now_ms - r->since_ms);
+        jw_lit(w, ",\"changed\":");
+        jw_int(w, r->changed);
+        jw_lit(w, ",\"fired\":");
+        jw_uint(w, r->fired);
+        jw_char(w, '}');
+    }
+    jw_lit(w, "],\"events\":");
+    jw_uint(w, __atomic_load_n(&a->events, __ATOMIC_RELAXED));
+    int queued = a->queued;
+    pthread_mutex_unlock(&a->mutex);
+
+    jw_lit(w, ",\"webhook\":");
+    if (a->target[0] == '\0') {
+        jw_lit(w, "null}");
+        return;
+    }
+    jw_lit(w, "{\"target\":");
+    jw_string(w, a->target);
+    jw_lit(w, ",\"queued\":");
+    jw_int(w, queued);
+    jw_lit(w, ",\"sent\":");
+    jw_uint(w, __atomic_load_n(&a->sent, __ATOMIC_RELAXED));
+    jw_lit(w, ",\"retries\":");
+    jw_uint(w, __atomic_load_n(&a->retries, __ATOMIC_RELAXED));
+    jw_lit(w, ",\"failed\":");
+    jw_uint(w, __atomic_load_n(&a->failed, __ATOMIC_RELAXED));
+    jw_lit(w, ",\"dropped\":");
+    jw_uint(w, __atomic_load_n(&a->dropped, __ATOMIC_RELAXED));
+    jw_lit(w, "}}");
+}
@@ -0,0 +1,123 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include "config.h"
+#include "history.h"
+#include "json_writer.h"
+
+/*
+ * Пороговые алерты (--alerts rules.conf). Правило на строку:
+ *
+ *   [имя:] метрика [rate] оп порог[/s|/min|/h] [for N[s|m|h]]
+ *
+ *   cpu_hot: cpu.usage > 90 for 30s
+ *   memory.percentage rate > 5/min
+ *
+ * Метрики - поля HistorySample. Правила проверяются в потоке сбора на
+ * каждой точке истории: состояние правила - несколько чисел (начало
+ * нарушения, прошлое значение, EWMA скорости), без окон и аллокаций.
+ *
+ * Переходы в firing и обратно (resolved) кладутся в очередь на
+ * ALERT_QUEUE_SLOTS событий; при --alert-webhook http://host:port/path
+ * фоновый поток отправляет их POST-ом с JSON. Неудачная отправка
+ * повторяется с удвоением паузы, до ALERT_RETRY_MAX попыток.
+ * Переполнение очереди выбрасывает самое старое событие.
+ */
+
+typedef enum {
+    ALERT_OK,
+    ALERT_PENDING,      // условие выполняется, for еще не истек
+    ALERT_FIRING
+} AlertState;
+
+typedef enum {
+    ALERT_GT,
+    ALERT_GE,
+    ALERT_LT,
+    ALERT_LE
+} AlertOp;
+
+typedef struct {
+    char name[64];
+    char expr[128];
+    size_t offset;              // поле HistorySample
+    int rate;                   // сравнивается скорость изменения
+    double rate_unit_s;         // 1 - в секунду, 60 - в минуту
+    AlertOp op;
+    double threshold;
+    long for_ms;
+
+    AlertState state;
+    double value;               // последнее значение или сглаженная скорость
+    double prev;
+    long prev_ms;
+    int has_prev;
+    int has_rate;
+    long since_ms;              // начало текущего нарушения
+    long changed;               // timestamp последнего перехода
+    unsigned long fired;
+} AlertRule;
+
+typedef struct {
+    char name[64];
+    char expr[128];
+    int firing;                 // 0 - resolved
+    double value;
+    double threshold;
+    long timestamp;
+    int attempts;
+    long next_try_ms;
+} AlertEvent;
+
+typedef struct {
+    AlertRule rules[MAX_ALERT_RULES];
+    int count;
+    char host[64];
+
+    // вебхук; target[0] == '\0' - события только в журнале
+    char target[256];
+    char http_host[200];
+    char path[200];
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    long retry_base_ms;
+
+    // правила и очередь: голова - самое старое событие
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    AlertEvent queue[ALERT_QUEUE_SLOTS];
+    int head;
+    int queued;
+    volatile int running;
+    pthread_t thread;
+
+    // счетчики для /api/alerts (атомарные)
+    unsigned long events;
+    unsigned long sent;
+    unsigned long retries;
+    unsigned long failed;       // отброшены после ALERT_RETRY_MAX попыток
+    unsigned long dropped;      // вытеснены из полной очереди
+} AlertEngine;
+
+// 1 - правило, 0 - пустая строка или комментарий, -1 - ошибка
+int alert_parse_rule(const char *line, AlertRule *rule);
+
+int alerts_init(AlertEngine *a);
+int alerts_load(AlertEngine *a, const char *path);
+int alerts_set_webhook(AlertEngine *a, const char *url);
+int alerts_start(AlertEngine *a);
+void alerts_stop(AlertEngine *a);
+void alerts_free(AlertEngine *a);
+
+// Поток сбора: после add_history_sample
+void alerts_evaluate(AlertEngine *a, const HistorySample *sample, long now_ms, long timestamp);
+
+// Забирает самое старое событие (для потока отправки и тестов)
+int alerts_take(AlertEngine *a, AlertEvent *out);
+void write_alert_event_json(JsonWriter *w, const AlertEngine *a, const AlertEvent *e);
+void write_alerts_json(JsonWriter *w, AlertEngine *a, long now_ms);
+
+#endif
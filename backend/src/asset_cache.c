@@ -0,0 +1,323 @@
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "asset_cache.h"
+
+static const struct {
+    const char *ext;
+    const char *type;
+} asset_types[] = {
+    {".html", "text/html; charset=utf-8"},
+    {".js",   "application/javascript; charset=utf-8"},
+    {".css",  "text/css; charset=utf-8"},
+    {".json", "application/json"},
+    {".svg",  "image/svg+xml"},
+    {".png",  "image/png"},
+    {".ico",  "image/x-icon"},
+    {".woff2", "font/woff2"},
+};
+
+const char *asset_content_type(const char *name) {
+    const char *ext = strrchr(name, '.');
+    if (!ext) return NULL;
+
+    for (size_t i = 0; i < sizeof(asset_types) / sizeof(asset_types[0]); i++) {
+        if (strcmp(ext, asset_types[i].ext) == 0) return asset_types[i].type;
+    }
+    return NULL;
+}
+
+static uint64_t fnv1a(const char *data, size_t len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void body_set_etag(AssetBody *b, const char *suffix) {
+    snprintf(b->etag, sizeof(b->etag), "\"%016llx%s\"",
+             (unsigned long long)fnv1a(b->data, b->len), suffix);
+}
+
+static void body_free(AssetBody *b) {
+    free(b->data);
+    if (b->fd >= 0) close(b->fd);
+    b->data = NULL;
+    b->len = 0;
+    b->fd = -1;
+}
+
+static char *read_whole_file(const char *path, size_t len) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    char *data = malloc(len ? len : 1);
+    size_t got = 0;
+    while (data && got < len) {
+        ssize_t n = read(fd, data + got, len - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    close(fd);
+
+    if (data && got != len) {
+        free(data);
+        return NULL;
+    }
+    return data;
+}
+
+// Копия в memfd: sendfile() отдает ее без копирования через user space
+static int body_make_memfd(AssetBody *b, const char *name) {
+    if (b->len < ASSET_SENDFILE_MIN) return 0;
+
+    int fd = memfd_create(name, MFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    size_t done = 0;
+    while (done < b->len) {
+        ssize_t n = write(fd, b->data + done, b->len - done);
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        done += n;
+    }
+    b->fd = fd;
+    return 0;
+}
+
+// name.gz принимается, только если он свежее оригинала и распаковывается
+// в ту же длину (ISIZE в последних 4 байтах gzip)
+static void load_gzip_variant(Asset *a, const char *path, const struct stat *orig) {
+    char gz_path[512];
+    struct stat st;
+
+    if (snprintf(gz_path, sizeof(gz_path), "%s.gz", path) >= (int)sizeof(gz_path)) return;
+    if (stat(gz_path, &st) != 0 || !S_ISREG(st.st_mode)) return;
+
+    if (st.st_mtime < orig->st_mtime) {
+        printf("Frontend: %s is older than %s, ignoring\n", gz_path, path);
+        return;
+    }
+    if (st.st_size < 18 || st.st_size >= orig->st_size) return;
+
+    char *data = read_whole_file(gz_path, st.st_size);
+    if (!data) return;
+
+    const unsigned char *u = (const unsigned char *)data;
+    const unsigned char *tail = u + st.st_size - 4;
+    uint32_t isize = tail[0] | (tail[1] << 8) | (tail[2] << 16) | ((uint32_t)tail[3] << 24);
+
+    if (u[0] != 0x1f || u[1] != 0x8b || u[2] != 8 || isize != (uint32_t)a->plain.len) {
+        printf("Frontend: %s does not match %s, ignoring\n", gz_path, path);
+        free(data);
+        return;
+    }
+
+    a->gzip.data = data;
+    a->gzip.len = st.st_size;
+    body_set_etag(&a->gzip, "-gz");
+}
+
+static const Asset *find_exact(const AssetCache *cache, const char *path) {
+    for (int i = 0; i < cache->count; i++) {
+        if (strcmp(cache->assets[i].path, path) == 0) return &cache->assets[i];
+    }
+    return NULL;
+}
+
+static int append(char **buf, size_t *len, size_t *cap, const char *data, size_t n) {
+    if (*len + n > *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 4096;
+        while (new_cap < *len + n) new_cap *= 2;
+        char *p = realloc(*buf, new_cap);
+        if (!p) return -1;
+        *buf = p;
+        *cap = new_cap;
+    }
+    memcpy(*buf + *len, data, n);
+    *len += n;
+    return 0;
+}
+
+// src="x"/href="x" на свои файлы -> "x?v=<etag>"; внешние ссылки не трогаем.
+// Возвращает число ссылок на отсутствующие файлы или -1
+static int version_references(const AssetCache *cache, Asset *html) {
+    char *out = NULL;
+    size_t out_len = 0, out_cap = 0;
+    const char *p = html->plain.data;
+    const char *end = p + html->plain.len;
+    int missing = 0, rewritten = 0;
+
+    while (p < end) {
+        const char *attr = NULL;
+        size_t attr_len = 0;
+        for (const char *q = p; q < end; q++) {
+            if (end - q >= 5 && memcmp(q, "src=\"", 5) == 0) { attr = q; attr_len = 5; break; }
+            if (end - q >= 6 && memcmp(q, "href=\"", 6) == 0) { attr = q; attr_len = 6; break; }
+        }
+        if (!attr) break;
+
+        const char *value = attr + attr_len;
+        const char *close_quote = memchr(value, '"', end - value);
+        if (!close_quote) break;
+
+        if (append(&out, &out_len, &out_cap, p, close_quote - p) != 0) goto fail;
+        p = close_quote;
+
+        size_t value_len = close_quote - value;
+        if (value_len == 0 || value_len >= 120 || memchr(value, ':', value_len) ||
+            memchr(value, '?', value_len) || value[0] == '#' || value[0] == '/') {
+            continue;
+        }
+
+        char path[128];
+        snprintf(path, sizeof(path), "/%.*s", (int)value_len, value);
+        const Asset *target = find_exact(cache, path);
+
+        if (!target) {
+            printf("Frontend: %s references missing file %s\n", html->path + 1, path + 1);
+            missing++;
+        } else if (target->content_type != html->content_type) {
+            // etag в кавычках: берем первые 8 hex-цифр
+            char version[16];
+            int n = snprintf(version, sizeof(version), "?v=%.8s", target->plain.etag + 1);
+            if (append(&out, &out_len, &out_cap, version, n) != 0) goto fail;
+            rewritten++;
+        }
+    }
+
+    if (append(&out, &out_len, &out_cap, p, end - p) != 0) goto fail;
+
+    if (rewritten > 0) {
+        free(html->plain.data);
+        html->plain.data = out;
+        html->plain.len = out_len;
+        body_set_etag(&html->plain, "");
+        // .gz был сжат из файла до переписывания ссылок
+        body_free(&html->gzip);
+    } else {
+        free(out);
+    }
+    return missing;
+
+fail:
+    free(out);
+    return -1;
+}
+
+int asset_cache_load(AssetCache *cache, const char *dir) {
+    memset(cache, 0, sizeof(*cache));
+
+    DIR *d = opendir(dir);
+    if (!d) {
+        return -1;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        const char *name = entry->d_name;
+        if (name[0] == '.') continue;
+
+        size_t name_len = strlen(name);
+        if (name_len > 3 && strcmp(name + name_len - 3, ".gz") == 0) continue;
+
+        const char *type = asset_content_type(name);
+        if (!type || name_len >= sizeof(cache->assets[0].path) - 1) {
+            printf("Frontend: skipping %s\n", name);
+            continue;
+        }
+
+        char path[512];
+        struct stat st;
+        if (snprintf(path, sizeof(path), "%s/%s", dir, name) >= (int)sizeof(path)) continue;
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+
+        if (st.st_size == 0 || st.st_size > ASSET_FILE_MAX) {
+            printf("Frontend: skipping %s (%ld bytes)\n", name, (long)st.st_size);
+            continue;
+        }
+        if (cache->count >= ASSET_MAX_FILES) {
+            printf("Frontend: more than %d files, skipping %s\n", ASSET_MAX_FILES, name);
+            continue;
+        }
+
+        Asset *a = &cache->assets[cache->count];
+        a->plain.fd = -1;
+        a->gzip.fd = -1;
+        a->plain.data = read_whole_file(path, st.st_size);
+        if (!a->plain.data) {
+            printf("Frontend: cannot read %s\n", path);
+            continue;
+        }
+
+        a->path[0] = '/';
+        memcpy(a->path + 1, name, name_len + 1);
+        a->content_type = type;
+        a->plain.len = st.st_size;
+        body_set_etag(&a->plain, "");
+        load_gzip_variant(a, path, &st);
+        cache->count++;
+    }
+    closedir(d);
+
+    if (!find_exact(cache, "/index.html")) {
+        printf("Frontend: %s has no index.html\n", dir);
+        asset_cache_free(cache);
+        return -1;
+    }
+
+    // версии в ссылках считаются от ETag файлов, поэтому HTML - последним
+    for (int i = 0; i < cache->count; i++) {
+        Asset *a = &cache->assets[i];
+        if (strcmp(a->content_type, asset_types[0].type) != 0) continue;
+        if (version_references(cache, a) < 0) {
+            asset_cache_free(cache);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < cache->count; i++) {
+        Asset *a = &cache->assets[i];
+        if (body_make_memfd(&a->plain, a->path) != 0 ||
+            (a->gzip.data && body_make_memfd(&a->gzip, a->path) != 0)) {
+            // без memfd ответ уходит через writev из памяти
+            perror("memfd_create");
+        }
+    }
+
+    return 0;
+}
+
+void asset_cache_free(AssetCache *cache) {
+    for (int i = 0; i < cache->count; i++) {
+        body_free(&cache->assets[i].plain);
+        body_free(&cache->assets[i].gzip);
+    }
+    cache->count = 0;
+}
+
+const Asset *asset_cache_find(const AssetCache *cache, const char *request_path) {
+    char path[128];
+    size_t len = strcspn(request_path, "?#");
+
+    if (len == 0 || len >= sizeof(path) || request_path[0] != '/') return NULL;
+    memcpy(path, request_path, len);
+    path[len] = '\0';
+
+    if (strcmp(path, "/") == 0) {
+        return find_exact(cache, "/index.html");
+    }
+    // только файлы верхнего уровня каталога: "/a/b" и ".." не совпадут ни с чем
+    if (strchr(path + 1, '/')) return NULL;
+    return find_exact(cache, path);
+}
@@ -0,0 +1,48 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <stddef.h>
+#include "config.h"
+
+/*
+ * Статика фронтенда в памяти: файлы каталога читаются один раз при старте,
+ * дальше отдаются без обращений к диску.
+ *
+ * - ETag - FNV-1a 64 от содержимого, считается при загрузке
+ * - name.gz рядом с файлом (gzip -k) подхватывается как сжатый вариант,
+ *   если он не старше оригинала и его ISIZE совпадает с длиной оригинала
+ * - в HTML ссылки на свои файлы переписываются в "app.js?v=<etag>",
+ *   поэтому такие адреса можно кэшировать в браузере надолго
+ * - содержимое продублировано в memfd для sendfile()
+ *
+ * После asset_cache_load кэш только читается - блокировки не нужны.
+ */
+
+typedef struct {
+    char *data;
+    size_t len;
+    char etag[32];
+    int fd;                 // memfd или -1
+} AssetBody;
+
+typedef struct {
+    char path[128];         // "/app.js"
+    const char *content_type;
+    AssetBody plain;
+    AssetBody gzip;         // data == NULL, если .gz нет
+} Asset;
+
+typedef struct {
+    Asset assets[ASSET_MAX_FILES];
+    int count;
+} AssetCache;
+
+int asset_cache_load(AssetCache *cache, const char *dir);
+void asset_cache_free(AssetCache *cache);
+
+// Путь запроса без query; "/" - это "/index.html". NULL для чужих путей
+const Asset *asset_cache_find(const AssetCache *cache, const char *request_path);
+
+const char *asset_content_type(const char *name);
+
+#endif
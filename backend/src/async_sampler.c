@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "async_sampler.h"
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void *async_sampler_thread(void *arg) {
+    AsyncSampler *a = arg;
+
+    pthread_mutex_lock(&a->mutex);
+    while (a->running) {
+        if (!a->requested) {
+            pthread_cond_wait(&a->cond, &a->mutex);
+            continue;
+        }
+        a->requested = 0;
+        a->busy = 1;
+        a->started_ms = now_ms();
+        pthread_mutex_unlock(&a->mutex);
+
+        int result = a->sample(a->ctx, a->work);
+
+        pthread_mutex_lock(&a->mutex);
+        long end = now_ms();
+        a->runs++;
+        a->last_ms = end - a->started_ms;
+        if (result == 0) {
+            memcpy(a->latest, a->work, a->size);
+            a->latest_ms = end;
+            a->has_result = 1;
+        } else {
+            a->failures++;
+        }
+        if (a->hung) printf("%s worker recovered after %ld ms\n", a->name, a->last_ms);
+        a->busy = 0;
+        a->hung = 0;
+    }
+    pthread_mutex_unlock(&a->mutex);
+    return NULL;
+}
+
+int async_sampler_start(AsyncSampler *a, const char *name, AsyncSampleFn sample, void *ctx,
+                        size_t size, long watchdog_ms) {
+    memset(a, 0, sizeof(AsyncSampler));
+    a->name = name;
+    a->sample = sample;
+    a->ctx = ctx;
+    a->size = size;
+    a->watchdog_ms = watchdog_ms;
+    a->work = calloc(1, size);
+    a->latest = calloc(1, size);
+    if (!a->work || !a->latest) {
+        free(a->work);
+        free(a->latest);
+        return -1;
+    }
+
+    pthread_mutex_init(&a->mutex, NULL);
+    pthread_cond_init(&a->cond, NULL);
+    a->running = 1;
+    if (pthread_create(&a->thread, NULL, async_sampler_thread, a) != 0) {
+        perror("pthread_create");
+        pthread_mutex_destroy(&a->mutex);
+        pthread_cond_destroy(&a->cond);
+        free(a->work);
+        free(a->latest);
+        a->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void async_sampler_stop(AsyncSampler *a) {
+    if (!a->running) return;
+
+    pthread_mutex_lock(&a->mutex);
+    a->running = 0;
+    pthread_cond_signal(&a->cond);
+    pthread_mutex_unlock(&a->mutex);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += a->watchdog_ms / 1000;
+    deadline.tv_nsec += (a->watchdog_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    if (pthread_timedjoin_np(a->thread, NULL, &deadline) != 0) {
+        // поток еще в sample и пишет в свои буферы: память остается ему
+        printf("%s worker still busy at shutdown, detached\n", a->name);
+        pthread_detach(a->thread);
+        return;
+    }
+
+    pthread_mutex_destroy(&a->mutex);
+    pthread_cond_destroy(&a->cond);
+    free(a->work);
+    free(a->latest);
+    a->work = NULL;
+    a->latest = NULL;
+}
+
+int async_sampler_request(AsyncSampler *a) {
+    int queued = 0;
+    pthread_mutex_lock(&a->mutex);
+    if (a->running && !a->busy) {
+        a->requested = 1;
+        pthread_cond_signal(&a->cond);
+        queued = 1;
+    }
+    pthread_mutex_unlock(&a->mutex);
+    return queued;
+}
+
+int async_sampler_take(AsyncSampler *a, void *out, long *sample_ms) {
+    pthread_mutex_lock(&a->mutex);
+    int has = a->has_result;
+    if (has) {
+        memcpy(out, a->latest, a->size);
+        if (sample_ms) *sample_ms = a->latest_ms;
+    }
+    pthread_mutex_unlock(&a->mutex);
+    return has;
+}
+
+int async_sampler_watchdog(AsyncSampler *a, long now_ms) {
+    pthread_mutex_lock(&a->mutex);
+    if (a->busy && !a->hung && now_ms - a->started_ms > a->watchdog_ms) {
+        a->hung = 1;
+        a->watchdog_trips++;
+        printf("%s worker stuck for %ld ms, not scheduling new samples\n",
+               a->name, now_ms - a->started_ms);
+    }
+    int hung = a->hung;
+    pthread_mutex_unlock(&a->mutex);
+    return hung;
+}
+
+void write_async_sampler_json(JsonWriter *w, AsyncSampler *a) {
+    pthread_mutex_lock(&a->mutex);
+    jw_lit(w, "{\"busy\":");
+    if (a->busy) jw_lit(w, "true");
+    else jw_lit(w, "false");
+    jw_lit(w, ",\"hung\":");
+    if (a->hung) jw_lit(w, "true");
+    else jw_lit(w, "false");
+    jw_lit(w, ",\"runs\":");
+    jw_uint(w, a->runs);
+    jw_lit(w, ",\"failures\":");
+    jw_uint(w, a->failures);
+    jw_lit(w, ",\"watchdog_trips\":");
+    jw_uint(w, a->watchdog_trips);
+    jw_lit(w, ",\"last_ms\":");
+    jw_int(w, a->last_ms);
+    jw_char(w, '}');
+    pthread_mutex_unlock(&a->mutex);
+}
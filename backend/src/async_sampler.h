@@ -0,0 +1,61 @@
+#ifndef ASYNC_SAMPLER_H
+#define ASYNC_SAMPLER_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include "json_writer.h"
+
+/*
+ * Медленный замер (nvidia-smi) в своем потоке: тик только просит новый
+ * замер и забирает последний готовый, поэтому CPU и память обновляются
+ * по расписанию, что бы ни делал медленный путь.
+ *
+ * Дочерние процессы ограничивает сам sample (command_read убивает их по
+ * дедлайну). Сторож ловит остальное: замер дольше watchdog_ms помечается
+ * hung, и новые запросы не ставятся, пока воркер не вернется.
+ */
+
+// Поток воркера: заполняет out, 0 - успех
+typedef int (*AsyncSampleFn)(void *ctx, void *out);
+
+typedef struct {
+    const char *name;
+    AsyncSampleFn sample;
+    void *ctx;
+    size_t size;
+    void *work;                 // пишет только воркер
+    void *latest;               // последний удачный замер, под mutex
+    long watchdog_ms;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int running;
+    int requested;
+    int busy;
+    int hung;
+    int has_result;
+    long started_ms;            // монотонное время начала текущего замера
+    long latest_ms;             // конец последнего удачного замера
+
+    unsigned long runs;
+    unsigned long failures;
+    unsigned long watchdog_trips;
+    long last_ms;               // длительность последнего замера
+} AsyncSampler;
+
+int async_sampler_start(AsyncSampler *a, const char *name, AsyncSampleFn sample, void *ctx,
+                        size_t size, long watchdog_ms);
+// Зависший воркер не ждется дольше watchdog_ms: поток отсоединяется, буферы остаются ему
+void async_sampler_stop(AsyncSampler *a);
+
+// Не блокируется: 1 - замер запрошен, 0 - воркер занят или завис
+int async_sampler_request(AsyncSampler *a);
+// Копия последнего удачного замера и его время; 0 - замеров еще не было
+int async_sampler_take(AsyncSampler *a, void *out, long *sample_ms);
+// 1 - текущий замер идет дольше watchdog_ms
+int async_sampler_watchdog(AsyncSampler *a, long now_ms);
+
+void write_async_sampler_json(JsonWriter *w, AsyncSampler *a);
+
+#endif
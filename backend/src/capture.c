@@ -0,0 +1,525 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "config.h"
+#include "capture.h"
+#include "proc_parser.h"
+
+#define CAPTURE_FRAME_HEADER 21
+#define CAPTURE_ENTRY_HEADER 7
+
+enum { CAPTURE_OFF, CAPTURE_RECORD, CAPTURE_REPLAY };
+
+// Файл, записанный в прошлых кадрах: хеши пути и содержимого
+typedef struct {
+    uint64_t path_hash;
+    uint64_t data_hash;
+    unsigned tick;
+} SeenFile;
+
+static int mode = CAPTURE_OFF;
+static FILE *capture_file = NULL;
+
+// запись: текущий кадр копится в памяти и дописывается одним fwrite
+static char *frame = NULL;
+static size_t frame_len = 0, frame_cap = 0;
+static unsigned frame_entries = 0;
+// readdir за тик: пары "каталог\0имя\0", в кадр идут в конце, по каталогам
+static char *lists = NULL;
+static size_t lists_len = 0, lists_cap = 0;
+static SeenFile *seen = NULL;
+static unsigned seen_count = 0;
+static unsigned tick = 1;
+
+// воспроизведение
+static double replay_speed = 1.0;
+static char replay_root[64];
+static char *entry_buf = NULL;
+static size_t entry_cap = 0;
+
+static uint64_t fnv1a(const char *data, size_t len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void put_u16(char *p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static void put_u32(char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xff;
+}
+
+static void put_u64(char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (v >> (8 * i)) & 0xff;
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+int capture_recording(void) {
+    return mode == CAPTURE_RECORD;
+}
+
+int capture_replaying(void) {
+    return mode == CAPTURE_REPLAY;
+}
+
+// "/proc/123/stat" -> "proc/123/stat" относительно текущих корней
+static const char *relative_path(const char *path, char *out, size_t size) {
+    const char *roots[2] = {get_proc_root(), get_sys_root()};
+    const char *names[2] = {"proc", "sys"};
+
+    for (int i = 0; i < 2; i++) {
+        size_t len = strlen(roots[i]);
+        if (strncmp(path, roots[i], len) != 0) continue;
+        if (path[len] != '/' && path[len] != '\0') continue;
+        int n = snprintf(out, size, "%s%s", names[i], path + len);
+        return (n > 0 && (size_t)n < size) ? out : NULL;
+    }
+    return NULL;
+}
+
+static int reserve(char **buf, size_t *cap, size_t len, size_t extra) {
+    if (len + extra <= *cap) return 0;
+    size_t grown_cap = *cap ? *cap : 65536;
+    while (grown_cap < len + extra) grown_cap *= 2;
+    char *grown = realloc(*buf, grown_cap);
+    if (!grown) return -1;
+    *buf = grown;
+    *cap = grown_cap;
+    return 0;
+}
+
+static int frame_reserve(size_t extra) {
+    return reserve(&frame, &frame_cap, frame_len, extra);
+}
+
+static long frame_add(char kind, const char *rel, const char *data, size_t len) {
+    size_t path_len = strlen(rel);
+    if (frame_reserve(CAPTURE_ENTRY_HEADER + path_len + len) != 0) return -1;
+
+    long offset = (long)frame_len;
+    char *p = frame + frame_len;
+    p[0] = kind;
+    put_u16(p + 1, (uint16_t)path_len);
+    put_u32(p + 3, (uint32_t)len);
+    memcpy(p + CAPTURE_ENTRY_HEADER, rel, path_len);
+    if (len > 0) memcpy(p + CAPTURE_ENTRY_HEADER + path_len, data, len);
+    frame_len += CAPTURE_ENTRY_HEADER + path_len + len;
+    frame_entries++;
+    return offset;
+}
+
+// Уже записанный и не изменившийся файл повторно не пишется. Файл, который
+// не читался в прошлом тике, пишется заново: между тиками он мог исчезнуть.
+static int seen_unchanged(const char *rel, const char *data, size_t len) {
+    uint64_t path_hash = fnv1a(rel, strlen(rel));
+    uint64_t data_hash = fnv1a(data, len);
+    unsigned mask = CAPTURE_SEEN_SIZE - 1;
+    unsigned i = (unsigned)path_hash & mask;
+
+    while (seen[i].path_hash != 0 && seen[i].path_hash != path_hash) {
+        i = (i + 1) & mask;
+    }
+
+    if (seen[i].path_hash == path_hash) {
+        int unchanged = seen[i].data_hash == data_hash && seen[i].tick + 1 >= tick;
+        seen[i].data_hash = data_hash;
+        seen[i].tick = tick;
+        return unchanged;
+    }
+
+    if (seen_count >= CAPTURE_SEEN_SIZE / 4 * 3) {
+        // таблица заполнена: следующие кадры запишут файлы целиком
+        memset(seen, 0, CAPTURE_SEEN_SIZE * sizeof(SeenFile));
+        seen_count = 0;
+        i = (unsigned)path_hash & mask;
+    }
+    seen[i].path_hash = path_hash;
+    seen[i].data_hash = data_hash;
+    seen[i].tick = tick;
+    seen_count++;
+    return 0;
+}
+
+int capture_record_open(const char *path) {
+    capture_file = fopen(path, "ab");
+    seen = calloc(CAPTURE_SEEN_SIZE, sizeof(SeenFile));
+    if (!capture_file || !seen) {
+        fprintf(stderr, "Cannot open capture file %s\n", path);
+        capture_close();
+        return -1;
+    }
+
+    // новый файл получает заголовок, существующий дописывается
+    if (ftell(capture_file) == 0) {
+        char header[8];
+        memcpy(header, CAPTURE_MAGIC, 6);
+        put_u16(header + 6, CAPTURE_VERSION);
+        fwrite(header, 1, sizeof(header), capture_file);
+    }
+
+    mode = CAPTURE_RECORD;
+    printf("Recording procfs/sysfs reads to %s\n", path);
+    return 0;
+}
+
+void capture_note_file(const char *path, const char *data, size_t len) {
+    char rel[CAPTURE_PATH_MAX];
+    if (mode != CAPTURE_RECORD || !relative_path(path, rel, sizeof(rel))) return;
+
+    if (!seen_unchanged(rel, data, len)) {
+        frame_add('F', rel, data, len);
+    }
+}
+
+void capture_note_missing(const char *path) {
+    char rel[CAPTURE_PATH_MAX];
+    if (mode != CAPTURE_RECORD || !relative_path(path, rel, sizeof(rel))) return;
+
+    frame_add('X', rel, NULL, 0);
+}
+
+void capture_note_entry(const char *dir, const char *name) {
+    if (mode != CAPTURE_RECORD) return;
+
+    size_t dir_len = strlen(dir) + 1, name_len = strlen(name) + 1;
+    if (reserve(&lists, &lists_cap, lists_len, dir_len + name_len) != 0) return;
+    memcpy(lists + lists_len, dir, dir_len);
+    memcpy(lists + lists_len + dir_len, name, name_len);
+    lists_len += dir_len + name_len;
+}
+
+static int compare_dirs(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Имена одного каталога собираются в одну запись 'L': readdir прерывается
+// чтением файлов, а обход cgroup рекурсивный
+static void flush_listings(void) {
+    size_t count = 0;
+    for (size_t off = 0; off < lists_len; off += strlen(lists + off) + 1) count++;
+    if (count == 0) return;
+
+    char **pairs = malloc(count / 2 * sizeof(char *));
+    if (!pairs) return;
+    size_t n = 0;
+    for (size_t off = 0; off < lists_len && n < count / 2; n++) {
+        pairs[n] = lists + off;
+        off += strlen(lists + off) + 1;
+        off += strlen(lists + off) + 1;
+    }
+    qsort(pairs, n, sizeof(char *), compare_dirs);
+
+    char rel[CAPTURE_PATH_MAX];
+    long entry = -1;
+    for (size_t i = 0; i < n; i++) {
+        const char *dir = pairs[i];
+        const char *name = dir + strlen(dir) + 1;
+
+        if (i == 0 || strcmp(dir, pairs[i - 1]) != 0) {
+            entry = relative_path(dir, rel, sizeof(rel)) ? frame_add('L', rel, NULL, 0) : -1;
+        }
+        if (entry < 0) continue;
+
+        size_t len = strlen(name) + 1;
+        if (frame_reserve(len) != 0) break;
+        memcpy(frame + frame_len, name, len);
+        frame_len += len;
+        char *header = frame + entry;
+        put_u32(header + 3, get_u32((unsigned char *)header + 3) + (uint32_t)len);
+    }
+
+    free(pairs);
+    lists_len = 0;
+}
+
+// Чтение целиком до CAPTURE_FILE_MAX; парсеру отдается копия в памяти
+FILE *capture_fopen(const char *path) {
+    if (mode != CAPTURE_RECORD) return fopen(path, "r");
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT || errno == ENOTDIR) capture_note_missing(path);
+        return NULL;
+    }
+
+    char *data = malloc(CAPTURE_FILE_MAX);
+    size_t len = 0;
+    ssize_t n;
+    while (data && len < CAPTURE_FILE_MAX &&
+           (n = read(fd, data + len, CAPTURE_FILE_MAX - len)) > 0) {
+        len += n;
+    }
+    close(fd);
+    if (!data) return NULL;
+
+    capture_note_file(path, data, len);
+
+    FILE *fp = fmemopen(NULL, len + 1, "w+");
+    if (fp) {
+        fwrite(data, 1, len, fp);
+        rewind(fp);
+    }
+    free(data);
+    return fp;
+}
+
+int capture_access(const char *path, int mode_flags) {
+    int result = access(path, mode_flags);
+    char rel[CAPTURE_PATH_MAX];
+
+    if (result == 0 && mode == CAPTURE_RECORD && relative_path(path, rel, sizeof(rel))) {
+        frame_add('E', rel, NULL, 0);
+    }
+    return result;
+}
+
+void capture_end_tick(double elapsed_sec) {
+    if (mode != CAPTURE_RECORD) return;
+    flush_listings();
+
+    char header[CAPTURE_FRAME_HEADER];
+    header[0] = 'T';
+    put_u32(header + 1, frame_entries);
+    put_u64(header + 5, (uint64_t)(elapsed_sec * 1e6));
+    put_u64(header + 13, (uint64_t)time(NULL));
+
+    if (fwrite(header, 1, sizeof(header), capture_file) != sizeof(header) ||
+        fwrite(frame, 1, frame_len, capture_file) != frame_len) {
+        fprintf(stderr, "Capture write failed, recording stopped\n");
+        capture_close();
+        return;
+    }
+    fflush(capture_file);
+
+    frame_len = 0;
+    frame_entries = 0;
+    tick++;
+}
+
+static int make_parents(char *path) {
+    for (char *p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+        *p = '\0';
+        int result = mkdir(path, 0755);
+        *p = '/';
+        if (result != 0 && errno != EEXIST) return -1;
+    }
+    return 0;
+}
+
+// Удаляемый файл сначала обрезается: закешированный дескриптор ProcFile
+// прочитает пустой файл, как у исчезнувшего процесса
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    (void)st;
+    (void)ftw;
+    if (flag == FTW_F && truncate(path, 0) != 0 && errno == ENOENT) return 0;
+    remove(path);
+    return 0;
+}
+
+static void remove_tree(const char *path) {
+    nftw(path, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static int name_listed(const char *names, size_t len, const char *name) {
+    for (size_t off = 0; off < len; off += strlen(names + off) + 1) {
+        if (strcmp(names + off, name) == 0) return 1;
+    }
+    return 0;
+}
+
+static void apply_listing(const char *dir_path, const char *names, size_t len) {
+    DIR *dir = opendir(dir_path);
+    if (!dir) return;
+
+    struct dirent *entry;
+    char child[CAPTURE_PATH_MAX + 80];
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        if (name_listed(names, len, entry->d_name)) continue;
+
+        struct stat st;
+        int n = snprintf(child, sizeof(child), "%s/%s", dir_path, entry->d_name);
+        if (n <= 0 || n >= (int)sizeof(child)) continue;
+        if (lstat(child, &st) == 0 && S_ISDIR(st.st_mode)) {
+            remove_tree(child);
+        }
+    }
+    closedir(dir);
+}
+
+static int apply_entry(char kind, const char *rel, const char *data, size_t len) {
+    char path[CAPTURE_PATH_MAX + 80];
+    if (strstr(rel, "..")) return -1;
+    snprintf(path, sizeof(path), "%s/%s", replay_root, rel);
+
+    switch (kind) {
+    case 'F': {
+        if (make_parents(path) != 0) return -1;
+        // перезапись на месте: открытые дескрипторы видят новое содержимое
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return -1;
+        ssize_t written = write(fd, data, len);
+        close(fd);
+        return (written == (ssize_t)len) ? 0 : -1;
+    }
+    case 'X':
+        if (truncate(path, 0) == 0 || errno != ENOENT) unlink(path);
+        return 0;
+    case 'E':
+        if (access(path, F_OK) != 0) {
+            make_parents(path);
+            mkdir(path, 0755);
+        }
+        return 0;
+    case 'L':
+        apply_listing(path, data, len);
+        return 0;
+    }
+    return -1;
+}
+
+static int replay_frame(double *elapsed) {
+    unsigned char header[CAPTURE_FRAME_HEADER];
+    if (fread(header, 1, sizeof(header), capture_file) != sizeof(header) || header[0] != 'T') {
+        return -1;
+    }
+    uint32_t entries = get_u32(header + 1);
+    *elapsed = get_u64(header + 5) / 1e6;
+
+    for (uint32_t i = 0; i < entries; i++) {
+        unsigned char eh[CAPTURE_ENTRY_HEADER];
+        if (fread(eh, 1, sizeof(eh), capture_file) != sizeof(eh)) return -1;
+        size_t path_len = eh[1] | (eh[2] << 8);
+        size_t data_len = get_u32(eh + 3);
+        if (path_len == 0 || path_len >= CAPTURE_PATH_MAX || data_len > CAPTURE_FILE_MAX) return -1;
+
+        if (entry_cap < path_len + data_len + 1) {
+            char *grown = realloc(entry_buf, path_len + data_len + 1);
+            if (!grown) return -1;
+            entry_buf = grown;
+            entry_cap = path_len + data_len + 1;
+        }
+        if (fread(entry_buf, 1, path_len + data_len, capture_file) != path_len + data_len) return -1;
+
+        // путь копируется: данные 'L' идут сразу за ним без разделителя
+        char rel[CAPTURE_PATH_MAX];
+        memcpy(rel, entry_buf, path_len);
+        rel[path_len] = '\0';
+        apply_entry(eh[0], rel, entry_buf + path_len, data_len);
+    }
+    return 0;
+}
+
+int capture_replay_open(const char *path, double speed) {
+    char header[8];
+
+    capture_file = fopen(path, "rb");
+    if (!capture_file || fread(header, 1, sizeof(header), capture_file) != sizeof(header) ||
+        memcmp(header, CAPTURE_MAGIC, 6) != 0) {
+        fprintf(stderr, "Not a capture file: %s\n", path);
+        capture_close();
+        return -1;
+    }
+
+    snprintf(replay_root, sizeof(replay_root), "/tmp/system_monitor_replay_XXXXXX");
+    if (!mkdtemp(replay_root)) {
+        replay_root[0] = '\0';
+        capture_close();
+        return -1;
+    }
+    mode = CAPTURE_REPLAY;
+    replay_speed = speed > 0 ? speed : 1.0;
+
+    // кадр 0 - состояние на момент инициализации коллекторов
+    double elapsed;
+    if (replay_frame(&elapsed) != 0) {
+        fprintf(stderr, "Capture file %s has no frames\n", path);
+        capture_close();
+        return -1;
+    }
+
+    char root[sizeof(replay_root) + 8];
+    snprintf(root, sizeof(root), "%s/proc", replay_root);
+    set_proc_root(root);
+    snprintf(root, sizeof(root), "%s/sys", replay_root);
+    set_sys_root(root);
+
+    printf("Replaying %s at %.1fx from %s\n", path, replay_speed, replay_root);
+    return 0;
+}
+
+double capture_replay_next(void) {
+    if (mode != CAPTURE_REPLAY) return -1.0;
+
+    long pos = ftell(capture_file);
+    double elapsed;
+    unsigned char kind;
+
+    // размер кадра заранее неизвестен: интервал берется из заголовка
+    if (fread(&kind, 1, 1, capture_file) == 1 && kind == 'T') {
+        unsigned char header[CAPTURE_FRAME_HEADER - 1];
+        if (fread(header, 1, sizeof(header), capture_file) == sizeof(header)) {
+            double interval = get_u64(header + 4) / 1e6 / replay_speed;
+            struct timespec ts = {(time_t)interval, (long)((interval - (time_t)interval) * 1e9)};
+            nanosleep(&ts, NULL);
+        }
+    }
+    fseek(capture_file, pos, SEEK_SET);
+
+    if (replay_frame(&elapsed) == 0) return elapsed;
+
+    // конец записи (или оборванный последний кадр): заново с кадра 0
+    printf("Replay reached end of capture, restarting\n");
+    fseek(capture_file, 8, SEEK_SET);
+    if (replay_frame(&elapsed) != 0 || replay_frame(&elapsed) != 0) return -1.0;
+    return elapsed;
+}
+
+void capture_close(void) {
+    if (capture_file) {
+        fclose(capture_file);
+        capture_file = NULL;
+    }
+    if (mode == CAPTURE_REPLAY && replay_root[0]) {
+        remove_tree(replay_root);
+        set_proc_root(PROC_ROOT);
+        set_sys_root(SYS_ROOT);
+    }
+    replay_root[0] = '\0';
+
+    free(frame);
+    free(lists);
+    free(seen);
+    free(entry_buf);
+    frame = NULL;
+    lists = NULL;
+    seen = NULL;
+    entry_buf = NULL;
+    frame_len = frame_cap = lists_len = lists_cap = entry_cap = 0;
+    frame_entries = seen_count = 0;
+    tick = 1;
+    mode = CAPTURE_OFF;
+}
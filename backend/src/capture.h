@@ -0,0 +1,51 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Запись сырых байтов procfs/sysfs (--record) и воспроизведение (--replay).
+ * Файл только дописывается, все числа little-endian.
+ *
+ * Заголовок, 8 байт: char[6] magic "SMREC1", u16 version
+ *
+ * Кадр - один тик сборщика (кадр 0 - чтения при инициализации коллекторов):
+ *   u8 'T', u32 entry_count, u64 elapsed_us, i64 timestamp
+ * Запись кадра:
+ *   u8 kind, u16 path_len, u32 data_len, path (без '\0'), data
+ *   'F' - содержимое файла; файл, не изменившийся с прошлого тика, не пишется
+ *   'X' - файл исчез (ENOENT)
+ *   'E' - путь существует (проверка через access)
+ *   'L' - каталог прочитан readdir, data - имена через '\0' (пустое имя -
+ *         каталог без подкаталогов); при воспроизведении остальные
+ *         подкаталоги удаляются. Записи 'L' идут в конце кадра
+ *
+ * Пути относительные: "proc/..." и "sys/..." от корней procfs/sysfs.
+ * Воспроизведение раскладывает кадры во временное дерево и переключает
+ * на него корни, поэтому байты идут через те же парсеры.
+ */
+
+#define CAPTURE_MAGIC "SMREC1"
+#define CAPTURE_VERSION 1
+
+int capture_record_open(const char *path);
+int capture_replay_open(const char *path, double speed);
+void capture_close(void);
+int capture_recording(void);
+int capture_replaying(void);
+
+// Хуки чтения: без --record ничего не делают
+void capture_note_file(const char *path, const char *data, size_t len);
+void capture_note_missing(const char *path);
+void capture_note_entry(const char *dir, const char *name);
+FILE *capture_fopen(const char *path);
+int capture_access(const char *path, int mode);
+
+void capture_end_tick(double elapsed_sec);
+
+// Ждет записанный интервал / speed и раскладывает следующий кадр;
+// возвращает записанный интервал или -1. В конце файла начинает сначала.
+double capture_replay_next(void);
+
+#endif
@@ -0,0 +1,456 @@
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "cgroup_collector.h"
+#include "capture.h"
+
+static int is_cgroup2_root(const char *dir) {
+    char path[PROCFS_PATH_MAX + 32];
+    snprintf(path, sizeof(path), "%s/cgroup.controllers", dir);
+    return capture_access(path, R_OK) == 0;
+}
+
+// На каждый узел держится до шести дескрипторов, поднимаем мягкий лимит
+static void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+int cgroup_collector_init(CgroupCollector *c, const char *cgroup_root, const char *proc_root) {
+    memset(c, 0, sizeof(CgroupCollector));
+
+    // гибридная иерархия: v2 смонтирована в unified/
+    if (is_cgroup2_root(cgroup_root)) {
+        snprintf(c->root, sizeof(c->root), "%s", cgroup_root);
+    } else {
+        snprintf(c->root, sizeof(c->root), "%s/unified", cgroup_root);
+        if (!is_cgroup2_root(c->root)) return -1;
+    }
+    snprintf(c->proc_root, sizeof(c->proc_root), "%s", proc_root);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    c->online_cpus = cpus > 0 ? (int)cpus : 1;
+
+    raise_fd_limit();
+
+    return cgroup_collector_scan(c) > 0 ? 0 : -1;
+}
+
+static void close_node(CgroupNode *n) {
+    procfile_close(&n->cpu_stat);
+    procfile_close(&n->memory_current);
+    procfile_close(&n->memory_stat);
+    procfile_close(&n->cpu_pressure);
+    procfile_close(&n->memory_pressure);
+    procfile_close(&n->io_pressure);
+    n->in_use = 0;
+}
+
+void cgroup_collector_free(CgroupCollector *c) {
+    for (int i = 0; i < MAX_CGROUPS; i++) {
+        if (c->nodes[i].in_use) close_node(&c->nodes[i]);
+    }
+    c->count = 0;
+}
+
+int find_cgroup_node(const CgroupCollector *c, const char *path) {
+    for (int i = 0; i < MAX_CGROUPS; i++) {
+        if (c->nodes[i].in_use && strcmp(c->nodes[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+static void node_file(const CgroupCollector *c, const CgroupNode *n, ProcFile *f, const char *name) {
+    char path[PROCFS_PATH_MAX];
+    int len = snprintf(path, sizeof(path), "%s%s/%s", c->root,
+                       strcmp(n->path, "/") == 0 ? "" : n->path, name);
+    procfile_init(f, path);
+    if (len < 0 || len >= (int)sizeof(path)) f->missing = 1;
+}
+
+// cpu.max: "max 100000" или "50000 100000" (квота и период в мкс)
+static double read_quota_cpus(const CgroupCollector *c, const CgroupNode *n) {
+    ProcFile f;
+    char buf[64];
+    double quota = 0.0;
+
+    node_file(c, n, &f, "cpu.max");
+    if (procfile_read(&f, buf, sizeof(buf)) > 0 && strncmp(buf, "max", 3) != 0) {
+        const char *p = buf;
+        unsigned long long limit = parse_ull(&p);
+        unsigned long long period = parse_ull(&p);
+        if (period > 0) quota = (double)limit / period;
+    }
+    procfile_close(&f);
+
+    return quota;
+}
+
+static int register_node(CgroupCollector *c, const char *path, int parent, int depth) {
+    int idx = find_cgroup_node(c, path);
+
+    if (idx < 0) {
+        for (int i = 0; i < MAX_CGROUPS; i++) {
+            if (!c->nodes[i].in_use) {
+                idx = i;
+                break;
+            }
+        }
+        if (idx < 0) return -1;
+
+        CgroupNode *n = &c->nodes[idx];
+        memset(n, 0, sizeof(CgroupNode));
+        snprintf(n->path, sizeof(n->path), "%s", path);
+        node_file(c, n, &n->cpu_stat, "cpu.stat");
+        node_file(c, n, &n->memory_current, "memory.current");
+        node_file(c, n, &n->memory_stat, "memory.stat");
+        node_file(c, n, &n->cpu_pressure, "cpu.pressure");
+        node_file(c, n, &n->memory_pressure, "memory.pressure");
+        node_file(c, n, &n->io_pressure, "io.pressure");
+        n->in_use = 1;
+    }
+
+    CgroupNode *n = &c->nodes[idx];
+    n->seen = 1;
+    n->parent = parent;
+    n->depth = depth;
+    n->quota_cpus = read_quota_cpus(c, n);
+
+    return idx;
+}
+
+static void walk_cgroups(CgroupCollector *c, const char *path, int parent, int depth) {
+    char dir_path[PROCFS_PATH_MAX];
+    int root = strcmp(path, "/") == 0;
+
+    int idx = register_node(c, path, parent, depth);
+    if (idx < 0 || depth >= CGROUP_MAX_DEPTH) return;
+
+    snprintf(dir_path, sizeof(dir_path), "%s%s", c->root, root ? "" : path);
+    DIR *dir = opendir(dir_path);
+    if (!dir) return;
+    // пустое имя: каталог прочитан, даже если подгрупп в нем не осталось
+    capture_note_entry(dir_path, "");
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            char full[PROCFS_PATH_MAX + 256];
+            snprintf(full, sizeof(full), "%s/%s", dir_path, entry->d_name);
+            if (stat(full, &st) != 0 || !S_ISDIR(st.st_mode)) continue;
+        } else if (entry->d_type != DT_DIR) {
+            continue;
+        }
+
+        capture_note_entry(dir_path, entry->d_name);
+        char child[CGROUP_PATH_MAX];
+        int n = snprintf(child, sizeof(child), "%s/%s", root ? "" : path, entry->d_name);
+        if (n <= 0 || n >= (int)sizeof(child)) continue;
+
+        walk_cgroups(c, child, idx, depth + 1);
+    }
+
+    closedir(dir);
+}
+
+// Обходит дерево, добавляет новые группы и закрывает исчезнувшие.
+// Возвращает число групп.
+int cgroup_collector_scan(CgroupCollector *c) {
+    for (int i = 0; i < MAX_CGROUPS; i++) {
+        c->nodes[i].seen = 0;
+    }
+
+    walk_cgroups(c, "/", -1, 0);
+
+    c->count = 0;
+    for (int i = MAX_CGROUPS - 1; i >= 0; i--) {
+        CgroupNode *n = &c->nodes[i];
+        if (n->in_use && !n->seen) close_node(n);
+        n->first_child = -1;
+        n->next_sibling = -1;
+    }
+    for (int i = MAX_CGROUPS - 1; i >= 0; i--) {
+        CgroupNode *n = &c->nodes[i];
+        if (!n->in_use) continue;
+        c->count++;
+        if (n->parent >= 0) {
+            n->next_sibling = c->nodes[n->parent].first_child;
+            c->nodes[n->parent].first_child = i;
+        }
+    }
+
+    // группы процессов могли смениться - кеш принадлежности устарел
+    c->generation++;
+
+    return c->count;
+}
+
+void cgroup_collector_sample(CgroupCollector *c, double elapsed_sec, long now) {
+    char buf[8192];
+
+    c->timestamp = now;
+
+    for (int i = 0; i < MAX_CGROUPS; i++) {
+        CgroupNode *n = &c->nodes[i];
+        if (!n->in_use) continue;
+
+        unsigned long long usage;
+        if (procfile_read(&n->cpu_stat, buf, sizeof(buf)) > 0 &&
+            find_key_ull(buf, "usage_usec", &usage) == 0) {
+            n->cpu_cores = 0.0;
+            n->cpu_percent = 0.0;
+
+            if (n->has_usage && elapsed_sec > 0 && usage >= n->usage_usec) {
+                double limit = n->quota_cpus > 0 ? n->quota_cpus : c->online_cpus;
+                n->cpu_cores = (usage - n->usage_usec) / 1e6 / elapsed_sec;
+                n->cpu_percent = limit > 0 ? n->cpu_cores / limit * 100.0 : 0.0;
+            }
+
+            n->usage_usec = usage;
+            n->has_usage = 1;
+        } else {
+            n->has_usage = 0;
+        }
+
+        n->has_memory = 0;
+        if (procfile_read(&n->memory_current, buf, sizeof(buf)) > 0) {
+            const char *p = buf;
+            n->memory_current_bytes = parse_ull(&p);
+            n->has_memory = 1;
+        }
+        if (procfile_read(&n->memory_stat, buf, sizeof(buf)) > 0) {
+            find_key_ull(buf, "anon", &n->memory_anon);
+            find_key_ull(buf, "file", &n->memory_file);
+        }
+
+        n->has_pressure = 0;
+        if (procfile_read(&n->cpu_pressure, buf, sizeof(buf)) > 0 &&
+            parse_pressure(buf, &n->cpu_psi) == 0) {
+            n->has_pressure = 1;
+        }
+        if (procfile_read(&n->memory_pressure, buf, sizeof(buf)) > 0) {
+            parse_pressure(buf, &n->memory_psi);
+        }
+        if (procfile_read(&n->io_pressure, buf, sizeof(buf)) > 0) {
+            parse_pressure(buf, &n->io_psi);
+        }
+    }
+}
+
+// Группа процесса из строки "0::/path" файла /proc/<pid>/cgroup
+static int read_pid_cgroup(const CgroupCollector *c, int pid, char *path, size_t size) {
+    char file[PROCFS_PATH_MAX + 32];
+    char buf[4096];
+
+    snprintf(file, sizeof(file), "%s/%d/cgroup", c->proc_root, pid);
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        capture_note_missing(file);
+        return -1;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    capture_note_file(file, buf, n);
+
+    const char *line = buf;
+    while (line && *line) {
+        if (strncmp(line, "0::", 3) == 0) {
+            const char *start = line + 3;
+            size_t len = strcspn(start, "\n");
+            if (len == 0 || len >= size) return -1;
+            memcpy(path, start, len);
+            path[len] = '\0';
+            return 0;
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+
+    return -1;
+}
+
+// Процесс глубже CGROUP_MAX_DEPTH (или в новой группе) относим к ближайшему предку
+static int resolve_pid_node(const CgroupCollector *c, int pid) {
+    char path[CGROUP_PATH_MAX];
+
+    if (read_pid_cgroup(c, pid, path, sizeof(path)) != 0) return -1;
+
+    for (;;) {
+        int idx = find_cgroup_node(c, path);
+        if (idx >= 0) return idx;
+
+        char *slash = strrchr(path, '/');
+        if (!slash) return -1;
+        if (slash == path) {
+            if (path[1] == '\0') return -1;
+            path[1] = '\0';
+        } else {
+            *slash = '\0';
+        }
+    }
+}
+
+static int lookup_pid_node(CgroupCollector *c, const ProcessInfo *p) {
+    unsigned int mask = CGROUP_PID_CACHE_SIZE - 1;
+    unsigned int h = ((unsigned int)p->pid * 2654435761u) & mask;
+
+    while (c->pid_cache[h].pid != 0 && c->pid_cache[h].pid != p->pid) {
+        h = (h + 1) & mask;
+    }
+
+    CgroupPidEntry *e = &c->pid_cache[h];
+    if (e->pid == p->pid && e->starttime == p->starttime && e->generation == c->generation) {
+        return e->node;
+    }
+
+    if (e->pid == 0) {
+        // записи завершившихся процессов не удаляются по одной: при заполнении
+        // на три четверти кеш сбрасывается целиком
+        if (c->pid_cache_used >= CGROUP_PID_CACHE_SIZE * 3 / 4) {
+            memset(c->pid_cache, 0, sizeof(c->pid_cache));
+            c->pid_cache_used = 0;
+            h = ((unsigned int)p->pid * 2654435761u) & mask;
+            e = &c->pid_cache[h];
+        }
+        c->pid_cache_used++;
+    }
+
+    e->pid = p->pid;
+    e->starttime = p->starttime;
+    e->generation = c->generation;
+    e->node = resolve_pid_node(c, p->pid);
+
+    return e->node;
+}
+
+void cgroup_attribute_processes(CgroupCollector *c, const ProcessInfo *processes, int count) {
+    for (int i = 0; i < MAX_CGROUPS; i++) {
+        c->nodes[i].process_count = 0;
+        c->nodes[i].process_rss = 0;
+        c->nodes[i].process_cpu = 0.0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (processes[i].pid <= 0) continue;
+
+        int idx = lookup_pid_node(c, &processes[i]);
+        if (idx < 0 || !c->nodes[idx].in_use) continue;
+
+        CgroupNode *n = &c->nodes[idx];
+        n->process_count++;
+        n->process_rss += (unsigned long long)processes[i].rss * 1024;
+        n->process_cpu += processes[i].cpu_usage;
+    }
+}
+
+static void write_pressure(JsonWriter *w, const PressureStats *psi) {
+    jw_lit(w, "{\"some\": ");
+    jw_fixed1(w, psi->some_avg10);
+    jw_lit(w, ", \"full\": ");
+    jw_fixed1(w, psi->full_avg10);
+    jw_char(w, '}');
+}
+
+static void write_indent(JsonWriter *w, int depth) {
+    jw_char(w, '\n');
+    for (int i = 0; i < depth + 2; i++) {
+        jw_lit(w, "  ");
+    }
+}
+
+static void write_node_json(JsonWriter *w, const CgroupCollector *c, int idx) {
+    const CgroupNode *n = &c->nodes[idx];
+    const char *name = strrchr(n->path, '/');
+
+    jw_lit(w, "{\"path\": ");
+    jw_string(w, n->path);
+    jw_lit(w, ", \"name\": ");
+    jw_string(w, name && name[1] ? name + 1 : n->path);
+
+    jw_lit(w, ", \"cpu\": {\"usage\": ");
+    jw_fixed1(w, n->cpu_percent);
+    jw_lit(w, ", \"cores\": ");
+    jw_fixed1(w, n->cpu_cores);
+    jw_lit(w, ", \"quota\": ");
+    if (n->quota_cpus > 0) {
+        jw_fixed1(w, n->quota_cpus);
+    } else {
+        jw_lit(w, "null");
+    }
+    jw_char(w, '}');
+
+    jw_lit(w, ", \"memory\": ");
+    if (n->has_memory) {
+        jw_lit(w, "{\"current\": ");
+        jw_uint(w, n->memory_current_bytes);
+        jw_lit(w, ", \"anon\": ");
+        jw_uint(w, n->memory_anon);
+        jw_lit(w, ", \"file\": ");
+        jw_uint(w, n->memory_file);
+        jw_char(w, '}');
+    } else {
+        jw_lit(w, "null");
+    }
+
+    jw_lit(w, ", \"pressure\": ");
+    if (n->has_pressure) {
+        jw_lit(w, "{\"cpu\": ");
+        write_pressure(w, &n->cpu_psi);
+        jw_lit(w, ", \"memory\": ");
+        write_pressure(w, &n->memory_psi);
+        jw_lit(w, ", \"io\": ");
+        write_pressure(w, &n->io_psi);
+        jw_char(w, '}');
+    } else {
+        jw_lit(w, "null");
+    }
+
+    jw_lit(w, ", \"processes\": ");
+    jw_int(w, n->process_count);
+    jw_lit(w, ", \"process_cpu\": ");
+    jw_fixed1(w, n->process_cpu);
+    jw_lit(w, ", \"process_memory\": ");
+    jw_uint(w, n->process_rss);
+
+    jw_lit(w, ", \"children\": [");
+    for (int child = n->first_child; child >= 0; child = c->nodes[child].next_sibling) {
+        if (child != n->first_child) jw_char(w, ',');
+        write_indent(w, n->depth + 1);
+        write_node_json(w, c, child);
+    }
+    if (n->first_child >= 0) write_indent(w, n->depth);
+    jw_lit(w, "]}");
+}
+
+void write_cgroups_json(JsonWriter *w, const CgroupCollector *c) {
+    int root = find_cgroup_node(c, "/");
+
+    jw_lit(w, "{\n  \"timestamp\": ");
+    jw_int(w, c->timestamp);
+    jw_lit(w, ",\n  \"root\": ");
+    jw_string(w, c->root);
+    jw_lit(w, ",\n  \"online_cpus\": ");
+    jw_int(w, c->online_cpus);
+    jw_lit(w, ",\n  \"count\": ");
+    jw_int(w, c->count);
+    jw_lit(w, ",\n  \"tree\": ");
+    if (root >= 0) {
+        write_node_json(w, c, root);
+    } else {
+        jw_lit(w, "null");
+    }
+    jw_lit(w, "\n}\n");
+}
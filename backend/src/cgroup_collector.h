@@ -0,0 +1,76 @@
+#ifndef CGROUP_COLLECTOR_H
+#define CGROUP_COLLECTOR_H
+
+#include "config.h"
+#include "json_writer.h"
+#include "procfs.h"
+
+#define CGROUP_PATH_MAX 256
+
+typedef struct {
+    char path[CGROUP_PATH_MAX];
+    int in_use;
+    int seen;
+    int parent;
+    int first_child;
+    int next_sibling;
+    int depth;
+
+    ProcFile cpu_stat;
+    ProcFile memory_current;
+    ProcFile memory_stat;
+    ProcFile cpu_pressure;
+    ProcFile memory_pressure;
+    ProcFile io_pressure;
+
+    double quota_cpus;
+    unsigned long long usage_usec;
+    int has_usage;
+    double cpu_cores;
+    double cpu_percent;
+
+    int has_memory;
+    unsigned long long memory_current_bytes;
+    unsigned long long memory_anon;
+    unsigned long long memory_file;
+
+    int has_pressure;
+    PressureStats cpu_psi;
+    PressureStats memory_psi;
+    PressureStats io_psi;
+
+    int process_count;
+    unsigned long long process_rss;
+    double process_cpu;
+} CgroupNode;
+
+typedef struct {
+    int pid;
+    unsigned long long starttime;
+    int node;
+    unsigned int generation;
+} CgroupPidEntry;
+
+// Узлы живут в фиксированных слотах: между пересканированиями дерева
+// у существующей группы сохраняются открытые дескрипторы и прошлый usage_usec
+typedef struct {
+    char root[PROCFS_PATH_MAX];
+    char proc_root[PROCFS_PATH_MAX];
+    CgroupNode nodes[MAX_CGROUPS];
+    int count;
+    int online_cpus;
+    long timestamp;
+    unsigned int generation;
+    int pid_cache_used;
+    CgroupPidEntry pid_cache[CGROUP_PID_CACHE_SIZE];
+} CgroupCollector;
+
+int cgroup_collector_init(CgroupCollector *c, const char *cgroup_root, const char *proc_root);
+void cgroup_collector_free(CgroupCollector *c);
+int cgroup_collector_scan(CgroupCollector *c);
+void cgroup_collector_sample(CgroupCollector *c, double elapsed_sec, long now);
+void cgroup_attribute_processes(CgroupCollector *c, const ProcessInfo *processes, int count);
+int find_cgroup_node(const CgroupCollector *c, const char *path);
+void write_cgroups_json(JsonWriter *w, const CgroupCollector *c);
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "collector.h"
+
+#define COLLECTOR_COST_ALPHA 0.2
+
+Collector *collector_register(CollectorRegistry *r, const CollectorOps *ops, void *state) {
+    if (r->count >= MAX_COLLECTORS || collector_find(r, ops->name)) return NULL;
+
+    Collector *c = &r->items[r->count++];
+    memset(c, 0, sizeof(Collector));
+    c->ops = ops;
+    c->state = state;
+    c->wanted = 1;
+    return c;
+}
+
+Collector *collector_find(CollectorRegistry *r, const char *name) {
+    for (int i = 0; i < r->count; i++) {
+        if (strcmp(r->items[i].ops->name, name) == 0) return &r->items[i];
+    }
+    return NULL;
+}
+
+int collector_set_wanted(CollectorRegistry *r, const char *name, int enabled) {
+    Collector *c = collector_find(r, name);
+    if (!c) return -1;
+    if (!enabled && c->ops->required) return -2;
+    __atomic_store_n(&c->wanted, enabled ? 1 : 0, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static void collector_stop(Collector *c) {
+    if (c->active && c->ops->teardown) c->ops->teardown(c);
+    c->active = 0;
+    c->has_data = 0;
+}
+
+// Недоступный коллектор повторно не пробуется, пока его не выключат и не включат
+int collectors_sync(CollectorRegistry *r) {
+    int changed = 0;
+    for (int i = 0; i < r->count; i++) {
+        Collector *c = &r->items[i];
+        int wanted = __atomic_load_n(&c->wanted, __ATOMIC_RELAXED);
+
+        if (wanted && !c->active && !c->unavailable) {
+            if (c->ops->init && c->ops->init(c) != 0) {
+                c->unavailable = 1;
+                printf("Collector %s not available on this host, disabled\n", c->ops->name);
+            } else {
+                c->active = 1;
+                changed++;
+            }
+        } else if (!wanted) {
+            if (c->active) changed++;
+            collector_stop(c);
+            c->unavailable = 0;
+        }
+    }
+    return changed;
+}
+
+void collectors_teardown(CollectorRegistry *r) {
+    for (int i = 0; i < r->count; i++) collector_stop(&r->items[i]);
+}
+
+int collector_run(Collector *c, double elapsed) {
+    if (!c || !c->active) return 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    c->ops->sample(c, elapsed);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    c->last_ms = ms;
+    c->avg_ms = c->samples ? COLLECTOR_COST_ALPHA * ms + (1.0 - COLLECTOR_COST_ALPHA) * c->avg_ms : ms;
+    if (ms > c->max_ms) c->max_ms = ms;
+    c->total_ms += ms;
+    c->samples++;
+    if (!c->ops->async) {
+        c->data_ms = end.tv_sec * 1000L + end.tv_nsec / 1000000L;
+        c->has_data = 1;
+    }
+    return 1;
+}
+
+static void write_ms(JsonWriter *w, double ms) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.3f", ms);
+    jw_raw(w, buf, n);
+}
+
+// Поток сбора: пишет в свой буфер, воркеры отдают опубликованную копию
+void write_collectors_json(JsonWriter *w, CollectorRegistry *r) {
+    jw_lit(w, "{\"collectors\":[");
+    for (int i = 0; i < r->count; i++) {
+        Collector *c = &r->items[i];
+        if (i) jw_char(w, ',');
+        jw_lit(w, "\n  {\"name\":");
+        jw_string(w, c->ops->name);
+        if (c->active) jw_lit(w, ",\"state\":\"active\"");
+        else if (c->unavailable) jw_lit(w, ",\"state\":\"unavailable\"");
+        else jw_lit(w, ",\"state\":\"disabled\"");
+        if (c->ops->required) jw_lit(w, ",\"required\":true");
+        jw_lit(w, ",\"samples\":");
+        jw_uint(w, c->samples);
+        jw_lit(w, ",\"last_ms\":");
+        write_ms(w, c->last_ms);
+        jw_lit(w, ",\"avg_ms\":");
+        write_ms(w, c->avg_ms);
+        jw_lit(w, ",\"max_ms\":");
+        write_ms(w, c->max_ms);
+        jw_lit(w, ",\"total_ms\":");
+        write_ms(w, c->total_ms);
+        if (c->active && c->ops->serialize) {
+            jw_lit(w, ",\"details\":");
+            c->ops->serialize(c, w);
+        }
+        jw_char(w, '}');
+    }
+    jw_lit(w, "\n]}");
+}
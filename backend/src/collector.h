@@ -0,0 +1,76 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include "config.h"
+#include "json_writer.h"
+
+/*
+ * Реестр коллекторов: у каждого таблица init/sample/serialize/teardown
+ * и свой учет времени сбора. Включать и выключать можно из конфига,
+ * флагами (--disable gpu,processes) и на ходу (POST /api/collectors/...):
+ * воркеры меняют только wanted, а init/teardown вызывает поток сбора в
+ * collectors_sync в начале тика, поэтому состояние коллектора всегда
+ * принадлежит одному потоку.
+ *
+ * Выключенный или недоступный (init вернул -1, например нет nvidia-smi)
+ * коллектор не вызывается вовсе.
+ *
+ * data_ms - когда получены данные коллектора; у синхронного это конец
+ * sample, асинхронный (gpu) ставит время последнего готового замера.
+ */
+
+#define MAX_COLLECTORS 16
+
+typedef struct Collector Collector;
+
+typedef struct {
+    const char *name;
+    int required;                                   // не выключается (cpu, memory)
+    int (*init)(Collector *c);                      // -1 - недоступен на этом хосте
+    void (*sample)(Collector *c, double elapsed);
+    void (*serialize)(Collector *c, JsonWriter *w); // поля в /api/collectors, может быть NULL
+    void (*teardown)(Collector *c);
+    int async;                                      // sample забирает результат воркера и сам ставит data_ms
+} CollectorOps;
+
+struct Collector {
+    const CollectorOps *ops;
+    void *state;
+
+    int wanted;                 // пишут воркеры (атомарно)
+    int active;                 // init удался; меняет только поток сбора
+    int unavailable;            // последний init вернул -1
+
+    // время sample, пишет поток сбора
+    unsigned long samples;
+    double last_ms;
+    double avg_ms;              // EWMA
+    double max_ms;
+    double total_ms;
+
+    // монотонное время данных: возраст секции в снимке
+    int has_data;
+    long data_ms;
+};
+
+typedef struct {
+    Collector items[MAX_COLLECTORS];
+    int count;
+} CollectorRegistry;
+
+Collector *collector_register(CollectorRegistry *r, const CollectorOps *ops, void *state);
+Collector *collector_find(CollectorRegistry *r, const char *name);
+
+// 0 - принято, -1 - нет такого коллектора, -2 - его нельзя выключить
+int collector_set_wanted(CollectorRegistry *r, const char *name, int enabled);
+
+// Поток сбора: init/teardown по wanted; возвращает число переключений
+int collectors_sync(CollectorRegistry *r);
+void collectors_teardown(CollectorRegistry *r);
+
+// sample с замером времени; 0 - коллектор не активен
+int collector_run(Collector *c, double elapsed);
+
+void write_collectors_json(JsonWriter *w, CollectorRegistry *r);
+
+#endif
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include "config.h"
+#include "command.h"
+
+extern char **environ;
+
+static pid_t stuck[COMMAND_STUCK_MAX];
+static int stuck_count = 0;
+static pthread_mutex_t stuck_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// Дожидается завершившихся; 1 - есть место под нового ребенка
+static int reap_stuck(void) {
+    pthread_mutex_lock(&stuck_mutex);
+    for (int i = 0; i < stuck_count; i++) {
+        if (waitpid(stuck[i], NULL, WNOHANG) != 0) {
+            stuck[i--] = stuck[--stuck_count];
+        }
+    }
+    int room = stuck_count < COMMAND_STUCK_MAX;
+    pthread_mutex_unlock(&stuck_mutex);
+    return room;
+}
+
+// SIGKILL группе и короткое ожидание; не завершился - в список зависших
+static void kill_child(pid_t pid) {
+    kill(-pid, SIGKILL);
+    for (int i = 0; i < 10; i++) {
+        if (waitpid(pid, NULL, WNOHANG) != 0) return;
+        usleep(10000);
+    }
+    pthread_mutex_lock(&stuck_mutex);
+    if (stuck_count < COMMAND_STUCK_MAX) stuck[stuck_count++] = pid;
+    pthread_mutex_unlock(&stuck_mutex);
+    printf("Command %d did not exit after SIGKILL\n", (int)pid);
+}
+
+int command_read(char *const argv[], char *out, size_t size, int timeout_ms) {
+    if (size == 0) return COMMAND_FAILED;
+    out[0] = '\0';
+    if (!reap_stuck()) return COMMAND_FAILED;
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return COMMAND_FAILED;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(fds[1]);
+    if (err != 0) {
+        close(fds[0]);
+        return COMMAND_FAILED;
+    }
+
+    size_t len = 0;
+    long deadline = now_ms() + timeout_ms;
+    int timed_out = 0;
+    for (;;) {
+        long left = deadline - now_ms();
+        if (left <= 0) {
+            timed_out = 1;
+            break;
+        }
+        struct pollfd pfd = {.fd = fds[0], .events = POLLIN};
+        int r = poll(&pfd, 1, (int)left);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            timed_out = (r == 0);
+            break;
+        }
+
+        char discard[256];
+        ssize_t n = len + 1 < size ? read(fds[0], out + len, size - 1 - len)
+                                   : read(fds[0], discard, sizeof(discard));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        if (len + 1 < size) len += n;
+    }
+    close(fds[0]);
+    out[len] = '\0';
+
+    if (timed_out) {
+        kill_child(pid);
+        out[0] = '\0';
+        return COMMAND_TIMEOUT;
+    }
+
+    // вывод закрыт: ждем выхода в пределах того же дедлайна
+    while (waitpid(pid, NULL, WNOHANG) == 0) {
+        if (now_ms() >= deadline) {
+            kill_child(pid);
+            out[0] = '\0';
+            return COMMAND_TIMEOUT;
+        }
+        usleep(1000);
+    }
+    return (int)len;
+}
+
+int command_read_shell(const char *script, char *out, size_t size, int timeout_ms) {
+    char *argv[] = {"/bin/sh", "-c", (char *)script, NULL};
+    return command_read(argv, out, size, timeout_ms);
+}
+
+int command_stuck_count(void) {
+    reap_stuck();
+    pthread_mutex_lock(&stuck_mutex);
+    int n = stuck_count;
+    pthread_mutex_unlock(&stuck_mutex);
+    return n;
+}
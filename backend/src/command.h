@@ -0,0 +1,27 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stddef.h>
+
+/*
+ * Запуск внешней команды (nvidia-smi, sensors) с жестким дедлайном:
+ * posix_spawn в своей группе процессов, вывод читается через poll, по
+ * истечении timeout_ms вся группа получает SIGKILL. Ребенок, который и
+ * после SIGKILL не завершился (висит в драйвере в D-state), не ждется:
+ * он дожидается следующих вызовов, а пока таких COMMAND_STUCK_MAX, новые
+ * команды не запускаются вовсе.
+ */
+
+#define COMMAND_FAILED -1
+#define COMMAND_TIMEOUT -2
+
+// stdout команды в out (с '\0'); число байт, COMMAND_FAILED или COMMAND_TIMEOUT
+int command_read(char *const argv[], char *out, size_t size, int timeout_ms);
+
+// То же через /bin/sh -c (конвейеры)
+int command_read_shell(const char *script, char *out, size_t size, int timeout_ms);
+
+// Убитые, но еще не завершившиеся дети
+int command_stuck_count(void);
+
+#endif
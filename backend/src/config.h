@@ -8,9 +8,86 @@
 #define BUFFER_SIZE 4096
 #define MAX_PROCESSES 512
 #define UPDATE_INTERVAL_MS 2000
-#define MAX_CONNECTIONS 10
-#define MAX_CORES 32
+#define LISTEN_BACKLOG 128
+#define MAX_WORKERS 64
+#define CLIENT_TIMEOUT_SEC 5
+#define KEEPALIVE_MAX_PER_WORKER 256
+#define KEEPALIVE_IDLE_SEC 15
+#define MAX_CORES 8192            // верхняя граница номера CPU (NR_CPUS ядра)
 #define HISTORY_SIZE 60
+#define TOP_PROCESSES 10
+
+#define PROC_ROOT "/proc"
+#define SYS_ROOT "/sys"
+
+#define PROC_HISTORY_SLOTS 256
+#define PROC_HISTORY_SIZE HISTORY_SIZE
+#define PROC_HISTORY_TOP_N 10
+#define PROC_HISTORY_RETENTION_SEC 600
+
+#define PROC_DETAIL_TOP_N 10
+#define PROC_DETAIL_WATCH_MAX 32
+#define PROC_DETAIL_MAX (PROC_DETAIL_TOP_N + PROC_DETAIL_WATCH_MAX)
+
+#define PSI_TRIGGER_STALL_US 100000
+#define PSI_TRIGGER_WINDOW_US 1000000
+#define PSI_EVENT_HISTORY 32
+
+#define FRONTEND_DIR "frontend"
+#define ASSET_MAX_FILES 64
+#define ASSET_FILE_MAX (4 * 1024 * 1024)
+#define ASSET_SENDFILE_MIN 16384
+#define ASSET_MAX_AGE_SEC 31536000
+
+#define FLEET_MAX_HOSTS 1024
+#define FLEET_STALE_INTERVALS 3    // ответ старше трех интервалов опроса - stale
+#define FLEET_DOWN_MS 30000
+#define FLEET_RESPONSE_MAX (1024 * 1024)
+#define FLEET_TOP_N 10
+#define FLEET_RESOLVE_RETRY_MS 1000       // повтор неудачного DNS-запроса, удваивается
+#define FLEET_RESOLVE_RETRY_MAX_MS 60000
+
+#define EXPORT_QUEUE_SLOTS 16
+#define EXPORT_BATCH_MAX 65536
+#define EXPORT_DATAGRAM_MAX 1400
+
+#define STATS_WINDOW_MINUTES 60        // самое длинное окно /api/stats
+
+#define MAX_ALERT_RULES 32
+#define ALERT_QUEUE_SLOTS 64
+#define ALERT_RETRY_MAX 5             // попыток доставки на событие
+#define ALERT_RETRY_BASE_MS 1000      // пауза перед повтором удваивается
+#define ALERT_HTTP_TIMEOUT_MS 2000
+#define ALERT_RATE_ALPHA 0.3          // сглаживание скорости (EWMA)
+
+#define COMMAND_TIMEOUT_MS 1000       // sensors, lscpu: процесс убивается по дедлайну
+#define COMMAND_OUTPUT_MAX 4096
+#define COMMAND_STUCK_MAX 4           // убитые, но не завершившиеся (D-state) дети
+#define GPU_COMMAND_TIMEOUT_MS 1500   // nvidia-smi, замер в потоке GPU
+#define GPU_WATCHDOG_MS 5000          // замер дольше - воркер помечен hung
+#define SECTION_STALE_TICKS 2         // секция старше - "stale": true
+
+#define DEMAND_IDLE_MS 60000
+#define DEMAND_IDLE_REFRESH_TICKS 30
+#define DEMAND_MAX_AGE_TICKS 2
+
+#define CAPTURE_PATH_MAX 512
+#define CAPTURE_FILE_MAX (1024 * 1024)
+#define CAPTURE_SEEN_SIZE 65536
+
+#define MAX_CGROUPS 128
+#define CGROUP_MAX_DEPTH 8
+#define CGROUP_RESCAN_TICKS 15
+#define CGROUP_PID_CACHE_SIZE 2048
+
+#define MAX_DISKS 32
+#define MAX_DISK_NAMES 256
+
+#define MAX_NET_INTERFACES 256
+#define NET_SKIP_VIRTUAL 1
+
+#define MAX_NUMA_NODES 64
+#define MAX_PACKAGES 64
 
 typedef struct {
     unsigned long long total;
@@ -47,16 +124,27 @@ typedef struct {
     char name[128];
 } GPUInfo;
 
+// Строка таблицы процессов фиксированного размера: name и command_line
+// указывают в интернированную арену process_cache (никогда не NULL)
 typedef struct {
     int pid;
-    char name[256];
     char state;
+    unsigned long long starttime;
     unsigned long utime;
     unsigned long stime;
     long rss;
     double cpu_usage;
     double mem_usage;
-    char command_line[512];
+    const char *name;
+    const char *command_line;
+
+    // заполняется process_detail только для top N и --watch
+    int has_detail;
+    double cpu_time_percent;      // % одного ядра по schedstat (нс)
+    double io_read_rate;          // байт/с
+    double io_write_rate;
+    double ctx_voluntary_rate;    // переключений/с
+    double ctx_involuntary_rate;
 } ProcessInfo;
 
 typedef struct {
@@ -65,9 +153,17 @@ typedef struct {
     double gpu_usage[HISTORY_SIZE];
     double gpu_memory[HISTORY_SIZE];
     double gpu_temperature[HISTORY_SIZE];
+    double disk_read[HISTORY_SIZE];
+    double disk_write[HISTORY_SIZE];
+    double net_rx[HISTORY_SIZE];
+    double net_tx[HISTORY_SIZE];
+    double psi_cpu[HISTORY_SIZE];
+    double psi_memory[HISTORY_SIZE];
+    double psi_io[HISTORY_SIZE];
     long timestamps[HISTORY_SIZE];
     int index;
     int count;
+    struct QuantileStore *quantiles;    // поминутные скетчи для /api/stats, NULL - нет
 } HistoryData;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config_file.h"
+
+static char *trim(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return s;
+}
+
+int config_file_parse_line(const char *line, char *key, size_t key_size,
+                           char *value, size_t value_size) {
+    char copy[512];
+
+    snprintf(copy, sizeof(copy), "%s", line);
+    char *comment = strchr(copy, '#');
+    if (comment) *comment = '\0';
+    char *text = trim(copy);
+    if (*text == '\0') return 0;
+
+    char *sep = text + strcspn(text, "= \t");
+    char *rest = "";
+    if (*sep) {
+        rest = sep + 1;
+        *sep = '\0';
+        rest = trim(rest);
+        if (*rest == '=') rest = trim(rest + 1);
+    }
+    text = trim(text);
+
+    if (*text == '\0' || text[0] == '-' || strlen(text) >= key_size || strlen(rest) >= value_size) return -1;
+    snprintf(key, key_size, "%s", text);
+    snprintf(value, value_size, "%s", rest);
+    return 1;
+}
+
+int config_file_args(const char *path, int argc, char **argv, int *out_argc, char ***out_argv) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    char **args = calloc(CONFIG_FILE_MAX_ARGS + argc + 1, sizeof(char *));
+    if (!args) {
+        fclose(file);
+        return -1;
+    }
+    int n = 0;
+    args[n++] = argv[0];
+
+    char line[512], key[64], value[400];
+    int line_no = 0, errors = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        int r = config_file_parse_line(line, key, sizeof(key), value, sizeof(value));
+        if (r == 0) continue;
+        if (r < 0 || n + 2 > CONFIG_FILE_MAX_ARGS) {
+            fprintf(stderr, "%s:%d: expected key = value\n", path, line_no);
+            errors++;
+            continue;
+        }
+
+        char flag[80];
+        snprintf(flag, sizeof(flag), "--%s", key);
+        args[n++] = strdup(flag);
+        if (value[0]) args[n++] = strdup(value);
+    }
+    fclose(file);
+
+    if (errors) {
+        free(args);
+        return -1;
+    }
+    for (int i = 1; i < argc; i++) args[n++] = argv[i];
+    args[n] = NULL;
+
+    *out_argc = n;
+    *out_argv = args;
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#include <stddef.h>
+
+/*
+ * --config FILE: строка "ключ = значение" (или "ключ значение") - это
+ * флаг --ключ значение, строка из одного ключа - флаг без значения,
+ * '#' - комментарий до конца строки:
+ *
+ *   port = 9090
+ *   interval-ms = 1000
+ *   disable = gpu,processes
+ *   all-interfaces
+ *
+ * Флаги файла ставятся перед флагами командной строки, поэтому
+ * командная строка их переопределяет.
+ */
+
+#define CONFIG_FILE_MAX_ARGS 256
+
+// Новый argv: argv[0], флаги файла, остальные argv; строки живут до выхода
+int config_file_args(const char *path, int argc, char **argv, int *out_argc, char ***out_argv);
+
+// 1 - флаг, 0 - пустая строка или комментарий, -1 - ошибка
+int config_file_parse_line(const char *line, char *key, size_t key_size,
+                           char *value, size_t value_size);
+
+#endif
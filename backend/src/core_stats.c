@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core_stats.h"
+#include "capture.h"
+
+int core_stats_init(CoreStats *c, int capacity) {
+    memset(c, 0, sizeof(CoreStats));
+    return core_stats_reserve(c, capacity > 0 ? capacity : 1);
+}
+
+void core_stats_free(CoreStats *c) {
+    free(c->total);
+    free(c->idle);
+    free(c->prev_total);
+    free(c->prev_idle);
+    free(c->usage);
+    free(c->online);
+    memset(c, 0, sizeof(CoreStats));
+}
+
+static int grow_column(void **column, int old_count, int new_count, size_t elem) {
+    void *p = realloc(*column, (size_t)new_count * elem);
+    if (!p) return -1;
+    memset((char *)p + (size_t)old_count * elem, 0, (size_t)(new_count - old_count) * elem);
+    *column = p;
+    return 0;
+}
+
+// Рост только при горячем подключении CPU за пределами possible
+int core_stats_reserve(CoreStats *c, int capacity) {
+    if (capacity <= c->capacity) return 0;
+    if (capacity > MAX_CORES) return -1;
+
+    if (grow_column((void **)&c->total, c->capacity, capacity, sizeof(uint64_t)) != 0 ||
+        grow_column((void **)&c->idle, c->capacity, capacity, sizeof(uint64_t)) != 0 ||
+        grow_column((void **)&c->prev_total, c->capacity, capacity, sizeof(uint64_t)) != 0 ||
+        grow_column((void **)&c->prev_idle, c->capacity, capacity, sizeof(uint64_t)) != 0 ||
+        grow_column((void **)&c->usage, c->capacity, capacity, sizeof(double)) != 0 ||
+        grow_column((void **)&c->online, c->capacity, capacity, 1) != 0) {
+        return -1;
+    }
+    c->capacity = capacity;
+    return 0;
+}
+
+void core_stats_begin(CoreStats *c) {
+    memset(c->online, 0, (size_t)c->capacity);
+    c->online_count = 0;
+}
+
+static const char *parse_u64(const char *p, uint64_t *out) {
+    uint64_t v = 0;
+    while (*p == ' ') p++;
+    if (*p < '0' || *p > '9') return NULL;
+    while (*p >= '0' && *p <= '9') v = v * 10 + (uint64_t)(*p++ - '0');
+    *out = v;
+    return p;
+}
+
+// "cpuN user nice system idle iowait irq softirq steal guest guest_nice";
+// guest уже входит в user, поэтому в total не добавляется
+int core_stats_parse_line(CoreStats *c, const char *line) {
+    uint64_t id, v[8] = {0};
+
+    if (strncmp(line, "cpu", 3) != 0 || line[3] < '0' || line[3] > '9') return -1;
+    const char *p = parse_u64(line + 3, &id);
+    for (int i = 0; i < 8; i++) {
+        p = parse_u64(p, &v[i]);
+        if (!p) return -1;
+    }
+    if (id >= (uint64_t)c->capacity &&
+        core_stats_reserve(c, id + 1 > (uint64_t)c->capacity * 2 ? (int)id + 1 : c->capacity * 2) != 0) {
+        return -1;
+    }
+
+    c->total[id] = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+    c->idle[id] = v[3];
+    if (!c->online[id]) c->online_count++;
+    c->online[id] = 1;
+    if ((int)id >= c->count) c->count = (int)id + 1;
+    return 0;
+}
+
+// Разности за тик в int32 (за 2 с это сотни тиков): min/max без ветвлений
+// и преобразование int32 -> double векторизуются и на SSE2. Счетчик,
+// ушедший назад (CPU переподключили), дает 0, а не переполнение
+void core_stats_compute(CoreStats *c) {
+    const uint64_t *restrict total = c->total;
+    const uint64_t *restrict idle = c->idle;
+    const uint64_t *restrict prev_total = c->prev_total;
+    const uint64_t *restrict prev_idle = c->prev_idle;
+    double *restrict usage = c->usage;
+    int n = c->count;
+
+    for (int i = 0; i < n; i++) {
+        int32_t dt = (int32_t)(uint32_t)(total[i] - prev_total[i]);
+        int32_t di = (int32_t)(uint32_t)(idle[i] - prev_idle[i]);
+        dt = dt > 0 ? dt : 0;
+        di = di > 0 ? di : 0;
+        di = di < dt ? di : dt;
+        int32_t span = dt > 0 ? dt : 1;
+        usage[i] = 100.0 * (double)(dt - di) / (double)span;
+    }
+}
+
+void core_stats_rotate(CoreStats *c) {
+    memcpy(c->prev_total, c->total, (size_t)c->count * sizeof(uint64_t));
+    memcpy(c->prev_idle, c->idle, (size_t)c->count * sizeof(uint64_t));
+}
+
+int cpulist_parse(const char *text, unsigned char *mask, int size) {
+    int max = -1;
+    const char *p = text;
+
+    if (mask && size > 0) memset(mask, 0, (size_t)size);
+    while (*p && *p != '\n') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0) return -1;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first) return -1;
+            p = end;
+        }
+        for (long i = first; i <= last && mask && i < size; i++) mask[i] = 1;
+        if (last > max) max = (int)last;
+        if (*p == ',') p++;
+        else if (*p && *p != '\n') return -1;
+    }
+    return max + 1;
+}
+
+// Без sysfs - столько, сколько CPU сейчас в системе; остальные добавит parse_line
+int core_stats_possible_cpus(const char *sys_root) {
+    char path[512], text[256];
+
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/possible", sys_root);
+    FILE *fp = capture_fopen(path);
+    if (fp) {
+        int count = -1;
+        if (fgets(text, sizeof(text), fp)) count = cpulist_parse(text, NULL, 0);
+        fclose(fp);
+        if (count > 0 && count <= MAX_CORES) return count;
+    }
+    return 0;
+}
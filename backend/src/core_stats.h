@@ -0,0 +1,42 @@
+#ifndef CORE_STATS_H
+#define CORE_STATS_H
+
+#include <stdint.h>
+#include "config.h"
+
+/*
+ * Счетчики ядер из /proc/stat колонками (structure of arrays).
+ * Индекс - номер CPU из строки cpuN, размер - число возможных CPU
+ * (/sys/devices/system/cpu/possible), включая выключенные: у них
+ * online = 0 и нулевая загрузка. Проценты за тик считаются одним
+ * проходом по колонкам, без ветвлений на ядро.
+ */
+typedef struct {
+    int capacity;
+    int count;                  // максимальный номер CPU + 1
+    int online_count;
+
+    uint64_t *total;            // user..steal, в тиках USER_HZ
+    uint64_t *idle;
+    uint64_t *prev_total;
+    uint64_t *prev_idle;
+    double *usage;              // % за последний тик
+    unsigned char *online;      // строка cpuN была в последнем /proc/stat
+} CoreStats;
+
+int core_stats_init(CoreStats *c, int capacity);
+void core_stats_free(CoreStats *c);
+int core_stats_reserve(CoreStats *c, int capacity);
+
+// Замер: begin, строки "cpuN ..." по одной, затем compute и rotate
+void core_stats_begin(CoreStats *c);
+int core_stats_parse_line(CoreStats *c, const char *line);
+void core_stats_compute(CoreStats *c);
+void core_stats_rotate(CoreStats *c);
+
+// Список CPU ядра ("0-3,8,10-11"): mask[i] = 1 для каждого CPU < size.
+// Возвращает максимальный номер + 1 или -1 при ошибке; mask может быть NULL
+int cpulist_parse(const char *text, unsigned char *mask, int size);
+int core_stats_possible_cpus(const char *sys_root);
+
+#endif
@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "demand.h"
+
+static const char *section_names[DEMAND_SECTIONS] = {"processes", "gpu"};
+
+const char *demand_section_name(DemandSection s) {
+    return (s >= 0 && s < DEMAND_SECTIONS) ? section_names[s] : "unknown";
+}
+
+long demand_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+int demand_init(DemandTracker *d, long idle_ms, int idle_every) {
+    memset(d, 0, sizeof(*d));
+    d->idle_ms = idle_ms;
+    d->idle_every = idle_every > 0 ? idle_every : 1;
+
+    d->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (d->wake_fd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    pthread_mutex_init(&d->mutex, NULL);
+    return 0;
+}
+
+void demand_free(DemandTracker *d) {
+    if (d->wake_fd >= 0) close(d->wake_fd);
+    d->wake_fd = -1;
+    pthread_mutex_destroy(&d->mutex);
+}
+
+static int section_active(DemandTracker *d, DemandSection s, long now_ms) {
+    long last = __atomic_load_n(&d->last_request_ms[s], __ATOMIC_RELAXED);
+    return last > 0 && now_ms - last < d->idle_ms;
+}
+
+int demand_should_collect(DemandTracker *d, DemandSection s, unsigned long tick, long now_ms) {
+    int collect;
+
+    pthread_mutex_lock(&d->mutex);
+    collect = d->idle_ms <= 0 || d->collections[s] == 0 ||
+              section_active(d, s, now_ms) ||
+              tick - d->collected_tick[s] >= (unsigned long)d->idle_every;
+    if (!collect) d->skipped[s]++;
+    pthread_mutex_unlock(&d->mutex);
+
+    return collect;
+}
+
+// Вызывается после публикации снимка: следующий запрос увидит уже новые данные
+void demand_collected(DemandTracker *d, int sections, unsigned long tick, long now_ms) {
+    pthread_mutex_lock(&d->mutex);
+    for (int s = 0; s < DEMAND_SECTIONS; s++) {
+        if (!(sections & (1 << s))) continue;
+        d->collected_ms[s] = now_ms;
+        d->collected_tick[s] = tick;
+        d->collections[s]++;
+    }
+    pthread_mutex_unlock(&d->mutex);
+}
+
+static int stale_locked(DemandTracker *d, int sections, long since_ms) {
+    for (int s = 0; s < DEMAND_SECTIONS; s++) {
+        if ((sections & (1 << s)) && d->collected_ms[s] < since_ms) return 1;
+    }
+    return 0;
+}
+
+int demand_request(DemandTracker *d, int sections, long max_age_ms) {
+    long now = demand_now_ms();
+
+    for (int s = 0; s < DEMAND_SECTIONS; s++) {
+        if (sections & (1 << s)) __atomic_store_n(&d->last_request_ms[s], now, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&d->mutex);
+    int stale = stale_locked(d, sections, now - max_age_ms);
+    if (stale) {
+        // внеочередной тик; несколько запросов подряд дают одно пробуждение
+        uint64_t one = 1;
+        if (write(d->wake_fd, &one, sizeof(one)) == (ssize_t)sizeof(one)) d->wakeups++;
+    }
+    pthread_mutex_unlock(&d->mutex);
+    return stale;
+}
+
+// "sections=processes,gpu" или "sections=none"; без параметра - все секции
+int demand_parse_sections(const char *query) {
+    const char *p = query ? strstr(query, "sections=") : NULL;
+    if (!p || (p != query && p[-1] != '&' && p[-1] != '?')) return DEMAND_ALL;
+
+    int mask = 0;
+    p += 9;
+    while (*p && *p != '&') {
+        size_t n = strcspn(p, ",&");
+        for (int s = 0; s < DEMAND_SECTIONS; s++) {
+            if (strlen(section_names[s]) == n && strncmp(p, section_names[s], n) == 0) {
+                mask |= 1 << s;
+            }
+        }
+        p += n;
+        if (*p == ',') p++;
+    }
+    return mask;
+}
+
+void write_demand_json(JsonWriter *w, DemandTracker *d, long now_ms) {
+    pthread_mutex_lock(&d->mutex);
+    jw_lit(w, "{\"idle_ms\": ");
+    jw_int(w, d->idle_ms);
+    jw_lit(w, ", \"wakeups\": ");
+    jw_uint(w, d->wakeups);
+    for (int s = 0; s < DEMAND_SECTIONS; s++) {
+        jw_lit(w, ", ");
+        jw_string(w, section_names[s]);
+        jw_lit(w, ": {\"active\": ");
+        if (d->idle_ms <= 0 || section_active(d, s, now_ms)) jw_lit(w, "true");
+        else jw_lit(w, "false");
+        jw_lit(w, ", \"age_ms\": ");
+        jw_int(w, d->collected_ms[s] > 0 ? now_ms - d->collected_ms[s] : -1);
+        jw_lit(w, ", \"collections\": ");
+        jw_uint(w, d->collections[s]);
+        jw_lit(w, ", \"skipped\": ");
+        jw_uint(w, d->skipped[s]);
+        jw_char(w, '}');
+    }
+    jw_char(w, '}');
+    pthread_mutex_unlock(&d->mutex);
+}
@@ -0,0 +1,58 @@
+#ifndef DEMAND_H
+#define DEMAND_H
+
+#include <pthread.h>
+#include "config.h"
+#include "json_writer.h"
+
+/*
+ * Сбор по спросу: дорогие секции (обход процессов, nvidia-smi) идут
+ * каждый тик, только пока их запрашивал клиент за последние idle_ms.
+ * Без клиентов они обновляются раз в idle_every тиков, чтобы история
+ * не рвалась, а дешевые коллекторы истории работают как раньше.
+ *
+ * Запрос секции, данные которой старше max_age, будит поток сбора
+ * (wake_fd) и сразу получает текущий снимок: возраст секций виден в
+ * нем самом, воркер не ждет тика.
+ */
+
+typedef enum {
+    DEMAND_PROCESSES,
+    DEMAND_GPU,
+    DEMAND_SECTIONS
+} DemandSection;
+
+#define DEMAND_ALL ((1 << DEMAND_SECTIONS) - 1)
+
+typedef struct {
+    long idle_ms;                               // 0: собирать всегда
+    int idle_every;
+
+    // last_request_ms пишут воркеры (атомарно), остальное - под mutex
+    long last_request_ms[DEMAND_SECTIONS];
+    long collected_ms[DEMAND_SECTIONS];         // CLOCK_MONOTONIC, 0: еще не было
+    unsigned long collected_tick[DEMAND_SECTIONS];
+    unsigned long collections[DEMAND_SECTIONS];
+    unsigned long skipped[DEMAND_SECTIONS];
+    unsigned long wakeups;
+
+    int wake_fd;                                // eventfd для потока сбора
+    pthread_mutex_t mutex;
+} DemandTracker;
+
+int demand_init(DemandTracker *d, long idle_ms, int idle_every);
+void demand_free(DemandTracker *d);
+long demand_now_ms(void);
+
+// Поток сбора: решение на тик и отметка после публикации снимка
+int demand_should_collect(DemandTracker *d, DemandSection s, unsigned long tick, long now_ms);
+void demand_collected(DemandTracker *d, int sections, unsigned long tick, long now_ms);
+
+// Воркер: отмечает спрос на sections; 0 - данные свежие, 1 - устарели, сбор разбужен
+int demand_request(DemandTracker *d, int sections, long max_age_ms);
+int demand_parse_sections(const char *query);
+
+const char *demand_section_name(DemandSection s);
+void write_demand_json(JsonWriter *w, DemandTracker *d, long now_ms);
+
+#endif
@@ -0,0 +1,203 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "disk_collector.h"
+#include "capture.h"
+
+#define SECTOR_SIZE 512
+#define DISKSTATS_FIELDS 11
+
+void disk_collector_init(DiskCollector *c, const char *diskstats_path, const char *sys_block_path) {
+    memset(c, 0, sizeof(DiskCollector));
+    procfile_init(&c->file, diskstats_path);
+    snprintf(c->sys_block, sizeof(c->sys_block), "%s", sys_block_path);
+}
+
+void disk_collector_free(DiskCollector *c) {
+    procfile_close(&c->file);
+}
+
+// Непустой slaves/: устройство собрано поверх других (device-mapper, md RAID)
+static int has_slaves(const char *device_path) {
+    char path[PROCFS_PATH_MAX + DISK_NAME_MAX + 10];
+    snprintf(path, sizeof(path), "%s/slaves", device_path);
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+    capture_note_entry(path, "");
+
+    int found = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        capture_note_entry(path, entry->d_name);
+        found = 1;
+    }
+    closedir(dir);
+    return found;
+}
+
+static int is_whole_disk(DiskCollector *c, const char *name, int *stacked) {
+    *stacked = 0;
+    if (strncmp(name, "loop", 4) == 0 || strncmp(name, "ram", 3) == 0) return 0;
+
+    for (int i = 0; i < c->verdict_count; i++) {
+        if (strcmp(c->verdicts[i].name, name) == 0) {
+            *stacked = c->verdicts[i].stacked;
+            return c->verdicts[i].whole_disk;
+        }
+    }
+
+    // в /sys/block есть только целые устройства, разделы лежат внутри них
+    char path[PROCFS_PATH_MAX + DISK_NAME_MAX + 2];
+    snprintf(path, sizeof(path), "%s/%s", c->sys_block, name);
+    int whole = capture_access(path, F_OK) == 0;
+    if (whole) *stacked = has_slaves(path);
+
+    if (c->verdict_count < MAX_DISK_NAMES) {
+        DiskNameVerdict *v = &c->verdicts[c->verdict_count++];
+        strcpy(v->name, name);
+        v->whole_disk = whole;
+        v->stacked = *stacked;
+    }
+
+    return whole;
+}
+
+static DiskDevice *find_or_add_device(DiskCollector *c, const char *name) {
+    for (int i = 0; i < c->count; i++) {
+        if (strcmp(c->devices[i].name, name) == 0) return &c->devices[i];
+    }
+    if (c->count >= MAX_DISKS) return NULL;
+
+    DiskDevice *d = &c->devices[c->count++];
+    memset(d, 0, sizeof(DiskDevice));
+    strcpy(d->name, name);
+    return d;
+}
+
+static void update_device(DiskDevice *d, const unsigned long long *f, double elapsed_sec) {
+    if (d->has_prev && elapsed_sec > 0) {
+        unsigned long long reads = counter_delta(d->reads, f[0]);
+        unsigned long long writes = counter_delta(d->writes, f[4]);
+
+        d->read_iops = reads / elapsed_sec;
+        d->write_iops = writes / elapsed_sec;
+        d->read_bytes = (double)counter_delta(d->sectors_read, f[2]) * SECTOR_SIZE / elapsed_sec;
+        d->write_bytes = (double)counter_delta(d->sectors_written, f[6]) * SECTOR_SIZE / elapsed_sec;
+        d->read_await = reads ? (double)counter_delta(d->read_ms, f[3]) / reads : 0.0;
+        d->write_await = writes ? (double)counter_delta(d->write_ms, f[7]) / writes : 0.0;
+
+        d->utilization = counter_delta(d->io_ms, f[9]) / (elapsed_sec * 10.0);
+        if (d->utilization > 100.0) d->utilization = 100.0;
+    }
+
+    d->reads = f[0];
+    d->sectors_read = f[2];
+    d->read_ms = f[3];
+    d->writes = f[4];
+    d->sectors_written = f[6];
+    d->write_ms = f[7];
+    d->io_ms = f[9];
+    d->has_prev = 1;
+}
+
+// Один проход по тексту: "major minor name f1 f2 ... f11 [f12 ...]"
+void disk_collector_update(DiskCollector *c, const char *text, double elapsed_sec) {
+    unsigned long long fields[DISKSTATS_FIELDS];
+    char name[DISK_NAME_MAX];
+
+    for (int i = 0; i < c->count; i++) {
+        c->devices[i].seen = 0;
+    }
+
+    const char *p = text;
+    while (*p) {
+        parse_ull(&p);
+        parse_ull(&p);
+
+        const char *start = skip_spaces(p);
+        p = skip_token(start);
+        size_t len = (size_t)(p - start);
+
+        for (int i = 0; i < DISKSTATS_FIELDS; i++) {
+            fields[i] = parse_ull(&p);
+        }
+
+        const char *eol = strchr(p, '\n');
+        p = eol ? eol + 1 : p + strlen(p);
+
+        if (len == 0 || len >= sizeof(name)) continue;
+        memcpy(name, start, len);
+        name[len] = '\0';
+
+        int stacked;
+        if (!is_whole_disk(c, name, &stacked)) continue;
+
+        DiskDevice *d = find_or_add_device(c, name);
+        if (!d) continue;
+        update_device(d, fields, elapsed_sec);
+        d->stacked = stacked;
+        d->seen = 1;
+    }
+
+    // устройства, пропавшие из diskstats (отключенный USB-диск), удаляем
+    int kept = 0;
+    for (int i = 0; i < c->count; i++) {
+        if (!c->devices[i].seen) continue;
+        if (kept != i) c->devices[kept] = c->devices[i];
+        kept++;
+    }
+    c->count = kept;
+}
+
+int disk_collector_sample(DiskCollector *c, double elapsed_sec) {
+    if (procfile_read(&c->file, c->buffer, sizeof(c->buffer)) < 0) return -1;
+    disk_collector_update(c, c->buffer, elapsed_sec);
+    return 0;
+}
+
+void disk_collector_totals(const DiskCollector *c, double *read_bytes, double *write_bytes) {
+    *read_bytes = 0.0;
+    *write_bytes = 0.0;
+    for (int i = 0; i < c->count; i++) {
+        if (c->devices[i].stacked) continue;
+        *read_bytes += c->devices[i].read_bytes;
+        *write_bytes += c->devices[i].write_bytes;
+    }
+}
+
+void write_disks_json(JsonWriter *w, const DiskCollector *c) {
+    jw_char(w, '[');
+
+    for (int i = 0; i < c->count; i++) {
+        const DiskDevice *d = &c->devices[i];
+
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n    {\"device\": ");
+        jw_string(w, d->name);
+        jw_lit(w, ", \"read_iops\": ");
+        jw_fixed1(w, d->read_iops);
+        jw_lit(w, ", \"write_iops\": ");
+        jw_fixed1(w, d->write_iops);
+        jw_lit(w, ", \"read_mb\": ");
+        jw_fixed1(w, d->read_bytes / (1024.0 * 1024.0));
+        jw_lit(w, ", \"write_mb\": ");
+        jw_fixed1(w, d->write_bytes / (1024.0 * 1024.0));
+        jw_lit(w, ", \"read_bytes\": ");
+        jw_uint(w, (unsigned long long)d->read_bytes);
+        jw_lit(w, ", \"write_bytes\": ");
+        jw_uint(w, (unsigned long long)d->write_bytes);
+        jw_lit(w, ", \"read_await\": ");
+        jw_fixed1(w, d->read_await);
+        jw_lit(w, ", \"write_await\": ");
+        jw_fixed1(w, d->write_await);
+        jw_lit(w, ", \"utilization\": ");
+        jw_fixed1(w, d->utilization);
+        if (d->stacked) jw_lit(w, ", \"stacked\": true");
+        jw_char(w, '}');
+    }
+
+    if (c->count > 0) jw_lit(w, "\n  ");
+    jw_char(w, ']');
+}
@@ -0,0 +1,61 @@
+#ifndef DISK_COLLECTOR_H
+#define DISK_COLLECTOR_H
+
+#include "config.h"
+#include "json_writer.h"
+#include "procfs.h"
+
+#define DISK_NAME_MAX 32
+#define DISKSTATS_BUFFER_SIZE 65536
+
+typedef struct {
+    char name[DISK_NAME_MAX];
+    int has_prev;
+    int seen;
+    int stacked;            // dm-*/md*: I/O уже учтен на нижних устройствах
+
+    // счетчики из /proc/diskstats на прошлом тике
+    unsigned long long reads;
+    unsigned long long sectors_read;
+    unsigned long long read_ms;
+    unsigned long long writes;
+    unsigned long long sectors_written;
+    unsigned long long write_ms;
+    unsigned long long io_ms;
+
+    double read_iops;
+    double write_iops;
+    double read_bytes;      // байт/с
+    double write_bytes;     // байт/с
+    double read_await;      // мс на операцию
+    double write_await;
+    double utilization;     // %
+} DiskDevice;
+
+// Решение "целый диск или нет" принимается один раз на имя:
+// разделы и loop/ram устройства не попадают в devices
+typedef struct {
+    char name[DISK_NAME_MAX];
+    int whole_disk;
+    int stacked;
+} DiskNameVerdict;
+
+typedef struct {
+    ProcFile file;
+    char sys_block[PROCFS_PATH_MAX];
+    DiskDevice devices[MAX_DISKS];
+    int count;
+    DiskNameVerdict verdicts[MAX_DISK_NAMES];
+    int verdict_count;
+    char buffer[DISKSTATS_BUFFER_SIZE];
+} DiskCollector;
+
+void disk_collector_init(DiskCollector *c, const char *diskstats_path, const char *sys_block_path);
+void disk_collector_free(DiskCollector *c);
+int disk_collector_sample(DiskCollector *c, double elapsed_sec);
+void disk_collector_update(DiskCollector *c, const char *text, double elapsed_sec);
+// Сумма по физическим дискам: устройства поверх других (stacked) не входят
+void disk_collector_totals(const DiskCollector *c, double *read_bytes, double *write_bytes);
+void write_disks_json(JsonWriter *w, const DiskCollector *c);
+
+#endif
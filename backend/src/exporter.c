@@ -0,0 +1,420 @@
+#include <errno.h>
+#include <math.h>
+#include <netdb.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include "exporter.h"
+#include "disk_collector.h"
+#include "net_collector.h"
+#include "psi_collector.h"
+
+static int parse_target(Exporter *e, const char *url) {
+    const char *rest;
+
+    if (strncmp(url, "udp://", 6) == 0) {
+        e->transport = EXPORT_UDP;
+        rest = url + 6;
+
+        char host[200];
+        const char *colon = strrchr(rest, ':');
+        if (!colon || colon == rest || (size_t)(colon - rest) >= sizeof(host)) return -1;
+        memcpy(host, rest, colon - rest);
+        host[colon - rest] = '\0';
+
+        struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM};
+        struct addrinfo *res = NULL;
+        if (getaddrinfo(host, colon + 1, &hints, &res) != 0 || !res) return -1;
+        memcpy(&e->addr, res->ai_addr, res->ai_addrlen);
+        e->addr_len = res->ai_addrlen;
+        freeaddrinfo(res);
+        return 0;
+    }
+
+    if (strncmp(url, "unixgram://", 11) == 0) {
+        e->transport = EXPORT_UNIXGRAM;
+        rest = url + 11;
+    } else if (strncmp(url, "unix://", 7) == 0) {
+        e->transport = EXPORT_UNIX;
+        rest = url + 7;
+    } else {
+        return -1;
+    }
+
+    struct sockaddr_un *sun = (struct sockaddr_un *)&e->addr;
+    if (rest[0] != '/' || strlen(rest) >= sizeof(sun->sun_path)) return -1;
+    sun->sun_family = AF_UNIX;
+    strcpy(sun->sun_path, rest);
+    e->addr_len = sizeof(struct sockaddr_un);
+    return 0;
+}
+
+int exporter_init(Exporter *e, const char *url, ExportFormat format) {
+    memset(e, 0, sizeof(*e));
+    e->fd = -1;
+    e->format = format;
+    snprintf(e->target, sizeof(e->target), "%s", url);
+
+    if (parse_target(e, url) != 0) {
+        fprintf(stderr, "Invalid export target: %s (udp://host:port, unixgram:///path, unix:///path)\n", url);
+        return -1;
+    }
+
+    if (gethostname(e->host, sizeof(e->host)) != 0) {
+        snprintf(e->host, sizeof(e->host), "localhost");
+    }
+    e->host[sizeof(e->host) - 1] = '\0';
+
+    e->queue = calloc(EXPORT_QUEUE_SLOTS, sizeof(ExportBatch));
+    if (!e->queue) return -1;
+    pthread_mutex_init(&e->mutex, NULL);
+    pthread_cond_init(&e->cond, NULL);
+    return 0;
+}
+
+// Строка протокола: при нехватке места выставляется overflow
+typedef struct {
+    char *p;
+    size_t n;
+    size_t room;
+    int overflow;
+} ExportLine;
+
+static void line_printf(ExportLine *l, const char *fmt, ...) {
+    if (l->overflow) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int k = vsnprintf(l->p + l->n, l->room - l->n, fmt, ap);
+    va_end(ap);
+
+    if (k < 0 || (size_t)k >= l->room - l->n) l->overflow = 1;
+    else l->n += k;
+}
+
+static void line_char(ExportLine *l, char c) {
+    if (l->overflow || l->n + 1 >= l->room) {
+        l->overflow = 1;
+        return;
+    }
+    l->p[l->n++] = c;
+}
+
+// Имена и значения тегов InfluxDB: пробел, запятая и '=' экранируются
+static void line_influx_escaped(ExportLine *l, const char *s) {
+    for (; *s; s++) {
+        if (*s == ' ' || *s == ',' || *s == '=') line_char(l, '\\');
+        line_char(l, *s);
+    }
+}
+
+// Компонент имени statsd: только [A-Za-z0-9_-], остальное - '_'
+static void line_statsd_name(ExportLine *l, const char *s) {
+    for (; *s; s++) {
+        char c = *s;
+        int ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                 (c >= '0' && c <= '9') || c == '_' || c == '-';
+        line_char(l, ok ? c : '_');
+    }
+}
+
+static void line_value(ExportLine *l, double v) {
+    if (!isfinite(v)) v = 0.0;
+    // байты и счетчики без дробной части, иначе %g съел бы разряды
+    if (v == floor(v) && fabs(v) < 1e15) line_printf(l, "%.0f", v);
+    else line_printf(l, "%.3f", v);
+}
+
+void exporter_begin(Exporter *e, long long timestamp_ns) {
+    e->scratch.len = 0;
+    e->timestamp_ns = timestamp_ns;
+}
+
+// Строка собирается во временный буфер и добавляется целиком либо никак
+void exporter_add(Exporter *e, const char *measurement, const char *tag_key, const char *tag_value,
+                  const ExportField *fields, int field_count) {
+    char buffer[EXPORT_DATAGRAM_MAX];
+    ExportLine line = {.p = buffer, .room = sizeof(buffer)};
+
+    if (e->format == EXPORT_INFLUX) {
+        line_influx_escaped(&line, measurement);
+        line_printf(&line, ",host=");
+        line_influx_escaped(&line, e->host);
+        if (tag_key && tag_value) {
+            line_printf(&line, ",%s=", tag_key);
+            line_influx_escaped(&line, tag_value);
+        }
+        for (int i = 0; i < field_count; i++) {
+            line_printf(&line, "%c%s=", i ? ',' : ' ', fields[i].name);
+            line_value(&line, fields[i].value);
+        }
+        line_printf(&line, " %lld\n", e->timestamp_ns);
+    } else {
+        for (int i = 0; i < field_count; i++) {
+            line_printf(&line, "system_monitor.");
+            line_statsd_name(&line, e->host);
+            line_char(&line, '.');
+            line_statsd_name(&line, measurement);
+            if (tag_value) {
+                line_char(&line, '.');
+                line_statsd_name(&line, tag_value);
+            }
+            line_printf(&line, ".%s:", fields[i].name);
+            line_value(&line, fields[i].value);
+            line_printf(&line, "|g\n");
+        }
+    }
+
+    if (line.overflow || e->scratch.len + line.n > sizeof(e->scratch.data)) {
+        e->truncated++;
+        return;
+    }
+    memcpy(e->scratch.data + e->scratch.len, buffer, line.n);
+    e->scratch.len += line.n;
+}
+
+// Очередь полна - выбрасывается самый старый тик, а не новый
+void exporter_commit(Exporter *e) {
+    if (e->scratch.len == 0) return;
+
+    pthread_mutex_lock(&e->mutex);
+    if (e->count == EXPORT_QUEUE_SLOTS) {
+        e->head = (e->head + 1) % EXPORT_QUEUE_SLOTS;
+        e->count--;
+        __atomic_fetch_add(&e->dropped, 1, __ATOMIC_RELAXED);
+    }
+    ExportBatch *slot = &e->queue[(e->head + e->count) % EXPORT_QUEUE_SLOTS];
+    memcpy(slot->data, e->scratch.data, e->scratch.len);
+    slot->len = e->scratch.len;
+    e->count++;
+    pthread_cond_signal(&e->cond);
+    pthread_mutex_unlock(&e->mutex);
+
+    __atomic_fetch_add(&e->batches, 1, __ATOMIC_RELAXED);
+}
+
+void exporter_push_tick(Exporter *e, const CPUStats *cpu, const MemoryInfo *mem,
+                        const GPUInfo *gpu, const SnapshotExtras *extras) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    exporter_begin(e, (long long)now.tv_sec * 1000000000LL + now.tv_nsec);
+
+    ExportField cpu_fields[] = {
+        {"usage", cpu->usage_percent},
+        {"temperature", cpu->temperature},
+        {"frequency", (double)cpu->frequency},
+    };
+    exporter_add(e, "cpu", NULL, NULL, cpu_fields, 3);
+
+    ExportField mem_fields[] = {
+        {"used", (double)mem->used},
+        {"total", (double)mem->total},
+        {"cached", (double)mem->cached},
+        {"percent", mem->percentage},
+    };
+    exporter_add(e, "memory", NULL, NULL, mem_fields, 4);
+
+    ExportField gpu_fields[] = {
+        {"usage", gpu->usage},
+        {"memory_used", (double)gpu->memory_used},
+        {"memory_total", (double)gpu->memory_total},
+        {"temperature", gpu->temperature},
+        {"power", gpu->power},
+    };
+    exporter_add(e, "gpu", NULL, NULL, gpu_fields, 5);
+
+    if (extras && extras->disks) {
+        for (int i = 0; i < extras->disks->count; i++) {
+            const DiskDevice *d = &extras->disks->devices[i];
+            ExportField fields[] = {
+                {"read_bytes", d->read_bytes},
+                {"write_bytes", d->write_bytes},
+                {"read_iops", d->read_iops},
+                {"write_iops", d->write_iops},
+                {"utilization", d->utilization},
+            };
+            exporter_add(e, "disk", "device", d->name, fields, 5);
+        }
+    }
+
+    if (extras && extras->network) {
+        for (int i = 0; i < extras->network->count; i++) {
+            const NetInterface *n = &extras->network->interfaces[i];
+            ExportField fields[] = {
+                {"rx_bytes", n->rx_bytes_rate},
+                {"tx_bytes", n->tx_bytes_rate},
+                {"rx_packets", n->rx_packets_rate},
+                {"tx_packets", n->tx_packets_rate},
+                {"rx_errors", n->rx_errors_rate},
+                {"tx_errors", n->tx_errors_rate},
+            };
+            exporter_add(e, "net", "interface", n->name, fields, 6);
+        }
+    }
+
+    if (extras && extras->pressure) {
+        ExportField fields[PSI_RESOURCES];
+        for (int r = 0; r < PSI_RESOURCES; r++) {
+            fields[r].name = psi_resource_name(r);
+            fields[r].value = extras->pressure->stall[r];
+        }
+        exporter_add(e, "pressure", NULL, NULL, fields, PSI_RESOURCES);
+    }
+
+    if (extras && extras->topology) {
+        char id[16];
+        for (int i = 0; i < extras->topology->node_count; i++) {
+            const TopologyNode *n = &extras->topology->nodes[i];
+            ExportField fields[] = {
+                {"usage", n->usage},
+                {"memory_used", (double)n->mem_used},
+                {"memory_total", (double)n->mem_total},
+                {"memory_percent", n->mem_percentage},
+            };
+            snprintf(id, sizeof(id), "%d", n->id);
+            exporter_add(e, "numa", "node", id, fields, n->has_memory ? 4 : 1);
+        }
+    }
+
+    exporter_commit(e);
+}
+
+static int take_locked(Exporter *e, ExportBatch *out) {
+    if (e->count == 0) return 0;
+    ExportBatch *slot = &e->queue[e->head];
+    memcpy(out->data, slot->data, slot->len);
+    out->len = slot->len;
+    e->head = (e->head + 1) % EXPORT_QUEUE_SLOTS;
+    e->count--;
+    return 1;
+}
+
+int exporter_take(Exporter *e, ExportBatch *out) {
+    pthread_mutex_lock(&e->mutex);
+    int taken = take_locked(e, out);
+    pthread_mutex_unlock(&e->mutex);
+    return taken;
+}
+
+// Длина следующей датаграммы: целые строки, пока влезают в max.
+// Строка длиннее max уходит одна
+size_t exporter_next_datagram(const char *data, size_t len, size_t max) {
+    size_t end = 0;
+    while (end < len) {
+        const char *nl = memchr(data + end, '\n', len - end);
+        size_t line_end = nl ? (size_t)(nl - data) + 1 : len;
+        if (line_end > max && end > 0) break;
+        end = line_end;
+        if (end >= max) break;
+    }
+    return end;
+}
+
+static int exporter_connect(Exporter *e) {
+    int type = e->transport == EXPORT_UNIX ? SOCK_STREAM : SOCK_DGRAM;
+    e->fd = socket(e->addr.ss_family, type | SOCK_CLOEXEC, 0);
+    if (e->fd < 0) return -1;
+
+    // блокируется только поток отправки и не дольше таймаута
+    struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+    setsockopt(e->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(e->fd, (struct sockaddr *)&e->addr, e->addr_len) != 0) {
+        close(e->fd);
+        e->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void exporter_send(Exporter *e, const ExportBatch *b) {
+    if (e->fd < 0 && exporter_connect(e) != 0) {
+        __atomic_fetch_add(&e->errors, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (e->transport == EXPORT_UNIX) {
+        size_t done = 0;
+        while (done < b->len) {
+            ssize_t n = send(e->fd, b->data + done, b->len - done, MSG_NOSIGNAL);
+            if (n <= 0) {
+                __atomic_fetch_add(&e->errors, 1, __ATOMIC_RELAXED);
+                close(e->fd);
+                e->fd = -1;
+                return;
+            }
+            done += n;
+        }
+        __atomic_fetch_add(&e->bytes, b->len, __ATOMIC_RELAXED);
+        return;
+    }
+
+    size_t offset = 0;
+    while (offset < b->len) {
+        size_t n = exporter_next_datagram(b->data + offset, b->len - offset, EXPORT_DATAGRAM_MAX);
+        // UDP без слушателя дает ECONNREFUSED - это потеря, а не повод ждать
+        if (send(e->fd, b->data + offset, n, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)n) {
+            __atomic_fetch_add(&e->datagrams, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&e->bytes, n, __ATOMIC_RELAXED);
+        } else {
+            __atomic_fetch_add(&e->errors, 1, __ATOMIC_RELAXED);
+        }
+        offset += n;
+    }
+}
+
+static void *exporter_thread(void *arg) {
+    Exporter *e = arg;
+    ExportBatch *batch = malloc(sizeof(ExportBatch));
+    if (!batch) return NULL;
+
+    for (;;) {
+        pthread_mutex_lock(&e->mutex);
+        while (e->running && e->count == 0) {
+            pthread_cond_wait(&e->cond, &e->mutex);
+        }
+        int taken = take_locked(e, batch);
+        int running = e->running;
+        pthread_mutex_unlock(&e->mutex);
+
+        if (!taken && !running) break;
+        if (taken) exporter_send(e, batch);
+    }
+
+    free(batch);
+    return NULL;
+}
+
+int exporter_start(Exporter *e) {
+    e->running = 1;
+    if (pthread_create(&e->thread, NULL, exporter_thread, e) != 0) {
+        perror("pthread_create");
+        e->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+// Остаток очереди дописывается перед выходом
+void exporter_stop(Exporter *e) {
+    if (!e->running) return;
+
+    pthread_mutex_lock(&e->mutex);
+    e->running = 0;
+    pthread_cond_signal(&e->cond);
+    pthread_mutex_unlock(&e->mutex);
+    pthread_join(e->thread, NULL);
+}
+
+void exporter_free(Exporter *e) {
+    if (e->fd >= 0) close(e->fd);
+    e->fd = -1;
+    free(e->queue);
+    e->queue = NULL;
+    pthread_mutex_destroy(&e->mutex);
+    pthread_cond_destroy(&e->cond);
+}
@@ -0,0 +1,92 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include "config.h"
+#include "json_formatter.h"
+
+/*
+ * Push-экспорт (--export URL): каждый тик кодируется в InfluxDB line
+ * protocol или statsd и кладется в очередь на EXPORT_QUEUE_SLOTS тиков.
+ * Отправляет фоновый поток; при переполнении выбрасывается самый старый
+ * тик, поток сбора никогда не ждет сеть.
+ *
+ *   udp://host:port      - строки склеиваются в датаграммы до EXPORT_DATAGRAM_MAX
+ *   unixgram:///path     - то же через unix datagram сокет
+ *   unix:///path         - поток: тик целиком одной записью, переподключение
+ *                          на следующем тике после ошибки
+ */
+
+typedef enum {
+    EXPORT_INFLUX,
+    EXPORT_STATSD
+} ExportFormat;
+
+typedef enum {
+    EXPORT_UDP,
+    EXPORT_UNIXGRAM,
+    EXPORT_UNIX
+} ExportTransport;
+
+typedef struct {
+    const char *name;
+    double value;
+} ExportField;
+
+typedef struct {
+    size_t len;
+    char data[EXPORT_BATCH_MAX];
+} ExportBatch;
+
+typedef struct {
+    ExportFormat format;
+    ExportTransport transport;
+    char target[256];
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    int fd;
+    char host[64];
+
+    // кодирует поток сбора, без блокировки
+    ExportBatch scratch;
+    long long timestamp_ns;
+    unsigned long truncated;
+
+    // очередь: голова - самый старый тик
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    ExportBatch *queue;
+    int head;
+    int count;
+    volatile int running;
+    pthread_t thread;
+
+    // счетчики для /api/health (атомарные)
+    unsigned long batches;
+    unsigned long dropped;
+    unsigned long datagrams;
+    unsigned long bytes;
+    unsigned long errors;
+} Exporter;
+
+int exporter_init(Exporter *e, const char *url, ExportFormat format);
+int exporter_start(Exporter *e);
+void exporter_stop(Exporter *e);
+void exporter_free(Exporter *e);
+
+// Кодирование тика: begin, add на каждую строку, commit кладет в очередь
+void exporter_begin(Exporter *e, long long timestamp_ns);
+void exporter_add(Exporter *e, const char *measurement, const char *tag_key, const char *tag_value,
+                  const ExportField *fields, int field_count);
+void exporter_commit(Exporter *e);
+
+void exporter_push_tick(Exporter *e, const CPUStats *cpu, const MemoryInfo *mem,
+                        const GPUInfo *gpu, const SnapshotExtras *extras);
+
+// Забирает самый старый тик из очереди (для потока отправки и тестов)
+int exporter_take(Exporter *e, ExportBatch *out);
+size_t exporter_next_datagram(const char *data, size_t len, size_t max);
+
+#endif
@@ -0,0 +1,746 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "fleet.h"
+
+enum { CONN_CLOSED, CONN_CONNECTING, CONN_READING, CONN_IDLE };
+
+static const char *state_names[] = {"pending", "ok", "stale", "down"};
+
+long fleet_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000;
+}
+
+// 1 - хост, 0 - пустая строка или комментарий, -1 - ошибка
+int fleet_parse_host_line(const char *line, char *host, size_t host_size, int *port,
+                          char *name, size_t name_size) {
+    char address[192] = "", label[64] = "";
+    char copy[256];
+
+    snprintf(copy, sizeof(copy), "%s", line);
+    char *comment = strchr(copy, '#');
+    if (comment) *comment = '\0';
+
+    int fields = sscanf(copy, "%191s %63s", address, label);
+    if (fields <= 0) return 0;
+
+    *port = PORT;
+    char *colon = strrchr(address, ':');
+    if (colon) {
+        char *end = NULL;
+        long p = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end != '\0' || p <= 0 || p > 65535) return -1;
+        *port = (int)p;
+        *colon = '\0';
+    }
+    if (address[0] == '\0' || strlen(address) >= host_size) return -1;
+
+    snprintf(host, host_size, "%s", address);
+    if (fields == 2) {
+        snprintf(name, name_size, "%s", label);
+    } else {
+        snprintf(name, name_size, "%s:%d", address, *port);
+    }
+    return 1;
+}
+
+static int resolve_address(const char *host, int port, int flags,
+                           struct sockaddr_storage *addr, socklen_t *addr_len) {
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = flags};
+    struct addrinfo *res = NULL;
+    char service[8];
+
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res) return -1;
+
+    memcpy(addr, res->ai_addr, res->ai_addrlen);
+    *addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return 0;
+}
+
+int fleet_load_hosts(Fleet *f, const char *path) {
+    memset(f, 0, sizeof(*f));
+    f->epfd = -1;
+    f->wake = -1;
+    f->interval_ms = UPDATE_INTERVAL_MS;
+    pthread_mutex_init(&f->mutex, NULL);
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    f->hosts = calloc(FLEET_MAX_HOSTS, sizeof(FleetHost));
+    if (!f->hosts) {
+        fclose(file);
+        return -1;
+    }
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_no++;
+        // разбор в локальные буферы: запись в массив - только после проверки места
+        char host[128], name[64];
+        int port;
+        int r = fleet_parse_host_line(line, host, sizeof(host), &port, name, sizeof(name));
+        if (r == 0) continue;
+        if (r < 0) {
+            fprintf(stderr, "%s:%d: expected host[:port] [name]\n", path, line_no);
+            continue;
+        }
+        if (f->count >= FLEET_MAX_HOSTS) {
+            fprintf(stderr, "%s: more than %d hosts, ignoring the rest\n", path, FLEET_MAX_HOSTS);
+            break;
+        }
+        FleetHost *h = &f->hosts[f->count++];
+        memcpy(h->host, host, sizeof(h->host));
+        memcpy(h->name, name, sizeof(h->name));
+        h->port = port;
+        h->fd = -1;
+        // IP-адрес разбирается сразу и без сети, имя - потоком резолвера
+        resolve_address(h->host, h->port, AI_NUMERICHOST, &h->addr, &h->addr_len);
+    }
+    fclose(file);
+
+    if (f->count == 0) {
+        fprintf(stderr, "%s: no hosts\n", path);
+        fleet_free(f);
+        return -1;
+    }
+    return 0;
+}
+
+// top=N из строки запроса (без '?'): 0 - нет ключа, -1 - не число > 0
+int parse_fleet_top(const char *query_string) {
+    const char *p = query_string;
+    while (p && *p) {
+        if (strncmp(p, "top=", 4) == 0) {
+            char *end = NULL;
+            long top = strtol(p + 4, &end, 10);
+            if (end == p + 4 || (*end != '\0' && *end != '&') || top <= 0) return -1;
+            return top > FLEET_MAX_HOSTS ? FLEET_MAX_HOSTS : (int)top;
+        }
+        p = strchr(p, '&');
+        if (p) p++;
+    }
+    return 0;
+}
+
+// 1 - ответ целиком в буфере, 0 - нужно дочитать, -1 - не HTTP
+int fleet_parse_response(const char *buf, size_t len, FleetResponse *r) {
+    const char *end = memmem(buf, len, "\r\n\r\n", 4);
+    if (!end) return len > 8192 ? -1 : 0;
+
+    memset(r, 0, sizeof(*r));
+    r->header_len = end - buf + 4;
+    r->content_length = -1;
+
+    if (sscanf(buf, "HTTP/1.%*d %d", &r->status) != 1) return -1;
+
+    const char *line = memmem(buf, r->header_len, "\r\n", 2);
+    while (line && line + 2 < end) {
+        line += 2;
+        const char *eol = memmem(line, end + 2 - line, "\r\n", 2);
+        size_t n = eol - line;
+
+        if (n > 15 && strncasecmp(line, "Content-Length:", 15) == 0) {
+            r->content_length = strtol(line + 15, NULL, 10);
+        } else if (n > 5 && strncasecmp(line, "ETag:", 5) == 0) {
+            const char *v = line + 5;
+            while (*v == ' ') v++;
+            int vlen = (int)(eol - v);
+            if (vlen > 0 && vlen < (int)sizeof(r->etag)) {
+                memcpy(r->etag, v, vlen);
+                r->etag[vlen] = '\0';
+            }
+        } else if (n > 11 && strncasecmp(line, "Connection:", 11) == 0) {
+            r->close = memmem(line, n, "close", 5) != NULL;
+        }
+        line = eol;
+    }
+
+    // у 304 тела нет, даже если длина не указана
+    if (r->status == 304 || (r->status >= 100 && r->status < 200)) r->content_length = 0;
+    if (r->content_length < 0) return 0;
+    return len >= r->header_len + (size_t)r->content_length ? 1 : 0;
+}
+
+// Число после "key": внутри объекта "object" (NULL - с начала документа)
+static int find_number(const char *json, const char *object, const char *key, double *out) {
+    char pattern[48];
+    const char *p = json;
+
+    if (object) {
+        snprintf(pattern, sizeof(pattern), "\"%s\":", object);
+        p = strstr(p, pattern);
+        if (!p) return -1;
+    }
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    p = strstr(p, pattern);
+    if (!p) return -1;
+
+    char *end = NULL;
+    *out = strtod(p + strlen(pattern), &end);
+    return end == p + strlen(pattern) ? -1 : 0;
+}
+
+// Метрики из ответа /api/system; -1, если это не снимок (например, "Data not ready yet")
+int fleet_parse_system_json(const char *json, FleetMetrics *m) {
+    double v;
+
+    memset(m, 0, sizeof(*m));
+    if (find_number(json, "cpu", "usage", &m->cpu_usage) != 0 ||
+        find_number(json, "memory", "percentage", &m->memory_percent) != 0) {
+        return -1;
+    }
+    if (find_number(json, NULL, "timestamp", &v) == 0) m->timestamp = (long)v;
+    if (find_number(json, "cpu", "cores_count", &v) == 0) m->cores = (int)v;
+    if (find_number(json, "memory", "total", &v) == 0) m->memory_total = (unsigned long long)v;
+    if (find_number(json, "memory", "used", &v) == 0) m->memory_used = (unsigned long long)v;
+    find_number(json, "gpu", "usage", &m->gpu_usage);
+    return 0;
+}
+
+FleetHostState fleet_host_state(const Fleet *f, const FleetHost *h, long now_ms) {
+    if (h->last_ok_ms == 0) return h->errors > 0 ? FLEET_DOWN : FLEET_PENDING;
+
+    long stale_ms = (long)FLEET_STALE_INTERVALS * f->interval_ms;
+    long down_ms = 2 * stale_ms > FLEET_DOWN_MS ? 2 * stale_ms : FLEET_DOWN_MS;
+    long age = now_ms - h->last_ok_ms;
+    if (age <= stale_ms) return FLEET_OK;
+    if (age <= down_ms) return FLEET_STALE;
+    return FLEET_DOWN;
+}
+
+static void host_close(Fleet *f, FleetHost *h) {
+    if (h->fd >= 0) {
+        epoll_ctl(f->epfd, EPOLL_CTL_DEL, h->fd, NULL);
+        close(h->fd);
+    }
+    h->fd = -1;
+    h->conn = CONN_CLOSED;
+}
+
+static void host_fail(Fleet *f, FleetHost *h, const char *error) {
+    host_close(f, h);
+    pthread_mutex_lock(&f->mutex);
+    h->errors++;
+    snprintf(h->error, sizeof(h->error), "%s", error);
+    pthread_mutex_unlock(&f->mutex);
+}
+
+// sections=none: опрос агрегатора не считается спросом на процессы и GPU,
+// иначе агенты парка никогда не переходили бы в ленивый режим
+static void host_send(Fleet *f, FleetHost *h) {
+    char request[384];
+    int len = snprintf(request, sizeof(request),
+                       "GET /api/system?sections=none HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "Connection: keep-alive\r\n"
+                       "%s%s%s"
+                       "\r\n",
+                       h->host,
+                       h->etag[0] ? "If-None-Match: " : "", h->etag, h->etag[0] ? "\r\n" : "");
+
+    // запрос маленький, в пустой буфер сокета уходит целиком
+    if (send(h->fd, request, len, MSG_NOSIGNAL) != len) {
+        host_fail(f, h, "send failed");
+        return;
+    }
+
+    h->len = 0;
+    h->conn = CONN_READING;
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = h};
+    epoll_ctl(f->epfd, EPOLL_CTL_MOD, h->fd, &ev);
+}
+
+static void host_request(Fleet *f, FleetHost *h, long now) {
+    if (h->conn == CONN_CONNECTING || h->conn == CONN_READING) {
+        // ответ не пришел за интервал опроса
+        host_fail(f, h, "timeout");
+    }
+
+    h->started_ms = now;
+    if (h->conn == CONN_IDLE) {
+        host_send(f, h);
+        return;
+    }
+
+    // имя разрешает поток резолвера: до первого ответа хост остается pending,
+    // после неудачи каждый раунд считается ошибкой
+    struct sockaddr_storage addr;
+    pthread_mutex_lock(&f->mutex);
+    socklen_t addr_len = h->addr_len;
+    int resolve_failures = h->resolve_failures;
+    if (addr_len > 0) memcpy(&addr, &h->addr, addr_len);
+    pthread_mutex_unlock(&f->mutex);
+    if (addr_len == 0) {
+        if (resolve_failures > 0) host_fail(f, h, "cannot resolve");
+        return;
+    }
+
+    h->fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (h->fd < 0) {
+        host_fail(f, h, "socket failed");
+        return;
+    }
+
+    struct epoll_event ev = {.events = EPOLLOUT, .data.ptr = h};
+    if (epoll_ctl(f->epfd, EPOLL_CTL_ADD, h->fd, &ev) != 0) {
+        close(h->fd);
+        h->fd = -1;
+        host_fail(f, h, "epoll failed");
+        return;
+    }
+
+    if (connect(h->fd, (struct sockaddr *)&addr, addr_len) == 0) {
+        host_send(f, h);
+    } else if (errno == EINPROGRESS) {
+        h->conn = CONN_CONNECTING;
+    } else {
+        host_fail(f, h, strerror(errno));
+    }
+}
+
+static void host_complete(Fleet *f, FleetHost *h, const FleetResponse *r) {
+    FleetMetrics m;
+    long now = fleet_now_ms();
+
+    if (r->status == 200) {
+        h->buf[r->header_len + r->content_length] = '\0';
+        if (fleet_parse_system_json(h->buf + r->header_len, &m) != 0) {
+            host_fail(f, h, "no snapshot");
+            return;
+        }
+    } else if (r->status != 304) {
+        char error[32];
+        snprintf(error, sizeof(error), "HTTP %d", r->status);
+        host_fail(f, h, error);
+        return;
+    }
+
+    pthread_mutex_lock(&f->mutex);
+    if (r->status == 200) {
+        h->metrics = m;
+        h->has_data = 1;
+    } else {
+        h->not_modified++;
+    }
+    h->polls++;
+    h->last_ok_ms = now;
+    h->latency_ms = (double)(now - h->started_ms);
+    h->error[0] = '\0';
+    pthread_mutex_unlock(&f->mutex);
+
+    if (r->status == 200) snprintf(h->etag, sizeof(h->etag), "%s", r->etag);
+
+    if (r->close) {
+        host_close(f, h);
+    } else {
+        // простаивающее соединение: EPOLLIN значит, что агент его закрыл
+        h->conn = CONN_IDLE;
+        struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = h};
+        epoll_ctl(f->epfd, EPOLL_CTL_MOD, h->fd, &ev);
+    }
+}
+
+static void host_read(Fleet *f, FleetHost *h) {
+    FleetResponse r = {0};
+    int eof = 0;
+
+    for (;;) {
+        if (h->cap - h->len < 4096) {
+            size_t cap = h->cap ? h->cap * 2 : 16384;
+            if (cap > FLEET_RESPONSE_MAX + 1) {
+                host_fail(f, h, "response too large");
+                return;
+            }
+            char *p = realloc(h->buf, cap);
+            if (!p) {
+                host_fail(f, h, "out of memory");
+                return;
+            }
+            h->buf = p;
+            h->cap = cap;
+        }
+
+        // место под '\0' после тела
+        ssize_t n = recv(h->fd, h->buf + h->len, h->cap - h->len - 1, 0);
+        if (n > 0) {
+            h->len += n;
+            continue;
+        }
+        if (n == 0) eof = 1;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            host_fail(f, h, strerror(errno));
+            return;
+        }
+        break;
+    }
+
+    int done = fleet_parse_response(h->buf, h->len, &r);
+    if (done == 0 && eof && r.header_len > 0 && r.content_length < 0) {
+        // без Content-Length тело идет до закрытия соединения
+        r.content_length = h->len - r.header_len;
+        r.close = 1;
+        done = 1;
+    }
+
+    if (done < 0) {
+        host_fail(f, h, "bad response");
+    } else if (done > 0) {
+        host_complete(f, h, &r);
+    } else if (eof) {
+        host_fail(f, h, "connection closed");
+    }
+}
+
+static void host_event(Fleet *f, FleetHost *h, unsigned events) {
+    if (h->conn == CONN_CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(h->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+            host_fail(f, h, err ? strerror(err) : "connect failed");
+        } else {
+            host_send(f, h);
+        }
+    } else if (h->conn == CONN_READING) {
+        host_read(f, h);
+    } else if (h->conn == CONN_IDLE) {
+        // агент закрыл keep-alive соединение между опросами - это не ошибка
+        host_close(f, h);
+    }
+}
+
+static void *fleet_thread(void *arg) {
+    Fleet *f = arg;
+    long next_round = fleet_now_ms();
+
+    while (f->running) {
+        long now = fleet_now_ms();
+        if (now >= next_round) {
+            for (int i = 0; i < f->count; i++) {
+                host_request(f, &f->hosts[i], now);
+            }
+            next_round += f->interval_ms;
+            if (next_round <= now) next_round = now + f->interval_ms;
+        }
+
+        struct epoll_event events[64];
+        long timeout = next_round - fleet_now_ms();
+        int n = epoll_wait(f->epfd, events, 64, timeout > 0 ? (int)timeout : 0);
+
+        for (int i = 0; i < n; i++) {
+            if (!events[i].data.ptr) continue;
+            host_event(f, events[i].data.ptr, events[i].events);
+        }
+    }
+    return NULL;
+}
+
+// Разрешает имена хостов по очереди; неудачное повторяется с удвоением паузы
+// от FLEET_RESOLVE_RETRY_MS до FLEET_RESOLVE_RETRY_MAX_MS. Завершается,
+// когда разрешены все
+static void *resolver_thread(void *arg) {
+    Fleet *f = arg;
+
+    pthread_mutex_lock(&f->mutex);
+    while (f->running) {
+        long now = fleet_now_ms();
+        long next = 0;
+        FleetHost *h = NULL;
+        for (int i = 0; i < f->count && !h; i++) {
+            FleetHost *c = &f->hosts[i];
+            if (c->addr_len > 0) continue;
+            if (c->resolve_at_ms <= now) h = c;
+            else if (next == 0 || c->resolve_at_ms < next) next = c->resolve_at_ms;
+        }
+
+        if (!h) {
+            if (next == 0) break;
+            struct timespec until = {.tv_sec = next / 1000, .tv_nsec = (next % 1000) * 1000000L};
+            pthread_cond_timedwait(&f->resolve_cond, &f->mutex, &until);
+            continue;
+        }
+
+        // host и port после загрузки не меняются: запрос - без блокировки
+        struct sockaddr_storage addr;
+        socklen_t addr_len = 0;
+        pthread_mutex_unlock(&f->mutex);
+        int r = resolve_address(h->host, h->port, 0, &addr, &addr_len);
+        pthread_mutex_lock(&f->mutex);
+
+        if (r == 0) {
+            memcpy(&h->addr, &addr, addr_len);
+            h->addr_len = addr_len;
+        } else {
+            long delay = FLEET_RESOLVE_RETRY_MS;
+            for (int i = 0; i < h->resolve_failures && delay < FLEET_RESOLVE_RETRY_MAX_MS; i++) {
+                delay *= 2;
+            }
+            if (delay > FLEET_RESOLVE_RETRY_MAX_MS) delay = FLEET_RESOLVE_RETRY_MAX_MS;
+            h->resolve_failures++;
+            h->resolve_at_ms = fleet_now_ms() + delay;
+        }
+    }
+    pthread_mutex_unlock(&f->mutex);
+    return NULL;
+}
+
+static int start_resolver(Fleet *f) {
+    int pending = 0;
+    for (int i = 0; i < f->count; i++) {
+        if (f->hosts[i].addr_len == 0) pending++;
+    }
+    if (pending == 0) return 0;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&f->resolve_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&f->resolver, NULL, resolver_thread, f) != 0) {
+        perror("pthread_create");
+        pthread_cond_destroy(&f->resolve_cond);
+        return -1;
+    }
+    f->has_resolver = 1;
+    return 0;
+}
+
+// Идущий getaddrinfo не прервать: остановка ждет не дольше одного запроса
+static void stop_resolver(Fleet *f) {
+    if (!f->has_resolver) return;
+
+    pthread_mutex_lock(&f->mutex);
+    f->running = 0;
+    pthread_cond_signal(&f->resolve_cond);
+    pthread_mutex_unlock(&f->mutex);
+    pthread_join(f->resolver, NULL);
+    pthread_cond_destroy(&f->resolve_cond);
+    f->has_resolver = 0;
+}
+
+int fleet_start(Fleet *f) {
+    f->epfd = epoll_create1(EPOLL_CLOEXEC);
+    f->wake = eventfd(0, EFD_CLOEXEC);
+    if (f->epfd < 0 || f->wake < 0) {
+        perror("fleet");
+        return -1;
+    }
+
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+    epoll_ctl(f->epfd, EPOLL_CTL_ADD, f->wake, &ev);
+
+    f->running = 1;
+    if (start_resolver(f) != 0) {
+        f->running = 0;
+        return -1;
+    }
+    if (pthread_create(&f->thread, NULL, fleet_thread, f) != 0) {
+        perror("pthread_create");
+        stop_resolver(f);
+        f->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void fleet_stop(Fleet *f) {
+    if (!f->running) return;
+
+    stop_resolver(f);
+    f->running = 0;
+    uint64_t one = 1;
+    if (write(f->wake, &one, sizeof(one)) < 0) {
+        perror("write");
+    }
+    pthread_join(f->thread, NULL);
+}
+
+void fleet_free(Fleet *f) {
+    for (int i = 0; i < f->count; i++) {
+        if (f->hosts[i].fd >= 0) close(f->hosts[i].fd);
+        free(f->hosts[i].buf);
+    }
+    free(f->hosts);
+    f->hosts = NULL;
+    f->count = 0;
+    if (f->epfd >= 0) close(f->epfd);
+    if (f->wake >= 0) close(f->wake);
+    f->epfd = -1;
+    f->wake = -1;
+    pthread_mutex_destroy(&f->mutex);
+}
+
+typedef struct {
+    double key;
+    int index;
+} FleetRank;
+
+static int rank_desc(const void *a, const void *b) {
+    const FleetRank *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? 1 : -1;
+    return x->index - y->index;
+}
+
+static void write_host_metrics(JsonWriter *w, const FleetHost *h, FleetHostState state, long now_ms) {
+    jw_lit(w, "{\"name\": ");
+    jw_string(w, h->name);
+    jw_lit(w, ", \"state\": ");
+    jw_string(w, state_names[state]);
+    jw_lit(w, ", \"age_ms\": ");
+    jw_int(w, now_ms - h->last_ok_ms);
+    jw_lit(w, ", \"cpu\": ");
+    jw_fixed1(w, h->metrics.cpu_usage);
+    jw_lit(w, ", \"cores\": ");
+    jw_int(w, h->metrics.cores);
+    jw_lit(w, ", \"memory\": ");
+    jw_fixed1(w, h->metrics.memory_percent);
+    jw_lit(w, ", \"memory_used\": ");
+    jw_uint(w, h->metrics.memory_used);
+    jw_lit(w, ", \"memory_total\": ");
+    jw_uint(w, h->metrics.memory_total);
+    jw_lit(w, ", \"gpu\": ");
+    jw_fixed1(w, h->metrics.gpu_usage);
+    jw_char(w, '}');
+}
+
+static void write_top(JsonWriter *w, const Fleet *f, FleetRank *ranks, int count,
+                      int top_n, long now_ms) {
+    qsort(ranks, count, sizeof(FleetRank), rank_desc);
+    jw_char(w, '[');
+    for (int i = 0; i < count && i < top_n; i++) {
+        const FleetHost *h = &f->hosts[ranks[i].index];
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n    ");
+        write_host_metrics(w, h, fleet_host_state(f, h, now_ms), now_ms);
+    }
+    if (count > 0) jw_lit(w, "\n  ");
+    jw_char(w, ']');
+}
+
+// Сводка по парку: состояния, суммы по свежим хостам, top N по CPU и памяти.
+// В top попадают и устаревшие хосты - с "state": "stale"
+void write_fleet_json(JsonWriter *w, Fleet *f, int top_n, long now_ms) {
+    FleetRank *by_cpu = malloc(sizeof(FleetRank) * (f->count + 1));
+    FleetRank *by_memory = malloc(sizeof(FleetRank) * (f->count + 1));
+    int states[4] = {0, 0, 0, 0};
+    int ranked = 0, fresh = 0, cores = 0;
+    double cpu_sum = 0.0, cpu_max = 0.0, memory_sum = 0.0;
+    unsigned long long memory_used = 0, memory_total = 0;
+
+    if (!by_cpu || !by_memory) {
+        free(by_cpu);
+        free(by_memory);
+        jw_lit(w, "{\"error\":\"Out of memory\"}");
+        return;
+    }
+
+    pthread_mutex_lock(&f->mutex);
+
+    for (int i = 0; i < f->count; i++) {
+        const FleetHost *h = &f->hosts[i];
+        FleetHostState state = fleet_host_state(f, h, now_ms);
+        states[state]++;
+
+        if (h->has_data && (state == FLEET_OK || state == FLEET_STALE)) {
+            by_cpu[ranked] = (FleetRank){h->metrics.cpu_usage, i};
+            by_memory[ranked] = (FleetRank){h->metrics.memory_percent, i};
+            ranked++;
+        }
+        if (h->has_data && state == FLEET_OK) {
+            fresh++;
+            cpu_sum += h->metrics.cpu_usage;
+            if (h->metrics.cpu_usage > cpu_max) cpu_max = h->metrics.cpu_usage;
+            memory_sum += h->metrics.memory_percent;
+            memory_used += h->metrics.memory_used;
+            memory_total += h->metrics.memory_total;
+            cores += h->metrics.cores;
+        }
+    }
+
+    jw_lit(w, "{\n  \"timestamp\": ");
+    jw_int(w, (long long)time(NULL));
+    jw_lit(w, ",\n  \"hosts_total\": ");
+    jw_int(w, f->count);
+    for (int s = 0; s < 4; s++) {
+        jw_lit(w, ",\n  \"hosts_");
+        jw_raw(w, state_names[s], strlen(state_names[s]));
+        jw_lit(w, "\": ");
+        jw_int(w, states[s]);
+    }
+
+    jw_lit(w, ",\n  \"rollup\": {\"hosts\": ");
+    jw_int(w, fresh);
+    jw_lit(w, ", \"cpu_avg\": ");
+    jw_fixed1(w, fresh ? cpu_sum / fresh : 0.0);
+    jw_lit(w, ", \"cpu_max\": ");
+    jw_fixed1(w, cpu_max);
+    jw_lit(w, ", \"memory_avg\": ");
+    jw_fixed1(w, fresh ? memory_sum / fresh : 0.0);
+    jw_lit(w, ", \"memory_used\": ");
+    jw_uint(w, memory_used);
+    jw_lit(w, ", \"memory_total\": ");
+    jw_uint(w, memory_total);
+    jw_lit(w, ", \"memory_percent\": ");
+    jw_fixed1(w, memory_total ? 100.0 * memory_used / memory_total : 0.0);
+    jw_lit(w, ", \"cores\": ");
+    jw_int(w, cores);
+    jw_char(w, '}');
+
+    jw_lit(w, ",\n  \"top_cpu\": ");
+    write_top(w, f, by_cpu, ranked, top_n, now_ms);
+    jw_lit(w, ",\n  \"top_memory\": ");
+    write_top(w, f, by_memory, ranked, top_n, now_ms);
+
+    jw_lit(w, ",\n  \"hosts\": [");
+    for (int i = 0; i < f->count; i++) {
+        const FleetHost *h = &f->hosts[i];
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n    {\"name\": ");
+        jw_string(w, h->name);
+        jw_lit(w, ", \"address\": ");
+        char address[160];
+        snprintf(address, sizeof(address), "%s:%d", h->host, h->port);
+        jw_string(w, address);
+        jw_lit(w, ", \"state\": ");
+        jw_string(w, state_names[fleet_host_state(f, h, now_ms)]);
+        jw_lit(w, ", \"age_ms\": ");
+        if (h->last_ok_ms) jw_int(w, now_ms - h->last_ok_ms);
+        else jw_lit(w, "null");
+        jw_lit(w, ", \"latency_ms\": ");
+        jw_fixed1(w, h->latency_ms);
+        jw_lit(w, ", \"polls\": ");
+        jw_uint(w, h->polls);
+        jw_lit(w, ", \"not_modified\": ");
+        jw_uint(w, h->not_modified);
+        jw_lit(w, ", \"errors\": ");
+        jw_uint(w, h->errors);
+        jw_lit(w, ", \"error\": ");
+        if (h->error[0]) jw_string(w, h->error);
+        else jw_lit(w, "null");
+        jw_char(w, '}');
+    }
+    jw_lit(w, "\n  ]\n}");
+
+    pthread_mutex_unlock(&f->mutex);
+    free(by_cpu);
+    free(by_memory);
+}
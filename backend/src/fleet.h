@@ -0,0 +1,105 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include "config.h"
+#include "json_writer.h"
+
+/*
+ * Режим агрегатора (--aggregate hosts.txt): один поток опрашивает
+ * /api/system агентов неблокирующим HTTP-клиентом на epoll.
+ * Соединения keep-alive, запрос идет с If-None-Match: агент, у которого
+ * с прошлого опроса не было тика, отвечает 304 без тела.
+ *
+ * hosts.txt: строка "host[:port] [имя]", '#' - комментарий до конца строки.
+ * IP-адреса разбираются при загрузке, имена разрешает отдельный поток:
+ * getaddrinfo блокируется и не должен задерживать опрос остальных хостов.
+ */
+
+typedef enum {
+    FLEET_PENDING,      // ответа еще не было
+    FLEET_OK,
+    FLEET_STALE,        // последний ответ старше FLEET_STALE_INTERVALS интервалов
+    FLEET_DOWN          // старше FLEET_DOWN_MS (и двух порогов stale) или ответа не было
+} FleetHostState;
+
+typedef struct {
+    long timestamp;             // время агента
+    double cpu_usage;
+    int cores;
+    double memory_percent;
+    unsigned long long memory_total;
+    unsigned long long memory_used;
+    double gpu_usage;
+} FleetMetrics;
+
+typedef struct {
+    int status;
+    size_t header_len;
+    long content_length;        // -1: до закрытия соединения
+    int close;
+    char etag[64];
+} FleetResponse;
+
+typedef struct {
+    char name[64];
+    char host[128];
+    int port;
+
+    // под Fleet.mutex: пишет поток опроса, читает /api/fleet
+    int has_data;
+    FleetMetrics metrics;
+    long last_ok_ms;            // CLOCK_MONOTONIC
+    double latency_ms;
+    unsigned long polls;
+    unsigned long not_modified;
+    unsigned long errors;
+    char error[64];
+
+    // адрес: пишет поток резолвера, addr_len == 0 - имя еще не разрешено
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    int resolve_failures;
+    long resolve_at_ms;         // следующая попытка после неудачи
+
+    // соединение: только поток опроса
+    int fd;
+    int conn;
+    char etag[64];
+    char *buf;
+    size_t len;
+    size_t cap;
+    long started_ms;
+} FleetHost;
+
+typedef struct {
+    FleetHost *hosts;
+    int count;
+    int interval_ms;            // период опроса: --interval-ms агрегатора
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    pthread_t resolver;
+    int has_resolver;
+    pthread_cond_t resolve_cond;    // будит резолвер при остановке
+    volatile int running;
+    int epfd;
+    int wake;                   // eventfd для fleet_stop
+} Fleet;
+
+int fleet_parse_host_line(const char *line, char *host, size_t host_size, int *port,
+                          char *name, size_t name_size);
+int fleet_load_hosts(Fleet *f, const char *path);
+int fleet_start(Fleet *f);
+void fleet_stop(Fleet *f);
+void fleet_free(Fleet *f);
+
+int parse_fleet_top(const char *query_string);
+int fleet_parse_response(const char *buf, size_t len, FleetResponse *r);
+int fleet_parse_system_json(const char *json, FleetMetrics *m);
+FleetHostState fleet_host_state(const Fleet *f, const FleetHost *h, long now_ms);
+long fleet_now_ms(void);
+void write_fleet_json(JsonWriter *w, Fleet *f, int top_n, long now_ms);
+
+#endif
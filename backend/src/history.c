@@ -1,9 +1,12 @@
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "config.h"
 #include "history.h"
+#include "quantile.h"
+#include "lttb.h"
 
 void init_history(HistoryData *history) {
     memset(history, 0, sizeof(HistoryData));
@@ -11,16 +14,25 @@ void init_history(HistoryData *history) {
     history->count = 0;
 }
 
-void add_to_history(HistoryData *history, double cpu_usage, double memory_usage, 
-                    double gpu_usage, double gpu_memory, double gpu_temp) {
+void add_history_sample(HistoryData *history, const HistorySample *sample) {
     time_t now = time(NULL);
     
-    history->cpu_usage[history->index] = cpu_usage;
-    history->memory_usage[history->index] = memory_usage;
-    history->gpu_usage[history->index] = gpu_usage;
-    history->gpu_memory[history->index] = gpu_memory;
-    history->gpu_temperature[history->index] = gpu_temp;
+    history->cpu_usage[history->index] = sample->cpu_usage;
+    history->memory_usage[history->index] = sample->memory_usage;
+    history->gpu_usage[history->index] = sample->gpu_usage;
+    history->gpu_memory[history->index] = sample->gpu_memory;
+    history->gpu_temperature[history->index] = sample->gpu_temperature;
+    history->disk_read[history->index] = sample->disk_read;
+    history->disk_write[history->index] = sample->disk_write;
+    history->net_rx[history->index] = sample->net_rx;
+    history->net_tx[history->index] = sample->net_tx;
+    history->psi_cpu[history->index] = sample->psi_cpu;
+    history->psi_memory[history->index] = sample->psi_memory;
+    history->psi_io[history->index] = sample->psi_io;
     history->timestamps[history->index] = now;
+    if (history->quantiles) {
+        quantile_store_add(history->quantiles, sample, (long)now);
+    }
     
     history->index = (history->index + 1) % HISTORY_SIZE;
     if (history->count < HISTORY_SIZE) {
@@ -28,75 +40,139 @@ void add_to_history(HistoryData *history, double cpu_usage, double memory_usage,
     }
 }
 
-void get_history_json(char *buffer, int buffer_size, HistoryData *history) {
-    int offset = 0;
-    
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "{\n"
-        "  \"cpu\": [");
-    
-    for (int i = 0; i < history->count; i++) {
-        int idx = (history->index - history->count + i + HISTORY_SIZE) % HISTORY_SIZE;
-        if (i > 0) offset += snprintf(buffer + offset, buffer_size - offset, ",");
-        offset += snprintf(buffer + offset, buffer_size - offset, "%.1f", history->cpu_usage[idx]);
-    }
-    
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "],\n"
-        "  \"memory\": [");
-    
-    for (int i = 0; i < history->count; i++) {
-        int idx = (history->index - history->count + i + HISTORY_SIZE) % HISTORY_SIZE;
-        if (i > 0) offset += snprintf(buffer + offset, buffer_size - offset, ",");
-        offset += snprintf(buffer + offset, buffer_size - offset, "%.1f", history->memory_usage[idx]);
-    }
-    
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "],\n"
-        "  \"gpu\": [");
-    
+void add_to_history(HistoryData *history, double cpu_usage, double memory_usage, 
+                    double gpu_usage, double gpu_memory, double gpu_temp) {
+    HistorySample sample = {
+        .cpu_usage = cpu_usage,
+        .memory_usage = memory_usage,
+        .gpu_usage = gpu_usage,
+        .gpu_memory = gpu_memory,
+        .gpu_temperature = gpu_temp
+    };
+    add_history_sample(history, &sample);
+}
+
+static void write_history_series(JsonWriter *w, HistoryData *history, const double *values) {
     for (int i = 0; i < history->count; i++) {
         int idx = (history->index - history->count + i + HISTORY_SIZE) % HISTORY_SIZE;
-        if (i > 0) offset += snprintf(buffer + offset, buffer_size - offset, ",");
-        offset += snprintf(buffer + offset, buffer_size - offset, "%.1f", history->gpu_usage[idx]);
+        if (i > 0) jw_char(w, ',');
+        jw_fixed1(w, values[idx]);
     }
-    
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "],\n"
-        "  \"gpu_memory\": [");
+}
+
+void write_history_json(JsonWriter *w, HistoryData *history) {
+    jw_lit(w, "{\n  \"cpu\": [");
+    write_history_series(w, history, history->cpu_usage);
+    jw_lit(w, "],\n  \"memory\": [");
+    write_history_series(w, history, history->memory_usage);
+    jw_lit(w, "],\n  \"gpu\": [");
+    write_history_series(w, history, history->gpu_usage);
+    jw_lit(w, "],\n  \"gpu_memory\": [");
+    write_history_series(w, history, history->gpu_memory);
+    jw_lit(w, "],\n  \"gpu_temperature\": [");
+    write_history_series(w, history, history->gpu_temperature);
+    jw_lit(w, "],\n  \"disk_read\": [");
+    write_history_series(w, history, history->disk_read);
+    jw_lit(w, "],\n  \"disk_write\": [");
+    write_history_series(w, history, history->disk_write);
+    jw_lit(w, "],\n  \"net_rx\": [");
+    write_history_series(w, history, history->net_rx);
+    jw_lit(w, "],\n  \"net_tx\": [");
+    write_history_series(w, history, history->net_tx);
+    jw_lit(w, "],\n  \"psi_cpu\": [");
+    write_history_series(w, history, history->psi_cpu);
+    jw_lit(w, "],\n  \"psi_memory\": [");
+    write_history_series(w, history, history->psi_memory);
+    jw_lit(w, "],\n  \"psi_io\": [");
+    write_history_series(w, history, history->psi_io);
+    jw_lit(w, "],\n  \"timestamps\": [");
     
     for (int i = 0; i < history->count; i++) {
         int idx = (history->index - history->count + i + HISTORY_SIZE) % HISTORY_SIZE;
-        if (i > 0) offset += snprintf(buffer + offset, buffer_size - offset, ",");
-        offset += snprintf(buffer + offset, buffer_size - offset, "%.1f", history->gpu_memory[idx]);
+        if (i > 0) jw_char(w, ',');
+        jw_int(w, history->timestamps[idx]);
     }
     
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "],\n"
-        "  \"gpu_temperature\": [");
-    
-    for (int i = 0; i < history->count; i++) {
-        int idx = (history->index - history->count + i + HISTORY_SIZE) % HISTORY_SIZE;
-        if (i > 0) offset += snprintf(buffer + offset, buffer_size - offset, ",");
-        offset += snprintf(buffer + offset, buffer_size - offset, "%.1f", history->gpu_temperature[idx]);
+    jw_lit(w, "],\n  \"count\": ");
+    jw_int(w, history->count);
+    jw_lit(w, "\n}");
+}
+
+static const struct {
+    const char *name;
+    size_t offset;
+} history_series[] = {
+    {"cpu", offsetof(HistoryData, cpu_usage)},
+    {"memory", offsetof(HistoryData, memory_usage)},
+    {"gpu", offsetof(HistoryData, gpu_usage)},
+    {"gpu_memory", offsetof(HistoryData, gpu_memory)},
+    {"gpu_temperature", offsetof(HistoryData, gpu_temperature)},
+    {"disk_read", offsetof(HistoryData, disk_read)},
+    {"disk_write", offsetof(HistoryData, disk_write)},
+    {"net_rx", offsetof(HistoryData, net_rx)},
+    {"net_tx", offsetof(HistoryData, net_tx)},
+    {"psi_cpu", offsetof(HistoryData, psi_cpu)},
+    {"psi_memory", offsetof(HistoryData, psi_memory)},
+    {"psi_io", offsetof(HistoryData, psi_io)},
+};
+
+// points=N: у каждого ряда свои точки LTTB, поэтому и свои timestamps
+void write_history_downsampled_json(JsonWriter *w, const HistoryData *history, int points) {
+    int selected[HISTORY_SIZE];
+    int first = (history->index - history->count + HISTORY_SIZE) % HISTORY_SIZE;
+
+    jw_lit(w, "{\n  \"count\": ");
+    jw_int(w, history->count);
+    jw_lit(w, ",\n  \"points\": ");
+    jw_int(w, points < history->count ? points : history->count);
+    jw_lit(w, ",\n  \"series\": {");
+
+    for (size_t s = 0; s < sizeof(history_series) / sizeof(history_series[0]); s++) {
+        const double *values = (const double *)((const char *)history + history_series[s].offset);
+        int n = lttb_select(history->timestamps, values, HISTORY_SIZE, first, history->count,
+                            points, selected);
+
+        if (s > 0) jw_char(w, ',');
+        jw_lit(w, "\n    ");
+        jw_string(w, history_series[s].name);
+        jw_lit(w, ": {\"timestamps\": [");
+        for (int i = 0; i < n; i++) {
+            if (i > 0) jw_char(w, ',');
+            jw_int(w, history->timestamps[(first + selected[i]) % HISTORY_SIZE]);
+        }
+        jw_lit(w, "], \"values\": [");
+        for (int i = 0; i < n; i++) {
+            if (i > 0) jw_char(w, ',');
+            jw_fixed1(w, values[(first + selected[i]) % HISTORY_SIZE]);
+        }
+        jw_lit(w, "]}");
     }
-    
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "],\n"
-        "  \"timestamps\": [");
-    
-    for (int i = 0; i < history->count; i++) {
-        int idx = (history->index - history->count + i + HISTORY_SIZE) % HISTORY_SIZE;
-        if (i > 0) offset += snprintf(buffer + offset, buffer_size - offset, ",");
-        offset += snprintf(buffer + offset, buffer_size - offset, "%ld", history->timestamps[idx]);
+    jw_lit(w, "\n  }\n}");
+}
+
+// points=N из строки запроса; 0 - параметра нет, -1 - неверное значение
+int parse_history_points(const char *query_string) {
+    const char *p = query_string;
+    while (p && *p) {
+        if (strncmp(p, "points=", 7) == 0) {
+            char *end = NULL;
+            long points = strtol(p + 7, &end, 10);
+            if (end == p + 7 || (*end != '\0' && *end != '&') || points <= 0) return -1;
+            return points > 1000000 ? 1000000 : (int)points;
+        }
+        p = strchr(p, '&');
+        if (p) p++;
     }
+    return 0;
+}
+
+void get_history_json(char *buffer, int buffer_size, HistoryData *history) {
+    JsonWriter w;
+    jw_init_fixed(&w, buffer, buffer_size);
     
-    offset += snprintf(buffer + offset, buffer_size - offset,
-        "],\n"
-        "  \"count\": %d\n"
-        "}", history->count);
+    write_history_json(&w, history);
     
-    if (offset >= buffer_size) {
-        buffer[buffer_size - 1] = '\0';
+    if (w.overflow) {
+        snprintf(buffer, buffer_size, "{\"error\":\"buffer overflow\"}");
     }
-}
\ No newline at end of file
+}
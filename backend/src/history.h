@@ -2,10 +2,32 @@
 #define HISTORY_H
 
 #include "config.h"
+#include "json_writer.h"
+
+// Одна точка истории; диски - суммарно по всем устройствам, МБ/с,
+// сеть - по всем интерфейсам кроме lo, КБ/с, давление - пик "some" за тик, %
+typedef struct {
+    double cpu_usage;
+    double memory_usage;
+    double gpu_usage;
+    double gpu_memory;
+    double gpu_temperature;
+    double disk_read;
+    double disk_write;
+    double net_rx;
+    double net_tx;
+    double psi_cpu;
+    double psi_memory;
+    double psi_io;
+} HistorySample;
 
 void init_history(HistoryData *history);
 void add_to_history(HistoryData *history, double cpu_usage, double memory_usage, 
                     double gpu_usage, double gpu_memory, double gpu_temp);
+void add_history_sample(HistoryData *history, const HistorySample *sample);
+void write_history_json(JsonWriter *w, HistoryData *history);
 void get_history_json(char *buffer, int buffer_size, HistoryData *history);
+void write_history_downsampled_json(JsonWriter *w, const HistoryData *history, int points);
+int parse_history_points(const char *query_string);
 
 #endif
\ No newline at end of file
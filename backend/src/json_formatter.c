@@ -3,80 +3,25 @@
 #include <time.h>
 #include <math.h>
 #include <stdlib.h>
-#include <ctype.h>
-#include <stdarg.h>
 #include "config.h"
+#include "json_writer.h"
 #include "json_formatter.h"
+#include "process_detail.h"
 
-static void json_sanitize_string(const char *input, char *output, int max_len) {
-    if (!input || !output || max_len <= 0) {
-        if (output && max_len > 0) output[0] = '\0';
-        return;
-    }
-    
-    int i = 0, j = 0;
-    
-    while (input[i] && j < max_len - 1) {
-        unsigned char c = (unsigned char)input[i];
-        
-        if (c >= 32 && c <= 126 && c != '"' && c != '\\') {
-            output[j++] = c;
-        }
-        else if (c == '"' || c == '\\') {
-            if (j + 2 < max_len) {
-                output[j++] = '\\';
-                output[j++] = c;
-            }
-        }
-        else if (c == '\n' || c == '\r' || c == '\t') {
-            if (j + 2 < max_len) {
-                output[j++] = '\\';
-                if (c == '\n') output[j++] = 'n';
-                else if (c == '\r') output[j++] = 'r';
-                else if (c == '\t') output[j++] = 't';
-            }
-        }
-        else if (c > 127) {
-            output[j++] = c;
-        }
-        i++;
-    }
-    output[j] = '\0';
-    
-    if (j == 0 && max_len > 10) {
-        strcpy(output, "[unknown]");
-    }
-}
-
-static int safe_snprintf(char *buffer, int buffer_size, int offset, const char *format, ...) {
-    if (offset >= buffer_size - 1) {
-        return 0;
-    }
-    
-    va_list args;
-    va_start(args, format);
-    int written = vsnprintf(buffer + offset, buffer_size - offset, format, args);
-    va_end(args);
-    
-    if (written < 0 || written >= buffer_size - offset) {
-        return 0;
+static void write_name_field(JsonWriter *w, const char *value, const char *fallback) {
+    if (value && value[0]) {
+        jw_string(w, value);
+    } else {
+        jw_string(w, fallback);
     }
-    
-    return written;
 }
 
-void format_system_info_json(char *buffer, int buffer_size, 
-                            CPUStats *cpu, CPUStats *cores, int cores_count,
+void write_system_info_json(JsonWriter *w,
+                            CPUStats *cpu, const CoreStats *cores,
                             MemoryInfo *mem,
                             GPUInfo *gpu,
-                            ProcessInfo *processes, int process_count) {
-    if (buffer_size < 1024) {
-        snprintf(buffer, buffer_size, "{\"error\":\"buffer too small\"}");
-        return;
-    }
-    
-    buffer[0] = '\0';
-    int offset = 0;
+                            ProcessInfo *processes, int process_count,
+                            const SnapshotExtras *extras) {
     time_t now = time(NULL);
     
     if (gpu->memory_total > 100ULL * 1024 * 1024 * 1024) { // Больше 100GB - явно ошибка
@@ -89,141 +34,152 @@ void format_system_info_json(char *buffer, int buffer_size,
         gpu->memory_used = gpu->memory_total * gpu->usage / 100.0;
     }
     
-    offset += safe_snprintf(buffer, buffer_size, offset,
-        "{\n"
-        "  \"timestamp\": %ld,\n"
-        "  \"cpu\": {\n"
-        "    \"usage\": %.1f,\n"
-        "    \"cores_count\": %d,\n"
-        "    \"temperature\": %.1f,\n"
-        "    \"frequency\": %lu,\n"
-        "    \"cores\": [",
-        now,
-        cpu->usage_percent,
-        cores_count,
-        cpu->temperature,
-        cpu->frequency);
-    
-    if (offset == 0) {
-        snprintf(buffer, buffer_size, "{\"error\":\"buffer overflow at start\"}");
-        return;
-    }
-    
-    int actual_cores = (cores_count < MAX_CORES) ? cores_count : MAX_CORES;
-    for (int i = 0; i < actual_cores; i++) {
-        double core_usage = cores[i].usage_percent;
+    jw_lit(w, "{\n  \"timestamp\": ");
+    jw_int(w, (long long)now);
+    jw_lit(w, ",\n  \"cpu\": {\n    \"usage\": ");
+    jw_fixed1(w, cpu->usage_percent);
+    jw_lit(w, ",\n    \"cores_count\": ");
+    jw_int(w, cores->online_count);
+    jw_lit(w, ",\n    \"temperature\": ");
+    jw_fixed1(w, cpu->temperature);
+    jw_lit(w, ",\n    \"frequency\": ");
+    jw_uint(w, cpu->frequency);
+    jw_lit(w, ",\n    \"cores\": [");
+    
+    // все CPU до максимального номера; выключенные - с "online": false
+    for (int i = 0; i < cores->count; i++) {
+        double core_usage = cores->usage[i];
         if (core_usage > 100) core_usage = 100;
         if (core_usage < 0) core_usage = 0;
         
-        if (i > 0) {
-            if (offset < buffer_size - 2) {
-                buffer[offset++] = ',';
-                buffer[offset] = '\0';
-            }
-        }
-        
-        int written = safe_snprintf(buffer, buffer_size, offset,
-            "\n      {\"core\": %d, \"usage\": %.1f}",
-            i, core_usage);
+        if (!jw_has_room(w, 200)) break;
         
-        if (written > 0) {
-            offset += written;
-        }
-        
-        if (offset >= buffer_size - 200) {
-            break;
-        }
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n      {\"core\": ");
+        jw_int(w, i);
+        jw_lit(w, ", \"usage\": ");
+        jw_fixed1(w, cores->online[i] ? core_usage : 0.0);
+        if (!cores->online[i]) jw_lit(w, ", \"online\": false");
+        jw_char(w, '}');
     }
     
-    int written = safe_snprintf(buffer, buffer_size, offset,
-        "\n    ]\n"
-        "  },\n"
-        "  \"memory\": {\n"
-        "    \"total\": %llu,\n"
-        "    \"used\": %llu,\n"
-        "    \"free\": %llu,\n"
-        "    \"cached\": %llu,\n"
-        "    \"percentage\": %.1f\n"
-        "  },\n"
-        "  \"gpu\": {\n"
-        "    \"usage\": %.1f,\n"
-        "    \"memory_total\": %llu,\n"
-        "    \"memory_used\": %llu,\n"
-        "    \"temperature\": %.1f,\n"
-        "    \"power\": %.1f,\n"
-        "    \"clock\": %lu,\n"
-        "    \"name\": \"%s\"\n"
-        "  },\n"
-        "  \"processes\": [",
-        mem->total, mem->used, mem->free, mem->cached, mem->percentage,
-        gpu->usage, gpu->memory_total, gpu->memory_used,
-        gpu->temperature, gpu->power, gpu->clock, gpu->name);
-    
-    if (written > 0) {
-        offset += written;
-    } else {
-        if (offset < buffer_size - 10) {
-            strcpy(buffer + offset, "]\n}");
+    jw_lit(w, "\n    ]\n  },\n  \"memory\": {\n    \"total\": ");
+    jw_uint(w, mem->total);
+    jw_lit(w, ",\n    \"used\": ");
+    jw_uint(w, mem->used);
+    jw_lit(w, ",\n    \"free\": ");
+    jw_uint(w, mem->free);
+    jw_lit(w, ",\n    \"cached\": ");
+    jw_uint(w, mem->cached);
+    jw_lit(w, ",\n    \"percentage\": ");
+    jw_fixed1(w, mem->percentage);
+    jw_lit(w, "\n  },\n  \"gpu\": {\n    \"usage\": ");
+    jw_fixed1(w, gpu->usage);
+    jw_lit(w, ",\n    \"memory_total\": ");
+    jw_uint(w, gpu->memory_total);
+    jw_lit(w, ",\n    \"memory_used\": ");
+    jw_uint(w, gpu->memory_used);
+    jw_lit(w, ",\n    \"temperature\": ");
+    jw_fixed1(w, gpu->temperature);
+    jw_lit(w, ",\n    \"power\": ");
+    jw_fixed1(w, gpu->power);
+    jw_lit(w, ",\n    \"clock\": ");
+    jw_uint(w, gpu->clock);
+    jw_lit(w, ",\n    \"name\": ");
+    jw_string(w, gpu->name);
+    jw_lit(w, "\n  },\n  ");
+    
+    if (extras && extras->disks) {
+        jw_lit(w, "\"disks\": ");
+        write_disks_json(w, extras->disks);
+        jw_lit(w, ",\n  ");
+    }
+    
+    if (extras && extras->network) {
+        jw_lit(w, "\"network\": ");
+        write_network_json(w, extras->network);
+        jw_lit(w, ",\n  ");
+    }
+    
+    if (extras && extras->pressure) {
+        jw_lit(w, "\"pressure\": ");
+        write_pressure_json(w, extras->pressure);
+        jw_lit(w, ",\n  ");
+    }
+    
+    if (extras && extras->topology) {
+        jw_lit(w, "\"topology\": ");
+        write_topology_json(w, extras->topology);
+        jw_lit(w, ",\n  ");
+    }
+    
+    // медленные секции (gpu) приходят из своего потока и могут отстать от тика
+    if (extras && extras->sections) {
+        jw_lit(w, "\"sections\": {");
+        for (int i = 0; i < extras->section_count; i++) {
+            const SectionAge *s = &extras->sections[i];
+            if (i > 0) jw_char(w, ',');
+            jw_lit(w, "\n    ");
+            jw_string(w, s->name);
+            jw_lit(w, ": {\"age_ms\": ");
+            jw_int(w, s->age_ms);
+            jw_lit(w, ", \"stale\": ");
+            if (s->stale) jw_lit(w, "true");
+            else jw_lit(w, "false");
+            jw_char(w, '}');
         }
-        return;
+        jw_lit(w, "\n  },\n  ");
     }
     
-    int limit = (process_count > 10) ? 10 : process_count;
-    int processes_added = 0;
+    jw_lit(w, "\"processes\": [");
+    
+    int limit = (process_count > TOP_PROCESSES) ? TOP_PROCESSES : process_count;
     
     for (int i = 0; i < limit; i++) {
         ProcessInfo *p = &processes[i];
         
-        if (buffer_size - offset < 500) {
-            break;
-        }
-        
-        char safe_cmd[512];
-        char safe_name[256];
-        
-        json_sanitize_string(p->command_line, safe_cmd, sizeof(safe_cmd));
-        json_sanitize_string(p->name, safe_name, sizeof(safe_name));
-        
-        if (strlen(safe_name) == 0) {
-            strcpy(safe_name, "unknown");
-        }
-        if (strlen(safe_cmd) == 0) {
-            strcpy(safe_cmd, safe_name);
-        }
-        
-        if (processes_added > 0) {
-            if (offset < buffer_size - 2) {
-                buffer[offset++] = ',';
-                buffer[offset] = '\0';
-            }
-        }
-        
-        written = safe_snprintf(buffer, buffer_size, offset,
-            "\n    {\n"
-            "      \"pid\": %d,\n"
-            "      \"name\": \"%s\",\n"
-            "      \"state\": \"%c\",\n"
-            "      \"memory\": %lu,\n"
-            "      \"cpu\": %.1f,\n"
-            "      \"command\": \"%s\"\n"
-            "    }",
-            p->pid, safe_name, p->state, p->rss * 1024, p->cpu_usage, safe_cmd);
+        if (!jw_has_room(w, 700)) break;
         
-        if (written > 0) {
-            offset += written;
-            processes_added++;
-        }
-        
-        if (offset >= buffer_size - 100) {
-            break;
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n    {\n      \"pid\": ");
+        jw_int(w, p->pid);
+        jw_lit(w, ",\n      \"name\": ");
+        write_name_field(w, p->name, "[unknown]");
+        jw_lit(w, ",\n      \"state\": \"");
+        jw_char(w, p->state);
+        jw_lit(w, "\",\n      \"memory\": ");
+        jw_uint(w, (unsigned long long)p->rss * 1024);
+        jw_lit(w, ",\n      \"cpu\": ");
+        jw_fixed1(w, p->cpu_usage);
+        jw_lit(w, ",\n      \"command\": ");
+        write_name_field(w, p->command_line, p->name[0] ? p->name : "[unknown]");
+        if (p->has_detail) {
+            jw_lit(w, ",\n      \"detail\": ");
+            write_process_detail_json(w, p);
         }
+        jw_lit(w, "\n    }");
     }
     
-    if (buffer_size - offset >= 10) {
-        strcpy(buffer + offset, "\n  ]\n}\n");
-    } else {
-        strncpy(buffer + buffer_size - 10, "\n]\n}\n", 10);
+    jw_lit(w, "\n  ]\n}\n");
+}
+
+void format_system_info_json(char *buffer, int buffer_size, 
+                            CPUStats *cpu, const CoreStats *cores,
+                            MemoryInfo *mem,
+                            GPUInfo *gpu,
+                            ProcessInfo *processes, int process_count,
+                            const SnapshotExtras *extras) {
+    if (buffer_size < 1024) {
+        snprintf(buffer, buffer_size, "{\"error\":\"buffer too small\"}");
+        return;
     }
     
-    buffer[buffer_size - 1] = '\0';
-}
\ No newline at end of file
+    JsonWriter w;
+    jw_init_fixed(&w, buffer, buffer_size);
+    
+    write_system_info_json(&w, cpu, cores, mem, gpu, processes, process_count, extras);
+    
+    if (w.overflow) {
+        snprintf(buffer, buffer_size, "{\"error\":\"buffer overflow\"}");
+    }
+}
@@ -2,11 +2,42 @@
 #define JSON_FORMATTER_H
 
 #include "config.h"
+#include "json_writer.h"
+#include "core_stats.h"
+#include "disk_collector.h"
+#include "net_collector.h"
+#include "psi_collector.h"
+#include "topology.h"
+
+// Возраст данных секции на момент снимка; age_ms < 0 - данных еще нет
+typedef struct {
+    const char *name;
+    long age_ms;
+    int stale;
+} SectionAge;
+
+// Данные необязательных коллекторов; NULL-поля в снимок не попадают
+typedef struct {
+    const DiskCollector *disks;
+    const NetCollector *network;
+    const PsiCollector *pressure;
+    const Topology *topology;
+    const SectionAge *sections;
+    int section_count;
+} SnapshotExtras;
+
+void write_system_info_json(JsonWriter *w,
+                            CPUStats *cpu, const CoreStats *cores,
+                            MemoryInfo *mem,
+                            GPUInfo *gpu,
+                            ProcessInfo *processes, int process_count,
+                            const SnapshotExtras *extras);
 
 void format_system_info_json(char *buffer, int buffer_size, 
-                            CPUStats *cpu, CPUStats *cores, int cores_count,
+                            CPUStats *cpu, const CoreStats *cores,
                             MemoryInfo *mem,
                             GPUInfo *gpu,
-                            ProcessInfo *processes, int process_count);
+                            ProcessInfo *processes, int process_count,
+                            const SnapshotExtras *extras);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "json_writer.h"
+
+// 0 - байт копируется как есть, 1 - байт отбрасывается,
+// иначе - символ после обратного слэша
+static const unsigned char escape_table[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 't', 'n', 1, 1, 'r', 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+};
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static int reserve(JsonWriter *w, size_t n) {
+    if (w->len + n + 1 <= w->cap) return 1;
+
+    if (!w->growable) {
+        w->overflow = 1;
+        return 0;
+    }
+
+    size_t new_cap = w->cap ? w->cap * 2 : 256;
+    while (new_cap < w->len + n + 1) new_cap *= 2;
+
+    char *data = realloc(w->data, new_cap);
+    if (!data) {
+        w->overflow = 1;
+        return 0;
+    }
+
+    w->data = data;
+    w->cap = new_cap;
+    return 1;
+}
+
+void jw_init(JsonWriter *w, size_t initial_cap) {
+    memset(w, 0, sizeof(JsonWriter));
+    w->growable = 1;
+    if (initial_cap > 0) {
+        w->data = malloc(initial_cap);
+        if (w->data) {
+            w->cap = initial_cap;
+            w->data[0] = '\0';
+        }
+    }
+}
+
+void jw_init_fixed(JsonWriter *w, char *buffer, size_t size) {
+    memset(w, 0, sizeof(JsonWriter));
+    w->data = buffer;
+    w->cap = size;
+    if (size > 0) buffer[0] = '\0';
+}
+
+void jw_reset(JsonWriter *w) {
+    w->len = 0;
+    w->overflow = 0;
+    if (w->cap > 0) w->data[0] = '\0';
+}
+
+void jw_free(JsonWriter *w) {
+    if (w->growable) free(w->data);
+    memset(w, 0, sizeof(JsonWriter));
+}
+
+int jw_has_room(const JsonWriter *w, size_t n) {
+    return w->growable || w->len + n < w->cap;
+}
+
+void jw_raw(JsonWriter *w, const char *s, size_t n) {
+    if (!reserve(w, n)) return;
+    memcpy(w->data + w->len, s, n);
+    w->len += n;
+    w->data[w->len] = '\0';
+}
+
+void jw_char(JsonWriter *w, char c) {
+    if (!reserve(w, 1)) return;
+    w->data[w->len++] = c;
+    w->data[w->len] = '\0';
+}
+
+static size_t format_uint(char *end, unsigned long long v) {
+    char *p = end;
+
+    while (v >= 100) {
+        unsigned idx = (unsigned)(v % 100) * 2;
+        v /= 100;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
+    }
+    if (v >= 10) {
+        unsigned idx = (unsigned)v * 2;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
+    } else {
+        *--p = (char)('0' + v);
+    }
+
+    return (size_t)(end - p);
+}
+
+void jw_uint(JsonWriter *w, unsigned long long v) {
+    char tmp[24];
+    size_t n = format_uint(tmp + sizeof(tmp), v);
+    jw_raw(w, tmp + sizeof(tmp) - n, n);
+}
+
+void jw_int(JsonWriter *w, long long v) {
+    char tmp[24];
+    unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    size_t n = format_uint(tmp + sizeof(tmp), u);
+    if (v < 0) tmp[sizeof(tmp) - ++n] = '-';
+    jw_raw(w, tmp + sizeof(tmp) - n, n);
+}
+
+// Эквивалент "%.1f". Значения рядом с половиной десятой доли
+// (где важно точное двоичное представление) отдаются snprintf.
+void jw_fixed1(JsonWriter *w, double v) {
+    if (!isfinite(v)) {
+        jw_raw(w, "0.0", 3);
+        return;
+    }
+
+    double mag = fabs(v);
+    if (mag >= 1e12) {
+        char tmp[64];
+        int n = snprintf(tmp, sizeof(tmp), "%.1f", v);
+        jw_raw(w, tmp, (size_t)n);
+        return;
+    }
+
+    double scaled = mag * 10.0;
+    double whole = floor(scaled);
+    double frac = scaled - whole;
+    if (fabs(frac - 0.5) < 1e-6) {
+        char tmp[64];
+        int n = snprintf(tmp, sizeof(tmp), "%.1f", v);
+        jw_raw(w, tmp, (size_t)n);
+        return;
+    }
+
+    unsigned long long tenths = (unsigned long long)whole + (frac > 0.5 ? 1 : 0);
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+    *--end = (char)('0' + tenths % 10);
+    *--end = '.';
+    size_t n = format_uint(end, tenths / 10) + 2;
+    if (signbit(v)) tmp[sizeof(tmp) - ++n] = '-';
+    jw_raw(w, tmp + sizeof(tmp) - n, n);
+}
+
+void jw_string(JsonWriter *w, const char *s) {
+    jw_char(w, '"');
+
+    const unsigned char *p = (const unsigned char *)(s ? s : "");
+    while (*p) {
+        const unsigned char *run = p;
+        while (*p && escape_table[*p] == 0) p++;
+        if (p > run) jw_raw(w, (const char *)run, (size_t)(p - run));
+
+        if (!*p) break;
+
+        unsigned char esc = escape_table[*p];
+        if (esc != 1) {
+            char pair[2] = {'\\', (char)esc};
+            jw_raw(w, pair, 2);
+        }
+        p++;
+    }
+
+    jw_char(w, '"');
+}
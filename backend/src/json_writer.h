@@ -0,0 +1,32 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+
+// Курсор в буфер: либо растущий (malloc/realloc), либо фиксированный
+// буфер вызывающей стороны. В фиксированном режиме запись, которая не
+// помещается, отбрасывается целиком и выставляется overflow.
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    int growable;
+    int overflow;
+} JsonWriter;
+
+void jw_init(JsonWriter *w, size_t initial_cap);
+void jw_init_fixed(JsonWriter *w, char *buffer, size_t size);
+void jw_reset(JsonWriter *w);
+void jw_free(JsonWriter *w);
+int jw_has_room(const JsonWriter *w, size_t n);
+
+void jw_raw(JsonWriter *w, const char *s, size_t n);
+void jw_char(JsonWriter *w, char c);
+void jw_int(JsonWriter *w, long long v);
+void jw_uint(JsonWriter *w, unsigned long long v);
+void jw_fixed1(JsonWriter *w, double v);
+void jw_string(JsonWriter *w, const char *s);
+
+#define jw_lit(w, s) jw_raw((w), (s), sizeof(s) - 1)
+
+#endif
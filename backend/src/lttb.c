@@ -0,0 +1,67 @@
+#include <math.h>
+#include "lttb.h"
+
+static inline int ring_at(int capacity, int first, int i) {
+    int j = first + i;
+    return j >= capacity ? j - capacity : j;
+}
+
+int lttb_select(const long *x, const double *y, int capacity, int first, int n,
+                int points, int *out) {
+    if (points >= n || points < 3) {
+        int count = points < n ? points : n;
+        if (count <= 0) return 0;
+        // 1-2 точки: первая и последняя
+        for (int i = 0; i < count; i++) out[i] = i == count - 1 ? n - 1 : i;
+        return count;
+    }
+
+    double every = (double)(n - 2) / (points - 2);
+    int selected = 0;
+    int a = 0;
+    out[selected++] = 0;
+
+    int start = 1;
+    for (int b = 0; b < points - 2; b++) {
+        int end = (int)((b + 1) * every) + 1;
+
+        // среднее следующей корзины; у последней - последняя точка
+        int next_end = (int)((b + 2) * every) + 1;
+        if (next_end > n) next_end = n;
+        double avg_x = 0.0, avg_y = 0.0;
+        for (int i = end; i < next_end; i++) {
+            int j = ring_at(capacity, first, i);
+            avg_x += (double)x[j];
+            avg_y += y[j];
+        }
+        int span = next_end - end;
+        if (span > 0) {
+            avg_x /= span;
+            avg_y /= span;
+        } else {
+            int j = ring_at(capacity, first, n - 1);
+            avg_x = (double)x[j];
+            avg_y = y[j];
+        }
+
+        int ja = ring_at(capacity, first, a);
+        double ax = (double)x[ja], ay = y[ja];
+        double best = -1.0;
+        int best_i = start;
+        for (int i = start; i < end; i++) {
+            int j = ring_at(capacity, first, i);
+            double area = fabs((ax - avg_x) * (y[j] - ay) - (ax - (double)x[j]) * (avg_y - ay));
+            if (area > best) {
+                best = area;
+                best_i = i;
+            }
+        }
+
+        out[selected++] = best_i;
+        a = best_i;
+        start = end;
+    }
+
+    out[selected++] = n - 1;
+    return selected;
+}
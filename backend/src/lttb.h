@@ -0,0 +1,20 @@
+#ifndef LTTB_H
+#define LTTB_H
+
+/*
+ * Largest-Triangle-Three-Buckets: из n точек (x, y) выбирается points,
+ * сохраняющих форму графика. Первая и последняя точки остаются, середина
+ * делится на points - 2 корзины; из каждой берется точка с наибольшей
+ * площадью треугольника с уже выбранной точкой слева и средним следующей
+ * корзины справа. Пики и провалы поэтому не усредняются, а выживают.
+ *
+ * Точки лежат в кольце: i-я - по индексу (first + i) % capacity, для
+ * обычного массива first = 0, capacity = n. Один проход по столбцам,
+ * без копий и аллокаций.
+ */
+
+// Номера выбранных точек (0..n-1, по возрастанию) в out[points]; возвращает их число
+int lttb_select(const long *x, const double *y, int capacity, int first, int n,
+                int points, int *out);
+
+#endif
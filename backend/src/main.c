@@ -1,9 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <unistd.h>
 #include "config.h"
 #include "server.h"
+#include "proc_parser.h"
+#include "capture.h"
+#include "config_file.h"
 
 volatile sig_atomic_t running = 1;
 
@@ -13,17 +17,149 @@ void signal_handler(int sig) {
     printf("\nShutting down server...\n");
 }
 
+// --disable gpu,processes / --enable gpu
+static int set_collectors(char *list, int enabled) {
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(list, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        int r = set_collector_enabled(tok, enabled);
+        if (r == -1) {
+            fprintf(stderr, "Unknown collector: %s\n", tok);
+            return -1;
+        }
+        if (r == -2) {
+            fprintf(stderr, "Collector %s is required\n", tok);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char **argv) {
     int port = PORT;
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    double replay_speed = 1.0;
+    const char *export_url = NULL;
+    const char *export_format = NULL;
+    const char *alert_rules = NULL;
+    const char *alert_webhook = NULL;
     
-    if (argc > 1) {
-        port = atoi(argv[1]);
-        if (port <= 0 || port > 65535) {
-            fprintf(stderr, "Invalid port. Using default: %d\n", PORT);
-            port = PORT;
+    // флаги из --config FILE идут перед флагами командной строки
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0) {
+            if (config_file_args(argv[i + 1], argc, argv, &argc, &argv) != 0) return 1;
+            break;
         }
     }
     
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            i++;
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+            if (port <= 0 || port > 65535) {
+                fprintf(stderr, "Invalid port. Using default: %d\n", PORT);
+                port = PORT;
+            }
+        } else if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            // период тика сбора; не меньше 100 мс
+            set_update_interval(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--max-processes") == 0 && i + 1 < argc) {
+            // не больше MAX_PROCESSES
+            set_process_limit(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--disable") == 0 && i + 1 < argc) {
+            // cpu и memory выключить нельзя; остальное - /api/collectors
+            if (set_collectors(argv[++i], 0) != 0) return 1;
+        } else if (strcmp(argv[i], "--enable") == 0 && i + 1 < argc) {
+            if (set_collectors(argv[++i], 1) != 0) return 1;
+        } else if (strcmp(argv[i], "--all-interfaces") == 0) {
+            // veth/docker/bridge интерфейсы по умолчанию скрыты
+            set_network_skip_virtual(0);
+        } else if (strcmp(argv[i], "--proc-root") == 0 && i + 1 < argc) {
+            // дерево фикстур или /proc хоста, смонтированный в контейнер
+            set_proc_root(argv[++i]);
+        } else if (strcmp(argv[i], "--sys-root") == 0 && i + 1 < argc) {
+            set_sys_root(argv[++i]);
+        } else if (strcmp(argv[i], "--psi-triggers") == 0) {
+            // внеочередные замеры по POLLPRI от /proc/pressure/*
+            set_psi_triggers(1);
+        } else if (strcmp(argv[i], "--demand-idle") == 0 && i + 1 < argc) {
+            // процессы и GPU без клиентов дольше SEC секунд - раз в минуту
+            set_demand_idle(atol(argv[++i]) * 1000L);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            // сырые байты всех прочитанных файлов procfs/sysfs, кадр на тик
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) {
+            replay_speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            // udp://host:port, unixgram:///path или unix:///path
+            export_url = argv[++i];
+        } else if (strcmp(argv[i], "--export-format") == 0 && i + 1 < argc) {
+            export_format = argv[++i];
+        } else if (strcmp(argv[i], "--alerts") == 0 && i + 1 < argc) {
+            // "cpu.usage > 90 for 30s" на строку, состояние в /api/alerts
+            alert_rules = argv[++i];
+        } else if (strcmp(argv[i], "--alert-webhook") == 0 && i + 1 < argc) {
+            alert_webhook = argv[++i];
+        } else if (strcmp(argv[i], "--aggregate") == 0 && i + 1 < argc) {
+            // hosts.txt: "host[:port] [имя]" на строку, сводка в /api/fleet
+            set_fleet_hosts(argv[++i]);
+        } else if (strcmp(argv[i], "--frontend") == 0 && i + 1 < argc) {
+            set_frontend_dir(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            // воркеры со своими SO_REUSEPORT-сокетами
+            set_server_workers(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--backlog") == 0 && i + 1 < argc) {
+            set_listen_backlog(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--pin-cpus") == 0 && i + 1 < argc) {
+            // --pin-cpus 0,2,4: воркер i на CPU из списка по кругу
+            char *list = argv[++i];
+            char *saveptr = NULL;
+            for (char *tok = strtok_r(list, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+                if (add_worker_cpu(atoi(tok)) != 0) {
+                    fprintf(stderr, "Ignoring CPU: %s\n", tok);
+                }
+            }
+        } else if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            // --watch 1234,5678: schedstat/io/ctxt для этих PID на каждом тике
+            char *list = argv[++i];
+            char *saveptr = NULL;
+            for (char *tok = strtok_r(list, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+                if (add_process_watch(atoi(tok)) != 0) {
+                    fprintf(stderr, "Ignoring watch PID: %s\n", tok);
+                }
+            }
+        } else {
+            port = atoi(argv[i]);
+            if (port <= 0 || port > 65535) {
+                fprintf(stderr, "Invalid port. Using default: %d\n", PORT);
+                port = PORT;
+            }
+        }
+    }
+    
+    if (export_url && set_export_target(export_url, export_format) != 0) {
+        fprintf(stderr, "--export-format must be influx or statsd\n");
+        return 1;
+    }
+    if (alert_webhook && !alert_rules) {
+        fprintf(stderr, "--alert-webhook requires --alerts\n");
+        return 1;
+    }
+    set_alert_rules(alert_rules, alert_webhook);
+    if (record_path && replay_path) {
+        fprintf(stderr, "--record and --replay are mutually exclusive\n");
+        return 1;
+    }
+    if (replay_path && capture_replay_open(replay_path, replay_speed) != 0) {
+        return 1;
+    }
+    if (record_path && capture_record_open(record_path) != 0) {
+        return 1;
+    }
+    
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
@@ -44,6 +180,7 @@ int main(int argc, char **argv) {
     }
     
     stop_server();
+    capture_close();
     printf("Server stopped\n");
     
     return 0;
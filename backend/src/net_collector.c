@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <string.h>
+#include "net_collector.h"
+
+#define NET_DEV_FIELDS 16
+
+static const char *virtual_prefixes[] = {"veth", "docker", "br-", "virbr", "cni", NULL};
+
+void net_collector_init(NetCollector *c, const char *net_dev_path, int skip_virtual) {
+    memset(c, 0, sizeof(NetCollector));
+    procfile_init(&c->file, net_dev_path);
+    c->skip_virtual = skip_virtual;
+    c->interfaces = c->slots[0];
+}
+
+void net_collector_free(NetCollector *c) {
+    procfile_close(&c->file);
+}
+
+int net_is_virtual_interface(const char *name) {
+    for (int i = 0; virtual_prefixes[i]; i++) {
+        if (strncmp(name, virtual_prefixes[i], strlen(virtual_prefixes[i])) == 0) return 1;
+    }
+    return 0;
+}
+
+static double rate(unsigned long long prev, unsigned long long curr, double elapsed_sec) {
+    return counter_delta(prev, curr) / elapsed_sec;
+}
+
+static void update_interface(NetInterface *n, const unsigned long long *f, double elapsed_sec) {
+    if (n->has_prev && elapsed_sec > 0) {
+        n->rx_bytes_rate = rate(n->rx_bytes, f[0], elapsed_sec);
+        n->rx_packets_rate = rate(n->rx_packets, f[1], elapsed_sec);
+        n->rx_errors_rate = rate(n->rx_errors, f[2], elapsed_sec);
+        n->rx_drops_rate = rate(n->rx_drops, f[3], elapsed_sec);
+        n->tx_bytes_rate = rate(n->tx_bytes, f[8], elapsed_sec);
+        n->tx_packets_rate = rate(n->tx_packets, f[9], elapsed_sec);
+        n->tx_errors_rate = rate(n->tx_errors, f[10], elapsed_sec);
+        n->tx_drops_rate = rate(n->tx_drops, f[11], elapsed_sec);
+    }
+
+    n->rx_bytes = f[0];
+    n->rx_packets = f[1];
+    n->rx_errors = f[2];
+    n->rx_drops = f[3];
+    n->tx_bytes = f[8];
+    n->tx_packets = f[9];
+    n->tx_errors = f[10];
+    n->tx_drops = f[11];
+    n->has_prev = 1;
+}
+
+// Формат после двух строк заголовка: "  eth0: rx(8 полей) tx(8 полей)".
+// Порядок интерфейсов между тиками почти не меняется, поэтому прошлое
+// значение ищется сначала по курсору и только при расхождении - перебором.
+void net_collector_update(NetCollector *c, const char *text, double elapsed_sec) {
+    unsigned long long fields[NET_DEV_FIELDS];
+    const NetInterface *prev = c->interfaces;
+    int prev_count = c->count;
+    NetInterface *next = (prev == c->slots[0]) ? c->slots[1] : c->slots[0];
+    int count = 0, cursor = 0;
+
+    c->dropped = 0;
+
+    const char *p = text;
+    for (int header = 0; header < 2 && p; header++) {
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+
+    while (p && *p) {
+        const char *start = skip_spaces(p);
+        const char *colon = start;
+        while (*colon && *colon != ':' && *colon != '\n') colon++;
+
+        if (*colon != ':') {
+            p = strchr(colon, '\n');
+            if (p) p++;
+            continue;
+        }
+
+        size_t len = (size_t)(colon - start);
+        p = colon + 1;
+        for (int i = 0; i < NET_DEV_FIELDS; i++) {
+            fields[i] = parse_ull(&p);
+        }
+        p = strchr(p, '\n');
+        if (p) p++;
+
+        if (len == 0 || len >= NET_NAME_MAX) continue;
+
+        char name[NET_NAME_MAX];
+        memcpy(name, start, len);
+        name[len] = '\0';
+
+        if (c->skip_virtual && net_is_virtual_interface(name)) continue;
+        if (count >= MAX_NET_INTERFACES) {
+            c->dropped++;
+            continue;
+        }
+
+        const NetInterface *old = NULL;
+        if (cursor < prev_count && strcmp(prev[cursor].name, name) == 0) {
+            old = &prev[cursor++];
+        } else {
+            for (int i = 0; i < prev_count; i++) {
+                if (strcmp(prev[i].name, name) == 0) {
+                    old = &prev[i];
+                    cursor = i + 1;
+                    break;
+                }
+            }
+        }
+
+        NetInterface *n = &next[count++];
+        if (old) {
+            *n = *old;
+        } else {
+            memset(n, 0, sizeof(NetInterface));
+            memcpy(n->name, name, len + 1);
+        }
+        update_interface(n, fields, elapsed_sec);
+    }
+
+    c->interfaces = next;
+    c->count = count;
+}
+
+int net_collector_sample(NetCollector *c, double elapsed_sec) {
+    if (procfile_read(&c->file, c->buffer, sizeof(c->buffer)) < 0) return -1;
+    net_collector_update(c, c->buffer, elapsed_sec);
+    return 0;
+}
+
+// Трафик loopback в сумму не входит
+void net_collector_totals(const NetCollector *c, double *rx_bytes, double *tx_bytes) {
+    *rx_bytes = 0.0;
+    *tx_bytes = 0.0;
+    for (int i = 0; i < c->count; i++) {
+        if (strcmp(c->interfaces[i].name, "lo") == 0) continue;
+        *rx_bytes += c->interfaces[i].rx_bytes_rate;
+        *tx_bytes += c->interfaces[i].tx_bytes_rate;
+    }
+}
+
+void write_network_json(JsonWriter *w, const NetCollector *c) {
+    jw_char(w, '[');
+
+    for (int i = 0; i < c->count; i++) {
+        const NetInterface *n = &c->interfaces[i];
+
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n    {\"interface\": ");
+        jw_string(w, n->name);
+        jw_lit(w, ", \"rx_kb\": ");
+        jw_fixed1(w, n->rx_bytes_rate / 1024.0);
+        jw_lit(w, ", \"tx_kb\": ");
+        jw_fixed1(w, n->tx_bytes_rate / 1024.0);
+        jw_lit(w, ", \"rx_packets_rate\": ");
+        jw_fixed1(w, n->rx_packets_rate);
+        jw_lit(w, ", \"tx_packets_rate\": ");
+        jw_fixed1(w, n->tx_packets_rate);
+        jw_lit(w, ", \"rx_errors_rate\": ");
+        jw_fixed1(w, n->rx_errors_rate);
+        jw_lit(w, ", \"tx_errors_rate\": ");
+        jw_fixed1(w, n->tx_errors_rate);
+        jw_lit(w, ", \"rx_drops_rate\": ");
+        jw_fixed1(w, n->rx_drops_rate);
+        jw_lit(w, ", \"tx_drops_rate\": ");
+        jw_fixed1(w, n->tx_drops_rate);
+        jw_lit(w, ", \"rx_bytes\": ");
+        jw_uint(w, n->rx_bytes);
+        jw_lit(w, ", \"tx_bytes\": ");
+        jw_uint(w, n->tx_bytes);
+        jw_lit(w, ", \"rx_packets\": ");
+        jw_uint(w, n->rx_packets);
+        jw_lit(w, ", \"tx_packets\": ");
+        jw_uint(w, n->tx_packets);
+        jw_lit(w, ", \"rx_errors\": ");
+        jw_uint(w, n->rx_errors);
+        jw_lit(w, ", \"tx_errors\": ");
+        jw_uint(w, n->tx_errors);
+        jw_lit(w, ", \"rx_drops\": ");
+        jw_uint(w, n->rx_drops);
+        jw_lit(w, ", \"tx_drops\": ");
+        jw_uint(w, n->tx_drops);
+        jw_char(w, '}');
+    }
+
+    if (c->count > 0) jw_lit(w, "\n  ");
+    jw_char(w, ']');
+}
@@ -0,0 +1,55 @@
+#ifndef NET_COLLECTOR_H
+#define NET_COLLECTOR_H
+
+#include "config.h"
+#include "json_writer.h"
+#include "procfs.h"
+
+#define NET_NAME_MAX 32
+#define NET_DEV_BUFFER_SIZE 131072
+
+typedef struct {
+    char name[NET_NAME_MAX];
+    int has_prev;
+
+    unsigned long long rx_bytes;
+    unsigned long long rx_packets;
+    unsigned long long rx_errors;
+    unsigned long long rx_drops;
+    unsigned long long tx_bytes;
+    unsigned long long tx_packets;
+    unsigned long long tx_errors;
+    unsigned long long tx_drops;
+
+    // в секунду за последний интервал
+    double rx_bytes_rate;
+    double rx_packets_rate;
+    double tx_bytes_rate;
+    double tx_packets_rate;
+    double rx_errors_rate;
+    double tx_errors_rate;
+    double rx_drops_rate;
+    double tx_drops_rate;
+} NetInterface;
+
+// Два массива в порядке строк /proc/net/dev: тик пишет в свободный,
+// сверяясь с прошлым по тому же индексу, поэтому проход линейный
+typedef struct {
+    ProcFile file;
+    int skip_virtual;
+    NetInterface slots[2][MAX_NET_INTERFACES];
+    NetInterface *interfaces;
+    int count;
+    int dropped;
+    char buffer[NET_DEV_BUFFER_SIZE];
+} NetCollector;
+
+void net_collector_init(NetCollector *c, const char *net_dev_path, int skip_virtual);
+void net_collector_free(NetCollector *c);
+int net_collector_sample(NetCollector *c, double elapsed_sec);
+void net_collector_update(NetCollector *c, const char *text, double elapsed_sec);
+int net_is_virtual_interface(const char *name);
+void net_collector_totals(const NetCollector *c, double *rx_bytes, double *tx_bytes);
+void write_network_json(JsonWriter *w, const NetCollector *c);
+
+#endif
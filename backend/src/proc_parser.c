@@ -9,49 +9,98 @@
 #include <glob.h>
 #include "config.h"
 #include "proc_parser.h"
+#include "capture.h"
+#include "process_cache.h"
+#include "command.h"
+
+// Корни procfs/sysfs: подменяются на дерево фикстур в тестах и бенчмарках
+static char proc_root[256] = PROC_ROOT;
+static char sys_root[256] = SYS_ROOT;
+
+// sensors/lscpu проверяются один раз: 0 - не проверялся, 1 - отвечает, -1 - источника нет.
+// Иначе без thermal_zone и cpufreq каждый тик стоил бы fork двух конвейеров
+static int sensors_source = 0;
+static int lscpu_source = 0;
+
+// --max-processes: не больше MAX_PROCESSES, под него выделены таблицы
+static int process_limit = MAX_PROCESSES;
+
+void set_process_limit(int limit) {
+    process_limit = (limit > 0 && limit < MAX_PROCESSES) ? limit : MAX_PROCESSES;
+}
+
+int get_process_limit() {
+    return process_limit;
+}
+
+void set_proc_root(const char *path) {
+    snprintf(proc_root, sizeof(proc_root), "%s", path);
+    lscpu_source = 0;
+}
+
+void set_sys_root(const char *path) {
+    snprintf(sys_root, sizeof(sys_root), "%s", path);
+    sensors_source = 0;
+}
+
+const char *get_proc_root() {
+    return proc_root;
+}
+
+const char *get_sys_root() {
+    return sys_root;
+}
 
 double get_cpu_temperature() {
     double temp = 0.0;
+    char path[512];
     
     const char *temp_paths[] = {
-        "/sys/class/thermal/thermal_zone0/temp",
-        "/sys/class/hwmon/hwmon0/temp1_input",
-        "/sys/class/hwmon/hwmon1/temp1_input",
-        "/sys/devices/platform/coretemp.0/hwmon/hwmon*/temp1_input"
+        "class/thermal/thermal_zone0/temp",
+        "class/hwmon/hwmon0/temp1_input",
+        "class/hwmon/hwmon1/temp1_input",
+        "devices/platform/coretemp.0/hwmon/hwmon*/temp1_input"
     };
     
     for (int i = 0; i < 4; i++) {
-        FILE *fp = fopen(temp_paths[i], "r");
+        snprintf(path, sizeof(path), "%s/%s", sys_root, temp_paths[i]);
+        FILE *fp = capture_fopen(path);
         if (fp) {
             int temp_raw;
             if (fscanf(fp, "%d", &temp_raw) == 1) {
                 temp = temp_raw / 1000.0;
                 fclose(fp);
-                printf("CPU temperature from %s: %.1f°C\n", temp_paths[i], temp);
+                printf("CPU temperature from %s: %.1f°C\n", path, temp);
                 return temp;
             }
             fclose(fp);
         }
     }
     
-    FILE *fp = popen("sensors | grep -i 'core\\|cpu' | grep -oP '\\+\\d+\\.\\d+°C' | head -1 | tr -d '+°C'", "r");
-    if (fp) {
-        if (fscanf(fp, "%lf", &temp) == 1) {
-            pclose(fp);
-            printf("CPU temperature from sensors: %.1f°C\n", temp);
-            return temp;
-        }
-        pclose(fp);
+    char output[64];
+    if (sensors_source >= 0 &&
+        command_read_shell("sensors | grep -i 'core\\|cpu' | grep -oP '\\+\\d+\\.\\d+°C' | head -1 | tr -d '+°C'",
+                           output, sizeof(output), COMMAND_TIMEOUT_MS) > 0 &&
+        sscanf(output, "%lf", &temp) == 1) {
+        sensors_source = 1;
+        printf("CPU temperature from sensors: %.1f°C\n", temp);
+        return temp;
     }
     
-    printf("Could not get CPU temperature, using default\n");
+    // отказ уже отвечавшего sensors не запрещает его насовсем
+    if (sensors_source == 0) {
+        sensors_source = -1;
+        printf("Could not get CPU temperature, using default\n");
+    }
     return 45.0;
 }
 
 unsigned long get_cpu_frequency() {
     unsigned long freq = 0;
+    char path[512];
     
-    FILE *fp = fopen("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", "r");
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", sys_root);
+    FILE *fp = capture_fopen(path);
     if (fp) {
         if (fscanf(fp, "%lu", &freq) == 1) {
             freq = freq / 1000;
@@ -62,7 +111,8 @@ unsigned long get_cpu_frequency() {
         fclose(fp);
     }
     
-    fp = fopen("/proc/cpuinfo", "r");
+    snprintf(path, sizeof(path), "%s/cpuinfo", proc_root);
+    fp = capture_fopen(path);
     if (fp) {
         char line[256];
         while (fgets(line, sizeof(line), fp)) {
@@ -78,24 +128,29 @@ unsigned long get_cpu_frequency() {
         fclose(fp);
     }
     
-    fp = popen("lscpu | grep 'CPU MHz' | grep -oP '\\d+\\.\\d+' | head -1", "r");
-    if (fp) {
-        double mhz;
-        if (fscanf(fp, "%lf", &mhz) == 1) {
-            freq = (unsigned long)mhz;
-            pclose(fp);
-            printf("CPU frequency from lscpu: %lu MHz\n", freq);
-            return freq;
-        }
-        pclose(fp);
+    char output[64];
+    double mhz;
+    if (lscpu_source >= 0 &&
+        command_read_shell("lscpu | grep 'CPU MHz' | grep -oP '\\d+\\.\\d+' | head -1",
+                           output, sizeof(output), COMMAND_TIMEOUT_MS) > 0 &&
+        sscanf(output, "%lf", &mhz) == 1) {
+        lscpu_source = 1;
+        freq = (unsigned long)mhz;
+        printf("CPU frequency from lscpu: %lu MHz\n", freq);
+        return freq;
     }
     
-    printf("Could not get CPU frequency, using default\n");
+    if (lscpu_source == 0) {
+        lscpu_source = -1;
+        printf("Could not get CPU frequency, using default\n");
+    }
     return 2400;
 }
 
 int get_cpu_cores_count() {
-    FILE *fp = fopen("/proc/cpuinfo", "r");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/cpuinfo", proc_root);
+    FILE *fp = capture_fopen(path);
     if (!fp) return 4;
     
     char line[256];
@@ -111,24 +166,26 @@ int get_cpu_cores_count() {
     return cores > 0 ? cores : 4;
 }
 
-int read_cpu_stats(CPUStats *cpu, CPUStats *cores, int *cores_count) {
-    FILE *fp = fopen("/proc/stat", "r");
+int read_cpu_stats(CPUStats *cpu, CoreStats *cores) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/stat", proc_root);
+    FILE *fp = capture_fopen(path);
     if (!fp) {
         cpu->usage_percent = 25.0;
         cpu->temperature = 45.0;
         cpu->frequency = 2400;
-        *cores_count = 4;
+        core_stats_reserve(cores, 4);
+        core_stats_begin(cores);
+        cores->count = cores->online_count = 4;
         for (int i = 0; i < 4; i++) {
-            cores[i].usage_percent = 20.0 + i * 5.0;
-            cores[i].temperature = 45.0 + i * 2.0;
-            cores[i].frequency = 2400 + i * 100;
+            cores->online[i] = 1;
+            cores->usage[i] = 20.0 + i * 5.0;
         }
         return 0;
     }
     
     char line[256];
-    *cores_count = 0;
-    int total_cores_found = 0;
+    core_stats_begin(cores);
     
     while (fgets(line, sizeof(line), fp)) {
         if (strncmp(line, "cpu ", 4) == 0) {
@@ -147,52 +204,23 @@ int read_cpu_stats(CPUStats *cpu, CPUStats *cores, int *cores_count) {
             cpu->frequency = get_cpu_frequency();
         }
         else if (strncmp(line, "cpu", 3) == 0 && isdigit(line[3])) {
-            if (total_cores_found < MAX_CORES) {
-                sscanf(line + 3, "%*d %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
-                       &cores[total_cores_found].user, &cores[total_cores_found].nice,
-                       &cores[total_cores_found].system, &cores[total_cores_found].idle,
-                       &cores[total_cores_found].iowait, &cores[total_cores_found].irq,
-                       &cores[total_cores_found].softirq, &cores[total_cores_found].steal,
-                       &cores[total_cores_found].guest, &cores[total_cores_found].guest_nice);
-                
-                cores[total_cores_found].total = 
-                    cores[total_cores_found].user + cores[total_cores_found].nice + 
-                    cores[total_cores_found].system + cores[total_cores_found].idle +
-                    cores[total_cores_found].iowait + cores[total_cores_found].irq +
-                    cores[total_cores_found].softirq + cores[total_cores_found].steal;
-                cores[total_cores_found].usage_percent = 0.0;
-                cores[total_cores_found].temperature = cpu->temperature;
-                cores[total_cores_found].frequency = cpu->frequency;
-                
-                total_cores_found++;
-            }
+            // колонки растут сами, если CPU подключили за пределами possible
+            core_stats_parse_line(cores, line);
         }
     }
     
     fclose(fp);
-    *cores_count = total_cores_found;
     
-    if (*cores_count == 0) {
-        *cores_count = get_cpu_cores_count();
-        if (*cores_count > MAX_CORES) *cores_count = MAX_CORES;
+    if (cores->online_count == 0) {
+        int count = get_cpu_cores_count();
+        if (core_stats_reserve(cores, count) != 0) return 0;
         
-        for (int i = 0; i < *cores_count; i++) {
-            cores[i].user = cpu->user * (0.8 + (rand() % 40) / 100.0);
-            cores[i].nice = cpu->nice;
-            cores[i].system = cpu->system * (1.0 + (rand() % 20) / 100.0);
-            cores[i].idle = cpu->idle * (0.9 + (rand() % 20) / 100.0);
-            cores[i].iowait = cpu->iowait;
-            cores[i].irq = cpu->irq;
-            cores[i].softirq = cpu->softirq;
-            cores[i].steal = cpu->steal;
-            cores[i].guest = cpu->guest;
-            cores[i].guest_nice = cpu->guest_nice;
-            cores[i].total = cores[i].user + cores[i].nice + cores[i].system + 
-                           cores[i].idle + cores[i].iowait + cores[i].irq +
-                           cores[i].softirq + cores[i].steal;
-            cores[i].usage_percent = 0.0;
-            cores[i].temperature = cpu->temperature;
-            cores[i].frequency = cpu->frequency;
+        cores->count = cores->online_count = count;
+        for (int i = 0; i < count; i++) {
+            cores->online[i] = 1;
+            cores->total[i] = (uint64_t)(cpu->total / count);
+            cores->idle[i] = (uint64_t)(cpu->idle / count * (0.9 + (rand() % 20) / 100.0));
+            if (cores->idle[i] > cores->total[i]) cores->idle[i] = cores->total[i];
         }
     }
     
@@ -202,7 +230,9 @@ int read_cpu_stats(CPUStats *cpu, CPUStats *cores, int *cores_count) {
 int read_memory_info(MemoryInfo *mem) {
     memset(mem, 0, sizeof(MemoryInfo));
     
-    FILE *fp = fopen("/proc/meminfo", "r");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/meminfo", proc_root);
+    FILE *fp = capture_fopen(path);
     if (!fp) {
         mem->total = 33238007808; // 31.0 GB
         mem->used = 10654793728;  // 9.9 GB (30%)
@@ -267,6 +297,26 @@ int read_memory_info(MemoryInfo *mem) {
     return 0;
 }
 
+// Есть ли nvidia-smi в PATH: без него read_gpu_info только тратит fork
+int gpu_probe() {
+    const char *path = getenv("PATH");
+    if (!path) return 0;
+    
+    char dir[512], file[600];
+    while (*path) {
+        size_t len = strcspn(path, ":");
+        if (len > 0 && len < sizeof(dir)) {
+            memcpy(dir, path, len);
+            dir[len] = '\0';
+            snprintf(file, sizeof(file), "%s/nvidia-smi", dir);
+            if (access(file, X_OK) == 0) return 1;
+        }
+        path += len;
+        if (*path == ':') path++;
+    }
+    return 0;
+}
+
 int read_gpu_info(GPUInfo *gpu) {
     memset(gpu, 0, sizeof(GPUInfo));
     strcpy(gpu->name, "Unknown GPU");
@@ -277,11 +327,21 @@ int read_gpu_info(GPUInfo *gpu) {
     
     printf("🔍 Searching for GPU information...\n");
     
-    FILE *fp = popen("nvidia-smi --query-gpu=utilization.gpu,memory.total,memory.used,temperature.gpu,power.draw,clocks.current.graphics,name --format=csv,noheader,nounits 2>/dev/null", "r");
+    // зависший nvidia-smi (сброс драйвера) убивается по дедлайну; замер -
+    // неудачный, а не выдуманный
+    char *query[] = {"nvidia-smi",
+                     "--query-gpu=utilization.gpu,memory.total,memory.used,temperature.gpu,power.draw,clocks.current.graphics,name",
+                     "--format=csv,noheader,nounits", NULL};
+    char line[512];
+    int result = command_read(query, line, sizeof(line), GPU_COMMAND_TIMEOUT_MS);
+    if (result == COMMAND_TIMEOUT) {
+        printf("nvidia-smi did not answer in %d ms, killed\n", GPU_COMMAND_TIMEOUT_MS);
+        return -1;
+    }
     
-    if (fp) {
-        char line[512];
-        if (fgets(line, sizeof(line), fp)) {
+    if (result >= 0) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0]) {
             printf("Raw nvidia-smi line: %s\n", line);
             
             char *line_ptr = line;
@@ -375,8 +435,6 @@ int read_gpu_info(GPUInfo *gpu) {
                 gpu->clock = clock;
                 strcpy(gpu->name, stable_name);
                 
-                pclose(fp);
-                
                 printf("✅ Final GPU data:\n");
                 printf("   Name: %s\n", gpu->name);
                 printf("   Memory: %.2f / %.2f GB\n", 
@@ -386,7 +444,6 @@ int read_gpu_info(GPUInfo *gpu) {
                 return 0;
             }
         }
-        pclose(fp);
     } else {
         printf("nvidia-smi command failed\n");
     }
@@ -401,10 +458,17 @@ int read_gpu_info(GPUInfo *gpu) {
     gpu->memory_total = stable_memory_total;
     strcpy(gpu->name, stable_name);
     
-    fp = popen("nvidia-smi --query-gpu=utilization.gpu,memory.used,temperature.gpu,power.draw,clocks.current.graphics --format=csv,noheader,nounits 2>/dev/null", "r");
-    if (fp) {
-        char line[256];
-        if (fgets(line, sizeof(line), fp)) {
+    char *dynamic_query[] = {"nvidia-smi",
+                             "--query-gpu=utilization.gpu,memory.used,temperature.gpu,power.draw,clocks.current.graphics",
+                             "--format=csv,noheader,nounits", NULL};
+    result = command_read(dynamic_query, line, sizeof(line), GPU_COMMAND_TIMEOUT_MS);
+    if (result == COMMAND_TIMEOUT) {
+        printf("nvidia-smi did not answer in %d ms, killed\n", GPU_COMMAND_TIMEOUT_MS);
+        return -1;
+    }
+    if (result >= 0) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0]) {
             printf("Raw dynamic data line: %s\n", line);
             
             char *line_ptr = line;
@@ -470,7 +534,6 @@ int read_gpu_info(GPUInfo *gpu) {
             gpu->power = 30.0 + gpu->usage * 0.8;
             gpu->clock = 1500 + (rand() % 500);
         }
-        pclose(fp);
     } else {
         printf("nvidia-smi command for dynamic data failed\n");
         gpu->usage = 5.0 + (rand() % 30);
@@ -495,20 +558,89 @@ int read_gpu_info(GPUInfo *gpu) {
     return 0;
 }
 
+// Имена и cmdline живут в арене кеша, строки таблицы только ссылаются на них
+static ProcessCache process_cache;
+static int process_cache_ready = 0;
+
+const ProcessCache *get_process_cache(void) {
+    return process_cache_ready ? &process_cache : NULL;
+}
+
+// cmdline: аргументы через '\0', пробелы и переводы строк в конце отбрасываются
+static const char *read_command_line(int pid, const char *name) {
+    char path[512], buffer[512];
+    size_t len = 0;
+
+    snprintf(path, sizeof(path), "%s/%d/cmdline", proc_root, pid);
+    FILE *fp = capture_fopen(path);
+    if (fp) {
+        len = fread(buffer, 1, sizeof(buffer) - 1, fp);
+        fclose(fp);
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (buffer[i] == '\0') buffer[i] = ' ';
+    }
+    while (len > 0 && (buffer[len - 1] == ' ' || buffer[len - 1] == '\n' || buffer[len - 1] == '\r')) {
+        len--;
+    }
+
+    // у потоков ядра cmdline пустой
+    if (len == 0) return name;
+    return process_cache_intern(&process_cache, buffer, len);
+}
+
+// "pid (comm) state ppid ...": comm может содержать пробелы и скобки,
+// поэтому конец имени - последняя ')'. Поля 14-15 utime/stime,
+// 22 starttime, 24 rss в страницах
+static int parse_pid_stat(char *line, ProcessInfo *p, char **comm, size_t *comm_len,
+                          long *rss_pages) {
+    char *open = strchr(line, '(');
+    char *close = strrchr(line, ')');
+    if (!open || !close || close < open || close[1] != ' ') return -1;
+
+    *comm = open + 1;
+    *comm_len = (size_t)(close - open - 1);
+    if (*comm_len > 255) *comm_len = 255;
+
+    char *cursor = close + 2;
+    p->state = *cursor ? *cursor++ : '?';
+    for (int field = 4; field <= 24; field++) {
+        char *end;
+        long long value = strtoll(cursor, &end, 10);
+        if (end == cursor) return -1;
+        cursor = end;
+
+        if (field == 14) p->utime = (unsigned long)value;
+        else if (field == 15) p->stime = (unsigned long)value;
+        else if (field == 22) p->starttime = (unsigned long long)value;
+        else if (field == 24) *rss_pages = (long)value;
+    }
+    return 0;
+}
+
 int get_processes(ProcessInfo *processes, int *count) {
-    DIR *dir = opendir("/proc");
+    if (!process_cache_ready) {
+        if (process_cache_init(&process_cache) != 0) return -1;
+        process_cache_ready = 1;
+    }
+    
+    DIR *dir = opendir(proc_root);
     if (!dir) {
         *count = 10;
         const char *proc_names[] = {"systemd", "bash", "chrome", "firefox", "vim", 
                                    "python3", "node", "docker", "nginx", "sshd"};
+        char command_line[64];
         for (int i = 0; i < 10; i++) {
             processes[i].pid = 1000 + i;
-            strncpy(processes[i].name, proc_names[i], 255);
+            processes[i].starttime = 0;
+            processes[i].name = proc_names[i];
             processes[i].state = (i % 3 == 0) ? 'R' : 'S';
             processes[i].rss = (i + 1) * 1024 * 10; // RSS в KB
             processes[i].cpu_usage = (i + 1) * 0.5; // Разные значения: 0.5%, 1.0%, 1.5%...
             processes[i].mem_usage = (i + 1) * 0.1;
-            snprintf(processes[i].command_line, 512, "/usr/bin/%s --option", proc_names[i]);
+            processes[i].has_detail = 0;
+            int len = snprintf(command_line, sizeof(command_line), "/usr/bin/%s --option", proc_names[i]);
+            processes[i].command_line = process_cache_intern(&process_cache, command_line, len);
         }
         return 0;
     }
@@ -520,7 +652,9 @@ int get_processes(ProcessInfo *processes, int *count) {
     static unsigned long long prev_idle = 0;
     unsigned long long total = 0, idle = 0;
     
-    FILE *stat_fp = fopen("/proc/stat", "r");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/stat", proc_root);
+    FILE *stat_fp = capture_fopen(path);
     if (stat_fp) {
         char line[256];
         if (fgets(line, sizeof(line), stat_fp)) {
@@ -534,10 +668,18 @@ int get_processes(ProcessInfo *processes, int *count) {
         fclose(stat_fp);
     }
     
-    long ticks_per_sec = sysconf(_SC_CLK_TCK);
-    if (ticks_per_sec <= 0) ticks_per_sec = 100;
+    // один раз на проход, а не на процесс
+    unsigned long long total_ram = 0;
+    struct sysinfo info;
+    if (sysinfo(&info) == 0) total_ram = (unsigned long long)info.totalram * info.mem_unit;
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    if (page_kb <= 0) page_kb = 4;
+    
+    process_cache_begin(&process_cache);
     
-    while ((entry = readdir(dir)) != NULL && *count < MAX_PROCESSES) {
+    while ((entry = readdir(dir)) != NULL && *count < process_limit) {
+        capture_note_entry(proc_root, entry->d_name);
+        
         int is_pid = 1;
         for (int i = 0; entry->d_name[i]; i++) {
             if (!isdigit(entry->d_name[i])) {
@@ -551,127 +693,69 @@ int get_processes(ProcessInfo *processes, int *count) {
         int pid = atoi(entry->d_name);
         if (pid <= 0) continue;
         
-        char path[256];
         ProcessInfo *p = &processes[*count];
         p->pid = pid;
-        
-        strcpy(p->name, "unknown");
         p->state = '?';
+        p->starttime = 0;
+        p->utime = 0;
+        p->stime = 0;
         p->rss = 0;
         p->cpu_usage = 0.0;
         p->mem_usage = 0.0;
-        strcpy(p->command_line, "");
+        p->has_detail = 0;
         
-        snprintf(path, sizeof(path), "/proc/%d/status", pid);
-        FILE *fp = fopen(path, "r");
-        if (fp) {
-            char line[256];
-            while (fgets(line, sizeof(line), fp)) {
-                if (strncmp(line, "Name:", 5) == 0) {
-                    char *name = line + 5;
-                    while (*name == ' ' || *name == '\t') name++;
-                    strncpy(p->name, name, 255);
-                    p->name[strcspn(p->name, "\n")] = 0;
-                } else if (strncmp(line, "State:", 6) == 0) {
-                    p->state = line[7];
-                } else if (strncmp(line, "VmRSS:", 6) == 0) {
-                    sscanf(line + 6, "%lu", &p->rss); // RSS в KB
-                }
-            }
-            fclose(fp);
-        }
+        // на тик читается только stat: state и RSS тоже берутся из него
+        char line[1024], *comm;
+        size_t comm_len;
+        long rss_pages = 0;
+        snprintf(path, sizeof(path), "%s/%d/stat", proc_root, pid);
+        FILE *fp = capture_fopen(path);
+        if (!fp) continue;  // процесс уже завершился
+        int parsed = fgets(line, sizeof(line), fp) && parse_pid_stat(line, p, &comm, &comm_len, &rss_pages) == 0;
+        fclose(fp);
+        if (!parsed) continue;
         
-        snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-        fp = fopen(path, "r");
-        if (fp) {
-            char line[1024];
-            if (fgets(line, sizeof(line), fp)) {
-                unsigned long utime, stime;
-                long rss_pages;
-                char comm[256];
-                
-                sscanf(line, "%*d (%255[^)]) %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %ld",
-                       comm, &utime, &stime, &rss_pages);
-                
-                if (strlen(comm) > 0 && strcmp(p->name, "unknown") == 0) {
-                    strncpy(p->name, comm, 255);
-                }
-                
-                static unsigned long long prev_utime[MAX_PROCESSES] = {0};
-                static unsigned long long prev_stime[MAX_PROCESSES] = {0};
-                static int prev_pid[MAX_PROCESSES] = {0};
-                
-                unsigned long long prev_u = 0, prev_s = 0;
-                for (int i = 0; i < MAX_PROCESSES; i++) {
-                    if (prev_pid[i] == pid) {
-                        prev_u = prev_utime[i];
-                        prev_s = prev_stime[i];
-                        break;
-                    }
-                }
-                
-                if (prev_u > 0 || prev_s > 0) {
-                    unsigned long long total_cpu_diff = total - prev_total;
-                    if (total_cpu_diff > 0) {
-                        unsigned long long proc_cpu_diff = (utime - prev_u) + (stime - prev_s);
-                        p->cpu_usage = 100.0 * proc_cpu_diff / total_cpu_diff;
-                        if (p->cpu_usage > 100.0) p->cpu_usage = 100.0;
-                    }
-                } else {
-                    p->cpu_usage = 0.1;
-                }
-                
-                for (int i = 0; i < MAX_PROCESSES; i++) {
-                    if (prev_pid[i] == pid || prev_pid[i] == 0) {
-                        prev_pid[i] = pid;
-                        prev_utime[i] = utime;
-                        prev_stime[i] = stime;
-                        break;
-                    }
-                }
-                
-                if (p->rss == 0 && rss_pages > 0) {
-                    p->rss = rss_pages * sysconf(_SC_PAGESIZE) / 1024;
-                }
-            }
-            fclose(fp);
+        // смена comm при том же (pid, starttime) - exec: перечитать cmdline
+        const ProcessCacheEntry *cached = process_cache_lookup(&process_cache, pid, p->starttime);
+        if (cached && strlen(cached->name) == comm_len && memcmp(cached->name, comm, comm_len) == 0) {
+            p->name = cached->name;
+            p->command_line = cached->command_line;
+            process_cache.hits++;
+        } else {
+            p->name = process_cache_intern(&process_cache, comm, comm_len);
+            p->command_line = read_command_line(pid, p->name);
+            process_cache.misses++;
         }
         
-        snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
-        fp = fopen(path, "rb");
-        if (fp) {
-            int bytes = fread(p->command_line, 1, 511, fp);
-            if (bytes > 0) {
-                p->command_line[bytes] = '\0';
-                for (int i = 0; i < bytes; i++) {
-                    if (p->command_line[i] == '\0') {
-                        p->command_line[i] = ' ';
-                    }
-                }
-                int len = strlen(p->command_line);
-                while (len > 0 && (p->command_line[len-1] == ' ' || 
-                                   p->command_line[len-1] == '\n' || 
-                                   p->command_line[len-1] == '\r')) {
-                    p->command_line[len-1] = '\0';
-                    len--;
-                }
+        if (cached) {
+            unsigned long long total_cpu_diff = total - prev_total;
+            if (total_cpu_diff > 0) {
+                unsigned long long proc_cpu_diff = (p->utime - cached->utime) + (p->stime - cached->stime);
+                p->cpu_usage = 100.0 * proc_cpu_diff / total_cpu_diff;
+                if (p->cpu_usage > 100.0) p->cpu_usage = 100.0;
             }
-            fclose(fp);
         }
+        // у нового процесса дельты ещё нет - остаётся 0 до второго замера
         
-        if (strlen(p->command_line) == 0) {
-            strcpy(p->command_line, p->name);
+        ProcessCacheEntry *next = process_cache_insert(&process_cache, pid);
+        if (next) {
+            next->starttime = p->starttime;
+            next->utime = p->utime;
+            next->stime = p->stime;
+            next->name = p->name;
+            next->command_line = p->command_line;
         }
         
-        struct sysinfo info;
-        if (sysinfo(&info) == 0 && info.totalram > 0) {
-            p->mem_usage = 100.0 * (p->rss * 1024) / (info.totalram * info.mem_unit);
+        p->rss = rss_pages * page_kb;  // RSS в KB
+        if (total_ram > 0) {
+            p->mem_usage = 100.0 * (p->rss * 1024) / total_ram;
         }
         
         (*count)++;
     }
     
     closedir(dir);
+    process_cache_end(&process_cache);
     
     prev_total = total;
     prev_idle = idle;
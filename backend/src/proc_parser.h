@@ -2,11 +2,24 @@
 #define PROC_PARSER_H
 
 #include "config.h"
+#include "core_stats.h"
+#include "process_cache.h"
 
+double get_cpu_temperature();
+unsigned long get_cpu_frequency();
 int get_cpu_cores_count();
-int read_cpu_stats(CPUStats *cpu, CPUStats *cores, int *cores_count);
+int read_cpu_stats(CPUStats *cpu, CoreStats *cores);
 int read_memory_info(MemoryInfo *mem);
+int gpu_probe();
 int read_gpu_info(GPUInfo *gpu);
 int get_processes(ProcessInfo *processes, int *count);
+const ProcessCache *get_process_cache(void);
+void set_process_limit(int limit);
+int get_process_limit();
+
+void set_proc_root(const char *path);
+void set_sys_root(const char *path);
+const char *get_proc_root();
+const char *get_sys_root();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <string.h>
+#include "process_cache.h"
+
+int process_cache_init(ProcessCache *c) {
+    memset(c, 0, sizeof(ProcessCache));
+    c->prev = calloc(PROCESS_CACHE_SLOTS, sizeof(ProcessCacheEntry));
+    c->next = calloc(PROCESS_CACHE_SLOTS, sizeof(ProcessCacheEntry));
+    if (!c->prev || !c->next ||
+        string_arena_init(&c->arenas[0]) != 0 || string_arena_init(&c->arenas[1]) != 0) {
+        process_cache_free(c);
+        return -1;
+    }
+    return 0;
+}
+
+void process_cache_free(ProcessCache *c) {
+    free(c->prev);
+    free(c->next);
+    string_arena_free(&c->arenas[0]);
+    string_arena_free(&c->arenas[1]);
+    memset(c, 0, sizeof(ProcessCache));
+}
+
+static int slot_of(int pid) {
+    return (int)(((unsigned int)pid * 2654435761u) & (PROCESS_CACHE_SLOTS - 1));
+}
+
+static const char *intern_or_empty(StringArena *a, const char *s) {
+    const char *p = string_arena_intern(a, s, strlen(s));
+    return p ? p : "";
+}
+
+// Живые строки переезжают во вторую арену; первая сбросится при
+// следующем сжатии, когда на нее уже не будет ссылок
+static void compact(ProcessCache *c) {
+    int spare = 1 - c->active;
+    StringArena *to = &c->arenas[spare];
+
+    string_arena_reset(to);
+    for (int i = 0; i < PROCESS_CACHE_SLOTS; i++) {
+        ProcessCacheEntry *e = &c->prev[i];
+        if (!e->pid) continue;
+        e->name = intern_or_empty(to, e->name);
+        e->command_line = intern_or_empty(to, e->command_line);
+    }
+    c->active = spare;
+    c->compactions++;
+}
+
+void process_cache_begin(ProcessCache *c) {
+    const StringArena *a = &c->arenas[c->active];
+    if (a->bytes > PROCESS_CACHE_COMPACT_BYTES && c->live_bytes * 2 < a->bytes) {
+        compact(c);
+    }
+    memset(c->next, 0, PROCESS_CACHE_SLOTS * sizeof(ProcessCacheEntry));
+    c->count = 0;
+}
+
+const ProcessCacheEntry *process_cache_lookup(const ProcessCache *c, int pid,
+                                              unsigned long long starttime) {
+    for (int i = slot_of(pid); c->prev[i].pid; i = (i + 1) & (PROCESS_CACHE_SLOTS - 1)) {
+        if (c->prev[i].pid == pid) {
+            return c->prev[i].starttime == starttime ? &c->prev[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+// Слот в next; NULL, если таблица заполнена
+ProcessCacheEntry *process_cache_insert(ProcessCache *c, int pid) {
+    if (c->count >= PROCESS_CACHE_SLOTS - 1) return NULL;
+
+    int i = slot_of(pid);
+    while (c->next[i].pid && c->next[i].pid != pid) i = (i + 1) & (PROCESS_CACHE_SLOTS - 1);
+    if (!c->next[i].pid) c->count++;
+    c->next[i].pid = pid;
+    return &c->next[i];
+}
+
+void process_cache_end(ProcessCache *c) {
+    ProcessCacheEntry *t = c->prev;
+    c->prev = c->next;
+    c->next = t;
+
+    c->live_bytes = 0;
+    for (int i = 0; i < PROCESS_CACHE_SLOTS; i++) {
+        if (!c->prev[i].pid) continue;
+        c->live_bytes += strlen(c->prev[i].name) + strlen(c->prev[i].command_line) + 2;
+    }
+}
+
+const char *process_cache_intern(ProcessCache *c, const char *s, size_t len) {
+    const char *p = string_arena_intern(&c->arenas[c->active], s, len);
+    return p ? p : "";
+}
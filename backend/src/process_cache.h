@@ -0,0 +1,60 @@
+#ifndef PROCESS_CACHE_H
+#define PROCESS_CACHE_H
+
+#include "config.h"
+#include "string_arena.h"
+
+#define PROCESS_CACHE_SLOTS 1024            // степень двойки, >= 2 * MAX_PROCESSES
+#define PROCESS_CACHE_COMPACT_BYTES (1024 * 1024)
+
+/*
+ * Что не меняется за жизнь процесса: имя и cmdline, интернированные в
+ * арене, плюс utime/stime прошлого прохода. Ключ - (pid, starttime):
+ * переиспользованный PID - новая запись. cmdline перечитывается только
+ * после exec (comm из /proc/<pid>/stat отличается от сохраненного имени).
+ *
+ * Два хеша по pid: проход ищет в prev и переносит найденное в next,
+ * завершившиеся процессы просто не переносятся.
+ *
+ * Строки умерших процессов копятся в арене; когда живых меньше половины,
+ * живые переинтернируются во вторую арену. Опубликованная таблица
+ * процессов указывает в текущую арену, поэтому сбрасывается всегда та,
+ * на которую таблицы уже не ссылаются.
+ */
+
+typedef struct {
+    int pid;                    // 0 - пустой слот
+    unsigned long long starttime;
+    unsigned long utime;
+    unsigned long stime;
+    const char *name;
+    const char *command_line;
+} ProcessCacheEntry;
+
+typedef struct {
+    ProcessCacheEntry *prev;
+    ProcessCacheEntry *next;
+    int count;
+
+    StringArena arenas[2];
+    int active;
+    size_t live_bytes;          // строки записей prev (общие считаются дважды)
+
+    unsigned long hits;
+    unsigned long misses;       // новые процессы и exec: прочитан cmdline
+    unsigned long compactions;
+} ProcessCache;
+
+int process_cache_init(ProcessCache *c);
+void process_cache_free(ProcessCache *c);
+
+// Проход: begin, на каждый PID lookup и insert, затем end
+void process_cache_begin(ProcessCache *c);
+const ProcessCacheEntry *process_cache_lookup(const ProcessCache *c, int pid,
+                                              unsigned long long starttime);
+ProcessCacheEntry *process_cache_insert(ProcessCache *c, int pid);
+void process_cache_end(ProcessCache *c);
+
+const char *process_cache_intern(ProcessCache *c, const char *s, size_t len);
+
+#endif
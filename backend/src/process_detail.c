@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+#include "process_detail.h"
+
+void process_detail_init(ProcessDetailCollector *c, const char *proc_root, int top_n) {
+    memset(c, 0, sizeof(ProcessDetailCollector));
+    snprintf(c->proc_root, sizeof(c->proc_root), "%s", proc_root);
+    c->top_n = top_n > PROC_DETAIL_TOP_N ? PROC_DETAIL_TOP_N : top_n;
+    c->details = c->slots[0];
+}
+
+static void close_detail(ProcessDetail *d) {
+    procfile_close(&d->schedstat);
+    procfile_close(&d->io);
+    procfile_close(&d->status);
+}
+
+void process_detail_free(ProcessDetailCollector *c) {
+    for (int i = 0; i < c->count; i++) {
+        close_detail(&c->details[i]);
+    }
+    c->count = 0;
+}
+
+int process_detail_watch(ProcessDetailCollector *c, int pid) {
+    if (pid <= 0) return -1;
+    for (int i = 0; i < c->watch_count; i++) {
+        if (c->watch[i] == pid) return 0;
+    }
+    if (c->watch_count >= PROC_DETAIL_WATCH_MAX) return -1;
+    c->watch[c->watch_count++] = pid;
+    return 0;
+}
+
+static int is_watched(const ProcessDetailCollector *c, int pid) {
+    for (int i = 0; i < c->watch_count; i++) {
+        if (c->watch[i] == pid) return 1;
+    }
+    return 0;
+}
+
+// /proc/<pid>/schedstat: "время на CPU (нс) ожидание в очереди (нс) кол-во запусков"
+int parse_schedstat(const char *text, unsigned long long *run_ns) {
+    const char *p = skip_spaces(text);
+    if (*p < '0' || *p > '9') return -1;
+    *run_ns = parse_ull(&p);
+    return 0;
+}
+
+// Путь длиннее PROCFS_PATH_MAX помечается отсутствующим, а не обрезается
+static void detail_file(ProcessDetailCollector *c, ProcFile *f, int pid, const char *name) {
+    char path[PROCFS_PATH_MAX];
+    int len = snprintf(path, sizeof(path), "%s/%d/%s", c->proc_root, pid, name);
+
+    procfile_init(f, path);
+    if (len < 0 || len >= (int)sizeof(path)) f->missing = 1;
+}
+
+static void open_detail(ProcessDetailCollector *c, ProcessDetail *d, const ProcessInfo *p) {
+    memset(d, 0, sizeof(ProcessDetail));
+    d->pid = p->pid;
+    d->starttime = p->starttime;
+
+    detail_file(c, &d->schedstat, p->pid, "schedstat");
+    detail_file(c, &d->io, p->pid, "io");
+    detail_file(c, &d->status, p->pid, "status");
+}
+
+static double rate(unsigned long long prev, unsigned long long curr, double elapsed_sec) {
+    return curr >= prev ? (curr - prev) / elapsed_sec : 0.0;
+}
+
+// /proc/<pid>/io недоступен без прав ptrace - тогда I/O остается нулевым
+static void read_detail(ProcessDetailCollector *c, ProcessDetail *d, ProcessInfo *p,
+                        double elapsed_sec) {
+    unsigned long long run_ns = d->run_ns;
+    unsigned long long read_bytes = d->read_bytes, write_bytes = d->write_bytes;
+    unsigned long long voluntary = d->voluntary, involuntary = d->involuntary;
+
+    if (procfile_read(&d->schedstat, c->buffer, sizeof(c->buffer)) > 0) {
+        parse_schedstat(c->buffer, &run_ns);
+    }
+    if (procfile_read(&d->io, c->buffer, sizeof(c->buffer)) > 0) {
+        find_key_ull(c->buffer, "read_bytes:", &read_bytes);
+        find_key_ull(c->buffer, "write_bytes:", &write_bytes);
+    }
+    if (procfile_read(&d->status, c->buffer, sizeof(c->buffer)) > 0) {
+        find_key_ull(c->buffer, "voluntary_ctxt_switches:", &voluntary);
+        find_key_ull(c->buffer, "nonvoluntary_ctxt_switches:", &involuntary);
+    }
+
+    p->has_detail = 1;
+    p->cpu_time_percent = 0.0;
+    p->io_read_rate = p->io_write_rate = 0.0;
+    p->ctx_voluntary_rate = p->ctx_involuntary_rate = 0.0;
+    if (d->has_prev && elapsed_sec > 0) {
+        p->cpu_time_percent = rate(d->run_ns, run_ns, elapsed_sec) / 1e7;
+        p->io_read_rate = rate(d->read_bytes, read_bytes, elapsed_sec);
+        p->io_write_rate = rate(d->write_bytes, write_bytes, elapsed_sec);
+        p->ctx_voluntary_rate = rate(d->voluntary, voluntary, elapsed_sec);
+        p->ctx_involuntary_rate = rate(d->involuntary, involuntary, elapsed_sec);
+    }
+
+    d->run_ns = run_ns;
+    d->read_bytes = read_bytes;
+    d->write_bytes = write_bytes;
+    d->voluntary = voluntary;
+    d->involuntary = involuntary;
+    d->has_prev = 1;
+}
+
+static ProcessDetail *find_prev(ProcessDetailCollector *c, const ProcessInfo *p) {
+    for (int i = 0; i < c->count; i++) {
+        ProcessDetail *d = &c->details[i];
+        if (!d->carried && d->pid == p->pid && d->starttime == p->starttime) return d;
+    }
+    return NULL;
+}
+
+// processes отсортированы по CPU, первые top_n строк - top N тика
+void process_detail_sample(ProcessDetailCollector *c, ProcessInfo *processes, int count,
+                           double elapsed_sec) {
+    ProcessDetail *next = (c->details == c->slots[0]) ? c->slots[1] : c->slots[0];
+    int next_count = 0;
+    elapsed_sec += c->skipped_sec;
+    c->skipped_sec = 0.0;
+
+    for (int i = 0; i < count && next_count < PROC_DETAIL_MAX; i++) {
+        ProcessInfo *p = &processes[i];
+        if (i >= c->top_n && !is_watched(c, p->pid)) continue;
+
+        ProcessDetail *d = &next[next_count++];
+        ProcessDetail *old = find_prev(c, p);
+        if (old) {
+            *d = *old;
+            old->carried = 1;
+            d->carried = 0;
+        } else {
+            open_detail(c, d, p);
+        }
+        read_detail(c, d, p, elapsed_sec);
+    }
+
+    // процессы, выбывшие из top N или завершившиеся
+    for (int i = 0; i < c->count; i++) {
+        if (!c->details[i].carried) close_detail(&c->details[i]);
+    }
+
+    c->details = next;
+    c->count = next_count;
+}
+
+// Тик без скана: его длительность войдет в делитель следующих скоростей
+void process_detail_skip(ProcessDetailCollector *c, double elapsed_sec) {
+    c->skipped_sec += elapsed_sec;
+}
+
+void write_process_detail_json(JsonWriter *w, const ProcessInfo *p) {
+    jw_lit(w, "{\"cpu_time\": ");
+    jw_fixed1(w, p->cpu_time_percent);
+    jw_lit(w, ", \"io_read\": ");
+    jw_fixed1(w, p->io_read_rate);
+    jw_lit(w, ", \"io_write\": ");
+    jw_fixed1(w, p->io_write_rate);
+    jw_lit(w, ", \"ctx_voluntary\": ");
+    jw_fixed1(w, p->ctx_voluntary_rate);
+    jw_lit(w, ", \"ctx_involuntary\": ");
+    jw_fixed1(w, p->ctx_involuntary_rate);
+    jw_char(w, '}');
+}
@@ -0,0 +1,54 @@
+#ifndef PROCESS_DETAIL_H
+#define PROCESS_DETAIL_H
+
+#include "config.h"
+#include "json_writer.h"
+#include "procfs.h"
+
+#define PROC_DETAIL_BUFFER_SIZE 4096
+
+typedef struct {
+    int pid;
+    unsigned long long starttime;
+    int has_prev;
+    int carried;
+
+    ProcFile schedstat;
+    ProcFile io;
+    ProcFile status;
+
+    unsigned long long run_ns;
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    unsigned long long voluntary;
+    unsigned long long involuntary;
+} ProcessDetail;
+
+// Расширенный скан дорогой (три файла на процесс), поэтому он идет
+// только по top N строк тика и по списку --watch. Прошлые значения
+// ищутся по (pid, starttime), дескрипторы файлов переживают тики.
+// Скан по спросу идет не каждый тик: скорости делятся на время с прошлого
+// скана, а не на интервал последнего тика.
+typedef struct {
+    char proc_root[PROCFS_PATH_MAX];
+    int top_n;
+    int watch[PROC_DETAIL_WATCH_MAX];
+    int watch_count;
+    ProcessDetail slots[2][PROC_DETAIL_MAX];
+    ProcessDetail *details;
+    int count;
+    double skipped_sec;         // тики без скана с прошлого process_detail_sample
+    char buffer[PROC_DETAIL_BUFFER_SIZE];
+} ProcessDetailCollector;
+
+void process_detail_init(ProcessDetailCollector *c, const char *proc_root, int top_n);
+void process_detail_free(ProcessDetailCollector *c);
+int process_detail_watch(ProcessDetailCollector *c, int pid);
+void process_detail_sample(ProcessDetailCollector *c, ProcessInfo *processes, int count,
+                           double elapsed_sec);
+void process_detail_skip(ProcessDetailCollector *c, double elapsed_sec);
+
+int parse_schedstat(const char *text, unsigned long long *run_ns);
+void write_process_detail_json(JsonWriter *w, const ProcessInfo *p);
+
+#endif
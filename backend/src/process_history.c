@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "process_history.h"
+
+static int bucket_of(int pid) {
+    return (int)((unsigned int)pid * 2654435761u % PROC_HISTORY_BUCKETS);
+}
+
+static void lru_unlink(ProcessHistoryStore *store, int idx) {
+    ProcessSeries *s = &store->slots[idx];
+
+    if (s->lru_prev >= 0) store->slots[s->lru_prev].lru_next = s->lru_next;
+    else store->lru_head = s->lru_next;
+
+    if (s->lru_next >= 0) store->slots[s->lru_next].lru_prev = s->lru_prev;
+    else store->lru_tail = s->lru_prev;
+
+    s->lru_prev = s->lru_next = -1;
+}
+
+static void lru_push_front(ProcessHistoryStore *store, int idx) {
+    ProcessSeries *s = &store->slots[idx];
+
+    s->lru_prev = -1;
+    s->lru_next = store->lru_head;
+    if (store->lru_head >= 0) store->slots[store->lru_head].lru_prev = idx;
+    store->lru_head = idx;
+    if (store->lru_tail < 0) store->lru_tail = idx;
+}
+
+static void release_slot(ProcessHistoryStore *store, int idx) {
+    ProcessSeries *s = &store->slots[idx];
+    int *link = &store->buckets[bucket_of(s->pid)];
+
+    while (*link >= 0 && *link != idx) {
+        link = &store->slots[*link].hash_next;
+    }
+    if (*link == idx) *link = s->hash_next;
+
+    lru_unlink(store, idx);
+
+    s->in_use = 0;
+    s->hash_next = store->free_head;
+    store->free_head = idx;
+    store->used--;
+}
+
+static int acquire_slot(ProcessHistoryStore *store, ProcessInfo *p) {
+    if (store->free_head < 0) {
+        release_slot(store, store->lru_tail);
+        store->evictions++;
+    }
+
+    int idx = store->free_head;
+    ProcessSeries *s = &store->slots[idx];
+    store->free_head = s->hash_next;
+
+    s->pid = p->pid;
+    s->starttime = p->starttime;
+    strncpy(s->name, p->name, sizeof(s->name) - 1);
+    s->name[sizeof(s->name) - 1] = '\0';
+    s->index = 0;
+    s->count = 0;
+    s->in_use = 1;
+
+    int b = bucket_of(p->pid);
+    s->hash_next = store->buckets[b];
+    store->buckets[b] = idx;
+
+    lru_push_front(store, idx);
+    store->used++;
+
+    return idx;
+}
+
+static int lookup_slot(ProcessHistoryStore *store, int pid, unsigned long long starttime) {
+    for (int idx = store->buckets[bucket_of(pid)]; idx >= 0; idx = store->slots[idx].hash_next) {
+        if (store->slots[idx].pid == pid && store->slots[idx].starttime == starttime) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+void init_process_history(ProcessHistoryStore *store) {
+    memset(store, 0, sizeof(ProcessHistoryStore));
+
+    for (int i = 0; i < PROC_HISTORY_BUCKETS; i++) {
+        store->buckets[i] = -1;
+    }
+    for (int i = 0; i < PROC_HISTORY_SLOTS; i++) {
+        store->slots[i].lru_prev = -1;
+        store->slots[i].lru_next = -1;
+        store->slots[i].hash_next = (i + 1 < PROC_HISTORY_SLOTS) ? i + 1 : -1;
+    }
+
+    store->free_head = 0;
+    store->lru_head = -1;
+    store->lru_tail = -1;
+}
+
+// processes должны быть отсортированы по убыванию CPU (как после get_processes)
+void update_process_history(ProcessHistoryStore *store, ProcessInfo *processes, int count,
+                            int top_n, long now) {
+    if (top_n > PROC_HISTORY_SLOTS) top_n = PROC_HISTORY_SLOTS;
+
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *p = &processes[i];
+        int is_top = i < top_n;
+        int idx = lookup_slot(store, p->pid, p->starttime);
+
+        if (idx < 0) {
+            if (!is_top) continue;
+            idx = acquire_slot(store, p);
+        }
+
+        ProcessSeries *s = &store->slots[idx];
+        if (is_top) {
+            s->last_top = now;
+            lru_unlink(store, idx);
+            lru_push_front(store, idx);
+        }
+
+        s->cpu_usage[s->index] = (float)p->cpu_usage;
+        s->rss[s->index] = p->rss;
+        s->timestamps[s->index] = now;
+        s->index = (s->index + 1) % PROC_HISTORY_SIZE;
+        if (s->count < PROC_HISTORY_SIZE) {
+            s->count++;
+        }
+        s->last_seen = now;
+    }
+
+    while (store->lru_tail >= 0 &&
+           store->slots[store->lru_tail].last_top < now - PROC_HISTORY_RETENTION_SEC) {
+        release_slot(store, store->lru_tail);
+    }
+}
+
+ProcessSeries *find_process_series(ProcessHistoryStore *store, int pid) {
+    ProcessSeries *best = NULL;
+
+    for (int idx = store->buckets[bucket_of(pid)]; idx >= 0; idx = store->slots[idx].hash_next) {
+        ProcessSeries *s = &store->slots[idx];
+        if (s->pid == pid && (!best || s->starttime > best->starttime)) {
+            best = s;
+        }
+    }
+
+    return best;
+}
+
+int write_process_history_json(JsonWriter *w, ProcessHistoryStore *store, int pid,
+                               long age_ms, int stale) {
+    ProcessSeries *s = find_process_series(store, pid);
+    if (!s) {
+        jw_lit(w, "{\"error\":\"Process not tracked\",\"pid\":");
+        jw_int(w, pid);
+        jw_char(w, '}');
+        return -1;
+    }
+
+    jw_lit(w, "{\n  \"pid\": ");
+    jw_int(w, s->pid);
+    jw_lit(w, ",\n  \"starttime\": ");
+    jw_uint(w, s->starttime);
+    jw_lit(w, ",\n  \"name\": ");
+    jw_string(w, s->name);
+    jw_lit(w, ",\n  \"last_seen\": ");
+    jw_int(w, s->last_seen);
+    jw_lit(w, ",\n  \"age_ms\": ");
+    jw_int(w, age_ms);
+    jw_lit(w, ",\n  \"stale\": ");
+    if (stale) jw_lit(w, "true");
+    else jw_lit(w, "false");
+    jw_lit(w, ",\n  \"cpu\": [");
+
+    for (int i = 0; i < s->count; i++) {
+        int idx = (s->index - s->count + i + PROC_HISTORY_SIZE) % PROC_HISTORY_SIZE;
+        if (i > 0) jw_char(w, ',');
+        jw_fixed1(w, s->cpu_usage[idx]);
+    }
+
+    jw_lit(w, "],\n  \"memory\": [");
+
+    for (int i = 0; i < s->count; i++) {
+        int idx = (s->index - s->count + i + PROC_HISTORY_SIZE) % PROC_HISTORY_SIZE;
+        if (i > 0) jw_char(w, ',');
+        jw_int(w, (long long)s->rss[idx] * 1024);
+    }
+
+    jw_lit(w, "],\n  \"timestamps\": [");
+
+    for (int i = 0; i < s->count; i++) {
+        int idx = (s->index - s->count + i + PROC_HISTORY_SIZE) % PROC_HISTORY_SIZE;
+        if (i > 0) jw_char(w, ',');
+        jw_int(w, s->timestamps[idx]);
+    }
+
+    jw_lit(w, "],\n  \"count\": ");
+    jw_int(w, s->count);
+    jw_lit(w, "\n}");
+
+    return 0;
+}
+
+int get_process_history_json(char *buffer, int buffer_size, ProcessHistoryStore *store, int pid,
+                             long age_ms, int stale) {
+    JsonWriter w;
+    jw_init_fixed(&w, buffer, buffer_size);
+
+    int result = write_process_history_json(&w, store, pid, age_ms, stale);
+
+    if (w.overflow) {
+        snprintf(buffer, buffer_size, "{\"error\":\"buffer overflow\"}");
+    }
+
+    return result;
+}
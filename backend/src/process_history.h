@@ -0,0 +1,48 @@
+#ifndef PROCESS_HISTORY_H
+#define PROCESS_HISTORY_H
+
+#include "config.h"
+#include "json_writer.h"
+
+#define PROC_HISTORY_BUCKETS (PROC_HISTORY_SLOTS * 2)
+
+typedef struct {
+    int pid;
+    unsigned long long starttime;
+    char name[64];
+    long last_top;
+    long last_seen;
+    int lru_prev;
+    int lru_next;
+    int hash_next;
+    int in_use;
+    float cpu_usage[PROC_HISTORY_SIZE];
+    long rss[PROC_HISTORY_SIZE];
+    long timestamps[PROC_HISTORY_SIZE];
+    int index;
+    int count;
+} ProcessSeries;
+
+// Пул фиксированного размера: слоты не выделяются динамически,
+// при заполнении вытесняется процесс, дольше всех не входивший в top N
+typedef struct {
+    ProcessSeries slots[PROC_HISTORY_SLOTS];
+    int buckets[PROC_HISTORY_BUCKETS];
+    int lru_head;
+    int lru_tail;
+    int free_head;
+    int used;
+    unsigned long evictions;
+} ProcessHistoryStore;
+
+void init_process_history(ProcessHistoryStore *store);
+void update_process_history(ProcessHistoryStore *store, ProcessInfo *processes, int count,
+                            int top_n, long now);
+ProcessSeries *find_process_series(ProcessHistoryStore *store, int pid);
+// age_ms/stale - возраст последнего обхода процессов, из которого пополнялась история
+int write_process_history_json(JsonWriter *w, ProcessHistoryStore *store, int pid,
+                               long age_ms, int stale);
+int get_process_history_json(char *buffer, int buffer_size, ProcessHistoryStore *store, int pid,
+                             long age_ms, int stale);
+
+#endif
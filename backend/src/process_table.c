@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "process_table.h"
+#include "process_detail.h"
+
+#define DEFAULT_QUERY_LIMIT 50
+
+static const char *sort_names[PROCESS_SORT_COUNT] = {"cpu", "rss", "pid", "name"};
+
+int process_table_init(ProcessTable *table, int capacity) {
+    memset(table, 0, sizeof(ProcessTable));
+
+    table->rows = calloc(capacity, sizeof(ProcessInfo));
+    if (!table->rows) return -1;
+
+    for (int k = 0; k < PROCESS_SORT_COUNT; k++) {
+        table->order[k] = calloc(capacity, sizeof(int));
+        if (!table->order[k]) {
+            process_table_free(table);
+            return -1;
+        }
+    }
+
+    table->capacity = capacity;
+    return 0;
+}
+
+void process_table_free(ProcessTable *table) {
+    free(table->rows);
+    for (int k = 0; k < PROCESS_SORT_COUNT; k++) {
+        free(table->order[k]);
+    }
+    memset(table, 0, sizeof(ProcessTable));
+}
+
+static int compare_pid(const ProcessInfo *a, const ProcessInfo *b) {
+    return (a->pid > b->pid) - (a->pid < b->pid);
+}
+
+static int compare_by_cpu(const void *x, const void *y, void *arg) {
+    const ProcessInfo *rows = arg;
+    const ProcessInfo *a = &rows[*(const int *)x], *b = &rows[*(const int *)y];
+    if (a->cpu_usage != b->cpu_usage) return a->cpu_usage < b->cpu_usage ? 1 : -1;
+    return compare_pid(a, b);
+}
+
+static int compare_by_rss(const void *x, const void *y, void *arg) {
+    const ProcessInfo *rows = arg;
+    const ProcessInfo *a = &rows[*(const int *)x], *b = &rows[*(const int *)y];
+    if (a->rss != b->rss) return a->rss < b->rss ? 1 : -1;
+    return compare_pid(a, b);
+}
+
+static int compare_by_pid(const void *x, const void *y, void *arg) {
+    const ProcessInfo *rows = arg;
+    return compare_pid(&rows[*(const int *)x], &rows[*(const int *)y]);
+}
+
+static int compare_by_name(const void *x, const void *y, void *arg) {
+    const ProcessInfo *rows = arg;
+    const ProcessInfo *a = &rows[*(const int *)x], *b = &rows[*(const int *)y];
+    int c = strcmp(a->name, b->name);
+    return c ? c : compare_pid(a, b);
+}
+
+void process_table_build_indices(ProcessTable *table) {
+    static int (*const comparators[PROCESS_SORT_COUNT])(const void *, const void *, void *) = {
+        compare_by_cpu, compare_by_rss, compare_by_pid, compare_by_name
+    };
+
+    for (int k = 0; k < PROCESS_SORT_COUNT; k++) {
+        for (int i = 0; i < table->count; i++) {
+            table->order[k][i] = i;
+        }
+        qsort_r(table->order[k], table->count, sizeof(int), comparators[k], table->rows);
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void url_decode(const char *src, size_t len, char *dst, size_t dst_size) {
+    size_t j = 0;
+
+    for (size_t i = 0; i < len && j + 1 < dst_size; i++) {
+        if (src[i] == '+') {
+            dst[j++] = ' ';
+        } else if (src[i] == '%' && i + 2 < len &&
+                   hex_value(src[i + 1]) >= 0 && hex_value(src[i + 2]) >= 0) {
+            dst[j++] = (char)(hex_value(src[i + 1]) * 16 + hex_value(src[i + 2]));
+            i += 2;
+        } else {
+            dst[j++] = src[i];
+        }
+    }
+
+    dst[j] = '\0';
+}
+
+const char *process_sort_name(ProcessSortKey key) {
+    return (key >= 0 && key < PROCESS_SORT_COUNT) ? sort_names[key] : "cpu";
+}
+
+int parse_process_query(const char *query_string, ProcessQuery *query) {
+    memset(query, 0, sizeof(ProcessQuery));
+    query->sort = PROCESS_SORT_CPU;
+    query->limit = DEFAULT_QUERY_LIMIT;
+
+    const char *p = query_string;
+    while (p && *p) {
+        const char *end = strchr(p, '&');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        const char *eq = memchr(p, '=', len);
+
+        if (eq) {
+            size_t key_len = eq - p;
+            const char *value = eq + 1;
+            size_t value_len = len - key_len - 1;
+            char decoded[128];
+            url_decode(value, value_len, decoded, sizeof(decoded));
+
+            if (key_len == 4 && strncmp(p, "sort", 4) == 0) {
+                int found = 0;
+                for (int k = 0; k < PROCESS_SORT_COUNT; k++) {
+                    if (strcmp(decoded, sort_names[k]) == 0) {
+                        query->sort = (ProcessSortKey)k;
+                        found = 1;
+                    }
+                }
+                if (!found) return -1;
+            } else if (key_len == 5 && strncmp(p, "limit", 5) == 0) {
+                char *num_end = NULL;
+                long limit = strtol(decoded, &num_end, 10);
+                if (num_end == decoded || *num_end != '\0' || limit <= 0) return -1;
+                query->limit = limit > 1000000 ? 1000000 : (int)limit;
+            } else if (key_len == 6 && strncmp(p, "filter", 6) == 0) {
+                strcpy(query->filter, decoded);
+            } else if (key_len == 5 && strncmp(p, "state", 5) == 0) {
+                if (strlen(decoded) != 1) return -1;
+                query->state = decoded[0];
+            }
+        }
+
+        p = end ? end + 1 : NULL;
+    }
+
+    return 0;
+}
+
+static int process_matches(const ProcessInfo *p, const ProcessQuery *query) {
+    if (query->state && p->state != query->state) return 0;
+    if (query->filter[0] &&
+        !strcasestr(p->name, query->filter) &&
+        !strcasestr(p->command_line, query->filter)) {
+        return 0;
+    }
+    return 1;
+}
+
+int write_processes_json(JsonWriter *w, const ProcessTable *table, const ProcessQuery *query,
+                         long age_ms, int stale) {
+    const int *order = table->order[query->sort];
+    int matched = 0;
+
+    jw_lit(w, "{\n  \"timestamp\": ");
+    jw_int(w, table->timestamp);
+    jw_lit(w, ",\n  \"age_ms\": ");
+    jw_int(w, age_ms);
+    jw_lit(w, ",\n  \"stale\": ");
+    if (stale) jw_lit(w, "true");
+    else jw_lit(w, "false");
+    jw_lit(w, ",\n  \"total\": ");
+    jw_int(w, table->count);
+    jw_lit(w, ",\n  \"sort\": ");
+    jw_string(w, sort_names[query->sort]);
+    jw_lit(w, ",\n  \"processes\": [");
+
+    for (int i = 0; i < table->count; i++) {
+        const ProcessInfo *p = &table->rows[order[i]];
+        if (!process_matches(p, query)) continue;
+
+        if (matched < query->limit) {
+            if (matched > 0) jw_char(w, ',');
+            jw_lit(w, "\n    {\"pid\": ");
+            jw_int(w, p->pid);
+            jw_lit(w, ", \"name\": ");
+            jw_string(w, p->name[0] ? p->name : "[unknown]");
+            jw_lit(w, ", \"state\": \"");
+            jw_char(w, p->state);
+            jw_lit(w, "\", \"memory\": ");
+            jw_uint(w, (unsigned long long)p->rss * 1024);
+            jw_lit(w, ", \"cpu\": ");
+            jw_fixed1(w, p->cpu_usage);
+            jw_lit(w, ", \"command\": ");
+            jw_string(w, p->command_line[0] ? p->command_line : p->name);
+            if (p->has_detail) {
+                jw_lit(w, ", \"detail\": ");
+                write_process_detail_json(w, p);
+            }
+            jw_char(w, '}');
+        } else if (!query->filter[0] && !query->state) {
+            matched = table->count;
+            break;
+        }
+        matched++;
+    }
+
+    jw_lit(w, "\n  ],\n  \"matched\": ");
+    jw_int(w, matched);
+    jw_lit(w, "\n}\n");
+
+    return matched;
+}
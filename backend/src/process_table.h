@@ -0,0 +1,43 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include "config.h"
+#include "json_writer.h"
+
+typedef enum {
+    PROCESS_SORT_CPU,
+    PROCESS_SORT_RSS,
+    PROCESS_SORT_PID,
+    PROCESS_SORT_NAME,
+    PROCESS_SORT_COUNT
+} ProcessSortKey;
+
+// Таблица процессов одного тика и индексы сортировки по каждому ключу.
+// Индексы строятся один раз при публикации, запросы только читают их.
+typedef struct {
+    ProcessInfo *rows;
+    int count;
+    int capacity;
+    int *order[PROCESS_SORT_COUNT];
+    long timestamp;
+    long collected_ms;          // CLOCK_MONOTONIC, 0: таблица не собиралась
+} ProcessTable;
+
+typedef struct {
+    ProcessSortKey sort;
+    int limit;
+    char filter[128];
+    char state;
+} ProcessQuery;
+
+int process_table_init(ProcessTable *table, int capacity);
+void process_table_free(ProcessTable *table);
+void process_table_build_indices(ProcessTable *table);
+
+int parse_process_query(const char *query_string, ProcessQuery *query);
+const char *process_sort_name(ProcessSortKey key);
+// age_ms/stale - возраст таблицы: при сборе по спросу она может отстать от тика
+int write_processes_json(JsonWriter *w, const ProcessTable *table, const ProcessQuery *query,
+                         long age_ms, int stale);
+
+#endif
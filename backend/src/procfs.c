@@ -0,0 +1,168 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "procfs.h"
+#include "capture.h"
+
+void procfile_init(ProcFile *f, const char *path) {
+    f->fd = -1;
+    f->missing = 0;
+    snprintf(f->path, sizeof(f->path), "%s", path);
+}
+
+// Читает файл целиком с начала, возвращает длину без '\0' или -1.
+// Отсутствующий файл запоминается, повторно open() не вызывается.
+ssize_t procfile_read(ProcFile *f, char *buffer, size_t size) {
+    if (size == 0 || f->missing) return -1;
+
+    if (f->fd < 0) {
+        f->fd = open(f->path, O_RDONLY | O_CLOEXEC);
+        if (f->fd < 0) {
+            if (errno == ENOENT || errno == ENOTDIR) {
+                f->missing = 1;
+                capture_note_missing(f->path);
+            }
+            return -1;
+        }
+    }
+
+    ssize_t n = pread(f->fd, buffer, size - 1, 0);
+    if (n < 0) {
+        // файл удален (cgroup или процесс исчез) - дескриптор больше не нужен
+        procfile_close(f);
+        return -1;
+    }
+
+    buffer[n] = '\0';
+    capture_note_file(f->path, buffer, n);
+    return n;
+}
+
+void procfile_close(ProcFile *f) {
+    if (f->fd >= 0) {
+        close(f->fd);
+        f->fd = -1;
+    }
+}
+
+const char *skip_spaces(const char *p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+const char *skip_token(const char *p) {
+    p = skip_spaces(p);
+    while (*p && *p != ' ' && *p != '\t' && *p != '\n') p++;
+    return p;
+}
+
+unsigned long long parse_ull(const char **cursor) {
+    const char *p = skip_spaces(*cursor);
+    unsigned long long value = 0;
+
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10 + (unsigned long long)(*p - '0');
+        p++;
+    }
+
+    *cursor = p;
+    return value;
+}
+
+// Только формат ядра: цифры и необязательная дробная часть
+double parse_decimal(const char **cursor) {
+    const char *p = skip_spaces(*cursor);
+    double value = (double)parse_ull(&p);
+
+    if (*p == '.') {
+        double scale = 0.1;
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            value += (*p - '0') * scale;
+            scale *= 0.1;
+            p++;
+        }
+    }
+
+    *cursor = p;
+    return value;
+}
+
+// Ищет строку вида "key value" (как в memory.stat и cpu.stat) или
+// "key:\tvalue" (как в /proc/<pid>/status)
+int find_key_ull(const char *text, const char *key, unsigned long long *value) {
+    size_t key_len = strlen(key);
+    const char *line = text;
+
+    while (line && *line) {
+        if (strncmp(line, key, key_len) == 0 &&
+            (line[key_len] == ' ' || line[key_len] == '\t')) {
+            const char *p = line + key_len;
+            *value = parse_ull(&p);
+            return 0;
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+
+    return -1;
+}
+
+// Счетчики ядра бывают 32-битными (поля "ms" в diskstats, байты
+// интерфейсов на 32-битных ядрах). Уменьшение значения, которое помещалось
+// в 32 бита, считаем переполнением, иначе - сбросом счетчика.
+unsigned long long counter_delta(unsigned long long prev, unsigned long long curr) {
+    if (curr >= prev) return curr - prev;
+    if (prev <= 0xffffffffULL) return (curr + 0x100000000ULL - prev) & 0xffffffffULL;
+    return 0;
+}
+
+static void parse_pressure_line(const char *p, double *avg10, double *avg60,
+                                double *avg300, unsigned long long *total) {
+    while (*p && *p != '\n') {
+        p = skip_spaces(p);
+        if (strncmp(p, "avg10=", 6) == 0) {
+            p += 6;
+            *avg10 = parse_decimal(&p);
+        } else if (strncmp(p, "avg60=", 6) == 0) {
+            p += 6;
+            *avg60 = parse_decimal(&p);
+        } else if (strncmp(p, "avg300=", 7) == 0) {
+            p += 7;
+            *avg300 = parse_decimal(&p);
+        } else if (strncmp(p, "total=", 6) == 0) {
+            p += 6;
+            *total = parse_ull(&p);
+        } else {
+            p = skip_token(p);
+        }
+    }
+}
+
+// Формат /proc/pressure/* и *.pressure в cgroup v2:
+// some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+// full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+int parse_pressure(const char *text, PressureStats *out) {
+    int found = 0;
+    const char *line = text;
+
+    memset(out, 0, sizeof(PressureStats));
+
+    while (line && *line) {
+        if (strncmp(line, "some ", 5) == 0) {
+            parse_pressure_line(line + 5, &out->some_avg10, &out->some_avg60,
+                                &out->some_avg300, &out->some_total);
+            found = 1;
+        } else if (strncmp(line, "full ", 5) == 0) {
+            parse_pressure_line(line + 5, &out->full_avg10, &out->full_avg60,
+                                &out->full_avg300, &out->full_total);
+            found = 1;
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+
+    return found ? 0 : -1;
+}
@@ -0,0 +1,41 @@
+#ifndef PROCFS_H
+#define PROCFS_H
+
+#include <sys/types.h>
+
+#define PROCFS_PATH_MAX 512
+
+// Файл procfs/sysfs с закешированным дескриптором: открывается один раз,
+// дальше каждое чтение - один pread() с нулевого смещения
+typedef struct {
+    int fd;
+    int missing;
+    char path[PROCFS_PATH_MAX];
+} ProcFile;
+
+typedef struct {
+    double some_avg10;
+    double some_avg60;
+    double some_avg300;
+    unsigned long long some_total;
+    double full_avg10;
+    double full_avg60;
+    double full_avg300;
+    unsigned long long full_total;
+} PressureStats;
+
+void procfile_init(ProcFile *f, const char *path);
+ssize_t procfile_read(ProcFile *f, char *buffer, size_t size);
+void procfile_close(ProcFile *f);
+
+// Разбор без sscanf: функции сдвигают курсор за прочитанное значение
+const char *skip_spaces(const char *p);
+const char *skip_token(const char *p);
+unsigned long long parse_ull(const char **cursor);
+double parse_decimal(const char **cursor);
+int find_key_ull(const char *text, const char *key, unsigned long long *value);
+unsigned long long counter_delta(unsigned long long prev, unsigned long long curr);
+
+int parse_pressure(const char *text, PressureStats *out);
+
+#endif
@@ -0,0 +1,249 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "psi_collector.h"
+
+static const char *resource_names[PSI_RESOURCES] = {"cpu", "memory", "io"};
+
+const char *psi_resource_name(PsiResource r) {
+    return (r >= 0 && r < PSI_RESOURCES) ? resource_names[r] : "unknown";
+}
+
+// 0, если доступен хотя бы один файл давления (ядро с CONFIG_PSI и без psi=0)
+int psi_collector_init(PsiCollector *c, const char *pressure_root) {
+    char path[PROCFS_PATH_MAX];
+    int found = 0;
+
+    memset(c, 0, sizeof(PsiCollector));
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        c->triggers[r] = -1;
+        snprintf(path, sizeof(path), "%s/%s", pressure_root, resource_names[r]);
+        procfile_init(&c->files[r], path);
+        if (procfile_read(&c->files[r], c->buffer, sizeof(c->buffer)) > 0 &&
+            parse_pressure(c->buffer, &c->stats[r]) == 0) {
+            c->available[r] = 1;
+            found = 1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &c->last_sample);
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (c->available[r]) c->has_prev[r] = 1;
+    }
+
+    return found ? 0 : -1;
+}
+
+void psi_collector_free(PsiCollector *c) {
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        procfile_close(&c->files[r]);
+        if (c->triggers[r] >= 0) {
+            close(c->triggers[r]);
+            c->triggers[r] = -1;
+        }
+    }
+    c->trigger_count = 0;
+}
+
+// Триггер: "some <stall_us> <window_us>" в отдельный дескриптор, дальше
+// ядро выставляет POLLPRI, когда за окно набралось stall_us простоя.
+// Без прав или без поддержки в ядре write() дает ошибку - тогда остается
+// обычный опрос по интервалу.
+int psi_collector_arm_triggers(PsiCollector *c, const char *pressure_root,
+                               long stall_us, long window_us) {
+    char path[PROCFS_PATH_MAX];
+    char trigger[64];
+    int len = snprintf(trigger, sizeof(trigger), "some %ld %ld", stall_us, window_us);
+
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (!c->available[r] || c->triggers[r] >= 0) continue;
+
+        snprintf(path, sizeof(path), "%s/%s", pressure_root, resource_names[r]);
+        int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) continue;
+
+        if (write(fd, trigger, len + 1) < 0) {
+            printf("PSI trigger for %s rejected: %s\n", resource_names[r], strerror(errno));
+            close(fd);
+            continue;
+        }
+
+        c->triggers[r] = fd;
+        c->trigger_count++;
+    }
+
+    return c->trigger_count;
+}
+
+void psi_collector_update(PsiCollector *c, PsiResource r, const char *text, double elapsed_sec) {
+    PressureStats stats;
+
+    if (parse_pressure(text, &stats) != 0) return;
+
+    if (c->has_prev[r] && elapsed_sec > 0) {
+        unsigned long long stalled = counter_delta(c->stats[r].some_total, stats.some_total);
+        c->stall[r] = stalled / elapsed_sec / 1e4;
+        if (c->stall[r] > 100.0) c->stall[r] = 100.0;
+        if (c->stall[r] > c->peak[r]) c->peak[r] = c->stall[r];
+    }
+
+    c->stats[r] = stats;
+    c->available[r] = 1;
+    c->has_prev[r] = 1;
+}
+
+void psi_collector_sample(PsiCollector *c) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (now.tv_sec - c->last_sample.tv_sec) +
+                     (now.tv_nsec - c->last_sample.tv_nsec) / 1e9;
+    c->last_sample = now;
+
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (!c->available[r]) continue;
+        if (procfile_read(&c->files[r], c->buffer, sizeof(c->buffer)) > 0) {
+            psi_collector_update(c, (PsiResource)r, c->buffer, elapsed);
+        }
+    }
+}
+
+static void record_event(PsiCollector *c, int r, double interval_ms) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    PsiEvent *e = &c->events[c->event_next];
+    e->timestamp_ms = (long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+    e->resource = r;
+    e->stall = c->stall[r];
+    e->interval_ms = interval_ms;
+
+    c->event_next = (c->event_next + 1) % PSI_EVENT_HISTORY;
+    if (c->event_count < PSI_EVENT_HISTORY) c->event_count++;
+}
+
+// Ждет до timeout_ms. Если сработал триггер - сразу делает замер давления
+// и возвращает маску ресурсов (1 << PsiResource), иначе 0.
+// wake_fd (eventfd, -1 - нет) прерывает ожидание: в маске PSI_WAKE
+int psi_collector_wait(PsiCollector *c, int timeout_ms, int wake_fd) {
+    struct pollfd fds[PSI_RESOURCES + 1];
+    int map[PSI_RESOURCES + 1];
+    int nfds = 0;
+
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (c->triggers[r] < 0) continue;
+        fds[nfds].fd = c->triggers[r];
+        fds[nfds].events = POLLPRI;
+        fds[nfds].revents = 0;
+        map[nfds++] = r;
+    }
+
+    if (wake_fd >= 0) {
+        fds[nfds].fd = wake_fd;
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        map[nfds++] = -1;
+    }
+
+    int ready = poll(nfds > 0 ? fds : NULL, nfds, timeout_ms);
+    if (ready <= 0) return 0;
+
+    int mask = 0;
+    int woken = 0;
+    for (int i = 0; i < nfds; i++) {
+        int r = map[i];
+        if (r < 0) {
+            uint64_t value;
+            woken = (fds[i].revents & POLLIN) && read(wake_fd, &value, sizeof(value)) > 0;
+        } else if (fds[i].revents & POLLERR) {
+            close(c->triggers[r]);
+            c->triggers[r] = -1;
+            c->trigger_count--;
+        } else if (fds[i].revents & POLLPRI) {
+            mask |= 1 << r;
+        }
+    }
+    if (!mask) return woken ? PSI_WAKE : 0;
+
+    struct timespec before = c->last_sample;
+    psi_collector_sample(c);
+    double interval_ms = (c->last_sample.tv_sec - before.tv_sec) * 1e3 +
+                         (c->last_sample.tv_nsec - before.tv_nsec) / 1e6;
+
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (mask & (1 << r)) record_event(c, r, interval_ms);
+    }
+    c->wakeups++;
+
+    return woken ? mask | PSI_WAKE : mask;
+}
+
+// Пики за тик идут в историю: короткий всплеск между тиками не теряется
+void psi_collector_take_peaks(PsiCollector *c, double *peaks) {
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        peaks[r] = c->peak[r];
+        c->peak[r] = 0.0;
+    }
+}
+
+void write_pressure_json(JsonWriter *w, const PsiCollector *c) {
+    jw_char(w, '{');
+
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        const PressureStats *s = &c->stats[r];
+
+        jw_lit(w, "\n    ");
+        jw_string(w, resource_names[r]);
+        jw_lit(w, ": ");
+        if (!c->available[r]) {
+            jw_lit(w, "null,");
+            continue;
+        }
+        jw_lit(w, "{\"some_avg10\": ");
+        jw_fixed1(w, s->some_avg10);
+        jw_lit(w, ", \"some_avg60\": ");
+        jw_fixed1(w, s->some_avg60);
+        jw_lit(w, ", \"some_avg300\": ");
+        jw_fixed1(w, s->some_avg300);
+        jw_lit(w, ", \"full_avg10\": ");
+        jw_fixed1(w, s->full_avg10);
+        jw_lit(w, ", \"full_avg60\": ");
+        jw_fixed1(w, s->full_avg60);
+        jw_lit(w, ", \"full_avg300\": ");
+        jw_fixed1(w, s->full_avg300);
+        jw_lit(w, ", \"some_total\": ");
+        jw_uint(w, s->some_total);
+        jw_lit(w, ", \"full_total\": ");
+        jw_uint(w, s->full_total);
+        jw_lit(w, ", \"stall\": ");
+        jw_fixed1(w, c->stall[r]);
+        jw_lit(w, "},");
+    }
+
+    jw_lit(w, "\n    \"triggers\": ");
+    jw_int(w, c->trigger_count);
+    jw_lit(w, ",\n    \"wakeups\": ");
+    jw_uint(w, c->wakeups);
+    jw_lit(w, ",\n    \"events\": [");
+
+    for (int i = 0; i < c->event_count; i++) {
+        int idx = (c->event_next - c->event_count + i + PSI_EVENT_HISTORY) % PSI_EVENT_HISTORY;
+        const PsiEvent *e = &c->events[idx];
+
+        if (i > 0) jw_lit(w, ", ");
+        jw_lit(w, "{\"time\": ");
+        jw_int(w, e->timestamp_ms);
+        jw_lit(w, ", \"resource\": ");
+        jw_string(w, resource_names[e->resource]);
+        jw_lit(w, ", \"stall\": ");
+        jw_fixed1(w, e->stall);
+        jw_lit(w, ", \"interval_ms\": ");
+        jw_fixed1(w, e->interval_ms);
+        jw_char(w, '}');
+    }
+
+    jw_lit(w, "]\n  }");
+}
@@ -0,0 +1,55 @@
+#ifndef PSI_COLLECTOR_H
+#define PSI_COLLECTOR_H
+
+#include <time.h>
+#include "config.h"
+#include "json_writer.h"
+#include "procfs.h"
+
+typedef enum {
+    PSI_CPU,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_RESOURCES
+} PsiResource;
+
+// psi_collector_wait: ожидание прервано через wake_fd
+#define PSI_WAKE (1 << PSI_RESOURCES)
+
+// Внеочередной замер по срабатыванию триггера
+typedef struct {
+    long timestamp_ms;
+    int resource;
+    double stall;           // % времени "some" с прошлого замера
+    double interval_ms;
+} PsiEvent;
+
+typedef struct {
+    ProcFile files[PSI_RESOURCES];
+    int triggers[PSI_RESOURCES];
+    int trigger_count;
+    PressureStats stats[PSI_RESOURCES];
+    int available[PSI_RESOURCES];
+    int has_prev[PSI_RESOURCES];
+    double stall[PSI_RESOURCES];    // % за последний интервал по total
+    double peak[PSI_RESOURCES];     // максимум stall с прошлого take_peaks
+    struct timespec last_sample;
+    PsiEvent events[PSI_EVENT_HISTORY];
+    int event_count;
+    int event_next;
+    unsigned long wakeups;
+    char buffer[512];
+} PsiCollector;
+
+int psi_collector_init(PsiCollector *c, const char *pressure_root);
+void psi_collector_free(PsiCollector *c);
+int psi_collector_arm_triggers(PsiCollector *c, const char *pressure_root,
+                               long stall_us, long window_us);
+void psi_collector_update(PsiCollector *c, PsiResource r, const char *text, double elapsed_sec);
+void psi_collector_sample(PsiCollector *c);
+int psi_collector_wait(PsiCollector *c, int timeout_ms, int wake_fd);
+void psi_collector_take_peaks(PsiCollector *c, double *peaks);
+const char *psi_resource_name(PsiResource r);
+void write_pressure_json(JsonWriter *w, const PsiCollector *c);
+
+#endif
@@ -0,0 +1,284 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "quantile.h"
+
+static const struct {
+    const char *name;
+    size_t offset;
+} metrics[QUANTILE_METRICS] = {
+    {"cpu", offsetof(HistorySample, cpu_usage)},
+    {"memory", offsetof(HistorySample, memory_usage)},
+    {"gpu", offsetof(HistorySample, gpu_usage)},
+    {"gpu_memory", offsetof(HistorySample, gpu_memory)},
+    {"gpu_temperature", offsetof(HistorySample, gpu_temperature)},
+    {"disk_read", offsetof(HistorySample, disk_read)},
+    {"disk_write", offsetof(HistorySample, disk_write)},
+    {"net_rx", offsetof(HistorySample, net_rx)},
+    {"net_tx", offsetof(HistorySample, net_tx)},
+    {"psi_cpu", offsetof(HistorySample, psi_cpu)},
+    {"psi_memory", offsetof(HistorySample, psi_memory)},
+    {"psi_io", offsetof(HistorySample, psi_io)},
+};
+
+static const double gamma_ = (1.0 + QUANTILE_ACCURACY) / (1.0 - QUANTILE_ACCURACY);
+
+// -1 - значение меньше QUANTILE_MIN_VALUE
+static int bucket_of(double value) {
+    if (!(value >= QUANTILE_MIN_VALUE)) return -1;
+    int k = (int)ceil(log(value / QUANTILE_MIN_VALUE) / log(gamma_));
+    return k < QUANTILE_BUCKETS ? k : QUANTILE_BUCKETS - 1;
+}
+
+// Середина корзины: относительная ошибка не больше QUANTILE_ACCURACY
+static double bucket_value(int k) {
+    return QUANTILE_MIN_VALUE * 2.0 * pow(gamma_, k) / (gamma_ + 1.0);
+}
+
+void quantile_sketch_reset(QuantileSketch *s) {
+    memset(s, 0, sizeof(QuantileSketch));
+}
+
+void quantile_sketch_add(QuantileSketch *s, double value) {
+    if (!isfinite(value)) return;
+    int k = bucket_of(value);
+    if (k < 0) s->zero++;
+    else s->buckets[k]++;
+
+    if (s->count == 0 || value < s->min) s->min = value;
+    if (s->count == 0 || value > s->max) s->max = value;
+    s->sum += value;
+    s->count++;
+}
+
+void quantile_sketch_merge(QuantileSketch *s, const MinuteSketch *m) {
+    if (m->count == 0) return;
+    for (int i = 0; i < m->bin_count; i++) s->buckets[m->bins[i].bucket] += m->bins[i].count;
+
+    if (s->count == 0 || m->min < s->min) s->min = m->min;
+    if (s->count == 0 || m->max > s->max) s->max = m->max;
+    s->zero += m->zero;
+    s->sum += m->sum;
+    s->count += m->count;
+}
+
+// Значение ранга floor(q * (count - 1)) по возрастанию
+double quantile_sketch_value(const QuantileSketch *s, double q) {
+    if (s->count == 0) return 0.0;
+    if (q <= 0.0) return s->min;
+    if (q >= 1.0) return s->max;
+
+    unsigned long rank = (unsigned long)(q * (double)(s->count - 1));
+    if (rank < s->zero) return s->min > 0.0 ? s->min : 0.0;
+
+    unsigned long seen = s->zero;
+    for (int k = 0; k < QUANTILE_BUCKETS; k++) {
+        seen += s->buckets[k];
+        if (seen > rank) {
+            double v = bucket_value(k);
+            if (v < s->min) v = s->min;
+            if (v > s->max) v = s->max;
+            return v;
+        }
+    }
+    return s->max;
+}
+
+int quantile_store_init(QuantileStore *store, int interval_ms) {
+    int count = QUANTILE_METRICS * STATS_WINDOW_MINUTES;
+    store->minute_bins = QUANTILE_MINUTE_BINS(interval_ms > 0 ? interval_ms : UPDATE_INTERVAL_MS);
+    store->minutes = calloc(count, sizeof(MinuteSketch));
+    store->bins = calloc((size_t)count * store->minute_bins, sizeof(QuantileBin));
+    if (!store->minutes || !store->bins) {
+        free(store->minutes);
+        free(store->bins);
+        store->minutes = NULL;
+        store->bins = NULL;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) store->minutes[i].bins = store->bins + (size_t)i * store->minute_bins;
+    pthread_mutex_init(&store->mutex, NULL);
+    return 0;
+}
+
+void quantile_store_free(QuantileStore *store) {
+    free(store->minutes);
+    free(store->bins);
+    store->minutes = NULL;
+    store->bins = NULL;
+    pthread_mutex_destroy(&store->mutex);
+}
+
+static void minute_add_bucket(MinuteSketch *m, int k, int capacity) {
+    int nearest = -1;
+    for (int i = 0; i < m->bin_count; i++) {
+        if (m->bins[i].bucket == k) {
+            nearest = i;
+            break;
+        }
+        if (nearest < 0 || abs(m->bins[i].bucket - k) < abs(m->bins[nearest].bucket - k)) nearest = i;
+    }
+
+    if ((nearest < 0 || m->bins[nearest].bucket != k) && m->bin_count < capacity) {
+        m->bins[m->bin_count].bucket = (uint16_t)k;
+        m->bins[m->bin_count].count = 1;
+        m->bin_count++;
+    } else if (m->bins[nearest].count < UINT16_MAX) {
+        m->bins[nearest].count++;
+    }
+}
+
+static void minute_add(MinuteSketch *m, double value, int capacity) {
+    if (!isfinite(value)) return;
+    int k = bucket_of(value);
+    if (k < 0) m->zero++;
+    else minute_add_bucket(m, k, capacity);
+
+    if (m->count == 0 || value < m->min) m->min = value;
+    if (m->count == 0 || value > m->max) m->max = value;
+    m->sum += value;
+    m->count++;
+}
+
+void quantile_store_add(QuantileStore *store, const HistorySample *sample, long now) {
+    long minute = now / 60;
+    int slot = (int)(minute % STATS_WINDOW_MINUTES);
+
+    pthread_mutex_lock(&store->mutex);
+    for (int i = 0; i < QUANTILE_METRICS; i++) {
+        MinuteSketch *m = &store->minutes[i * STATS_WINDOW_MINUTES + slot];
+        if (m->minute != minute) {
+            QuantileBin *bins = m->bins;
+            memset(m, 0, sizeof(MinuteSketch));
+            m->bins = bins;
+            m->minute = minute;
+        }
+        minute_add(m, *(const double *)((const char *)sample + metrics[i].offset), store->minute_bins);
+    }
+    pthread_mutex_unlock(&store->mutex);
+}
+
+// Число минут с данными
+int quantile_store_window(QuantileStore *store, int metric, int minutes, long now, QuantileSketch *out) {
+    long current = now / 60;
+    int found = 0;
+
+    quantile_sketch_reset(out);
+    if (minutes > STATS_WINDOW_MINUTES) minutes = STATS_WINDOW_MINUTES;
+
+    pthread_mutex_lock(&store->mutex);
+    for (long minute = current - minutes + 1; minute <= current; minute++) {
+        const MinuteSketch *m = &store->minutes[metric * STATS_WINDOW_MINUTES +
+                                                minute % STATS_WINDOW_MINUTES];
+        if (m->minute != minute || m->count == 0) continue;
+        quantile_sketch_merge(out, m);
+        found++;
+    }
+    pthread_mutex_unlock(&store->mutex);
+    return found;
+}
+
+int quantile_metric_index(const char *name) {
+    for (int i = 0; i < QUANTILE_METRICS; i++) {
+        if (strcmp(name, metrics[i].name) == 0) return i;
+    }
+    return -1;
+}
+
+// "1h", "15m", "900s", "900" - в минутах, с округлением вверх
+static int parse_window(const char *s, int *minutes) {
+    char *end = NULL;
+    long v = strtol(s, &end, 10);
+    if (end == s || v <= 0) return -1;
+
+    long seconds;
+    if (*end == '\0' || strcmp(end, "s") == 0) seconds = v;
+    else if (strcmp(end, "m") == 0) seconds = v * 60;
+    else if (strcmp(end, "h") == 0) seconds = v * 3600;
+    else return -1;
+
+    long m = (seconds + 59) / 60;
+    if (m > STATS_WINDOW_MINUTES) return -1;
+    *minutes = (int)m;
+    return 0;
+}
+
+int parse_stats_query(const char *query_string, int *metric, int *minutes) {
+    *metric = -1;
+    *minutes = STATS_WINDOW_MINUTES;
+
+    const char *p = query_string;
+    while (p && *p) {
+        const char *end = strchr(p, '&');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        const char *eq = memchr(p, '=', len);
+
+        if (eq) {
+            size_t key_len = eq - p;
+            char value[32];
+            size_t value_len = len - key_len - 1;
+            if (value_len >= sizeof(value)) return -1;
+            memcpy(value, eq + 1, value_len);
+            value[value_len] = '\0';
+
+            if (key_len == 6 && strncmp(p, "metric", 6) == 0) {
+                *metric = quantile_metric_index(value);
+                if (*metric < 0) return -1;
+            } else if (key_len == 6 && strncmp(p, "window", 6) == 0) {
+                if (parse_window(value, minutes) != 0) return -1;
+            }
+        }
+
+        p = end ? end + 1 : NULL;
+    }
+
+    return *metric < 0 ? -1 : 0;
+}
+
+static void write_value(JsonWriter *w, double v) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.2f", v);
+    jw_raw(w, buf, n);
+}
+
+void write_stats_json(JsonWriter *w, QuantileStore *store, int metric, int minutes, long now) {
+    QuantileSketch *s = malloc(sizeof(QuantileSketch));
+    if (!s) {
+        w->overflow = 1;
+        return;
+    }
+    int found = quantile_store_window(store, metric, minutes, now, s);
+
+    jw_lit(w, "{\"metric\":");
+    jw_string(w, metrics[metric].name);
+    jw_lit(w, ",\"window\":");
+    jw_int(w, minutes * 60L);
+    jw_lit(w, ",\"minutes\":");
+    jw_int(w, found);
+    jw_lit(w, ",\"timestamp\":");
+    jw_int(w, now);
+    jw_lit(w, ",\"count\":");
+    jw_uint(w, s->count);
+    jw_lit(w, ",\"accuracy\":");
+    write_value(w, QUANTILE_ACCURACY);
+
+    if (s->count == 0) {
+        jw_lit(w, ",\"min\":null,\"mean\":null,\"p50\":null,\"p90\":null,\"p99\":null,\"max\":null}");
+    } else {
+        jw_lit(w, ",\"min\":");
+        write_value(w, s->min);
+        jw_lit(w, ",\"mean\":");
+        write_value(w, s->sum / s->count);
+        jw_lit(w, ",\"p50\":");
+        write_value(w, quantile_sketch_value(s, 0.50));
+        jw_lit(w, ",\"p90\":");
+        write_value(w, quantile_sketch_value(s, 0.90));
+        jw_lit(w, ",\"p99\":");
+        write_value(w, quantile_sketch_value(s, 0.99));
+        jw_lit(w, ",\"max\":");
+        write_value(w, s->max);
+        jw_char(w, '}');
+    }
+    free(s);
+}
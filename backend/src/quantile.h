@@ -0,0 +1,88 @@
+#ifndef QUANTILE_H
+#define QUANTILE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "config.h"
+#include "history.h"
+#include "json_writer.h"
+
+/*
+ * Квантили метрик истории за окно до часа (/api/stats) без хранения
+ * точек: на каждую метрику и минуту - лог-гистограмма в духе DDSketch.
+ * Корзина i покрывает (MIN * g^(i-1), MIN * g^i], g = (1+a)/(1-a), и ее
+ * середина отличается от любого попавшего в нее значения не больше чем
+ * на a. Значения меньше QUANTILE_MIN_VALUE (в том числе 0) считаются
+ * отдельно и отдаются как 0.
+ *
+ * Скетчи складываются покорзинно, поэтому окно - сумма последних
+ * минутных скетчей (текущая минута входит неполной). Минуты лежат в
+ * кольце по номеру минуты от эпохи: устаревшая ячейка очищается при
+ * первой записи в нее.
+ *
+ * За минуту точек немного (30 при тике 2 с), поэтому минута хранит
+ * только непустые корзины парами (корзина, счетчик): около 10 КБ на
+ * метрику за час против 14 КБ сырых точек. Корзины всех минут выделяются
+ * при инициализации под интервал тика (--interval-ms). Если непустых
+ * корзин больше (тик чаще интервала, например --replay-speed), точка
+ * добавляется в ближайшую занятую корзину.
+ * Окно суммируется в плотную гистограмму.
+ */
+
+#define QUANTILE_ACCURACY 0.01
+#define QUANTILE_MIN_VALUE 0.01
+#define QUANTILE_BUCKETS 1040           // до 1e7: КБ/с сети, МБ/с дисков
+#define QUANTILE_METRICS 12             // поля HistorySample
+#define QUANTILE_MINUTE_BINS(interval_ms) (60000 / (interval_ms) + 2)
+
+typedef struct {
+    uint16_t bucket;
+    uint16_t count;
+} QuantileBin;
+
+typedef struct {
+    long minute;                        // время / 60; 0 - пустая ячейка
+    unsigned int count;
+    unsigned int zero;
+    double sum;
+    double min;
+    double max;
+    int bin_count;
+    QuantileBin *bins;                  // QuantileStore.minute_bins штук
+} MinuteSketch;
+
+// Сумма минут окна
+typedef struct {
+    unsigned long count;
+    unsigned long zero;
+    double sum;
+    double min;
+    double max;
+    uint32_t buckets[QUANTILE_BUCKETS];
+} QuantileSketch;
+
+typedef struct QuantileStore {
+    MinuteSketch *minutes;              // [метрика][STATS_WINDOW_MINUTES]
+    QuantileBin *bins;
+    int minute_bins;
+    pthread_mutex_t mutex;
+} QuantileStore;
+
+void quantile_sketch_reset(QuantileSketch *s);
+void quantile_sketch_add(QuantileSketch *s, double value);
+void quantile_sketch_merge(QuantileSketch *s, const MinuteSketch *m);
+double quantile_sketch_value(const QuantileSketch *s, double q);
+
+int quantile_store_init(QuantileStore *store, int interval_ms);
+void quantile_store_free(QuantileStore *store);
+void quantile_store_add(QuantileStore *store, const HistorySample *sample, long now);
+int quantile_store_window(QuantileStore *store, int metric, int minutes, long now, QuantileSketch *out);
+
+// Имена - как в /api/history: cpu, memory, gpu, ..., psi_io
+int quantile_metric_index(const char *name);
+
+// metric=cpu&window=1h (30m, 900s, 900); окно - целые минуты до STATS_WINDOW_MINUTES
+int parse_stats_query(const char *query_string, int *metric, int *minutes);
+void write_stats_json(JsonWriter *w, QuantileStore *store, int metric, int minutes, long now);
+
+#endif
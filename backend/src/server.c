@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -11,27 +12,293 @@
 #include <ifaddrs.h>
 #include <netdb.h>
 #include <stdarg.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
 #include "config.h"
 #include "proc_parser.h"
 #include "json_formatter.h"
 #include "history.h"
+#include "process_history.h"
+#include "process_detail.h"
+#include "snapshot_binary.h"
+#include "process_table.h"
+#include "cgroup_collector.h"
+#include "disk_collector.h"
+#include "net_collector.h"
+#include "psi_collector.h"
+#include "topology.h"
+#include "capture.h"
+#include "asset_cache.h"
+#include "fleet.h"
+#include "exporter.h"
+#include "alerts.h"
+#include "quantile.h"
+#include "collector.h"
+#include "async_sampler.h"
+#include "command.h"
+#include "demand.h"
 
-static int server_socket = -1;
 static pthread_t update_thread;
 static volatile int running = 1;
 static pthread_mutex_t data_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-#define JSON_BUFFER_SIZE 65536
+#define JSON_BUFFER_SIZE 262144
 #define HISTORY_BUFFER_SIZE 16384
 
-static char system_json[JSON_BUFFER_SIZE];
-static char history_json[HISTORY_BUFFER_SIZE];
+// Опубликованный снимок: воркеры берут ссылку и отправляют его без
+// data_mutex, тик собирает следующий и подменяет указатель
+typedef struct {
+    int refs;
+    unsigned long generation;   // номер тика: ETag ответов из снимка
+    int system_len;
+    int bin_len;
+    int history_len;
+    char system_json[JSON_BUFFER_SIZE];
+    unsigned char system_bin[JSON_BUFFER_SIZE];
+    char history_json[HISTORY_BUFFER_SIZE];
+    HistoryData history;        // для /api/history?points=N
+} PublishedSnapshot;
+
+static pthread_mutex_t snapshot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PublishedSnapshot *published_snapshot = NULL;
+static PublishedSnapshot *spare_snapshots[2];
+
+// Готовый JSON одного эндпоинта: воркер берет ссылку и отправляет без блокировки,
+// поток сбора пишет следующий в другой буфер. Счетчики - под snapshot_mutex
+typedef struct {
+    int refs;
+    JsonWriter json;
+} PublishedJson;
+
+typedef struct {
+    PublishedJson *published;
+    PublishedJson *spare;
+    size_t capacity;
+} PublishedJsonSlot;
+
+// Неотправленный остаток ответа: дописывается по EPOLLOUT
+typedef struct {
+    char *data;
+    size_t len;
+    size_t sent;
+    size_t cap;
+    int failed;
+} OutputQueue;
+
+// Соединение в epoll воркера: ждет запрос (или остаток пришедшего не целиком,
+// request != NULL), дописывает ответ или простаивает по keep-alive (idle)
+typedef struct {
+    int fd;
+    int slot;                   // индекс в ServerWorker.connections
+    int served;                 // уже был ответ - соединение занимает слот keep-alive
+    int idle;
+    int close_after;            // закрыть, когда уйдет output
+    time_t last_active;
+    char *request;              // BUFFER_SIZE байт
+    int len;
+    OutputQueue output;
+} Connection;
+
+// Воркер: свой SO_REUSEPORT-сокет и epoll, ядро раздает соединения между ними.
+// Новые соединения отслеживаются всегда, KEEPALIVE_MAX_PER_WORKER ограничивает
+// только оставленные открытыми после ответа
+typedef struct {
+    int id;
+    int socket;
+    int cpu;                    // -1: без привязки
+    pthread_t thread;
+    unsigned long requests;
+    Connection **connections;
+    int connection_count;
+    int connection_cap;
+    int kept_count;             // простаивающие keep-alive
+} ServerWorker;
+
+static ServerWorker workers[MAX_WORKERS];
+static int worker_count = 1;
+static int worker_cpus[MAX_WORKERS];
+static int worker_cpu_count = 0;
+static int listen_backlog = LISTEN_BACKLOG;
+static int stop_event = -1;
+
+// Время старта в ETag: после перезапуска номера тиков начинаются заново
+static long server_epoch = 0;
+
+// Keep-alive решается на запрос: воркер разрешает его, пока есть слоты
+static __thread int keep_alive_allowed = 0;
+static __thread int keep_alive = 0;
+// Очередь ответа текущего соединения воркера; NULL - блокирующая запись (handle_client)
+static __thread OutputQueue *response_output = NULL;
+
+// --aggregate: опрос агентов парка, NULL - обычный режим
+static Fleet *fleet = NULL;
+static const char *fleet_hosts_path = NULL;
+
+// --export: push-экспорт тиков, NULL - выключен
+static Exporter *exporter = NULL;
+static const char *export_url = NULL;
+static ExportFormat export_format = EXPORT_INFLUX;
+
+// --alerts: пороговые правила, NULL - выключены
+static AlertEngine *alerts = NULL;
+static const char *alert_rules_path = NULL;
+static const char *alert_webhook_url = NULL;
+
+// Сбор процессов и GPU по спросу клиентов (--demand-idle)
+static DemandTracker demand;
+static long demand_idle_ms = DEMAND_IDLE_MS;
+
+// frontend/ в памяти; count == 0 - отдается встроенная страница
+static AssetCache frontend_assets;
+static const char *frontend_dir = NULL;
 
 static CPUStats cpu_prev, cpu_curr;
-static CPUStats cores_prev[MAX_CORES], cores_curr[MAX_CORES];
-static GPUInfo gpu_info;
+static CoreStats cores;
+static GPUInfo gpu_info = {.name = "No GPU"};
+static AsyncSampler gpu_sampler;
 static HistoryData system_history;
-static int cores_count = 0;
+static QuantileStore system_quantiles;
+static ProcessHistoryStore process_history;
+static ProcessTable process_tables[2];
+static ProcessTable *published_processes = NULL;
+static CgroupCollector *cgroups = NULL;
+static PublishedJsonSlot cgroups_json = {.capacity = 16384};
+
+// Коллекторы тика (--disable, POST /api/collectors/<имя>/disable);
+// /api/collectors отдает копию, которую поток сбора пишет после тика
+static CollectorRegistry collectors;
+static Collector *cpu_collector, *memory_collector, *gpu_collector;
+static Collector *processes_collector, *disks_collector, *network_collector;
+static ProcessTable *process_back = NULL;
+static PublishedJsonSlot collectors_json = {.capacity = 2048};
+
+// Расписание тиков для /api/health: под нагрузкой видно, не отстает ли сбор
+static int update_interval_ms = UPDATE_INTERVAL_MS;
+static unsigned long tick_count = 0;
+static double tick_interval_ms = 0.0;
+static double tick_duration_ms = 0.0;
+static double tick_max_lag_ms = 0.0;
+static DiskCollector disks;
+static NetCollector network;
+static int network_skip_virtual = NET_SKIP_VIRTUAL;
+static ProcessDetailCollector process_details;
+static PsiCollector pressure;
+static Topology topology;
+static MemoryInfo mem_info;
+static int pressure_available = 0;
+static int psi_triggers_enabled = 0;
+static int watch_pids[PROC_DETAIL_WATCH_MAX];
+static int watch_count = 0;
+
+// Буферы снимка переиспользуются: malloc на 500 КБ каждый тик - это mmap
+static PublishedSnapshot *snapshot_alloc(void) {
+    PublishedSnapshot *s = NULL;
+    
+    pthread_mutex_lock(&snapshot_mutex);
+    for (int i = 0; i < 2 && !s; i++) {
+        s = spare_snapshots[i];
+        spare_snapshots[i] = NULL;
+    }
+    pthread_mutex_unlock(&snapshot_mutex);
+    
+    return s ? s : malloc(sizeof(PublishedSnapshot));
+}
+
+static void snapshot_unref_locked(PublishedSnapshot *s) {
+    if (--s->refs > 0) return;
+    for (int i = 0; i < 2; i++) {
+        if (!spare_snapshots[i]) {
+            spare_snapshots[i] = s;
+            return;
+        }
+    }
+    free(s);
+}
+
+static PublishedSnapshot *snapshot_acquire(void) {
+    pthread_mutex_lock(&snapshot_mutex);
+    PublishedSnapshot *s = published_snapshot;
+    if (s) s->refs++;
+    pthread_mutex_unlock(&snapshot_mutex);
+    return s;
+}
+
+static void snapshot_release(PublishedSnapshot *s) {
+    if (!s) return;
+    pthread_mutex_lock(&snapshot_mutex);
+    snapshot_unref_locked(s);
+    pthread_mutex_unlock(&snapshot_mutex);
+}
+
+// Опубликованный снимок держит одну ссылку, пока его не сменит следующий
+static void snapshot_publish(PublishedSnapshot *s) {
+    s->refs = 1;
+    pthread_mutex_lock(&snapshot_mutex);
+    PublishedSnapshot *old = published_snapshot;
+    published_snapshot = s;
+    if (old) snapshot_unref_locked(old);
+    pthread_mutex_unlock(&snapshot_mutex);
+}
+
+static void published_json_unref_locked(PublishedJsonSlot *slot, PublishedJson *j) {
+    if (--j->refs > 0) return;
+    if (!slot->spare) {
+        slot->spare = j;
+        return;
+    }
+    jw_free(&j->json);
+    free(j);
+}
+
+// Буфер для записи следующего JSON: запасной, если его уже никто не читает
+static PublishedJson *published_json_alloc(PublishedJsonSlot *slot) {
+    pthread_mutex_lock(&snapshot_mutex);
+    PublishedJson *j = slot->spare;
+    slot->spare = NULL;
+    pthread_mutex_unlock(&snapshot_mutex);
+    
+    if (!j) {
+        j = malloc(sizeof(PublishedJson));
+        if (!j) return NULL;
+        jw_init(&j->json, slot->capacity);
+    }
+    j->refs = 1;
+    jw_reset(&j->json);
+    return j;
+}
+
+static PublishedJson *published_json_acquire(PublishedJsonSlot *slot) {
+    pthread_mutex_lock(&snapshot_mutex);
+    PublishedJson *j = slot->published;
+    if (j) j->refs++;
+    pthread_mutex_unlock(&snapshot_mutex);
+    return j;
+}
+
+static void published_json_release(PublishedJsonSlot *slot, PublishedJson *j) {
+    if (!j) return;
+    pthread_mutex_lock(&snapshot_mutex);
+    published_json_unref_locked(slot, j);
+    pthread_mutex_unlock(&snapshot_mutex);
+}
+
+// Ссылка вызывающего переходит к слоту; неполный JSON не публикуется
+static void published_json_publish(PublishedJsonSlot *slot, PublishedJson *j) {
+    pthread_mutex_lock(&snapshot_mutex);
+    if (j->json.overflow) {
+        published_json_unref_locked(slot, j);
+    } else {
+        PublishedJson *old = slot->published;
+        slot->published = j;
+        if (old) published_json_unref_locked(slot, old);
+    }
+    pthread_mutex_unlock(&snapshot_mutex);
+}
 
 void calculate_cpu_usage(CPUStats *prev, CPUStats *curr) {
     if (!prev || !curr) return;
@@ -48,135 +315,869 @@ void calculate_cpu_usage(CPUStats *prev, CPUStats *curr) {
     }
 }
 
+// До следующего тика ждем на PSI-триггерах: всплеск давления дает
+// внеочередной замер PSI, а базовый интервал остается прежним.
+// Возвращает реально прошедшее время - на него делятся счетчики коллекторов
+static double wait_next_tick(struct timespec *tick_prev) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += update_interval_ms / 1000;
+    deadline.tv_nsec += (update_interval_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    while (running) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long remaining_ms = (deadline.tv_sec - now.tv_sec) * 1000 +
+                            (deadline.tv_nsec - now.tv_nsec) / 1000000;
+        if (remaining_ms <= 0) break;
+        // запрос к устаревшей секции будит сбор раньше срока
+        if (psi_collector_wait(&pressure, (int)remaining_ms, demand.wake_fd) & PSI_WAKE) break;
+    }
+    
+    struct timespec tick_now;
+    clock_gettime(CLOCK_MONOTONIC, &tick_now);
+    double elapsed = (tick_now.tv_sec - tick_prev->tv_sec) +
+                     (tick_now.tv_nsec - tick_prev->tv_nsec) / 1e9;
+    *tick_prev = tick_now;
+    return elapsed;
+}
+
+// cpu: /proc/stat целиком и по ядрам, загрузка NUMA-узлов.
+// Прошлый замер сдвигается в начале sample, а не в конце тика
+static int cpu_collector_init(Collector *c) {
+    (void)c;
+    const char *sys = get_sys_root();
+    
+    // колонки по числу возможных CPU, включая выключенные
+    if (core_stats_init(&cores, core_stats_possible_cpus(sys)) != 0) {
+        fprintf(stderr, "Failed to allocate per-core counters\n");
+        return -1;
+    }
+    if (read_cpu_stats(&cpu_curr, &cores) != 0) {
+        cpu_curr.total = 1000;
+        cpu_curr.idle = 800;
+    }
+    
+    // узлы, пакеты и SMT; при смене набора CPU пересканируется в тике
+    topology_init(&topology, sys);
+    topology_scan(&topology, &cores);
+    printf("🧩 Topology: %d NUMA node(s), %d package(s), %d cores, %d thread(s) per core\n",
+           topology.node_count, topology.package_count, topology.physical_cores, topology.smt);
+    return 0;
+}
+
+static void cpu_collector_sample(Collector *c, double elapsed) {
+    (void)c;
+    (void)elapsed;
+    memcpy(&cpu_prev, &cpu_curr, sizeof(CPUStats));
+    core_stats_rotate(&cores);
+    read_cpu_stats(&cpu_curr, &cores);
+    calculate_cpu_usage(&cpu_prev, &cpu_curr);
+    core_stats_compute(&cores);
+    topology_update(&topology, &cores);
+}
+
+static void cpu_collector_serialize(Collector *c, JsonWriter *w) {
+    (void)c;
+    jw_lit(w, "{\"cores\":");
+    jw_int(w, cores.count);
+    jw_lit(w, ",\"numa_nodes\":");
+    jw_int(w, topology.node_count);
+    jw_char(w, '}');
+}
+
+static void cpu_collector_teardown(Collector *c) {
+    (void)c;
+    topology_free(&topology);
+    core_stats_free(&cores);
+}
+
+static void memory_collector_sample(Collector *c, double elapsed) {
+    (void)c;
+    (void)elapsed;
+    read_memory_info(&mem_info);
+}
+
+// gpu: nvidia-smi в потоке gpu_sampler с дедлайном GPU_COMMAND_TIMEOUT_MS;
+// тик только забирает последний готовый замер и просит следующий.
+// Без nvidia-smi в PATH коллектор недоступен и не стоит ни одного fork
+static int gpu_sample_worker(void *ctx, void *out) {
+    (void)ctx;
+    return read_gpu_info(out);
+}
+
+static int gpu_collector_init(Collector *c) {
+    (void)c;
+    if (!gpu_probe()) return -1;
+    if (async_sampler_start(&gpu_sampler, "GPU", gpu_sample_worker, NULL,
+                            sizeof(GPUInfo), GPU_WATCHDOG_MS) != 0) {
+        return -1;
+    }
+    async_sampler_request(&gpu_sampler);
+    return 0;
+}
+
+static void gpu_collector_sample(Collector *c, double elapsed) {
+    (void)elapsed;
+    long sample_ms;
+    if (async_sampler_take(&gpu_sampler, &gpu_info, &sample_ms)) {
+        c->data_ms = sample_ms;
+        c->has_data = 1;
+    }
+    async_sampler_request(&gpu_sampler);
+}
+
+static void gpu_collector_serialize(Collector *c, JsonWriter *w) {
+    (void)c;
+    jw_lit(w, "{\"name\":");
+    jw_string(w, gpu_info.name);
+    jw_lit(w, ",\"worker\":");
+    write_async_sampler_json(w, &gpu_sampler);
+    jw_lit(w, ",\"stuck_commands\":");
+    jw_int(w, command_stuck_count());
+    jw_char(w, '}');
+}
+
+static void gpu_collector_teardown(Collector *c) {
+    (void)c;
+    async_sampler_stop(&gpu_sampler);
+    memset(&gpu_info, 0, sizeof(GPUInfo));
+    strcpy(gpu_info.name, "No GPU");
+}
+
+// processes: обход /proc в свободную из двух таблиц
+static void processes_collector_sample(Collector *c, double elapsed) {
+    (void)c;
+    get_processes(process_back->rows, &process_back->count);
+    process_detail_sample(&process_details, process_back->rows, process_back->count, elapsed);
+    process_back->timestamp = (long)time(NULL);
+    process_back->collected_ms = demand_now_ms();
+    process_table_build_indices(process_back);
+}
+
+static void processes_collector_serialize(Collector *c, JsonWriter *w) {
+    (void)c;
+    const ProcessCache *cache = get_process_cache();
+    jw_lit(w, "{\"limit\":");
+    jw_int(w, get_process_limit());
+    if (cache) {
+        jw_lit(w, ",\"cache_hits\":");
+        jw_uint(w, cache->hits);
+        jw_lit(w, ",\"cache_misses\":");
+        jw_uint(w, cache->misses);
+    }
+    jw_char(w, '}');
+}
+
+static int disks_collector_init(Collector *c) {
+    (void)c;
+    char path[512], block[512];
+    snprintf(path, sizeof(path), "%s/diskstats", get_proc_root());
+    snprintf(block, sizeof(block), "%s/block", get_sys_root());
+    disk_collector_init(&disks, path, block);
+    disk_collector_sample(&disks, 0.0);
+    return 0;
+}
+
+static void disks_collector_sample(Collector *c, double elapsed) {
+    (void)c;
+    disk_collector_sample(&disks, elapsed);
+}
+
+static void disks_collector_serialize(Collector *c, JsonWriter *w) {
+    (void)c;
+    jw_lit(w, "{\"devices\":");
+    jw_int(w, disks.count);
+    jw_char(w, '}');
+}
+
+static void disks_collector_teardown(Collector *c) {
+    (void)c;
+    disk_collector_free(&disks);
+}
+
+static int network_collector_init(Collector *c) {
+    (void)c;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/net/dev", get_proc_root());
+    net_collector_init(&network, path, network_skip_virtual);
+    net_collector_sample(&network, 0.0);
+    return 0;
+}
+
+static void network_collector_sample(Collector *c, double elapsed) {
+    (void)c;
+    net_collector_sample(&network, elapsed);
+}
+
+static void network_collector_serialize(Collector *c, JsonWriter *w) {
+    (void)c;
+    jw_lit(w, "{\"interfaces\":");
+    jw_int(w, network.count);
+    jw_char(w, '}');
+}
+
+static void network_collector_teardown(Collector *c) {
+    (void)c;
+    net_collector_free(&network);
+}
+
+static const CollectorOps collector_table[] = {
+    {"cpu", 1, cpu_collector_init, cpu_collector_sample, cpu_collector_serialize, cpu_collector_teardown, 0},
+    {"memory", 1, NULL, memory_collector_sample, NULL, NULL, 0},
+    {"gpu", 0, gpu_collector_init, gpu_collector_sample, gpu_collector_serialize, gpu_collector_teardown, 1},
+    {"processes", 0, NULL, processes_collector_sample, processes_collector_serialize, NULL, 0},
+    {"disks", 0, disks_collector_init, disks_collector_sample, disks_collector_serialize,
+     disks_collector_teardown, 0},
+    {"network", 0, network_collector_init, network_collector_sample, network_collector_serialize,
+     network_collector_teardown, 0},
+};
+
+static void register_collectors(void) {
+    if (collectors.count > 0) return;
+    for (size_t i = 0; i < sizeof(collector_table) / sizeof(collector_table[0]); i++) {
+        collector_register(&collectors, &collector_table[i], NULL);
+    }
+    cpu_collector = collector_find(&collectors, "cpu");
+    memory_collector = collector_find(&collectors, "memory");
+    gpu_collector = collector_find(&collectors, "gpu");
+    processes_collector = collector_find(&collectors, "processes");
+    disks_collector = collector_find(&collectors, "disks");
+    network_collector = collector_find(&collectors, "network");
+}
+
+// Возраст данных активных коллекторов для снимка; hung - воркер gpu завис.
+// Асинхронный замер забирается тиком позже запроса, ему - лишний интервал
+static int collector_section_ages(SectionAge *out, long now_ms, int gpu_hung) {
+    int n = 0;
+    for (int i = 0; i < collectors.count; i++) {
+        Collector *c = &collectors.items[i];
+        if (!c->active) continue;
+        long stale_ms = (SECTION_STALE_TICKS + (c->ops->async ? 1 : 0)) * (long)update_interval_ms;
+        out[n].name = c->ops->name;
+        out[n].age_ms = c->has_data ? now_ms - c->data_ms : -1;
+        out[n].stale = !c->has_data || out[n].age_ms > stale_ms || (c == gpu_collector && gpu_hung);
+        n++;
+    }
+    return n;
+}
+
+// Возраст опубликованной таблицы процессов (под data_mutex): при сборе по
+// спросу она обновляется не каждый тик, и ответ показывает, насколько отстал
+static long processes_age_ms(int *stale) {
+    long collected_ms = published_processes ? published_processes->collected_ms : 0;
+    long age_ms = collected_ms > 0 ? demand_now_ms() - collected_ms : -1;
+    *stale = age_ms < 0 || age_ms > SECTION_STALE_TICKS * (long)update_interval_ms;
+    return age_ms;
+}
+
 void *update_data_thread(void *arg) {
     (void)arg;
     
-    MemoryInfo mem;
-    ProcessInfo processes[MAX_PROCESSES];
-    int process_count = 0;
-    
     srand(time(NULL));
     
-    init_history(&system_history);
+    // Двойной буфер: пока одна таблица опубликована для запросов,
+    // следующий тик заполняет вторую
+    if (process_table_init(&process_tables[0], get_process_limit()) != 0 ||
+        process_table_init(&process_tables[1], get_process_limit()) != 0) {
+        fprintf(stderr, "Failed to allocate process tables\n");
+        return NULL;
+    }
+    process_back = &process_tables[0];
     
-    if (read_cpu_stats(&cpu_prev, cores_prev, &cores_count) != 0) {
-        cores_count = 4;
-        cpu_prev.total = 1000;
-        cpu_prev.idle = 800;
-        for (int i = 0; i < cores_count; i++) {
-            cores_prev[i].total = 250;
-            cores_prev[i].idle = 200;
-        }
+    // все пути коллекторов строятся от корней procfs/sysfs (--proc-root, --sys-root)
+    const char *proc = get_proc_root();
+    const char *sys = get_sys_root();
+    char path[512];
+    
+    // cgroup v2 может отсутствовать (v1 или нет прав) - тогда /api/cgroups недоступен
+    snprintf(path, sizeof(path), "%s/fs/cgroup", sys);
+    cgroups = malloc(sizeof(CgroupCollector));
+    if (cgroups && cgroup_collector_init(cgroups, path, proc) != 0) {
+        printf("cgroup v2 hierarchy not found, /api/cgroups disabled\n");
+        free(cgroups);
+        cgroups = NULL;
+    }
+    int tick = 0;
+    
+    process_detail_init(&process_details, proc, PROC_DETAIL_TOP_N);
+    
+    snprintf(path, sizeof(path), "%s/pressure", proc);
+    pressure_available = (psi_collector_init(&pressure, path) == 0);
+    if (!pressure_available) {
+        printf("PSI not available (%s), pressure disabled\n", path);
+    } else if (psi_triggers_enabled) {
+        int armed = psi_collector_arm_triggers(&pressure, path,
+                                               PSI_TRIGGER_STALL_US, PSI_TRIGGER_WINDOW_US);
+        printf("PSI triggers armed: %d\n", armed);
     }
+    for (int i = 0; i < watch_count; i++) {
+        process_detail_watch(&process_details, watch_pids[i]);
+    }
+    
+    struct timespec tick_prev;
+    clock_gettime(CLOCK_MONOTONIC, &tick_prev);
     
-    read_gpu_info(&gpu_info);
+    init_history(&system_history);
+    if (system_quantiles.minutes) system_history.quantiles = &system_quantiles;
+    init_process_history(&process_history);
     
-    memcpy(&cpu_curr, &cpu_prev, sizeof(CPUStats));
-    for (int i = 0; i < cores_count; i++) {
-        memcpy(&cores_curr[i], &cores_prev[i], sizeof(CPUStats));
+    // init включенных коллекторов; без cpu и memory снимок не собрать
+    collectors_sync(&collectors);
+    if (!cpu_collector->active || !memory_collector->active) {
+        collectors_teardown(&collectors);
+        return NULL;
     }
     
+    // кадр 0 записи: все, что коллекторы прочитали при инициализации
+    capture_end_tick(0.0);
+    
     while (running) {
-        usleep(UPDATE_INTERVAL_MS * 1000);
+        double elapsed;
+        if (capture_replaying()) {
+            // --replay: байты procfs и интервал берутся из записанного кадра
+            elapsed = capture_replay_next();
+            if (elapsed < 0) {
+                usleep(update_interval_ms * 1000);
+                elapsed = update_interval_ms / 1000.0;
+            }
+        } else {
+            elapsed = wait_next_tick(&tick_prev);
+            if (!running) break;
+        }
+        struct timespec collect_start;
+        clock_gettime(CLOCK_MONOTONIC, &collect_start);
+        
+        // включения и выключения с прошлого тика
+        collectors_sync(&collectors);
+        
+        // дорогие секции - только по спросу; экспорт - постоянный потребитель GPU
+        long demand_ms = demand_now_ms();
+        int collected = 0;
+        if (!published_processes ||
+            demand_should_collect(&demand, DEMAND_PROCESSES, tick_count + 1, demand_ms)) {
+            collected |= 1 << DEMAND_PROCESSES;
+        }
+        if (exporter || demand_should_collect(&demand, DEMAND_GPU, tick_count + 1, demand_ms)) {
+            collected |= 1 << DEMAND_GPU;
+        }
         
-        read_cpu_stats(&cpu_curr, cores_curr, &cores_count);
-        read_memory_info(&mem);
-        read_gpu_info(&gpu_info);
-        get_processes(processes, &process_count);
+        collector_run(cpu_collector, elapsed);
+        collector_run(memory_collector, elapsed);
+        if (collected & (1 << DEMAND_GPU)) {
+            collector_run(gpu_collector, elapsed);
+        }
+        collector_run(disks_collector, elapsed);
+        collector_run(network_collector, elapsed);
+        if (pressure_available) psi_collector_sample(&pressure);
         
-        calculate_cpu_usage(&cpu_prev, &cpu_curr);
-        for (int i = 0; i < cores_count; i++) {
-            calculate_cpu_usage(&cores_prev[i], &cores_curr[i]);
+        // пропущенный скан: снимок строится по последней опубликованной таблице;
+        // выключенный коллектор публикует пустую
+        ProcessTable *back = process_back;
+        ProcessTable *table = published_processes;
+        if (!processes_collector->active) {
+            back->count = 0;
+            back->collected_ms = 0;
+            table = back;
+            process_detail_skip(&process_details, elapsed);
+        } else if (collected & (1 << DEMAND_PROCESSES)) {
+            collector_run(processes_collector, elapsed);
+            table = back;
+        } else {
+            process_detail_skip(&process_details, elapsed);
         }
         
+        ProcessInfo *processes = table->rows;
+        int process_count = table->count;
+        
         double gpu_memory_percent = 0.0;
         if (gpu_info.memory_total > 0) {
             gpu_memory_percent = (double)gpu_info.memory_used / gpu_info.memory_total * 100.0;
         }
         
-        add_to_history(&system_history, 
-                      cpu_curr.usage_percent,
-                      mem.percentage,
-                      gpu_info.usage,
-                      gpu_memory_percent,
-                      gpu_info.temperature);
+        HistorySample sample = {
+            .cpu_usage = cpu_curr.usage_percent,
+            .memory_usage = mem_info.percentage,
+            .gpu_usage = gpu_info.usage,
+            .gpu_memory = gpu_memory_percent,
+            .gpu_temperature = gpu_info.temperature
+        };
+        if (disks_collector->active) {
+            disk_collector_totals(&disks, &sample.disk_read, &sample.disk_write);
+            sample.disk_read /= 1024.0 * 1024.0;
+            sample.disk_write /= 1024.0 * 1024.0;
+        }
+        if (network_collector->active) {
+            net_collector_totals(&network, &sample.net_rx, &sample.net_tx);
+            sample.net_rx /= 1024.0;
+            sample.net_tx /= 1024.0;
+        }
+        double psi_peaks[PSI_RESOURCES];
+        psi_collector_take_peaks(&pressure, psi_peaks);
+        sample.psi_cpu = psi_peaks[PSI_CPU];
+        sample.psi_memory = psi_peaks[PSI_MEMORY];
+        sample.psi_io = psi_peaks[PSI_IO];
+        add_history_sample(&system_history, &sample);
+        if (alerts) {
+            alerts_evaluate(alerts, &sample, demand_now_ms(), (long)time(NULL));
+        }
+        
+        if (cgroups) {
+            if (++tick % CGROUP_RESCAN_TICKS == 0) {
+                cgroup_collector_scan(cgroups);
+            }
+            cgroup_collector_sample(cgroups, elapsed, (long)time(NULL));
+            cgroup_attribute_processes(cgroups, processes, process_count);
+            
+            PublishedJson *cgroups_next = published_json_alloc(&cgroups_json);
+            if (cgroups_next) {
+                write_cgroups_json(&cgroups_next->json, cgroups);
+                published_json_publish(&cgroups_json, cgroups_next);
+            }
+        }
+        capture_end_tick(elapsed);
+        
+        // сторож GPU-воркера: зависание видно в снимке, тик его не ждет
+        int gpu_hung = gpu_collector->active && async_sampler_watchdog(&gpu_sampler, demand_now_ms());
+        SectionAge sections[MAX_COLLECTORS];
+        int section_count = collector_section_ages(sections, demand_now_ms(), gpu_hung);
+        
+        SnapshotExtras extras = {
+            .disks = disks_collector->active ? &disks : NULL,
+            .network = network_collector->active ? &network : NULL,
+            .pressure = pressure_available ? &pressure : NULL,
+            .topology = &topology,
+            .sections = sections,
+            .section_count = section_count
+        };
+        
+        PublishedJson *collectors_next = published_json_alloc(&collectors_json);
+        if (collectors_next) {
+            write_collectors_json(&collectors_next->json, &collectors);
+            published_json_publish(&collectors_json, collectors_next);
+        }
         
         pthread_mutex_lock(&data_mutex);
         
-        format_system_info_json(system_json, sizeof(system_json),
-                               &cpu_curr, cores_curr, cores_count,
-                               &mem, &gpu_info, processes, process_count);
+        published_processes = table;
         
-        get_history_json(history_json, sizeof(history_json), &system_history);
+        if (table == back) {
+            update_process_history(&process_history, processes, process_count,
+                                   PROC_HISTORY_TOP_N, (long)time(NULL));
+        }
         
         pthread_mutex_unlock(&data_mutex);
         
-        memcpy(&cpu_prev, &cpu_curr, sizeof(CPUStats));
-        for (int i = 0; i < cores_count; i++) {
-            memcpy(&cores_prev[i], &cores_curr[i], sizeof(CPUStats));
+        // снимок читает только данные этого потока, поэтому собирается без блокировки
+        PublishedSnapshot *next = snapshot_alloc();
+        if (next) {
+            format_system_info_json(next->system_json, sizeof(next->system_json),
+                                   &cpu_curr, &cores,
+                                   &mem_info, &gpu_info, processes, process_count, &extras);
+            next->system_len = strlen(next->system_json);
+            
+            next->bin_len = encode_system_info_binary(next->system_bin, sizeof(next->system_bin),
+                                                      &cpu_curr, &cores,
+                                                      &mem_info, &gpu_info, processes, process_count);
+            
+            get_history_json(next->history_json, sizeof(next->history_json), &system_history);
+            next->history_len = strlen(next->history_json);
+            next->history = system_history;
+            
+            next->generation = tick_count + 1;
+            snapshot_publish(next);
+        }
+        
+        // только кодирование и копия в очередь, отправляет поток экспорта
+        if (exporter) {
+            exporter_push_tick(exporter, &cpu_curr, &mem_info, &gpu_info, &extras);
+        }
+        
+        pthread_mutex_lock(&data_mutex);
+        struct timespec collect_end;
+        clock_gettime(CLOCK_MONOTONIC, &collect_end);
+        tick_count++;
+        tick_interval_ms = elapsed * 1000.0;
+        tick_duration_ms = (collect_end.tv_sec - collect_start.tv_sec) * 1000.0 +
+                           (collect_end.tv_nsec - collect_start.tv_nsec) / 1e6;
+        // при воспроизведении интервал записанный, отставание не считается
+        if (!capture_replaying() && tick_count > 1 &&
+            tick_interval_ms - update_interval_ms > tick_max_lag_ms) {
+            tick_max_lag_ms = tick_interval_ms - update_interval_ms;
+        }
+        
+        pthread_mutex_unlock(&data_mutex);
+        
+        // снимок уже опубликован: ждущие запросы получат свежие данные
+        demand_collected(&demand, collected, tick_count, demand_now_ms());
+        
+        if (table == back) {
+            process_back = (back == &process_tables[0]) ? &process_tables[1] : &process_tables[0];
         }
     }
     
+    collectors_teardown(&collectors);
     return NULL;
 }
 
-void send_http_response(int client_socket, int status, const char* content_type, const char* body) {
-    char response[8192];
+// Вызывается до start_server
+void set_network_skip_virtual(int skip) {
+    network_skip_virtual = skip;
+}
+
+// Вызывается до start_server; 0 - собирать все секции каждый тик
+void set_demand_idle(long idle_ms) {
+    demand_idle_ms = idle_ms;
+}
+
+// Вызывается до start_server
+void set_psi_triggers(int enabled) {
+    psi_triggers_enabled = enabled;
+}
+
+// Вызывается до start_server: процессы, для которых всегда идет расширенный скан
+int add_process_watch(int pid) {
+    if (pid <= 0 || watch_count >= PROC_DETAIL_WATCH_MAX) return -1;
+    watch_pids[watch_count++] = pid;
+    return 0;
+}
+
+static const char *connection_header(void) {
+    return keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+}
+
+static int write_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n <= 0) return -1;
+        
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+static void output_reset(OutputQueue *q) {
+    free(q->data);
+    memset(q, 0, sizeof(*q));
+}
+
+static int output_pending(const OutputQueue *q) {
+    return q && q->sent < q->len;
+}
+
+static int output_append(OutputQueue *q, const char *data, size_t len) {
+    if (q->len + len > q->cap) {
+        size_t cap = q->cap ? q->cap : BUFFER_SIZE;
+        while (cap < q->len + len) cap *= 2;
+        char *grown = realloc(q->data, cap);
+        if (!grown) {
+            q->failed = 1;
+            return -1;
+        }
+        q->data = grown;
+        q->cap = cap;
+    }
+    memcpy(q->data + q->len, data, len);
+    q->len += len;
+    return 0;
+}
+
+// 1 - очередь ушла целиком, 0 - ждать EPOLLOUT, -1 - клиент пропал
+static int output_flush(int fd, OutputQueue *q) {
+    while (q->sent < q->len) {
+        ssize_t n = send(fd, q->data + q->sent, q->len - q->sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n <= 0) return -1;
+        q->sent += n;
+    }
+    output_reset(q);
+    return 1;
+}
+
+// Запись ответа. Сокет воркера неблокирующий: что не ушло сразу, копируется
+// в очередь соединения, и клиент, который не читает, не держит остальных
+static void response_writev(int fd, struct iovec *iov, int iovcnt, int flags) {
+    OutputQueue *q = response_output;
+    if (!q) {
+        write_all(fd, iov, iovcnt);
+        return;
+    }
+    if (q->failed) return;
+    
+    size_t done = 0;
+    if (!output_pending(q)) {
+        struct msghdr msg = {.msg_iov = iov, .msg_iovlen = iovcnt};
+        ssize_t n;
+        do {
+            n = sendmsg(fd, &msg, flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            q->failed = 1;
+            return;
+        }
+        if (n > 0) done = n;
+    }
+    
+    for (int i = 0; i < iovcnt; i++) {
+        size_t skip = done < iov[i].iov_len ? done : iov[i].iov_len;
+        done -= skip;
+        if (skip < iov[i].iov_len &&
+            output_append(q, (const char *)iov[i].iov_base + skip, iov[i].iov_len - skip) != 0) {
+            return;
+        }
+    }
+}
+
+static void response_send(int fd, const void *data, size_t len, int flags) {
+    struct iovec iov = {.iov_base = (void *)data, .iov_len = len};
+    response_writev(fd, &iov, 1, flags);
+}
+
+static void send_http_reply(int client_socket, int status, const char* content_type,
+                            const char* etag, const void* body, size_t body_length) {
+    char header[1024];
+    char etag_header[64] = "";
     const char* status_text;
     
+    if (etag) {
+        snprintf(etag_header, sizeof(etag_header), "ETag: %s\r\n", etag);
+    }
+    
     switch (status) {
         case 200: status_text = "OK"; break;
+        case 202: status_text = "Accepted"; break;
+        case 304: status_text = "Not Modified"; break;
+        case 400: status_text = "Bad Request"; break;
         case 404: status_text = "Not Found"; break;
+        case 403: status_text = "Forbidden"; break;
         case 405: status_text = "Method Not Allowed"; break;
+        case 409: status_text = "Conflict"; break;
         case 500: status_text = "Internal Server Error"; break;
         default: status_text = "Unknown"; break;
     }
     
-    int length = snprintf(response, sizeof(response),
+    int length = snprintf(header, sizeof(header),
         "HTTP/1.1 %d %s\r\n"
         "Content-Type: %s\r\n"
         "Access-Control-Allow-Origin: *\r\n"
-        "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+        "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
         "Access-Control-Allow-Headers: Content-Type, Accept, Origin, User-Agent\r\n"
         "Access-Control-Expose-Headers: Content-Length, Content-Type\r\n"
         "Access-Control-Max-Age: 86400\r\n"
-        "Vary: Origin\r\n"
+        "Vary: Origin, Accept\r\n"
+        "%s"
         "Content-Length: %ld\r\n"
-        "Connection: close\r\n"
-        "\r\n"
-        "%s",
+        "%s"
+        "\r\n",
         status,
         status_text,
         content_type,
-        (long)strlen(body),
-        body);
+        etag_header,
+        (long)body_length,
+        connection_header());
     
-    if (length >= (int)sizeof(response) - 1) {
-        response[sizeof(response) - 1] = '\0';
-        length = sizeof(response) - 1;
+    if (length <= 0 || length >= (int)sizeof(header)) {
+        return;
     }
     
-    send(client_socket, response, length, 0);
+    response_send(client_socket, header, length, body_length > 0 ? MSG_MORE : 0);
+    if (body_length > 0) {
+        response_send(client_socket, body, body_length, 0);
+    }
 }
 
-void handle_client(int client_socket) {
-    char request[4096];
-    char method[16], path[256], protocol[16];
+void send_http_body(int client_socket, int status, const char* content_type,
+                    const void* body, size_t body_length) {
+    send_http_reply(client_socket, status, content_type, NULL, body, body_length);
+}
+
+void send_http_response(int client_socket, int status, const char* content_type, const char* body) {
+    send_http_body(client_socket, status, content_type, body, strlen(body));
+}
+
+// Значение заголовка запроса (без учета регистра имени), 0 если найден
+static int get_request_header(const char* request, const char* name, char* value, int value_size) {
+    size_t name_len = strlen(name);
+    const char* line = strstr(request, "\r\n");
     
-    int bytes_read = recv(client_socket, request, sizeof(request) - 1, 0);
-    if (bytes_read <= 0) {
-        close(client_socket);
+    while (line) {
+        line += 2;
+        if (*line == '\r' || *line == '\0') break;
+        
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char* v = line + name_len + 1;
+            while (*v == ' ' || *v == '\t') v++;
+            
+            int n = 0;
+            while (v[n] && v[n] != '\r' && v[n] != '\n' && n < value_size - 1) n++;
+            memcpy(value, v, n);
+            value[n] = '\0';
+            return 0;
+        }
+        
+        line = strstr(line, "\r\n");
+    }
+    
+    return -1;
+}
+
+// Управление коллекторами без авторизации: только с этой машины и не из браузера.
+// Origin браузер ставит в любой POST, так чужая страница не дотянется до localhost
+static int control_request_allowed(int client_socket, const char* request) {
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    char origin[256];
+    
+    if (getpeername(client_socket, (struct sockaddr*)&peer, &peer_len) != 0) return 0;
+    if (get_request_header(request, "Origin", origin, sizeof(origin)) == 0) return 0;
+    
+    if (peer.ss_family == AF_INET) {
+        const struct sockaddr_in *in = (const struct sockaddr_in*)&peer;
+        return (ntohl(in->sin_addr.s_addr) >> 24) == 127;
+    }
+    if (peer.ss_family == AF_INET6) {
+        const struct in6_addr *a = &((const struct sockaddr_in6*)&peer)->sin6_addr;
+        return IN6_IS_ADDR_LOOPBACK(a) || (IN6_IS_ADDR_V4MAPPED(a) && a->s6_addr[12] == 127);
+    }
+    return peer.ss_family == AF_UNIX;
+}
+
+static int wants_binary_snapshot(const char* request) {
+    char accept[256];
+    if (get_request_header(request, "Accept", accept, sizeof(accept)) != 0) {
+        return 0;
+    }
+    return strstr(accept, SNAPSHOT_CONTENT_TYPE) != NULL;
+}
+
+// Статика из кэша: 304 по If-None-Match, gzip по Accept-Encoding.
+// Адреса с ?v= выдает переписанный index.html - их браузер кэширует надолго
+static void send_asset(int client_socket, const Asset *asset, const char *request,
+                       const char *path, int head_only) {
+    char value[256];
+    char header[512];
+    const AssetBody *body = &asset->plain;
+    const char *encoding = "";
+    
+    if (asset->gzip.data &&
+        get_request_header(request, "Accept-Encoding", value, sizeof(value)) == 0 &&
+        strstr(value, "gzip") && !strstr(value, "gzip;q=0")) {
+        body = &asset->gzip;
+        encoding = "Content-Encoding: gzip\r\n";
+    }
+    
+    char cache_control[64];
+    if (strstr(path, "?v=")) {
+        snprintf(cache_control, sizeof(cache_control), "public, max-age=%d, immutable", ASSET_MAX_AGE_SEC);
+    } else {
+        snprintf(cache_control, sizeof(cache_control), "no-cache");
+    }
+    
+    if (get_request_header(request, "If-None-Match", value, sizeof(value)) == 0 &&
+        (strstr(value, body->etag) || strcmp(value, "*") == 0)) {
+        int length = snprintf(header, sizeof(header),
+            "HTTP/1.1 304 Not Modified\r\n"
+            "ETag: %s\r\n"
+            "Cache-Control: %s\r\n"
+            "Vary: Accept-Encoding\r\n"
+            "%s"
+            "\r\n",
+            body->etag, cache_control, connection_header());
+        response_send(client_socket, header, length, 0);
         return;
     }
-    request[bytes_read] = '\0';
     
-    if (sscanf(request, "%s %s %s", method, path, protocol) != 3) {
-        printf("Invalid request format\n");
-        close(client_socket);
+    int length = snprintf(header, sizeof(header),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "%s"
+        "Content-Length: %ld\r\n"
+        "ETag: %s\r\n"
+        "Cache-Control: %s\r\n"
+        "Vary: Accept-Encoding\r\n"
+        "%s"
+        "\r\n",
+        asset->content_type, encoding, (long)body->len, body->etag, cache_control,
+        connection_header());
+    
+    if (head_only) {
+        response_send(client_socket, header, length, 0);
+    } else if (body->fd >= 0) {
+        // крупные файлы: заголовок с MSG_MORE и sendfile из memfd, пока сокет
+        // принимает; остаток уходит из памяти через очередь соединения
+        response_send(client_socket, header, length, MSG_MORE);
+        off_t offset = 0;
+        while ((size_t)offset < body->len && !output_pending(response_output)) {
+            if (sendfile(client_socket, body->fd, &offset, body->len - offset) <= 0) break;
+        }
+        if ((size_t)offset < body->len) {
+            response_send(client_socket, body->data + offset, body->len - offset, 0);
+        }
+    } else {
+        struct iovec iov[2] = {
+            {.iov_base = header, .iov_len = length},
+            {.iov_base = body->data, .iov_len = body->len},
+        };
+        response_writev(client_socket, iov, 2, 0);
+    }
+}
+
+// Соединение остается открытым только по явному "Connection: keep-alive"
+static int wants_keep_alive(const char* request) {
+    char value[64];
+    if (get_request_header(request, "Connection", value, sizeof(value)) != 0) {
+        return 0;
+    }
+    return strcasestr(value, "keep-alive") != NULL;
+}
+
+// Ответ из снимка: ETag по номеру тика, If-None-Match -> 304 без тела
+static void send_snapshot_body(int client_socket, const char* request, const PublishedSnapshot *s,
+                               char kind, const char* content_type, const void* body, size_t length) {
+    char etag[48];
+    char value[256];
+    
+    snprintf(etag, sizeof(etag), "\"%lx-%lu%c\"", server_epoch, s->generation, kind);
+    if (get_request_header(request, "If-None-Match", value, sizeof(value)) == 0 &&
+        strstr(value, etag)) {
+        send_http_reply(client_socket, 304, content_type, etag, NULL, 0);
         return;
     }
+    send_http_reply(client_socket, 200, content_type, etag, body, length);
+}
+
+// Путь совпадает с route с точностью до строки запроса
+static int path_matches(const char* path, const char* route) {
+    size_t n = strlen(route);
+    return strncmp(path, route, n) == 0 && (path[n] == '\0' || path[n] == '?');
+}
+
+// Один запрос; возвращает 1, если соединение можно оставить открытым
+// request - заголовки запроса целиком, с завершающим нулем
+static int serve_request(int client_socket, char *request) {
+    char method[16], path[256], protocol[16];
+    
+    keep_alive = 0;
+    if (sscanf(request, "%15s %255s %15s", method, path, protocol) != 3) {
+        printf("Invalid request format\n");
+        return 0;
+    }
     
     printf("Request: %s %s %s\n", method, path, protocol);
+    keep_alive = keep_alive_allowed && wants_keep_alive(request);
     
     if (strcmp(method, "OPTIONS") == 0) {
         printf("Processing CORS preflight request\n");
@@ -185,24 +1186,36 @@ void handle_client(int client_socket) {
         int length = snprintf(response, sizeof(response),
             "HTTP/1.1 200 OK\r\n"
             "Access-Control-Allow-Origin: *\r\n"
-            "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+            "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
             "Access-Control-Allow-Headers: Content-Type, Accept, Origin, User-Agent\r\n"
             "Access-Control-Expose-Headers: Content-Length, Content-Type\r\n"
             "Access-Control-Max-Age: 86400\r\n"
             "Vary: Origin\r\n"
             "Content-Length: 0\r\n"
-            "Connection: close\r\n"
-            "\r\n");
+            "%s"
+            "\r\n",
+            connection_header());
         
         if (length > 0) {
-            send(client_socket, response, length, 0);
+            response_send(client_socket, response, length, 0);
         }
-        close(client_socket);
-        return;
+        return keep_alive;
+    }
+    
+    if (strcmp(method, "HEAD") == 0 && frontend_assets.count > 0 &&
+        asset_cache_find(&frontend_assets, path)) {
+        send_asset(client_socket, asset_cache_find(&frontend_assets, path), request, path, 1);
+        return keep_alive;
     }
     
     if (strcmp(method, "GET") == 0) {
-        if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
+        const Asset *asset = frontend_assets.count > 0 ?
+            asset_cache_find(&frontend_assets, path) : NULL;
+        
+        if (asset) {
+            send_asset(client_socket, asset, request, path, 0);
+            
+        } else if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
             const char* html = 
                 "<!DOCTYPE html>\n"
                 "<html>\n"
@@ -227,8 +1240,16 @@ void handle_client(int client_socket) {
                 "            <p><strong>API Endpoints:</strong></p>\n"
                 "            <ul>\n"
                 "                <li><a href=\"/api/system\">GET /api/system</a> - System information (JSON)</li>\n"
+                "                <li><a href=\"/api/system.bin\">GET /api/system.bin</a> - System information (binary snapshot)</li>\n"
                 "                <li><a href=\"/api/history\">GET /api/history</a> - System history (JSON)</li>\n"
+                "                <li><a href=\"/api/processes?sort=rss&amp;limit=20\">GET /api/processes?sort=&amp;limit=&amp;filter=&amp;state=</a> - Process table (JSON)</li>\n"
+                "                <li><a href=\"/api/cgroups\">GET /api/cgroups</a> - cgroup v2 tree: CPU, memory, PSI (JSON)</li>\n"
                 "                <li><a href=\"/api/health\">GET /api/health</a> - Health check (JSON)</li>\n"
+                "                <li><a href=\"/api/stats?metric=cpu&amp;window=1h\">GET /api/stats</a> - p50/p90/p99/max over a window</li>\n"
+                "                <li><a href=\"/api/alerts\">GET /api/alerts</a> - Alert rules (--alerts)</li>\n"
+                "                <li><a href=\"/api/collectors\">GET /api/collectors</a> - Collectors and their cost; POST /api/collectors/&lt;name&gt;/enable|disable</li>\n"
+                "                <li><a href=\"/api/fleet\">GET /api/fleet?top=N</a> - Fleet rollup in --aggregate mode (JSON)</li>\n"
+                "                <li>GET /api/process/&lt;pid&gt;/history - Process CPU/RSS history (JSON)</li>\n"
                 "            </ul>\n"
                 "            <p><strong>Frontend:</strong> Open <code>frontend/index.html</code> in your browser</p>\n"
                 "        </div>\n"
@@ -244,52 +1265,296 @@ void handle_client(int client_socket) {
             
             send_http_response(client_socket, 200, "text/html; charset=utf-8", html);
             
-        } else if (strcmp(path, "/api/system") == 0) {
+        } else if (path_matches(path, "/api/system.bin") ||
+                   (path_matches(path, "/api/system") && wants_binary_snapshot(request))) {
+            printf("Serving binary system data\n");
+            demand_request(&demand, demand_parse_sections(strchr(path, '?')),
+                           DEMAND_MAX_AGE_TICKS * (long)update_interval_ms);
+            PublishedSnapshot *snapshot = snapshot_acquire();
+            
+            if (!snapshot || snapshot->bin_len <= 0) {
+                const char* error_json = "{\"error\":\"Data not ready yet\",\"timestamp\":0}";
+                send_http_response(client_socket, 200, "application/json", error_json);
+            } else {
+                send_snapshot_body(client_socket, request, snapshot, 'b', SNAPSHOT_CONTENT_TYPE,
+                                   snapshot->system_bin, snapshot->bin_len);
+            }
+            
+            snapshot_release(snapshot);
+            
+        } else if (path_matches(path, "/api/system")) {
             printf("Serving system data\n");
-            pthread_mutex_lock(&data_mutex);
+            demand_request(&demand, demand_parse_sections(strchr(path, '?')),
+                           DEMAND_MAX_AGE_TICKS * (long)update_interval_ms);
+            PublishedSnapshot *snapshot = snapshot_acquire();
             
-            if (strlen(system_json) == 0) {
+            if (!snapshot || snapshot->system_len == 0) {
                 const char* error_json = "{\"error\":\"Data not ready yet\",\"timestamp\":0}";
                 send_http_response(client_socket, 200, "application/json", error_json);
             } else {
-                send_http_response(client_socket, 200, "application/json", system_json);
+                send_snapshot_body(client_socket, request, snapshot, 's', "application/json",
+                                   snapshot->system_json, snapshot->system_len);
             }
             
-            pthread_mutex_unlock(&data_mutex);
+            snapshot_release(snapshot);
             
-        } else if (strcmp(path, "/api/history") == 0) {
+        } else if (strcmp(path, "/api/history") == 0 || strncmp(path, "/api/history?", 13) == 0) {
             printf("Serving history data\n");
-            pthread_mutex_lock(&data_mutex);
+            const char* query_string = strchr(path, '?');
+            int points = parse_history_points(query_string ? query_string + 1 : "");
+            PublishedSnapshot *snapshot = points < 0 ? NULL : snapshot_acquire();
             
-            if (strlen(history_json) == 0) {
+            if (points < 0) {
+                const char* error_json = "{\"error\":\"Invalid query: points=N, N > 0\"}";
+                send_http_response(client_socket, 400, "application/json", error_json);
+            } else if (!snapshot || snapshot->history_len == 0) {
                 const char* error_json = "{\"error\":\"History not ready yet\",\"timestamp\":0}";
                 send_http_response(client_socket, 200, "application/json", error_json);
+            } else if (points > 0) {
+                JsonWriter w;
+                jw_init(&w, HISTORY_BUFFER_SIZE);
+                write_history_downsampled_json(&w, &snapshot->history, points);
+                
+                if (w.overflow) {
+                    send_http_response(client_socket, 500, "application/json", "{\"error\":\"Out of memory\"}");
+                } else {
+                    send_http_body(client_socket, 200, "application/json", w.data, w.len);
+                }
+                jw_free(&w);
             } else {
-                send_http_response(client_socket, 200, "application/json", history_json);
+                send_snapshot_body(client_socket, request, snapshot, 'h', "application/json",
+                                   snapshot->history_json, snapshot->history_len);
             }
             
-            pthread_mutex_unlock(&data_mutex);
+            snapshot_release(snapshot);
+            
+        } else if (strcmp(path, "/api/processes") == 0 || strncmp(path, "/api/processes?", 15) == 0) {
+            ProcessQuery query;
+            const char* query_string = strchr(path, '?');
+            
+            if (parse_process_query(query_string ? query_string + 1 : "", &query) != 0) {
+                const char* error_json = "{\"error\":\"Invalid query: sort=cpu|rss|pid|name, limit>0, state=<char>\"}";
+                send_http_response(client_socket, 400, "application/json", error_json);
+            } else {
+                JsonWriter w;
+                jw_init(&w, 16384);
+                
+                demand_request(&demand, 1 << DEMAND_PROCESSES,
+                               DEMAND_MAX_AGE_TICKS * (long)update_interval_ms);
+                pthread_mutex_lock(&data_mutex);
+                if (published_processes) {
+                    int stale;
+                    long age_ms = processes_age_ms(&stale);
+                    write_processes_json(&w, published_processes, &query, age_ms, stale);
+                } else {
+                    jw_lit(&w, "{\"error\":\"Data not ready yet\",\"timestamp\":0}");
+                }
+                pthread_mutex_unlock(&data_mutex);
+                
+                if (w.overflow) {
+                    send_http_response(client_socket, 500, "application/json", "{\"error\":\"Out of memory\"}");
+                } else {
+                    send_http_body(client_socket, 200, "application/json", w.data, w.len);
+                }
+                jw_free(&w);
+            }
+            
+        } else if (strcmp(path, "/api/cgroups") == 0) {
+            printf("Serving cgroup data\n");
+            PublishedJson *cgroups_data = published_json_acquire(&cgroups_json);
+            
+            if (!cgroups_data) {
+                const char* error_json = cgroups ?
+                    "{\"error\":\"Data not ready yet\",\"timestamp\":0}" :
+                    "{\"error\":\"cgroup v2 hierarchy not available\"}";
+                send_http_response(client_socket, cgroups ? 200 : 404, "application/json", error_json);
+            } else {
+                send_http_body(client_socket, 200, "application/json",
+                               cgroups_data->json.data, cgroups_data->json.len);
+            }
+            
+            published_json_release(&cgroups_json, cgroups_data);
+            
+        } else if (strncmp(path, "/api/process/", 13) == 0) {
+            char *end = NULL;
+            long pid = strtol(path + 13, &end, 10);
+            
+            if (end == path + 13 || pid <= 0 || strcmp(end, "/history") != 0) {
+                const char* error_json = "{\"error\":\"Invalid process path\"}";
+                send_http_response(client_socket, 404, "application/json", error_json);
+            } else {
+                char process_json[HISTORY_BUFFER_SIZE];
+                
+                demand_request(&demand, 1 << DEMAND_PROCESSES,
+                               DEMAND_MAX_AGE_TICKS * (long)update_interval_ms);
+                pthread_mutex_lock(&data_mutex);
+                int stale;
+                long age_ms = processes_age_ms(&stale);
+                int found = get_process_history_json(process_json, sizeof(process_json),
+                                                     &process_history, (int)pid, age_ms, stale);
+                pthread_mutex_unlock(&data_mutex);
+                
+                send_http_response(client_socket, found == 0 ? 200 : 404,
+                                   "application/json", process_json);
+            }
+            
+        } else if (strcmp(path, "/api/fleet") == 0 || strncmp(path, "/api/fleet?", 11) == 0) {
+            const char* query_string = strchr(path, '?');
+            int top_n = parse_fleet_top(query_string ? query_string + 1 : "");
+            
+            if (!fleet) {
+                const char* error_json = "{\"error\":\"Not an aggregator (start with --aggregate hosts.txt)\"}";
+                send_http_response(client_socket, 404, "application/json", error_json);
+            } else if (top_n < 0) {
+                const char* error_json = "{\"error\":\"Invalid query: top=N, N > 0\"}";
+                send_http_response(client_socket, 400, "application/json", error_json);
+            } else {
+                if (top_n == 0) top_n = FLEET_TOP_N;
+                
+                JsonWriter w;
+                jw_init(&w, 16384);
+                write_fleet_json(&w, fleet, top_n, fleet_now_ms());
+                
+                if (w.overflow) {
+                    send_http_response(client_socket, 500, "application/json", "{\"error\":\"Out of memory\"}");
+                } else {
+                    send_http_body(client_socket, 200, "application/json", w.data, w.len);
+                }
+                jw_free(&w);
+            }
+            
+        } else if (strcmp(path, "/api/stats") == 0 || strncmp(path, "/api/stats?", 11) == 0) {
+            int metric, minutes;
+            const char* query_string = strchr(path, '?');
+            
+            if (!system_quantiles.minutes) {
+                send_http_response(client_socket, 500, "application/json", "{\"error\":\"Out of memory\"}");
+            } else if (parse_stats_query(query_string ? query_string + 1 : "", &metric, &minutes) != 0) {
+                const char* error_json = "{\"error\":\"Invalid query: metric=cpu|memory|gpu|gpu_memory|gpu_temperature|"
+                                         "disk_read|disk_write|net_rx|net_tx|psi_cpu|psi_memory|psi_io, window=1h|15m|900s (max 1h)\"}";
+                send_http_response(client_socket, 400, "application/json", error_json);
+            } else {
+                JsonWriter w;
+                jw_init(&w, 512);
+                write_stats_json(&w, &system_quantiles, metric, minutes, (long)time(NULL));
+                
+                if (w.overflow) {
+                    send_http_response(client_socket, 500, "application/json", "{\"error\":\"Out of memory\"}");
+                } else {
+                    send_http_body(client_socket, 200, "application/json", w.data, w.len);
+                }
+                jw_free(&w);
+            }
+            
+        } else if (strcmp(path, "/api/alerts") == 0) {
+            if (!alerts) {
+                const char* error_json = "{\"error\":\"Alerts disabled (start with --alerts rules.conf)\"}";
+                send_http_response(client_socket, 404, "application/json", error_json);
+            } else {
+                JsonWriter w;
+                jw_init(&w, 4096);
+                write_alerts_json(&w, alerts, demand_now_ms());
+                
+                if (w.overflow) {
+                    send_http_response(client_socket, 500, "application/json", "{\"error\":\"Out of memory\"}");
+                } else {
+                    send_http_body(client_socket, 200, "application/json", w.data, w.len);
+                }
+                jw_free(&w);
+            }
+            
+        } else if (strcmp(path, "/api/collectors") == 0) {
+            PublishedJson *collectors_data = published_json_acquire(&collectors_json);
+            
+            if (!collectors_data) {
+                send_http_response(client_socket, 200, "application/json",
+                                   "{\"error\":\"Data not ready yet\",\"timestamp\":0}");
+            } else {
+                send_http_body(client_socket, 200, "application/json",
+                               collectors_data->json.data, collectors_data->json.len);
+            }
+            
+            published_json_release(&collectors_json, collectors_data);
             
         } else if (strcmp(path, "/api/health") == 0) {
             printf("Serving health check\n");
-            char buffer[256];
+            char buffer[4096];
             time_t now = time(NULL);
             
-            int server_ok = (server_socket != -1) && running;
-            int data_ok = (strlen(system_json) > 0);
+            int server_ok = (worker_count > 0 && workers[0].socket != -1) && running;
+            PublishedSnapshot *snapshot = snapshot_acquire();
+            int data_ok = snapshot && snapshot->system_len > 0;
+            snapshot_release(snapshot);
             
-            snprintf(buffer, sizeof(buffer), 
+            pthread_mutex_lock(&data_mutex);
+            int len = snprintf(buffer, sizeof(buffer), 
                 "{\n"
                 "  \"status\": \"%s\",\n"
                 "  \"service\": \"system-monitor\",\n"
                 "  \"timestamp\": %ld,\n"
                 "  \"server_running\": %s,\n"
-                "  \"data_available\": %s\n"
-                "}",
+                "  \"data_available\": %s,\n"
+                "  \"tick_interval_target_ms\": %d,\n"
+                "  \"ticks\": %lu,\n"
+                "  \"tick_interval_ms\": %.1f,\n"
+                "  \"tick_duration_ms\": %.1f,\n"
+                "  \"tick_max_lag_ms\": %.1f,\n"
+                "  \"listen_backlog\": %d,\n"
+                "  \"workers\": [",
                 server_ok ? "ok" : "error",
                 (long)now,
                 server_ok ? "true" : "false",
-                data_ok ? "true" : "false");
+                data_ok ? "true" : "false",
+                update_interval_ms,
+                tick_count,
+                tick_interval_ms,
+                tick_duration_ms,
+                tick_max_lag_ms,
+                listen_backlog);
+            pthread_mutex_unlock(&data_mutex);
+            
+            // счетчики пишет только свой воркер, здесь - атомарное чтение
+            for (int i = 0; i < worker_count && len > 0 && len < (int)sizeof(buffer); i++) {
+                len += snprintf(buffer + len, sizeof(buffer) - len,
+                                "%s{\"id\": %d, \"cpu\": %d, \"requests\": %lu, \"connections\": %d, "
+                                "\"keepalive\": %d}",
+                                i ? ", " : "", workers[i].id, workers[i].cpu,
+                                __atomic_load_n(&workers[i].requests, __ATOMIC_RELAXED),
+                                __atomic_load_n(&workers[i].connection_count, __ATOMIC_RELAXED),
+                                __atomic_load_n(&workers[i].kept_count, __ATOMIC_RELAXED));
+            }
+            if (len > 0 && len < (int)sizeof(buffer)) {
+                len += snprintf(buffer + len, sizeof(buffer) - len, "]");
+            }
+            // target - строка из --export или config-файла: экранируется
+            if (exporter && len > 0 && len < (int)sizeof(buffer) - 32) {
+                JsonWriter w;
+                jw_init_fixed(&w, buffer + len, sizeof(buffer) - len - 4);
+                jw_lit(&w, ",\n  \"export\": {\"target\": ");
+                jw_string(&w, exporter->target);
+                jw_lit(&w, ", \"batches\": ");
+                jw_uint(&w, __atomic_load_n(&exporter->batches, __ATOMIC_RELAXED));
+                jw_lit(&w, ", \"dropped\": ");
+                jw_uint(&w, __atomic_load_n(&exporter->dropped, __ATOMIC_RELAXED));
+                jw_lit(&w, ", \"datagrams\": ");
+                jw_uint(&w, __atomic_load_n(&exporter->datagrams, __ATOMIC_RELAXED));
+                jw_lit(&w, ", \"bytes\": ");
+                jw_uint(&w, __atomic_load_n(&exporter->bytes, __ATOMIC_RELAXED));
+                jw_lit(&w, ", \"errors\": ");
+                jw_uint(&w, __atomic_load_n(&exporter->errors, __ATOMIC_RELAXED));
+                jw_char(&w, '}');
+                len = w.overflow ? -1 : len + (int)w.len;
+            }
+            if (len > 0 && len < (int)sizeof(buffer) - 32) {
+                len += snprintf(buffer + len, sizeof(buffer) - len, ",\n  \"demand\": ");
+                JsonWriter w;
+                jw_init_fixed(&w, buffer + len, sizeof(buffer) - len - 4);
+                write_demand_json(&w, &demand, demand_now_ms());
+                len = w.overflow ? -1 : len + (int)w.len;
+            }
+            if (len > 0 && len < (int)sizeof(buffer)) {
+                snprintf(buffer + len, sizeof(buffer) - len, "\n}");
+            }
             
             send_http_response(client_socket, 200, "application/json", buffer);
             
@@ -316,8 +1581,12 @@ void handle_client(int client_socket) {
                 "            <p>Available endpoints:</p>\n"
                 "            <ul>\n"
                 "                <li><code>/api/system</code> - System information</li>\n"
+                "                <li><code>/api/system.bin</code> - System information (binary)</li>\n"
                 "                <li><code>/api/history</code> - System history</li>\n"
+                "                <li><code>/api/processes</code> - Process table</li>\n"
+                "                <li><code>/api/cgroups</code> - cgroup tree</li>\n"
                 "                <li><code>/api/health</code> - Health check</li>\n"
+                "                <li><code>/api/process/&lt;pid&gt;/history</code> - Process history</li>\n"
                 "            </ul>\n"
                 "        </div>\n"
                 "    </div>\n"
@@ -329,6 +1598,30 @@ void handle_client(int client_socket) {
             send_http_response(client_socket, 404, "text/html; charset=utf-8", not_found_buffer);
         }
         
+    } else if (strcmp(method, "POST") == 0 && strncmp(path, "/api/collectors/", 16) == 0) {
+        // /api/collectors/<имя>/enable|disable: применится в начале следующего тика
+        char name[32], action[16];
+        int result = -1;
+        if (!control_request_allowed(client_socket, request)) {
+            printf("Collector control refused: not a local request\n");
+            send_http_response(client_socket, 403, "application/json",
+                               "{\"error\":\"Collector control is only allowed from localhost\"}");
+            return keep_alive;
+        }
+        if (sscanf(path + 16, "%31[^/]/%15s", name, action) == 2 &&
+            (strcmp(action, "enable") == 0 || strcmp(action, "disable") == 0)) {
+            result = collector_set_wanted(&collectors, name, strcmp(action, "enable") == 0);
+        }
+        if (result == 0) {
+            printf("Collector %s: %s requested\n", name, action);
+            send_http_response(client_socket, 202, "application/json", "{\"status\":\"accepted\"}");
+        } else if (result == -2) {
+            send_http_response(client_socket, 409, "application/json",
+                               "{\"error\":\"Collector is required and cannot be disabled\"}");
+        } else {
+            send_http_response(client_socket, 404, "application/json", "{\"error\":\"Unknown collector\"}");
+        }
+        
     } else {
         printf("405 Method Not Allowed: %s\n", method);
         const char* not_allowed = 
@@ -348,7 +1641,8 @@ void handle_client(int client_socket) {
             "        <h1>405 Method Not Allowed</h1>\n"
             "        <div class=\"warning\">\n"
             "            <p>The method <code>%s</code> is not allowed for the requested URL.</p>\n"
-            "            <p>This server only supports <code>GET</code> and <code>OPTIONS</code> methods.</p>\n"
+            "            <p>This server supports <code>GET</code> and <code>OPTIONS</code>; "
+            "<code>POST</code> only for <code>/api/collectors/&lt;name&gt;/enable|disable</code> from localhost.</p>\n"
             "        </div>\n"
             "    </div>\n"
             "</body>\n"
@@ -359,6 +1653,17 @@ void handle_client(int client_socket) {
         send_http_response(client_socket, 405, "text/html; charset=utf-8", not_allowed_buffer);
     }
     
+    return keep_alive;
+}
+
+void handle_client(int client_socket) {
+    char request[BUFFER_SIZE];
+    keep_alive_allowed = 0;
+    int bytes_read = recv(client_socket, request, sizeof(request) - 1, 0);
+    if (bytes_read > 0) {
+        request[bytes_read] = '\0';
+        serve_request(client_socket, request);
+    }
     close(client_socket);
 }
 
@@ -392,17 +1697,92 @@ char* get_local_ip() {
     return ip;
 }
 
-int start_server(int port) {
-    server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket < 0) {
+// Вызывается до start_server; format: "influx" или "statsd"
+int set_export_target(const char *url, const char *format) {
+    if (format && strcmp(format, "statsd") == 0) {
+        export_format = EXPORT_STATSD;
+    } else if (format && strcmp(format, "influx") != 0) {
+        return -1;
+    }
+    export_url = url;
+    return 0;
+}
+
+// Вызывается до start_server; webhook - NULL или http://host:port/path
+void set_alert_rules(const char *path, const char *webhook) {
+    alert_rules_path = path;
+    alert_webhook_url = webhook;
+}
+
+// До start_server (--disable) и на ходу (POST /api/collectors/<имя>/...);
+// init/teardown выполнит поток сбора в начале тика
+int set_collector_enabled(const char *name, int enabled) {
+    register_collectors();
+    return collector_set_wanted(&collectors, name, enabled);
+}
+
+// Вызывается до start_server
+void set_update_interval(int interval_ms) {
+    if (interval_ms >= 100) update_interval_ms = interval_ms;
+}
+
+// Вызывается до start_server
+void set_fleet_hosts(const char *path) {
+    fleet_hosts_path = path;
+}
+
+// Вызывается до start_server
+void set_frontend_dir(const char *dir) {
+    frontend_dir = dir;
+}
+
+static void load_frontend(void) {
+    if (frontend_dir) {
+        if (asset_cache_load(&frontend_assets, frontend_dir) != 0) {
+            printf("Frontend: cannot load %s, serving built-in page\n", frontend_dir);
+        }
+        return;
+    }
+    
+    // по умолчанию: запуск из корня репозитория или из backend/
+    if (asset_cache_load(&frontend_assets, FRONTEND_DIR) == 0 ||
+        asset_cache_load(&frontend_assets, "../" FRONTEND_DIR) == 0) {
+        return;
+    }
+    printf("Frontend: %s not found, serving built-in page\n", FRONTEND_DIR);
+}
+
+// Вызывается до start_server
+void set_server_workers(int count) {
+    if (count < 1) count = 1;
+    if (count > MAX_WORKERS) count = MAX_WORKERS;
+    worker_count = count;
+}
+
+// Вызывается до start_server
+void set_listen_backlog(int backlog) {
+    if (backlog > 0) listen_backlog = backlog;
+}
+
+// Вызывается до start_server: воркер i привязывается к cpus[i % count]
+int add_worker_cpu(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE || worker_cpu_count >= MAX_WORKERS) return -1;
+    worker_cpus[worker_cpu_count++] = cpu;
+    return 0;
+}
+
+static int open_listen_socket(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
         perror("socket");
         return -1;
     }
     
     int opt = 1;
-    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
         perror("setsockopt");
-        close(server_socket);
+        close(fd);
         return -1;
     }
     
@@ -412,24 +1792,334 @@ int start_server(int port) {
     server_addr.sin_addr.s_addr = INADDR_ANY;
     server_addr.sin_port = htons(port);
     
-    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+    if (bind(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
         perror("bind");
-        close(server_socket);
+        close(fd);
         return -1;
     }
     
-    if (listen(server_socket, MAX_CONNECTIONS) < 0) {
+    if (listen(fd, listen_backlog) < 0) {
         perror("listen");
-        close(server_socket);
+        close(fd);
         return -1;
     }
     
+    return fd;
+}
+
+static void close_connection(ServerWorker *w, Connection *c) {
+    close(c->fd);
+    free(c->request);
+    output_reset(&c->output);
+    if (c->idle) __atomic_store_n(&w->kept_count, w->kept_count - 1, __ATOMIC_RELAXED);
+    
+    Connection *last = w->connections[w->connection_count - 1];
+    w->connections[c->slot] = last;
+    last->slot = c->slot;
+    __atomic_store_n(&w->connection_count, w->connection_count - 1, __ATOMIC_RELAXED);
+    free(c);
+}
+
+static Connection *track_connection(ServerWorker *w, int epfd, int fd) {
+    if (w->connection_count == w->connection_cap) {
+        int cap = w->connection_cap ? w->connection_cap * 2 : KEEPALIVE_MAX_PER_WORKER;
+        Connection **grown = realloc(w->connections, cap * sizeof(Connection *));
+        if (!grown) return NULL;
+        w->connections = grown;
+        w->connection_cap = cap;
+    }
+    
+    Connection *c = calloc(1, sizeof(Connection));
+    if (!c) return NULL;
+    c->fd = fd;
+    c->last_active = time(NULL);
+    
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = c};
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        free(c);
+        return NULL;
+    }
+    c->slot = w->connection_count;
+    w->connections[c->slot] = c;
+    __atomic_store_n(&w->connection_count, w->connection_count + 1, __ATOMIC_RELAXED);
+    return c;
+}
+
+static void set_idle(ServerWorker *w, Connection *c, int idle) {
+    if (c->idle == idle) return;
+    c->idle = idle;
+    __atomic_store_n(&w->kept_count, w->kept_count + (idle ? 1 : -1), __ATOMIC_RELAXED);
+}
+
+// Пока уходит ответ, соединение ждет только EPOLLOUT: RDHUP от клиента,
+// закрывшего свою сторону, крутил бы цикл впустую
+static void wait_for(int epfd, Connection *c, unsigned events) {
+    struct epoll_event ev = {.events = events, .data.ptr = c};
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+// Дочитывает запрос без блокировки в buf (начало - из c->request).
+// 1 - заголовки пришли целиком, 0 - ждать остальное в epoll, -1 - закрыть
+static int read_request(Connection *c, char *buf, int size) {
+    int len = 0;
+    if (c->request) {
+        memcpy(buf, c->request, c->len);
+        len = c->len;
+    }
+    
+    for (;;) {
+        int n = recv(c->fd, buf + len, size - 1 - len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) return -1;
+        
+        // конец заголовков ищется только в новых байтах (с захватом 3 прежних)
+        int from = len > 3 ? len - 3 : 0;
+        len += n;
+        buf[len] = '\0';
+        // заголовки длиннее буфера: для разбора хватает начала
+        if (strstr(buf + from, "\r\n\r\n") || len >= size - 1) {
+            free(c->request);
+            c->request = NULL;
+            c->len = 0;
+            return 1;
+        }
+    }
+    
+    if (len == 0) return 0;
+    if (!c->request) {
+        c->request = malloc(size);
+        if (!c->request) return -1;
+        c->last_active = time(NULL);   // отсчет CLIENT_TIMEOUT_SEC с начала запроса
+    }
+    memcpy(c->request, buf, len);
+    c->len = len;
+    return 0;
+}
+
+// Событие на соединении: дописать ответ или прочитать запрос. Запрос,
+// пришедший не целиком, дочитывается по следующим EPOLLIN, ответ, не
+// ушедший сразу, - по EPOLLOUT: воркер не ждет медленного клиента
+static void serve_connection(int epfd, ServerWorker *w, Connection *c) {
+    if (output_pending(&c->output)) {
+        size_t sent = c->output.sent;
+        int flushed = output_flush(c->fd, &c->output);
+        if (flushed < 0 || (flushed > 0 && c->close_after)) {
+            close_connection(w, c);
+        } else if (flushed > 0 || c->output.sent > sent) {
+            c->last_active = time(NULL);
+            if (flushed > 0) {
+                set_idle(w, c, 1);
+                wait_for(epfd, c, EPOLLIN | EPOLLRDHUP);
+            }
+        }
+        return;
+    }
+    
+    char request[BUFFER_SIZE];
+    int ready = read_request(c, request, sizeof(request));
+    if (ready < 0) {
+        close_connection(w, c);
+        return;
+    }
+    if (c->request) set_idle(w, c, 0);
+    if (ready == 0) return;
+    
+    set_idle(w, c, 0);
+    keep_alive_allowed = c->served || w->kept_count < KEEPALIVE_MAX_PER_WORKER;
+    response_output = &c->output;
+    int keep = serve_request(c->fd, request);
+    response_output = NULL;
+    __atomic_fetch_add(&w->requests, 1, __ATOMIC_RELAXED);
+    c->served = 1;
+    c->last_active = time(NULL);
+    
+    if (c->output.failed) {
+        close_connection(w, c);
+    } else if (output_pending(&c->output)) {
+        c->close_after = !keep;
+        wait_for(epfd, c, EPOLLOUT);
+    } else if (!keep) {
+        close_connection(w, c);
+    } else {
+        set_idle(w, c, 1);
+    }
+}
+
+static void *worker_thread(void *arg) {
+    ServerWorker *w = arg;
+    
+    if (w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            printf("Worker %d: cannot pin to CPU %d\n", w->id, w->cpu);
+            w->cpu = -1;
+        }
+    }
+    
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        perror("epoll_create1");
+        return NULL;
+    }
+    // data.ptr: NULL - слушающий сокет, &stop_event - остановка, иначе Connection
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, w->socket, &ev);
+    ev.data.ptr = &stop_event;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, stop_event, &ev);
+    
+    while (running) {
+        struct epoll_event events[32];
+        // открытые соединения раз в секунду проверяются на простой
+        int n = epoll_wait(epfd, events, 32, w->connection_count > 0 ? 1000 : -1);
+        
+        for (int i = 0; i < n && running; i++) {
+            void *ptr = events[i].data.ptr;
+            if (ptr == &stop_event) continue;
+            
+            if (ptr) {
+                serve_connection(epfd, w, ptr);
+                continue;
+            }
+            
+            // слушающий сокет неблокирующий: забираем всю очередь
+            int client_socket;
+            while (running && (client_socket = accept4(w->socket, NULL, NULL,
+                                                       SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                Connection *c = track_connection(w, epfd, client_socket);
+                if (!c) {
+                    close(client_socket);
+                    continue;
+                }
+                serve_connection(epfd, w, c);
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && running) {
+                perror("accept");
+            }
+        }
+        
+        // запрос или ответ, не продвинувшийся за CLIENT_TIMEOUT_SEC, закрывается;
+        // простой между запросами keep-alive - KEEPALIVE_IDLE_SEC
+        time_t now = time(NULL);
+        for (int i = w->connection_count - 1; i >= 0; i--) {
+            Connection *c = w->connections[i];
+            int limit = c->idle ? KEEPALIVE_IDLE_SEC : CLIENT_TIMEOUT_SEC;
+            if (now - c->last_active >= limit) {
+                close_connection(w, c);
+            }
+        }
+    }
+    
+    while (w->connection_count > 0) {
+        close_connection(w, w->connections[w->connection_count - 1]);
+    }
+    free(w->connections);
+    w->connections = NULL;
+    w->connection_cap = 0;
+    close(epfd);
+    return NULL;
+}
+
+int start_server(int port) {
+    server_epoch = (long)time(NULL);
+    stop_event = eventfd(0, EFD_CLOEXEC);
+    if (stop_event < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    
+    load_frontend();
+    
+    if (demand_init(&demand, demand_idle_ms, DEMAND_IDLE_REFRESH_TICKS) != 0) {
+        return -1;
+    }
+    
+    if (fleet_hosts_path) {
+        fleet = malloc(sizeof(Fleet));
+        if (!fleet || fleet_load_hosts(fleet, fleet_hosts_path) != 0) {
+            free(fleet);
+            fleet = NULL;
+            return -1;
+        }
+        fleet->interval_ms = update_interval_ms;
+        if (fleet_start(fleet) != 0) {
+            fleet_free(fleet);
+            free(fleet);
+            fleet = NULL;
+            return -1;
+        }
+    }
+    
+    for (int i = 0; i < worker_count; i++) {
+        workers[i].id = i;
+        workers[i].cpu = worker_cpu_count > 0 ? worker_cpus[i % worker_cpu_count] : -1;
+        workers[i].socket = open_listen_socket(port);
+        if (workers[i].socket < 0) {
+            for (int j = 0; j < i; j++) close(workers[j].socket);
+            worker_count = 0;
+            return -1;
+        }
+    }
+    
+    if (export_url) {
+        exporter = malloc(sizeof(Exporter));
+        if (!exporter || exporter_init(exporter, export_url, export_format) != 0) {
+            free(exporter);
+            exporter = NULL;
+            return -1;
+        }
+        if (exporter_start(exporter) != 0) {
+            exporter_free(exporter);
+            free(exporter);
+            exporter = NULL;
+            return -1;
+        }
+    }
+    
+    if (quantile_store_init(&system_quantiles, update_interval_ms) != 0) {
+        fprintf(stderr, "Failed to allocate quantile sketches, /api/stats disabled\n");
+    }
+    
+    if (alert_rules_path) {
+        alerts = malloc(sizeof(AlertEngine));
+        if (!alerts || alerts_init(alerts) != 0) {
+            free(alerts);
+            alerts = NULL;
+            return -1;
+        }
+        if (alerts_load(alerts, alert_rules_path) != 0 ||
+            (alert_webhook_url && alerts_set_webhook(alerts, alert_webhook_url) != 0) ||
+            alerts_start(alerts) != 0) {
+            if (alert_webhook_url && alerts->target[0] == '\0') {
+                fprintf(stderr, "Invalid alert webhook: %s (http://host:port/path)\n", alert_webhook_url);
+            }
+            alerts_free(alerts);
+            free(alerts);
+            alerts = NULL;
+            return -1;
+        }
+    }
+    
+    register_collectors();
     if (pthread_create(&update_thread, NULL, update_data_thread, NULL) != 0) {
         perror("pthread_create");
-        close(server_socket);
         return -1;
     }
     
+    int started = 0;
+    for (int i = 0; i < worker_count; i++) {
+        if (pthread_create(&workers[i].thread, NULL, worker_thread, &workers[i]) != 0) {
+            perror("pthread_create");
+            close(workers[i].socket);
+            workers[i].socket = -1;
+            continue;
+        }
+        started++;
+    }
+    if (started == 0) return -1;
+    
     printf("\n");
     printf("╔══════════════════════════════════════════╗\n");
     printf("║      System Monitor Server v2.0         ║\n");
@@ -439,40 +2129,81 @@ int start_server(int port) {
     printf("🌐 Network: http://%s:%d\n", get_local_ip(), port);
     printf("📊 API:     http://localhost:%d/api/system\n", port);
     printf("🏥 Health:  http://localhost:%d/api/health\n", port);
-    printf("🖥️  GPU:     Data collection enabled\n");
+    printf("🧰 Collectors: http://localhost:%d/api/collectors (every %d ms)\n", port, update_interval_ms);
+    printf("🧵 Workers: %d (SO_REUSEPORT, backlog %d)\n", started, listen_backlog);
+    if (exporter) {
+        printf("📤 Export:  %s (%s)\n", exporter->target,
+               exporter->format == EXPORT_STATSD ? "statsd" : "influx");
+    }
+    if (alerts) {
+        printf("🔔 Alerts:  %d rules, http://localhost:%d/api/alerts%s%s\n", alerts->count, port,
+               alerts->target[0] ? " -> " : "", alerts->target);
+    }
+    if (fleet) {
+        printf("🛰️  Fleet:   %d hosts, http://localhost:%d/api/fleet\n", fleet->count, port);
+    }
+    if (frontend_assets.count > 0) {
+        printf("🖼️  Frontend: %d files cached, http://localhost:%d/\n", frontend_assets.count, port);
+    }
     printf("🛑 Press Ctrl+C to stop\n");
     printf("\n");
     
-    while (running) {
-        struct sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
-        
-        int client_socket = accept(server_socket, 
-                                  (struct sockaddr *)&client_addr, 
-                                  &client_len);
-        
-        if (client_socket < 0) {
-            if (running) {
-                perror("accept");
-            }
-            continue;
-        }
-        
-        handle_client(client_socket);
-    }
-    
     return 0;
 }
 
 void stop_server() {
     running = 0;
     
-    if (server_socket != -1) {
-        close(server_socket);
-        server_socket = -1;
+    // eventfd будит epoll всех воркеров
+    if (stop_event >= 0) {
+        uint64_t one = 1;
+        if (write(stop_event, &one, sizeof(one)) < 0) {
+            perror("write");
+        }
+    }
+    
+    for (int i = 0; i < worker_count; i++) {
+        if (workers[i].socket == -1) continue;
+        pthread_join(workers[i].thread, NULL);
+        close(workers[i].socket);
+        workers[i].socket = -1;
     }
     
     if (update_thread) {
+        // поток сбора спит до следующего тика - будим, чтобы не ждать интервал
+        uint64_t one = 1;
+        if (write(demand.wake_fd, &one, sizeof(one)) < 0) {
+            perror("write");
+        }
         pthread_join(update_thread, NULL);
     }
-}
\ No newline at end of file
+    
+    if (system_quantiles.minutes) {
+        quantile_store_free(&system_quantiles);
+    }
+    
+    // после update_thread: новых тиков в очереди уже не будет
+    if (exporter) {
+        exporter_stop(exporter);
+        exporter_free(exporter);
+        free(exporter);
+        exporter = NULL;
+    }
+    
+    if (alerts) {
+        alerts_stop(alerts);
+        alerts_free(alerts);
+        free(alerts);
+        alerts = NULL;
+    }
+    
+    if (fleet) {
+        fleet_stop(fleet);
+        fleet_free(fleet);
+        free(fleet);
+        fleet = NULL;
+    }
+    
+    demand_free(&demand);
+    asset_cache_free(&frontend_assets);
+}
@@ -3,5 +3,18 @@
 
 int start_server(int port);
 void stop_server();
+void set_network_skip_virtual(int skip);
+int add_process_watch(int pid);
+void set_psi_triggers(int enabled);
+void set_server_workers(int count);
+void set_listen_backlog(int backlog);
+int add_worker_cpu(int cpu);
+void set_frontend_dir(const char *dir);
+void set_fleet_hosts(const char *path);
+void set_demand_idle(long idle_ms);
+int set_export_target(const char *url, const char *format);
+void set_alert_rules(const char *path, const char *webhook);
+int set_collector_enabled(const char *name, int enabled);
+void set_update_interval(int interval_ms);
 
 #endif
\ No newline at end of file
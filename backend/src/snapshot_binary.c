@@ -0,0 +1,343 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "snapshot_binary.h"
+
+#define HEADER_SIZE 16
+#define DIRECTORY_ENTRY_SIZE 12
+#define SECTION_COUNT 7
+
+#define META_RECORD 16
+#define CPU_RECORD 24
+#define CORE_RECORD 4
+#define MEMORY_RECORD 40
+#define GPU_RECORD 56
+#define PROCESS_RECORD 32
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t len;
+    int overflow;
+} BinWriter;
+
+static void put_bytes(BinWriter *w, const void *src, size_t n) {
+    if (w->overflow || w->len + n > w->size) {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->data + w->len, src, n);
+    w->len += n;
+}
+
+static void put_u8(BinWriter *w, uint8_t v) {
+    put_bytes(w, &v, 1);
+}
+
+static void put_u16(BinWriter *w, uint16_t v) {
+    unsigned char b[2] = {(unsigned char)v, (unsigned char)(v >> 8)};
+    put_bytes(w, b, 2);
+}
+
+static void put_u32(BinWriter *w, uint32_t v) {
+    unsigned char b[4];
+    for (int i = 0; i < 4; i++) b[i] = (unsigned char)(v >> (8 * i));
+    put_bytes(w, b, 4);
+}
+
+static void put_u64(BinWriter *w, uint64_t v) {
+    unsigned char b[8];
+    for (int i = 0; i < 8; i++) b[i] = (unsigned char)(v >> (8 * i));
+    put_bytes(w, b, 8);
+}
+
+static void put_f32(BinWriter *w, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(w, bits);
+}
+
+static void put_f64(BinWriter *w, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u64(w, bits);
+}
+
+static void align8(BinWriter *w) {
+    while (!w->overflow && (w->len & 7)) put_u8(w, 0);
+}
+
+static void patch_u32(BinWriter *w, size_t at, uint32_t v) {
+    if (w->overflow) return;
+    for (int i = 0; i < 4; i++) w->data[at + i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const unsigned char *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static float get_f32(const unsigned char *p) {
+    uint32_t bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static double get_f64(const unsigned char *p) {
+    uint64_t bits = get_u64(p);
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// Таблица строк собирается во временном буфере и пишется последней секцией
+typedef struct {
+    char data[TOP_PROCESSES * 768 + 256];
+    uint32_t len;
+} StringTable;
+
+static uint32_t intern_string(StringTable *table, const char *s) {
+    size_t n = strlen(s);
+    if (table->len + n + 1 > sizeof(table->data)) {
+        n = sizeof(table->data) - table->len - 1;
+    }
+    uint32_t ref = table->len;
+    memcpy(table->data + table->len, s, n);
+    table->data[table->len + n] = '\0';
+    table->len += (uint32_t)n + 1;
+    return ref;
+}
+
+int encode_system_info_binary(unsigned char *buffer, size_t buffer_size,
+                              CPUStats *cpu, const CoreStats *cores,
+                              MemoryInfo *mem,
+                              GPUInfo *gpu,
+                              ProcessInfo *processes, int process_count) {
+    StringTable strings;
+    BinWriter w = {buffer, buffer_size, 0, 0};
+    uint32_t offsets[SECTION_COUNT];
+    strings.len = 0;
+
+    int limit = (process_count > TOP_PROCESSES) ? TOP_PROCESSES : process_count;
+    const uint16_t ids[SECTION_COUNT] = {
+        SNAPSHOT_SECTION_META, SNAPSHOT_SECTION_CPU, SNAPSHOT_SECTION_CORES,
+        SNAPSHOT_SECTION_MEMORY, SNAPSHOT_SECTION_GPU, SNAPSHOT_SECTION_PROCESSES,
+        SNAPSHOT_SECTION_STRINGS
+    };
+    const uint16_t record_sizes[SECTION_COUNT] = {
+        META_RECORD, CPU_RECORD, CORE_RECORD, MEMORY_RECORD, GPU_RECORD, PROCESS_RECORD, 1
+    };
+    uint32_t record_counts[SECTION_COUNT] = {1, 1, (uint32_t)cores->count, 1, 1, (uint32_t)limit, 0};
+
+    put_bytes(&w, SNAPSHOT_MAGIC, 4);
+    put_u16(&w, SNAPSHOT_VERSION);
+    put_u16(&w, SECTION_COUNT);
+    put_u32(&w, 0);
+    put_u32(&w, 0);
+
+    size_t directory = w.len;
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        put_u16(&w, ids[i]);
+        put_u16(&w, record_sizes[i]);
+        put_u32(&w, 0);
+        put_u32(&w, 0);
+    }
+
+    align8(&w);
+    offsets[0] = (uint32_t)w.len;
+    put_u64(&w, (uint64_t)(long long)time(NULL));
+    put_u32(&w, (uint32_t)cores->online_count);
+    put_u32(&w, (uint32_t)limit);
+
+    offsets[1] = (uint32_t)w.len;
+    put_f64(&w, cpu->usage_percent);
+    put_f64(&w, cpu->temperature);
+    put_u64(&w, cpu->frequency);
+
+    offsets[2] = (uint32_t)w.len;
+    for (int i = 0; i < cores->count; i++) {
+        double usage = cores->usage[i];
+        if (usage > 100) usage = 100;
+        if (usage < 0) usage = 0;
+        put_f32(&w, cores->online[i] ? (float)usage : -1.0f);
+    }
+
+    align8(&w);
+    offsets[3] = (uint32_t)w.len;
+    put_u64(&w, mem->total);
+    put_u64(&w, mem->used);
+    put_u64(&w, mem->free);
+    put_u64(&w, mem->cached);
+    put_f64(&w, mem->percentage);
+
+    offsets[4] = (uint32_t)w.len;
+    put_f64(&w, gpu->usage);
+    put_f64(&w, gpu->temperature);
+    put_f64(&w, gpu->power);
+    put_u64(&w, gpu->memory_total);
+    put_u64(&w, gpu->memory_used);
+    put_u64(&w, gpu->clock);
+    put_u32(&w, intern_string(&strings, gpu->name));
+    put_u32(&w, 0);
+
+    offsets[5] = (uint32_t)w.len;
+    for (int i = 0; i < limit; i++) {
+        ProcessInfo *p = &processes[i];
+        const char *name = p->name[0] ? p->name : "[unknown]";
+        uint32_t name_ref = intern_string(&strings, name);
+        uint32_t cmd_ref = p->command_line[0] ? intern_string(&strings, p->command_line) : name_ref;
+
+        put_u32(&w, (uint32_t)p->pid);
+        put_u32(&w, name_ref);
+        put_u32(&w, cmd_ref);
+        put_u8(&w, (uint8_t)p->state);
+        put_u8(&w, 0);
+        put_u16(&w, 0);
+        put_u64(&w, (uint64_t)p->rss * 1024);
+        put_f64(&w, p->cpu_usage);
+    }
+
+    offsets[6] = (uint32_t)w.len;
+    record_counts[6] = strings.len;
+    put_bytes(&w, strings.data, strings.len);
+    align8(&w);
+
+    if (w.overflow) {
+        return -1;
+    }
+
+    patch_u32(&w, 8, (uint32_t)w.len);
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        patch_u32(&w, directory + i * DIRECTORY_ENTRY_SIZE + 4, record_counts[i]);
+        patch_u32(&w, directory + i * DIRECTORY_ENTRY_SIZE + 8, offsets[i]);
+    }
+
+    return (int)w.len;
+}
+
+static const char *string_at(const unsigned char *strtab, uint32_t strtab_len, uint32_t ref) {
+    if (!strtab || ref >= strtab_len) return NULL;
+    if (!memchr(strtab + ref, '\0', strtab_len - ref)) return NULL;
+    return (const char *)strtab + ref;
+}
+
+int decode_system_info_binary(const unsigned char *data, size_t size, SnapshotView *out) {
+    memset(out, 0, sizeof(SnapshotView));
+
+    if (size < HEADER_SIZE || memcmp(data, SNAPSHOT_MAGIC, 4) != 0) return -1;
+
+    out->version = get_u16(data + 4);
+    if (out->version != SNAPSHOT_VERSION) return -1;
+
+    uint16_t section_count = get_u16(data + 6);
+    uint32_t total_size = get_u32(data + 8);
+    if (total_size > size || HEADER_SIZE + (size_t)section_count * DIRECTORY_ENTRY_SIZE > total_size) {
+        return -1;
+    }
+
+    const unsigned char *procs = NULL;
+    uint32_t procs_count = 0, procs_record = 0;
+    const unsigned char *strtab = NULL;
+    uint32_t strtab_len = 0;
+    uint32_t gpu_name_ref = 0;
+    int have_gpu = 0;
+
+    for (int i = 0; i < section_count; i++) {
+        const unsigned char *entry = data + HEADER_SIZE + i * DIRECTORY_ENTRY_SIZE;
+        uint16_t id = get_u16(entry);
+        uint16_t record_size = get_u16(entry + 2);
+        uint32_t count = get_u32(entry + 4);
+        uint32_t offset = get_u32(entry + 8);
+
+        if (offset > total_size || (uint64_t)record_size * count > total_size - offset) return -1;
+        const unsigned char *s = data + offset;
+
+        switch (id) {
+            case SNAPSHOT_SECTION_META:
+                if (record_size < META_RECORD || count < 1) return -1;
+                out->timestamp = (long long)get_u64(s);
+                out->cores_count = (int)get_u32(s + 8);
+                break;
+            case SNAPSHOT_SECTION_CPU:
+                if (record_size < CPU_RECORD || count < 1) return -1;
+                out->cpu_usage = get_f64(s);
+                out->cpu_temperature = get_f64(s + 8);
+                out->cpu_frequency = get_u64(s + 16);
+                break;
+            case SNAPSHOT_SECTION_CORES:
+                if (record_size < CORE_RECORD) return -1;
+                out->core_usage_count = (int)count;
+                out->core_usage_data = s;
+                out->core_usage_record = record_size;
+                break;
+            case SNAPSHOT_SECTION_MEMORY:
+                if (record_size < MEMORY_RECORD || count < 1) return -1;
+                out->memory.total = get_u64(s);
+                out->memory.used = get_u64(s + 8);
+                out->memory.free = get_u64(s + 16);
+                out->memory.cached = get_u64(s + 24);
+                out->memory.percentage = get_f64(s + 32);
+                break;
+            case SNAPSHOT_SECTION_GPU:
+                if (record_size < GPU_RECORD || count < 1) return -1;
+                out->gpu_usage = get_f64(s);
+                out->gpu_temperature = get_f64(s + 8);
+                out->gpu_power = get_f64(s + 16);
+                out->gpu_memory_total = get_u64(s + 24);
+                out->gpu_memory_used = get_u64(s + 32);
+                out->gpu_clock = get_u64(s + 40);
+                gpu_name_ref = get_u32(s + 48);
+                have_gpu = 1;
+                break;
+            case SNAPSHOT_SECTION_PROCESSES:
+                if (record_size < PROCESS_RECORD) return -1;
+                procs = s;
+                procs_count = count;
+                procs_record = record_size;
+                break;
+            case SNAPSHOT_SECTION_STRINGS:
+                strtab = s;
+                strtab_len = count * record_size;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (have_gpu) {
+        out->gpu_name = string_at(strtab, strtab_len, gpu_name_ref);
+        if (!out->gpu_name) return -1;
+    }
+
+    out->process_count = procs_count < TOP_PROCESSES ? (int)procs_count : TOP_PROCESSES;
+    for (int i = 0; i < out->process_count; i++) {
+        const unsigned char *r = procs + (size_t)i * procs_record;
+        SnapshotProcess *p = &out->processes[i];
+
+        p->pid = (int)get_u32(r);
+        p->name = string_at(strtab, strtab_len, get_u32(r + 4));
+        p->command = string_at(strtab, strtab_len, get_u32(r + 8));
+        p->state = (char)r[12];
+        p->memory = get_u64(r + 16);
+        p->cpu = get_f64(r + 24);
+
+        if (!p->name || !p->command) return -1;
+    }
+
+    return 0;
+}
+
+// Загрузка CPU из секции CORES: ядер может быть сотни, копия не делается
+float snapshot_core_usage(const SnapshotView *view, int core) {
+    if (core < 0 || core >= view->core_usage_count || !view->core_usage_data) return -1.0f;
+    return get_f32(view->core_usage_data + (size_t)core * view->core_usage_record);
+}
@@ -0,0 +1,94 @@
+#ifndef SNAPSHOT_BINARY_H
+#define SNAPSHOT_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "core_stats.h"
+
+/*
+ * Бинарный снимок /api/system.bin (версия 1). Все числа little-endian.
+ *
+ * Заголовок, 16 байт:
+ *   0  char[4] magic "SMSB"
+ *   4  u16     version
+ *   6  u16     section_count
+ *   8  u32     total_size
+ *   12 u32     reserved (0)
+ *
+ * Каталог секций, section_count записей по 12 байт:
+ *   u16 id, u16 record_size, u32 record_count, u32 offset
+ *
+ * Секции выровнены на 8 байт. Декодер пропускает неизвестные id и
+ * принимает record_size больше известного (новые поля дописываются в
+ * конец записи), поэтому формат можно расширять без смены версии.
+ *
+ *   META    (1) 16 байт: i64 timestamp, u32 cores_count, u32 process_count
+ *   CPU     (2) 24 байта: f64 usage, f64 temperature, u64 frequency
+ *   CORES   (3)  4 байта: f32 usage, по записи на CPU 0..N-1; < 0 - CPU выключен
+ *   MEMORY  (4) 40 байт: u64 total, u64 used, u64 free, u64 cached, f64 percentage
+ *   GPU     (5) 56 байт: f64 usage, f64 temperature, f64 power,
+ *                        u64 memory_total, u64 memory_used, u64 clock,
+ *                        u32 name, u32 reserved
+ *   PROCS   (6) 32 байта: i32 pid, u32 name, u32 command, u8 state, u8[3] reserved,
+ *                        u64 memory (байты), f64 cpu
+ *   STRINGS (7)  1 байт: таблица строк; поля name/command - смещения
+ *                        NUL-терминированных строк внутри этой секции
+ */
+
+#define SNAPSHOT_MAGIC "SMSB"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_CONTENT_TYPE "application/vnd.system-monitor.snapshot"
+
+enum {
+    SNAPSHOT_SECTION_META = 1,
+    SNAPSHOT_SECTION_CPU = 2,
+    SNAPSHOT_SECTION_CORES = 3,
+    SNAPSHOT_SECTION_MEMORY = 4,
+    SNAPSHOT_SECTION_GPU = 5,
+    SNAPSHOT_SECTION_PROCESSES = 6,
+    SNAPSHOT_SECTION_STRINGS = 7
+};
+
+typedef struct {
+    int pid;
+    char state;
+    unsigned long long memory;
+    double cpu;
+    const char *name;
+    const char *command;
+} SnapshotProcess;
+
+// Результат декодирования; строки указывают внутрь исходного буфера
+typedef struct {
+    int version;
+    long long timestamp;
+    int cores_count;
+    double cpu_usage;
+    double cpu_temperature;
+    unsigned long long cpu_frequency;
+    int core_usage_count;
+    const unsigned char *core_usage_data;   // записи секции CORES, см. snapshot_core_usage
+    int core_usage_record;
+    MemoryInfo memory;
+    double gpu_usage;
+    double gpu_temperature;
+    double gpu_power;
+    unsigned long long gpu_memory_total;
+    unsigned long long gpu_memory_used;
+    unsigned long long gpu_clock;
+    const char *gpu_name;
+    int process_count;
+    SnapshotProcess processes[TOP_PROCESSES];
+} SnapshotView;
+
+int encode_system_info_binary(unsigned char *buffer, size_t buffer_size,
+                              CPUStats *cpu, const CoreStats *cores,
+                              MemoryInfo *mem,
+                              GPUInfo *gpu,
+                              ProcessInfo *processes, int process_count);
+
+int decode_system_info_binary(const unsigned char *data, size_t size, SnapshotView *out);
+float snapshot_core_usage(const SnapshotView *view, int core);
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+#include "string_arena.h"
+
+#define STRING_ARENA_SLOTS 1024
+
+static uint32_t hash_bytes(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static int alloc_slots(StringArena *a, int slot_count) {
+    a->slots = calloc(slot_count, sizeof(const char *));
+    a->hashes = calloc(slot_count, sizeof(uint32_t));
+    if (!a->slots || !a->hashes) {
+        free(a->slots);
+        free(a->hashes);
+        a->slots = NULL;
+        a->hashes = NULL;
+        return -1;
+    }
+    a->slot_count = slot_count;
+    return 0;
+}
+
+int string_arena_init(StringArena *a) {
+    memset(a, 0, sizeof(StringArena));
+    return alloc_slots(a, STRING_ARENA_SLOTS);
+}
+
+void string_arena_free(StringArena *a) {
+    StringArenaBlock *b = a->blocks;
+    while (b) {
+        StringArenaBlock *next = b->next;
+        free(b);
+        b = next;
+    }
+    free(a->slots);
+    free(a->hashes);
+    memset(a, 0, sizeof(StringArena));
+}
+
+// Оставляет один блок под следующие строки, остальные освобождает
+void string_arena_reset(StringArena *a) {
+    StringArenaBlock *keep = a->blocks;
+    while (keep && keep->size != STRING_ARENA_BLOCK) keep = keep->next;
+
+    StringArenaBlock *b = a->blocks;
+    while (b) {
+        StringArenaBlock *next = b->next;
+        if (b != keep) free(b);
+        b = next;
+    }
+    if (keep) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    a->blocks = keep;
+    a->bytes = 0;
+    a->count = 0;
+    memset(a->slots, 0, a->slot_count * sizeof(const char *));
+    memset(a->hashes, 0, a->slot_count * sizeof(uint32_t));
+}
+
+static int grow_slots(StringArena *a) {
+    const char **old_slots = a->slots;
+    uint32_t *old_hashes = a->hashes;
+    int old_count = a->slot_count;
+
+    if (alloc_slots(a, old_count * 2) != 0) {
+        a->slots = old_slots;
+        a->hashes = old_hashes;
+        return -1;
+    }
+    for (int i = 0; i < old_count; i++) {
+        if (!old_slots[i]) continue;
+        int j = old_hashes[i] & (a->slot_count - 1);
+        while (a->slots[j]) j = (j + 1) & (a->slot_count - 1);
+        a->slots[j] = old_slots[i];
+        a->hashes[j] = old_hashes[i];
+    }
+    free(old_slots);
+    free(old_hashes);
+    return 0;
+}
+
+static char *store(StringArena *a, size_t size) {
+    StringArenaBlock *b = a->blocks;
+    if (!b || b->size - b->used < size) {
+        // строка длиннее блока получает свой блок
+        size_t block = size > STRING_ARENA_BLOCK ? size : STRING_ARENA_BLOCK;
+        b = malloc(sizeof(StringArenaBlock) + block);
+        if (!b) return NULL;
+        b->used = 0;
+        b->size = block;
+        b->next = a->blocks;
+        a->blocks = b;
+    }
+    char *p = b->data + b->used;
+    b->used += size;
+    return p;
+}
+
+// NULL только при нехватке памяти
+const char *string_arena_intern(StringArena *a, const char *s, size_t len) {
+    if (a->count * 2 >= a->slot_count && grow_slots(a) != 0) return NULL;
+
+    uint32_t h = hash_bytes(s, len);
+    int i = h & (a->slot_count - 1);
+    while (a->slots[i]) {
+        if (a->hashes[i] == h && strncmp(a->slots[i], s, len) == 0 && a->slots[i][len] == '\0') {
+            return a->slots[i];
+        }
+        i = (i + 1) & (a->slot_count - 1);
+    }
+
+    char *p = store(a, len + 1);
+    if (!p) return NULL;
+    memcpy(p, s, len);
+    p[len] = '\0';
+
+    a->slots[i] = p;
+    a->hashes[i] = h;
+    a->count++;
+    a->bytes += len + 1;
+    return p;
+}
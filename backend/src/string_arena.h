@@ -0,0 +1,38 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define STRING_ARENA_BLOCK 65536
+
+/*
+ * Интернированные строки: каждая уникальная строка хранится один раз,
+ * повторный intern возвращает тот же указатель. Блоки не перемещаются и
+ * не освобождаются до reset, поэтому указатель остается валидным, пока
+ * арена не сброшена, даже если поток-владелец дописывает новые строки.
+ * Хеш-индекс нужен только пишущему потоку.
+ */
+
+typedef struct StringArenaBlock {
+    struct StringArenaBlock *next;
+    size_t used;
+    size_t size;
+    char data[];
+} StringArenaBlock;
+
+typedef struct {
+    StringArenaBlock *blocks;   // голова - блок, в который идет запись
+    size_t bytes;               // занято строками, с '\0'
+    int count;
+    const char **slots;         // открытая адресация, размер - степень двойки
+    uint32_t *hashes;
+    int slot_count;
+} StringArena;
+
+int string_arena_init(StringArena *a);
+void string_arena_free(StringArena *a);
+void string_arena_reset(StringArena *a);
+const char *string_arena_intern(StringArena *a, const char *s, size_t len);
+
+#endif
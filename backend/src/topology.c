@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "topology.h"
+#include "capture.h"
+
+#define NODE_ID_LIMIT 1024          // MAX_NUMNODES ядра
+#define CPULIST_TEXT_SIZE 4096
+
+void topology_init(Topology *t, const char *sys_root) {
+    memset(t, 0, sizeof(Topology));
+    snprintf(t->sys_root, sizeof(t->sys_root), "%s", sys_root);
+}
+
+void topology_free(Topology *t) {
+    for (int i = 0; i < t->node_count; i++) {
+        procfile_close(&t->nodes[i].meminfo);
+    }
+    free(t->cpu_node);
+    free(t->cpu_package);
+    free(t->cpu_online);
+    t->cpu_node = t->cpu_package = NULL;
+    t->cpu_online = NULL;
+    t->capacity = t->cpu_count = t->node_count = t->package_count = 0;
+}
+
+// Маленький файл sysfs одной строкой; -1, если его нет
+static int read_line(const char *path, char *text, size_t size) {
+    FILE *fp = capture_fopen(path);
+    if (!fp) return -1;
+    int ok = fgets(text, (int)size, fp) != NULL;
+    fclose(fp);
+    return ok ? 0 : -1;
+}
+
+static int reserve_cpus(Topology *t, int count) {
+    if (count <= t->capacity) return 0;
+
+    int *node = realloc(t->cpu_node, (size_t)count * sizeof(int));
+    if (node) t->cpu_node = node;
+    int *package = realloc(t->cpu_package, (size_t)count * sizeof(int));
+    if (package) t->cpu_package = package;
+    unsigned char *online = realloc(t->cpu_online, (size_t)count);
+    if (online) t->cpu_online = online;
+    if (!node || !package || !online) return -1;
+
+    t->capacity = count;
+    return 0;
+}
+
+// Узлы из node/online, CPU узла из nodeN/cpulist. Дескриптор meminfo
+// переезжает в новый массив, если узел с тем же номером уже был
+static void scan_nodes(Topology *t, unsigned char *mask) {
+    TopologyNode old[MAX_NUMA_NODES];
+    int old_count = t->node_count;
+    unsigned char ids[NODE_ID_LIMIT];
+    char path[PROCFS_PATH_MAX + 64], text[CPULIST_TEXT_SIZE];
+
+    memcpy(old, t->nodes, sizeof(TopologyNode) * old_count);
+    t->node_count = 0;
+
+    snprintf(path, sizeof(path), "%s/devices/system/node/online", t->sys_root);
+    int id_count = -1;
+    if (read_line(path, text, sizeof(text)) == 0) id_count = cpulist_parse(text, ids, NODE_ID_LIMIT);
+    t->numa = id_count > 0;
+
+    if (!t->numa) {
+        // ядро без CONFIG_NUMA: один узел, память - только глобальная
+        TopologyNode *n = &t->nodes[t->node_count++];
+        memset(n, 0, sizeof(TopologyNode));
+        procfile_init(&n->meminfo, "");
+        n->meminfo.missing = 1;
+        for (int i = 0; i < t->cpu_count; i++) t->cpu_node[i] = 0;
+    }
+
+    for (int id = 0; t->numa && id < id_count && id < NODE_ID_LIMIT; id++) {
+        if (!ids[id] || t->node_count >= MAX_NUMA_NODES) continue;
+
+        int index = t->node_count++;
+        TopologyNode *n = &t->nodes[index];
+        memset(n, 0, sizeof(TopologyNode));
+        n->id = id;
+        n->meminfo.fd = -1;
+        for (int j = 0; j < old_count; j++) {
+            if (old[j].id == id && old[j].meminfo.path[0]) {
+                n->meminfo = old[j].meminfo;
+                old[j].meminfo.fd = -1;
+                old[j].meminfo.path[0] = '\0';
+                break;
+            }
+        }
+        if (n->meminfo.fd < 0 && !n->meminfo.path[0]) {
+            snprintf(path, sizeof(path), "%s/devices/system/node/node%d/meminfo", t->sys_root, id);
+            procfile_init(&n->meminfo, path);
+        }
+
+        snprintf(path, sizeof(path), "%s/devices/system/node/node%d/cpulist", t->sys_root, id);
+        if (read_line(path, text, sizeof(text)) != 0) continue;
+        int max = cpulist_parse(text, mask, t->cpu_count);
+        for (int i = 0; i < max && i < t->cpu_count; i++) {
+            if (mask[i]) t->cpu_node[i] = index;
+        }
+    }
+
+    for (int j = 0; j < old_count; j++) {
+        procfile_close(&old[j].meminfo);
+    }
+}
+
+static int find_package(Topology *t, int id, int node) {
+    for (int i = 0; i < t->package_count; i++) {
+        if (t->packages[i].id == id) return i;
+    }
+    if (t->package_count >= MAX_PACKAGES) return -1;
+
+    TopologyPackage *p = &t->packages[t->package_count];
+    memset(p, 0, sizeof(TopologyPackage));
+    p->id = id;
+    p->node = node >= 0 ? t->nodes[node].id : -1;
+    return t->package_count++;
+}
+
+// Вызывается при старте и при смене набора включенных CPU: у выключенного
+// CPU каталога topology нет, а узлы и соседи по ядру меняются
+int topology_scan(Topology *t, const CoreStats *cores) {
+    char path[PROCFS_PATH_MAX + 64], text[CPULIST_TEXT_SIZE];
+
+    if (reserve_cpus(t, cores->count > 0 ? cores->count : 1) != 0) return -1;
+    unsigned char *mask = malloc((size_t)t->capacity);
+    if (!mask) return -1;
+
+    t->cpu_count = cores->count;
+    for (int i = 0; i < t->cpu_count; i++) {
+        t->cpu_node[i] = -1;
+        t->cpu_package[i] = -1;
+        t->cpu_online[i] = cores->online[i];
+    }
+
+    scan_nodes(t, mask);
+    for (int i = 0; i < t->node_count; i++) t->nodes[i].cpus = 0;
+    t->package_count = 0;
+    t->physical_cores = 0;
+    t->smt = 0;
+
+    for (int i = 0; i < t->cpu_count; i++) {
+        if (!t->cpu_online[i]) continue;
+        if (t->cpu_node[i] >= 0) t->nodes[t->cpu_node[i]].cpus++;
+
+        int package_id = 0;
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/topology/physical_package_id",
+                 t->sys_root, i);
+        if (read_line(path, text, sizeof(text)) == 0) package_id = atoi(text);
+
+        int package = find_package(t, package_id, t->cpu_node[i]);
+        t->cpu_package[i] = package;
+        if (package < 0) continue;
+        t->packages[package].threads++;
+
+        // физическое ядро считается у первого включенного CPU из соседей
+        int first = i, threads = 1;
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/topology/thread_siblings_list",
+                 t->sys_root, i);
+        if (read_line(path, text, sizeof(text)) == 0) {
+            int max = cpulist_parse(text, mask, t->cpu_count);
+            first = -1;
+            threads = 0;
+            for (int j = 0; j < max && j < t->cpu_count; j++) {
+                if (!mask[j] || !t->cpu_online[j]) continue;
+                if (first < 0) first = j;
+                threads++;
+            }
+        }
+        if (first == i || first < 0) {
+            t->packages[package].cores++;
+            t->physical_cores++;
+        }
+        if (threads > t->smt) t->smt = threads;
+    }
+
+    free(mask);
+    t->scans++;
+    return 0;
+}
+
+// Сумма разностей, а не среднее процентов: ядро с меньшим числом
+// тиков за интервал (только что включенное) не перевешивает остальные
+void topology_aggregate(Topology *t, const CoreStats *cores) {
+    for (int i = 0; i < t->node_count; i++) {
+        t->nodes[i].busy = t->nodes[i].total = 0;
+    }
+    for (int i = 0; i < t->package_count; i++) {
+        t->packages[i].busy = t->packages[i].total = 0;
+    }
+
+    int n = cores->count < t->cpu_count ? cores->count : t->cpu_count;
+    for (int i = 0; i < n; i++) {
+        if (!cores->online[i] || cores->total[i] < cores->prev_total[i]) continue;
+
+        uint64_t dt = cores->total[i] - cores->prev_total[i];
+        uint64_t di = cores->idle[i] >= cores->prev_idle[i] ? cores->idle[i] - cores->prev_idle[i] : 0;
+        uint64_t busy = dt - (di < dt ? di : dt);
+
+        if (t->cpu_node[i] >= 0) {
+            t->nodes[t->cpu_node[i]].busy += busy;
+            t->nodes[t->cpu_node[i]].total += dt;
+        }
+        if (t->cpu_package[i] >= 0) {
+            t->packages[t->cpu_package[i]].busy += busy;
+            t->packages[t->cpu_package[i]].total += dt;
+        }
+    }
+
+    for (int i = 0; i < t->node_count; i++) {
+        TopologyNode *node = &t->nodes[i];
+        node->usage = node->total ? 100.0 * (double)node->busy / (double)node->total : 0.0;
+    }
+    for (int i = 0; i < t->package_count; i++) {
+        TopologyPackage *p = &t->packages[i];
+        p->usage = p->total ? 100.0 * (double)p->busy / (double)p->total : 0.0;
+    }
+}
+
+void topology_update(Topology *t, const CoreStats *cores) {
+    if (cores->count != t->cpu_count ||
+        memcmp(cores->online, t->cpu_online, (size_t)cores->count) != 0) {
+        topology_scan(t, cores);
+    }
+
+    topology_aggregate(t, cores);
+
+    for (int i = 0; i < t->node_count; i++) {
+        TopologyNode *n = &t->nodes[i];
+        n->has_memory = procfile_read(&n->meminfo, t->buffer, sizeof(t->buffer)) > 0 &&
+                        parse_node_meminfo(t->buffer, n) == 0;
+    }
+}
+
+// "Node 0 MemTotal:       16318284 kB": ключ идет после номера узла
+int parse_node_meminfo(const char *text, TopologyNode *node) {
+    unsigned long long total = 0, free_kb = 0, used = 0;
+    int has_total = 0, has_used = 0;
+    const char *line = text;
+
+    while (line && *line) {
+        const char *p = skip_token(skip_token(line));
+        p = skip_spaces(p);
+
+        if (strncmp(p, "MemTotal:", 9) == 0) {
+            p += 9;
+            total = parse_ull(&p);
+            has_total = 1;
+        } else if (strncmp(p, "MemFree:", 8) == 0) {
+            p += 8;
+            free_kb = parse_ull(&p);
+        } else if (strncmp(p, "MemUsed:", 8) == 0) {
+            p += 8;
+            used = parse_ull(&p);
+            has_used = 1;
+        }
+
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+
+    if (!has_total) return -1;
+    if (!has_used) used = total > free_kb ? total - free_kb : 0;
+
+    node->mem_total = total * 1024;
+    node->mem_free = free_kb * 1024;
+    node->mem_used = used * 1024;
+    node->mem_percentage = total ? (double)used / (double)total * 100.0 : 0.0;
+    return 0;
+}
+
+void write_topology_json(JsonWriter *w, const Topology *t) {
+    double cpu_min = 0.0, cpu_max = 0.0, mem_min = 0.0, mem_max = 0.0;
+    int mem_nodes = 0;
+
+    if (t->numa) jw_lit(w, "{\n    \"numa\": true");
+    else jw_lit(w, "{\n    \"numa\": false");
+    jw_lit(w, ",\n    \"physical_cores\": ");
+    jw_int(w, t->physical_cores);
+    jw_lit(w, ",\n    \"threads_per_core\": ");
+    jw_int(w, t->smt);
+    jw_lit(w, ",\n    \"nodes\": [");
+
+    for (int i = 0; i < t->node_count; i++) {
+        const TopologyNode *n = &t->nodes[i];
+
+        if (i == 0 || n->usage < cpu_min) cpu_min = n->usage;
+        if (i == 0 || n->usage > cpu_max) cpu_max = n->usage;
+
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n      {\"node\": ");
+        jw_int(w, n->id);
+        jw_lit(w, ", \"cpus\": ");
+        jw_int(w, n->cpus);
+        jw_lit(w, ", \"usage\": ");
+        jw_fixed1(w, n->usage);
+        if (n->has_memory) {
+            if (mem_nodes == 0 || n->mem_percentage < mem_min) mem_min = n->mem_percentage;
+            if (mem_nodes == 0 || n->mem_percentage > mem_max) mem_max = n->mem_percentage;
+            mem_nodes++;
+
+            jw_lit(w, ", \"memory\": {\"total\": ");
+            jw_uint(w, n->mem_total);
+            jw_lit(w, ", \"used\": ");
+            jw_uint(w, n->mem_used);
+            jw_lit(w, ", \"free\": ");
+            jw_uint(w, n->mem_free);
+            jw_lit(w, ", \"percentage\": ");
+            jw_fixed1(w, n->mem_percentage);
+            jw_char(w, '}');
+        }
+        jw_char(w, '}');
+    }
+
+    if (t->node_count > 0) jw_lit(w, "\n    ");
+    jw_lit(w, "],\n    \"packages\": [");
+
+    for (int i = 0; i < t->package_count; i++) {
+        const TopologyPackage *p = &t->packages[i];
+
+        if (i > 0) jw_char(w, ',');
+        jw_lit(w, "\n      {\"package\": ");
+        jw_int(w, p->id);
+        jw_lit(w, ", \"node\": ");
+        jw_int(w, p->node);
+        jw_lit(w, ", \"cores\": ");
+        jw_int(w, p->cores);
+        jw_lit(w, ", \"threads\": ");
+        jw_int(w, p->threads);
+        jw_lit(w, ", \"usage\": ");
+        jw_fixed1(w, p->usage);
+        jw_char(w, '}');
+    }
+
+    if (t->package_count > 0) jw_lit(w, "\n    ");
+    // разброс между самым загруженным и самым свободным узлом
+    jw_lit(w, "],\n    \"cpu_imbalance\": ");
+    jw_fixed1(w, cpu_max - cpu_min);
+    jw_lit(w, ",\n    \"memory_imbalance\": ");
+    jw_fixed1(w, mem_max - mem_min);
+    jw_lit(w, "\n  }");
+}
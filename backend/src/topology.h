@@ -0,0 +1,79 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stdint.h>
+#include "config.h"
+#include "core_stats.h"
+#include "json_writer.h"
+#include "procfs.h"
+
+#define NODE_MEMINFO_BUFFER_SIZE 4096
+
+/*
+ * Топология CPU: NUMA-узлы (/sys/devices/system/node), пакеты (сокеты),
+ * физические ядра и SMT-соседи (cpuN/topology). Сканируется при старте и
+ * заново, когда меняется набор включенных CPU в /proc/stat (hotplug).
+ * Загрузка узлов и пакетов - сумма разностей счетчиков их ядер за тик,
+ * память узла - nodeN/meminfo через закешированный дескриптор.
+ */
+
+typedef struct {
+    int id;                     // N из nodeN
+    int cpus;                   // включенные CPU узла
+    double usage;               // % за последний тик
+    uint64_t busy;              // суммы разностей за тик
+    uint64_t total;
+
+    ProcFile meminfo;
+    int has_memory;
+    unsigned long long mem_total;   // байты
+    unsigned long long mem_free;
+    unsigned long long mem_used;
+    double mem_percentage;
+} TopologyNode;
+
+typedef struct {
+    int id;                     // physical_package_id
+    int node;                   // узел первого CPU пакета
+    int cores;                  // физические ядра
+    int threads;                // включенные CPU
+    double usage;
+    uint64_t busy;
+    uint64_t total;
+} TopologyPackage;
+
+typedef struct {
+    char sys_root[PROCFS_PATH_MAX];
+    int numa;                   // есть /sys/devices/system/node
+
+    // по номеру CPU, снимок на момент сканирования
+    int capacity;
+    int cpu_count;
+    int *cpu_node;              // индекс в nodes или -1
+    int *cpu_package;           // индекс в packages или -1
+    unsigned char *cpu_online;
+
+    TopologyNode nodes[MAX_NUMA_NODES];
+    int node_count;
+    TopologyPackage packages[MAX_PACKAGES];
+    int package_count;
+    int physical_cores;
+    int smt;                    // максимум потоков на ядро
+    unsigned long scans;
+
+    char buffer[NODE_MEMINFO_BUFFER_SIZE];
+} Topology;
+
+void topology_init(Topology *t, const char *sys_root);
+void topology_free(Topology *t);
+int topology_scan(Topology *t, const CoreStats *cores);
+
+// После core_stats_compute и до core_stats_rotate: пересканирует при
+// hotplug, суммирует разности ядер и читает память узлов
+void topology_update(Topology *t, const CoreStats *cores);
+void topology_aggregate(Topology *t, const CoreStats *cores);
+
+int parse_node_meminfo(const char *text, TopologyNode *node);
+void write_topology_json(JsonWriter *w, const Topology *t);
+
+#endif
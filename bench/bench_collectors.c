@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "proc_parser.h"
+#include "disk_collector.h"
+#include "net_collector.h"
+#include "psi_collector.h"
+#include "cgroup_collector.h"
+#include "process_detail.h"
+#include "topology.h"
+#include "bench/bench_common.h"
+#include "tests/fixture_tree.h"
+
+typedef struct {
+    CPUStats cpu;
+    CoreStats cores;
+    Topology topology;
+    MemoryInfo mem;
+    ProcessInfo processes[MAX_PROCESSES];
+    int process_count;
+    DiskCollector disks;
+    NetCollector network;
+    PsiCollector pressure;
+    CgroupCollector cgroups;
+    ProcessDetailCollector details;
+} CollectorState;
+
+static CollectorState state;
+
+static void op_read_cpu_stats(void *arg) {
+    CollectorState *s = arg;
+    read_cpu_stats(&s->cpu, &s->cores);
+}
+
+static void op_core_stats_compute(void *arg) {
+    CollectorState *s = arg;
+    core_stats_compute(&s->cores);
+    core_stats_rotate(&s->cores);
+}
+
+static void op_topology_update(void *arg) {
+    CollectorState *s = arg;
+    topology_update(&s->topology, &s->cores);
+}
+
+static void op_read_memory_info(void *arg) {
+    CollectorState *s = arg;
+    read_memory_info(&s->mem);
+}
+
+static void op_get_processes(void *arg) {
+    CollectorState *s = arg;
+    get_processes(s->processes, &s->process_count);
+}
+
+static void op_disk_sample(void *arg) {
+    CollectorState *s = arg;
+    disk_collector_sample(&s->disks, 2.0);
+}
+
+static void op_net_sample(void *arg) {
+    CollectorState *s = arg;
+    net_collector_sample(&s->network, 2.0);
+}
+
+static void op_psi_sample(void *arg) {
+    CollectorState *s = arg;
+    psi_collector_sample(&s->pressure);
+}
+
+static void op_cgroup_sample(void *arg) {
+    CollectorState *s = arg;
+    cgroup_collector_sample(&s->cgroups, 2.0, 0);
+}
+
+static void op_cgroup_attribute(void *arg) {
+    CollectorState *s = arg;
+    cgroup_attribute_processes(&s->cgroups, s->processes, s->process_count);
+}
+
+static void op_process_detail(void *arg) {
+    CollectorState *s = arg;
+    process_detail_sample(&s->details, s->processes, s->process_count, 2.0);
+}
+
+static int bench_tree(const FixtureSpec *spec, int iterations) {
+    char root[256], proc[300], sys[300], path[320], path2[320], params[128];
+    BenchResult r;
+
+    if (fixture_tree_create(root, sizeof(root), spec) != 0) {
+        fprintf(stderr, "cannot create fixture tree\n");
+        return -1;
+    }
+    snprintf(proc, sizeof(proc), "%s/proc", root);
+    snprintf(sys, sizeof(sys), "%s/sys", root);
+    set_proc_root(proc);
+    set_sys_root(sys);
+    snprintf(params, sizeof(params), "processes=%d cores=%d disks=%d interfaces=%d cgroups=%d",
+             spec->processes, spec->cores, spec->disks, spec->interfaces, spec->cgroups);
+
+    core_stats_init(&state.cores, core_stats_possible_cpus(sys));
+    r = bench_run(op_read_cpu_stats, &state, iterations);
+    bench_report("read_cpu_stats", params, &r);
+    r = bench_run(op_core_stats_compute, &state, iterations * 10);
+    bench_report("core_stats_compute", params, &r);
+    topology_init(&state.topology, sys);
+    topology_scan(&state.topology, &state.cores);
+    r = bench_run(op_topology_update, &state, iterations);
+    bench_report("topology_update", params, &r);
+    topology_free(&state.topology);
+    core_stats_free(&state.cores);
+    r = bench_run(op_read_memory_info, &state, iterations);
+    bench_report("read_memory_info", params, &r);
+    r = bench_run(op_get_processes, &state, iterations / 10);
+    bench_report("get_processes", params, &r);
+
+    snprintf(path, sizeof(path), "%s/diskstats", proc);
+    snprintf(path2, sizeof(path2), "%s/block", sys);
+    disk_collector_init(&state.disks, path, path2);
+    r = bench_run(op_disk_sample, &state, iterations);
+    bench_report("disk_collector_sample", params, &r);
+    disk_collector_free(&state.disks);
+
+    snprintf(path, sizeof(path), "%s/net/dev", proc);
+    net_collector_init(&state.network, path, 1);
+    r = bench_run(op_net_sample, &state, iterations);
+    bench_report("net_collector_sample", params, &r);
+    net_collector_free(&state.network);
+
+    snprintf(path, sizeof(path), "%s/pressure", proc);
+    psi_collector_init(&state.pressure, path);
+    r = bench_run(op_psi_sample, &state, iterations);
+    bench_report("psi_collector_sample", params, &r);
+    psi_collector_free(&state.pressure);
+
+    snprintf(path, sizeof(path), "%s/fs/cgroup", sys);
+    if (cgroup_collector_init(&state.cgroups, path, proc) == 0) {
+        cgroup_collector_scan(&state.cgroups);
+        r = bench_run(op_cgroup_sample, &state, iterations);
+        bench_report("cgroup_collector_sample", params, &r);
+        r = bench_run(op_cgroup_attribute, &state, iterations);
+        bench_report("cgroup_attribute_processes", params, &r);
+        cgroup_collector_free(&state.cgroups);
+    }
+
+    process_detail_init(&state.details, proc, PROC_DETAIL_TOP_N);
+    r = bench_run(op_process_detail, &state, iterations);
+    bench_report("process_detail_sample", params, &r);
+    process_detail_free(&state.details);
+
+    fixture_tree_remove(root);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    if (iterations < 10) iterations = 200;
+
+    static const FixtureSpec sizes[] = {
+        {.processes = 64, .cores = 4, .disks = 2, .interfaces = 4, .cgroups = 8},
+        {.processes = 256, .cores = 16, .disks = 8, .interfaces = 32, .cgroups = 32},
+        {.processes = MAX_PROCESSES, .cores = 512, .disks = MAX_DISKS, .interfaces = 128,
+         .cgroups = 64},
+    };
+
+    bench_init();
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (bench_tree(&sizes[i], iterations) != 0) return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include "bench_common.h"
+
+#define SYSCALL_ITERATIONS_MAX 50
+
+static FILE *out = NULL;
+static unsigned long alloc_count = 0;
+
+// Подсчет аллокаций: malloc/calloc/realloc бинаря бенчмарка перекрывают
+// libc для всех вызывающих, включая fopen/opendir внутри glibc
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+    alloc_count++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    alloc_count++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    alloc_count++;
+    return __libc_realloc(ptr, size);
+}
+
+unsigned long bench_alloc_count(void) {
+    return alloc_count;
+}
+
+void bench_init(void) {
+    fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    out = (fd >= 0) ? fdopen(fd, "w") : stderr;
+    setvbuf(out, NULL, _IOLBF, 0);
+    if (!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "cannot silence stdout\n");
+    }
+}
+
+FILE *bench_out(void) {
+    return out ? out : stderr;
+}
+
+double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Системные вызовы считает ptrace в дочернем процессе: после fork у него
+// то же прогретое состояние (открытые fd, кеши), что и у замера времени
+static long count_syscalls(BenchFn fn, void *arg, int iterations) {
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+
+    if (pid == 0) {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) _exit(1);
+        raise(SIGSTOP);
+        for (int i = 0; i < iterations; i++) {
+            fn(arg);
+        }
+        _exit(0);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFSTOPPED(status)) {
+        waitpid(pid, &status, 0);
+        return -1;
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, NULL, (void *)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL));
+
+    long stops = 0;
+    for (;;) {
+        if (ptrace(PTRACE_SYSCALL, pid, NULL, NULL) != 0) break;
+        if (waitpid(pid, &status, 0) < 0) break;
+        if (WIFEXITED(status) || WIFSIGNALED(status)) break;
+        if (WIFSTOPPED(status) && WSTOPSIG(status) == (SIGTRAP | 0x80)) stops++;
+    }
+
+    // вход и выход - две остановки; exit_group дает только вход
+    return (stops + 1) / 2;
+}
+
+BenchResult bench_run(BenchFn fn, void *arg, int iterations) {
+    BenchResult r;
+
+    if (iterations <= 0) iterations = 1;
+    fn(arg);
+
+    unsigned long allocs_before = alloc_count;
+    double start = bench_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        fn(arg);
+    }
+    r.ns_per_op = (bench_now_ns() - start) / iterations;
+    r.allocs_per_op = (double)(alloc_count - allocs_before) / iterations;
+
+    int traced = iterations < SYSCALL_ITERATIONS_MAX ? iterations : SYSCALL_ITERATIONS_MAX;
+    long baseline = count_syscalls(fn, arg, 0);
+    long total = count_syscalls(fn, arg, traced);
+    r.syscalls_per_op = (baseline < 0 || total < 0) ? -1.0 : (double)(total - baseline) / traced;
+
+    return r;
+}
+
+void bench_report(const char *op, const char *params, const BenchResult *r) {
+    fprintf(bench_out(), "%s %s ns/op=%.0f syscalls/op=%.1f allocs/op=%.1f\n",
+            op, params, r->ns_per_op, r->syscalls_per_op, r->allocs_per_op);
+}
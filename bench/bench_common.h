@@ -0,0 +1,25 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdio.h>
+
+typedef void (*BenchFn)(void *arg);
+
+typedef struct {
+    double ns_per_op;
+    double syscalls_per_op;     // -1, если ptrace недоступен
+    double allocs_per_op;
+} BenchResult;
+
+// Отчет - одна строка на замер, поля key=value:
+//   <op> <параметры> ns/op=... syscalls/op=... allocs/op=...
+// Логи кода под замером (printf в коллекторах) уходят в /dev/null
+void bench_init(void);
+FILE *bench_out(void);
+double bench_now_ns(void);
+unsigned long bench_alloc_count(void);
+
+BenchResult bench_run(BenchFn fn, void *arg, int iterations);
+void bench_report(const char *op, const char *params, const BenchResult *r);
+
+#endif
@@ -0,0 +1,484 @@
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/*
+ * Нагрузочный клиент для запущенного system_monitor:
+ *   bench_http [-H host] [-p port] [-c соединений] [-t потоков] [-d секунд]
+ *              [-k] [-m system=8,history=1,health=1]
+ * Каждый поток ведет свои соединения через epoll. -k - keep-alive: соединение
+ * переиспользуется, пока сервер не ответит "Connection: close".
+ * До и после прогона читается /api/health, во время - чаще тиков: счетчик
+ * тиков и интервалы тиков внутри прогона показывают, держит ли
+ * update_data_thread() расписание под нагрузкой. tick_max_lag_ms сервера -
+ * максимум за все время работы и в оценку не входит.
+ */
+
+#define MAX_ENDPOINTS 3
+#define HEADER_MAX 4096
+#define RECV_CHUNK 65536
+
+typedef struct {
+    const char *name;
+    const char *path;
+    int weight;
+} Endpoint;
+
+static Endpoint endpoints[MAX_ENDPOINTS] = {
+    {"system", "/api/system", 8},
+    {"history", "/api/history", 1},
+    {"health", "/api/health", 1},
+};
+
+typedef struct {
+    double *values;
+    size_t count;
+    size_t cap;
+} Samples;
+
+typedef enum { CONN_IDLE, CONN_CONNECTING, CONN_READING } ConnState;
+
+typedef struct {
+    int fd;
+    ConnState state;
+    int endpoint;
+    double started_ns;
+    char header[HEADER_MAX];
+    size_t header_len;
+    int headers_done;
+    long body_left;         // -1: Content-Length нет, читаем до EOF
+    int server_close;
+} Connection;
+
+typedef struct {
+    pthread_t thread;
+    int connections;
+    unsigned seed;
+    Samples latency[MAX_ENDPOINTS];
+    unsigned long errors;
+    unsigned long reconnects;
+    unsigned long long bytes;
+} Worker;
+
+static struct sockaddr_in server_addr;
+static int keep_alive = 0;
+static int total_weight = 0;
+static volatile int stop = 0;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void samples_add(Samples *s, double value) {
+    if (s->count == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 4096;
+        double *grown = realloc(s->values, cap * sizeof(double));
+        if (!grown) return;
+        s->values = grown;
+        s->cap = cap;
+    }
+    s->values[s->count++] = value;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const Samples *s, double q) {
+    if (s->count == 0) return 0.0;
+    size_t i = (size_t)(q * (s->count - 1) + 0.5);
+    return s->values[i];
+}
+
+static int pick_endpoint(unsigned *seed) {
+    int r = rand_r(seed) % total_weight;
+    for (int i = 0; i < MAX_ENDPOINTS; i++) {
+        if (r < endpoints[i].weight) return i;
+        r -= endpoints[i].weight;
+    }
+    return 0;
+}
+
+static int conn_open(int epfd, Connection *c) {
+    c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (c->fd < 0) return -1;
+    int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (connect(c->fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) != 0 &&
+        errno != EINPROGRESS) {
+        close(c->fd);
+        c->fd = -1;
+        return -1;
+    }
+
+    struct epoll_event ev = {.events = EPOLLOUT, .data.ptr = c};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+    c->state = CONN_CONNECTING;
+    return 0;
+}
+
+static void conn_close(Connection *c) {
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+    c->state = CONN_IDLE;
+}
+
+static int conn_send(int epfd, Worker *w, Connection *c) {
+    char request[256];
+    c->endpoint = pick_endpoint(&w->seed);
+    int len = snprintf(request, sizeof(request),
+                       "GET %s HTTP/1.1\r\nHost: bench\r\nConnection: %s\r\n\r\n",
+                       endpoints[c->endpoint].path, keep_alive ? "keep-alive" : "close");
+
+    c->started_ns = now_ns();
+    if (send(c->fd, request, len, MSG_NOSIGNAL) != len) return -1;
+
+    c->header_len = 0;
+    c->headers_done = 0;
+    c->body_left = -1;
+    c->server_close = !keep_alive;
+    c->state = CONN_READING;
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = c};
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+// Разбор заголовков ответа: статус, Content-Length, Connection
+static int parse_headers(Connection *c, size_t header_end) {
+    c->header[header_end] = '\0';
+    int status = 0;
+    if (sscanf(c->header, "HTTP/1.%*d %d", &status) != 1 || status != 200) return -1;
+
+    for (char *line = strstr(c->header, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, "Content-Length:", 15) == 0) {
+            c->body_left = atol(line + 17);
+        } else if (strncasecmp(line + 2, "Connection: close", 17) == 0) {
+            c->server_close = 1;
+        }
+    }
+    return 0;
+}
+
+static void finish_request(int epfd, Worker *w, Connection *c) {
+    samples_add(&w->latency[c->endpoint], (now_ns() - c->started_ns) / 1000.0);
+
+    if (c->server_close) {
+        conn_close(c);
+        w->reconnects++;
+        if (!stop && conn_open(epfd, c) != 0) w->errors++;
+    } else if (!stop && conn_send(epfd, w, c) != 0) {
+        w->errors++;
+        conn_close(c);
+        conn_open(epfd, c);
+    }
+}
+
+static void conn_fail(int epfd, Worker *w, Connection *c) {
+    w->errors++;
+    conn_close(c);
+    if (!stop) conn_open(epfd, c);
+}
+
+static void conn_read(int epfd, Worker *w, Connection *c, char *chunk) {
+    for (;;) {
+        ssize_t n = recv(c->fd, chunk, RECV_CHUNK, 0);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            conn_fail(epfd, w, c);
+            return;
+        }
+        if (n == 0) {
+            // без Content-Length тело кончается закрытием соединения
+            if (c->headers_done && c->body_left < 0) {
+                c->server_close = 1;
+                finish_request(epfd, w, c);
+            } else {
+                conn_fail(epfd, w, c);
+            }
+            return;
+        }
+        w->bytes += n;
+
+        size_t body = (size_t)n;
+        if (!c->headers_done) {
+            size_t copy = (size_t)n;
+            if (c->header_len + copy > HEADER_MAX - 1) copy = HEADER_MAX - 1 - c->header_len;
+            memcpy(c->header + c->header_len, chunk, copy);
+            c->header_len += copy;
+            c->header[c->header_len] = '\0';
+
+            char *end = strstr(c->header, "\r\n\r\n");
+            if (!end) {
+                if (c->header_len >= HEADER_MAX - 1) {
+                    conn_fail(epfd, w, c);
+                    return;
+                }
+                continue;
+            }
+            size_t header_end = end - c->header + 4;
+            if (parse_headers(c, header_end) != 0) {
+                conn_fail(epfd, w, c);
+                return;
+            }
+            c->headers_done = 1;
+            // хвост после заголовков - уже начало тела
+            body = (c->header_len - header_end) + ((size_t)n - copy);
+        }
+
+        if (c->body_left >= 0) {
+            c->body_left -= (long)body;
+            if (c->body_left <= 0) {
+                finish_request(epfd, w, c);
+                return;
+            }
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    Connection *conns = calloc(w->connections, sizeof(Connection));
+    char *chunk = malloc(RECV_CHUNK);
+    struct epoll_event events[256];
+
+    if (epfd < 0 || !conns || !chunk) {
+        fprintf(stderr, "worker setup failed\n");
+        free(conns);
+        free(chunk);
+        return NULL;
+    }
+
+    for (int i = 0; i < w->connections; i++) {
+        conns[i].fd = -1;
+        if (conn_open(epfd, &conns[i]) != 0) w->errors++;
+    }
+
+    while (!stop) {
+        int n = epoll_wait(epfd, events, 256, 100);
+        for (int i = 0; i < n; i++) {
+            Connection *c = events[i].data.ptr;
+            if (c->fd < 0) continue;
+
+            if (c->state == CONN_CONNECTING) {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err != 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+                    conn_fail(epfd, w, c);
+                } else if (conn_send(epfd, w, c) != 0) {
+                    conn_fail(epfd, w, c);
+                }
+            } else if (c->state == CONN_READING) {
+                conn_read(epfd, w, c, chunk);
+            }
+        }
+    }
+
+    for (int i = 0; i < w->connections; i++) conn_close(&conns[i]);
+    close(epfd);
+    free(conns);
+    free(chunk);
+    return NULL;
+}
+
+// Блокирующий GET /api/health; возвращает 0 и поля расписания тиков
+static int read_health(unsigned long *ticks, double *interval_ms, double *duration_ms,
+                       int *target_ms) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    const char *request = "GET /api/health HTTP/1.1\r\nHost: bench\r\nConnection: close\r\n\r\n";
+    if (send(fd, request, strlen(request), MSG_NOSIGNAL) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    char response[4096];
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(response) - 1 && (n = recv(fd, response + len, sizeof(response) - 1 - len, 0)) > 0) {
+        len += n;
+    }
+    close(fd);
+    response[len] = '\0';
+
+    const char *p;
+    if (!(p = strstr(response, "\"ticks\":"))) return -1;
+    *ticks = strtoul(p + 8, NULL, 10);
+    if ((p = strstr(response, "\"tick_interval_ms\":"))) *interval_ms = atof(p + 19);
+    if ((p = strstr(response, "\"tick_duration_ms\":"))) *duration_ms = atof(p + 19);
+    if ((p = strstr(response, "\"tick_interval_target_ms\":"))) *target_ms = atoi(p + 26);
+    return 0;
+}
+
+static int parse_mix(char *mix) {
+    for (int i = 0; i < MAX_ENDPOINTS; i++) endpoints[i].weight = 0;
+
+    char *saveptr = NULL;
+    for (char *tok = strtok_r(mix, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        char *eq = strchr(tok, '=');
+        if (!eq) return -1;
+        *eq = '\0';
+        int found = 0;
+        for (int i = 0; i < MAX_ENDPOINTS; i++) {
+            if (strcmp(tok, endpoints[i].name) == 0) {
+                endpoints[i].weight = atoi(eq + 1);
+                found = 1;
+            }
+        }
+        if (!found) return -1;
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-H host] [-p port] [-c connections] [-t threads] [-d seconds] "
+                    "[-k] [-m system=8,history=1,health=1]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    int port = 8080, connections = 64, threads = 4, duration = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "H:p:c:t:d:km:")) != -1) {
+        switch (opt) {
+        case 'H': host = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        case 'c': connections = atoi(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 'd': duration = atoi(optarg); break;
+        case 'k': keep_alive = 1; break;
+        case 'm':
+            if (parse_mix(optarg) != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (connections < threads) connections = threads;
+    if (duration < 1) duration = 1;
+    for (int i = 0; i < MAX_ENDPOINTS; i++) total_weight += endpoints[i].weight;
+    if (total_weight <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_STREAM}, *res;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0) {
+        fprintf(stderr, "cannot resolve %s\n", host);
+        return 1;
+    }
+    server_addr = *(struct sockaddr_in *)res->ai_addr;
+    server_addr.sin_port = htons(port);
+    freeaddrinfo(res);
+
+    unsigned long ticks_before = 0, ticks_after = 0;
+    double interval_ms = 0, duration_ms = 0;
+    int target_ms = 2000;
+    if (read_health(&ticks_before, &interval_ms, &duration_ms, &target_ms) != 0) {
+        fprintf(stderr, "no system_monitor at %s:%d (/api/health)\n", host, port);
+        return 1;
+    }
+
+    Worker *workers = calloc(threads, sizeof(Worker));
+    if (!workers) return 1;
+    double start = now_ns();
+    for (int i = 0; i < threads; i++) {
+        workers[i].connections = connections / threads + (i < connections % threads);
+        workers[i].seed = 7 + i;
+        pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+    }
+
+    // опрос чаще тиков: tick_interval_ms каждого нового тика окна - его отставание
+    double max_lag_ms = 0;
+    unsigned long seen_ticks = ticks_before;
+    long poll_us = target_ms * 250L;
+    if (poll_us < 10000) poll_us = 10000;
+    double deadline = start + duration * 1e9;
+    for (double left; (left = deadline - now_ns()) > 0;) {
+        usleep(left / 1000 < poll_us ? (useconds_t)(left / 1000) : (useconds_t)poll_us);
+        unsigned long ticks = 0;
+        if (read_health(&ticks, &interval_ms, &duration_ms, &target_ms) == 0 && ticks != seen_ticks) {
+            seen_ticks = ticks;
+            if (interval_ms - target_ms > max_lag_ms) max_lag_ms = interval_ms - target_ms;
+        }
+    }
+    stop = 1;
+    for (int i = 0; i < threads; i++) pthread_join(workers[i].thread, NULL);
+    double seconds = (now_ns() - start) / 1e9;
+
+    // все задержки в один массив на эндпоинт
+    Samples all = {0}, per[MAX_ENDPOINTS] = {{0}};
+    unsigned long errors = 0, reconnects = 0;
+    unsigned long long bytes = 0;
+    for (int i = 0; i < threads; i++) {
+        for (int e = 0; e < MAX_ENDPOINTS; e++) {
+            for (size_t j = 0; j < workers[i].latency[e].count; j++) {
+                samples_add(&per[e], workers[i].latency[e].values[j]);
+                samples_add(&all, workers[i].latency[e].values[j]);
+            }
+            free(workers[i].latency[e].values);
+        }
+        errors += workers[i].errors;
+        reconnects += workers[i].reconnects;
+        bytes += workers[i].bytes;
+    }
+
+    qsort(all.values, all.count, sizeof(double), compare_double);
+    printf("http_load connections=%d threads=%d keepalive=%d seconds=%.1f requests=%zu errors=%lu "
+           "reconnects=%lu rps=%.0f MB/s=%.1f p50_us=%.0f p99_us=%.0f p999_us=%.0f\n",
+           connections, threads, keep_alive, seconds, all.count, errors, reconnects,
+           all.count / seconds, bytes / seconds / 1e6,
+           percentile(&all, 0.50), percentile(&all, 0.99), percentile(&all, 0.999));
+
+    for (int e = 0; e < MAX_ENDPOINTS; e++) {
+        if (per[e].count == 0) continue;
+        qsort(per[e].values, per[e].count, sizeof(double), compare_double);
+        printf("http_endpoint path=%s weight=%d requests=%zu rps=%.0f p50_us=%.0f p99_us=%.0f "
+               "p999_us=%.0f\n",
+               endpoints[e].path, endpoints[e].weight, per[e].count, per[e].count / seconds,
+               percentile(&per[e], 0.50), percentile(&per[e], 0.99), percentile(&per[e], 0.999));
+        free(per[e].values);
+    }
+    free(all.values);
+    free(workers);
+
+    // тики за прогон против ожидаемых по интервалу; пропуск тика - отставание сбора
+    if (read_health(&ticks_after, &interval_ms, &duration_ms, &target_ms) != 0) {
+        fprintf(stderr, "/api/health did not answer after the run\n");
+        return 1;
+    }
+    double expected = seconds * 1000.0 / target_ms;
+    unsigned long ticks = ticks_after - ticks_before;
+    int on_schedule = ticks + 1 >= (unsigned long)expected && max_lag_ms < target_ms / 2.0;
+    printf("tick_schedule interval_ms=%d ticks=%lu expected=%.1f max_lag_ms=%.1f "
+           "last_duration_ms=%.1f on_schedule=%s\n",
+           target_ms, ticks, expected, max_lag_ms, duration_ms, on_schedule ? "yes" : "no");
+
+    return on_schedule ? 0 : 2;
+}
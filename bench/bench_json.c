@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "json_formatter.h"
+#include "history.h"
+#include "lttb.h"
+#include "string_arena.h"
+#include "bench/bench_common.h"
+
+#define BENCH_CORES 512
+#define BENCH_PROCESSES 1000
+#define BENCH_SERIES_POINTS 1000000
+
+typedef struct {
+    CPUStats cpu;
+    CoreStats cores;
+    MemoryInfo mem;
+    GPUInfo gpu;
+    ProcessInfo processes[BENCH_PROCESSES];
+    int process_count;
+    HistoryData history;
+    char buffer[131072];
+} JsonBench;
+
+static JsonBench bench;
+static StringArena strings;
+
+static void fill_snapshot(CPUStats *cpu, CoreStats *cores, MemoryInfo *mem, GPUInfo *gpu,
+                          ProcessInfo *processes) {
+    char text[128];
+
+    string_arena_init(&strings);
+    memset(cpu, 0, sizeof(CPUStats));
+    cpu->usage_percent = 37.4;
+    cpu->temperature = 61.2;
+    cpu->frequency = 3400;
+
+    core_stats_init(cores, BENCH_CORES);
+    for (int i = 0; i < BENCH_CORES; i++) {
+        cores->online[i] = 1;
+        cores->usage[i] = (i * 7919 % 1000) / 10.0;
+    }
+
+    mem->total = 512ULL * 1024 * 1024 * 1024;
+    mem->used = 301ULL * 1024 * 1024 * 1024;
+    mem->free = 150ULL * 1024 * 1024 * 1024;
+    mem->cached = 61ULL * 1024 * 1024 * 1024;
+    mem->percentage = 58.8;
+
+    memset(gpu, 0, sizeof(GPUInfo));
+    gpu->usage = 71.0;
+    gpu->memory_total = 80ULL * 1024 * 1024 * 1024;
+    gpu->memory_used = 40ULL * 1024 * 1024 * 1024;
+    gpu->temperature = 66.0;
+    gpu->power = 310.5;
+    gpu->clock = 1980;
+    strcpy(gpu->name, "NVIDIA H100 80GB HBM3");
+
+    for (int i = 0; i < BENCH_PROCESSES; i++) {
+        ProcessInfo *p = &processes[i];
+        memset(p, 0, sizeof(ProcessInfo));
+        p->pid = 1000 + i;
+        int len = snprintf(text, sizeof(text), "worker-%d", i);
+        p->name = string_arena_intern(&strings, text, len);
+        p->state = (i % 5 == 0) ? 'R' : 'S';
+        p->rss = 4096 + i * 17;
+        p->cpu_usage = (BENCH_PROCESSES - i) / 10.0;
+        len = snprintf(text, sizeof(text),
+                       "/usr/bin/worker --id=%d --config=\"/etc/worker/%d.conf\" --verbose", i, i);
+        p->command_line = string_arena_intern(&strings, text, len);
+    }
+}
+
+static void op_snapshot(void *arg) {
+    JsonBench *b = arg;
+    format_system_info_json(b->buffer, sizeof(b->buffer), &b->cpu, &b->cores,
+                            &b->mem, &b->gpu, b->processes, b->process_count, NULL);
+}
+
+static void op_history(void *arg) {
+    JsonBench *b = arg;
+    get_history_json(b->buffer, sizeof(b->buffer), &b->history);
+}
+
+// Ряд на миллион точек: суточная волна, шум и редкие пики
+typedef struct {
+    long *x;
+    double *y;
+    int *out;
+    int points;
+} LttbBench;
+
+static void op_lttb(void *arg) {
+    LttbBench *b = arg;
+    lttb_select(b->x, b->y, BENCH_SERIES_POINTS, 0, BENCH_SERIES_POINTS, b->points, b->out);
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 20000;
+    if (iterations <= 0) iterations = 20000;
+
+    static const int sizes[][2] = {{4, 64}, {32, 256}, {BENCH_CORES, BENCH_PROCESSES}};
+    char params[96];
+    BenchResult r;
+
+    bench_init();
+    fill_snapshot(&bench.cpu, &bench.cores, &bench.mem, &bench.gpu, bench.processes);
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench.cores.count = bench.cores.online_count = sizes[i][0];
+        bench.process_count = sizes[i][1];
+        op_snapshot(&bench);
+        snprintf(params, sizeof(params), "cores=%d processes=%d bytes=%zu",
+                 bench.cores.count, bench.process_count, strlen(bench.buffer));
+        r = bench_run(op_snapshot, &bench, iterations);
+        bench_report("format_system_info_json", params, &r);
+    }
+
+    init_history(&bench.history);
+    for (int i = 0; i < HISTORY_SIZE; i++) {
+        add_to_history(&bench.history, i * 1.3, i * 0.7, i * 0.9, i * 0.4, 40 + i * 0.2);
+    }
+    snprintf(params, sizeof(params), "points=%d", HISTORY_SIZE);
+    r = bench_run(op_history, &bench, iterations);
+    bench_report("get_history_json", params, &r);
+
+    LttbBench lttb = {
+        .x = malloc(BENCH_SERIES_POINTS * sizeof(long)),
+        .y = malloc(BENCH_SERIES_POINTS * sizeof(double)),
+        .out = malloc(BENCH_SERIES_POINTS * sizeof(int)),
+    };
+    if (!lttb.x || !lttb.y || !lttb.out) return 1;
+    unsigned int seed = 1;
+    for (int i = 0; i < BENCH_SERIES_POINTS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        lttb.x[i] = 1700000000L + i * 2L;
+        lttb.y[i] = 40.0 + 30.0 * ((i / 1000) % 86 < 43 ? 1 : -1) + (seed >> 16) % 1000 / 100.0;
+        if (seed % 5000 == 0) lttb.y[i] = 100.0;
+    }
+    static const int lttb_points[] = {500, 2000, 20000};
+    for (size_t i = 0; i < sizeof(lttb_points) / sizeof(lttb_points[0]); i++) {
+        lttb.points = lttb_points[i];
+        snprintf(params, sizeof(params), "points=%d series=%d", lttb.points, BENCH_SERIES_POINTS);
+        r = bench_run(op_lttb, &lttb, iterations / 1000 > 10 ? iterations / 1000 : 10);
+        bench_report("lttb_select", params, &r);
+    }
+    free(lttb.x);
+    free(lttb.y);
+    free(lttb.out);
+
+    return 0;
+}
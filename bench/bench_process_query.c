@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "process_table.h"
+#include "string_arena.h"
+#include "bench/bench_common.h"
+
+#define BENCH_PROCESSES 10000
+
+typedef struct {
+    ProcessTable *table;
+    ProcessQuery query;
+    JsonWriter w;
+} QueryBench;
+
+static void fill_table(ProcessTable *table) {
+    static const char *names[] = {"nginx", "postgres", "java", "python3", "node", "chrome", "bash", "sshd"};
+    static StringArena strings;
+    char text[128];
+
+    string_arena_init(&strings);
+
+    srand(7);
+    for (int i = 0; i < BENCH_PROCESSES; i++) {
+        ProcessInfo *p = &table->rows[i];
+        memset(p, 0, sizeof(ProcessInfo));
+        p->pid = 1 + rand() % 4000000;
+        int len = snprintf(text, sizeof(text), "%s-%d", names[i % 8], i % 97);
+        p->name = string_arena_intern(&strings, text, len);
+        p->state = (i % 13 == 0) ? 'R' : 'S';
+        p->rss = rand() % 4000000;
+        p->cpu_usage = (rand() % 10000) / 100.0;
+        len = snprintf(text, sizeof(text), "/usr/bin/%s --worker=%d", names[i % 8], i);
+        p->command_line = string_arena_intern(&strings, text, len);
+    }
+    table->count = BENCH_PROCESSES;
+}
+
+static void op_build_indices(void *arg) {
+    process_table_build_indices(arg);
+}
+
+static void op_query(void *arg) {
+    QueryBench *b = arg;
+    jw_reset(&b->w);
+    write_processes_json(&b->w, b->table, &b->query, 0, 0);
+}
+
+static void bench_query(ProcessTable *table, const char *query_string, int iterations) {
+    QueryBench b;
+    char params[160];
+
+    b.table = table;
+    jw_init(&b.w, 65536);
+    parse_process_query(query_string, &b.query);
+
+    BenchResult r = bench_run(op_query, &b, iterations);
+    snprintf(params, sizeof(params), "processes=%d query=\"%s\" bytes=%zu",
+             table->count, query_string, b.w.len);
+    bench_report("process_query", params, &r);
+    jw_free(&b.w);
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    if (iterations <= 0) iterations = 200;
+
+    ProcessTable table;
+    if (process_table_init(&table, BENCH_PROCESSES) != 0) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    fill_table(&table);
+    bench_init();
+
+    char params[32];
+    snprintf(params, sizeof(params), "processes=%d", table.count);
+    BenchResult r = bench_run(op_build_indices, &table, iterations);
+    bench_report("process_table_build_indices", params, &r);
+
+    bench_query(&table, "sort=cpu&limit=50", iterations * 10);
+    bench_query(&table, "sort=rss&limit=50", iterations * 10);
+    bench_query(&table, "sort=pid&limit=50", iterations * 10);
+    bench_query(&table, "sort=name&limit=50", iterations * 10);
+    bench_query(&table, "sort=cpu&limit=50&state=R", iterations);
+    bench_query(&table, "sort=rss&limit=50&filter=postgres", iterations);
+
+    process_table_free(&table);
+    return 0;
+}
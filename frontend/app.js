@@ -1,7 +1,9 @@
 class SystemMonitor {
     constructor() {
         console.log('🚀 System Monitor Initializing...');
-        this.serverUrl = 'http://localhost:8080';
+        // страница отдана самим сервером: API на том же origin
+        this.servedByServer = window.location.protocol.startsWith('http');
+        this.serverUrl = this.servedByServer ? window.location.origin : 'http://localhost:8080';
         this.isOnline = false;
         this.connectionTimeout = 10000;
         this.historyData = {
@@ -14,6 +16,7 @@ class SystemMonitor {
         };
         this.historyChart = null;
         this.gpuChart = null;
+        this.systemCharts = null;
         this.chartsInitialized = false;
         this.retryDelay = 5000;
         this.maxRetries = 3;
@@ -213,7 +216,10 @@ class SystemMonitor {
         this.showLoading(true, `Connecting to server (${this.currentRetry + 1}/${this.maxRetries})...`);
         
         try {
-            const testUrls = [
+            // с file:// перебираем локальные адреса, иначе origin уже известен
+            const testUrls = this.servedByServer ? [
+                `${window.location.origin}/api/health`
+            ] : [
                 'http://localhost:8080/api/system',
                 'http://127.0.0.1:8080/api/system',
                 'http://localhost:8080/api/health',
@@ -429,6 +435,14 @@ class SystemMonitor {
                 this.updateProcesses(data.processes);
             }
             
+            if (data.disks) {
+                this.updateDisks(data.disks);
+            }
+            
+            if (data.topology) {
+                this.updateTopology(data.topology);
+            }
+            
             this.updateLastUpdate();
             
         } catch (error) {
@@ -436,6 +450,20 @@ class SystemMonitor {
         }
     }
 
+    updateDisks(disks) {
+        if (typeof SystemCharts === 'undefined' || typeof Chart === 'undefined') return;
+        
+        if (!this.systemCharts) {
+            this.systemCharts = new SystemCharts();
+        }
+        
+        if (this.systemCharts.charts.disk) {
+            this.systemCharts.updateDiskChart(disks);
+        } else {
+            this.systemCharts.createDiskChart('diskChart', disks);
+        }
+    }
+
     updateCPU(cpu) {
         const cpuValueEl = document.getElementById('cpuValue');
         if (cpuValueEl && cpu.usage !== undefined) {
@@ -485,7 +513,11 @@ class SystemMonitor {
             return;
         }
         
-        cores.forEach((core, i) => {
+        // выключенные CPU (online: false) не показываем, номер берем из core
+        const online = cores.filter(core => core.online !== false);
+        
+        online.forEach((core, i) => {
+            const id = core.core !== undefined ? core.core : i;
             const usage = core.usage || 0;
             const color = this.getUsageColor(usage);
             
@@ -493,7 +525,7 @@ class SystemMonitor {
             coreEl.className = 'core-item';
             coreEl.innerHTML = `
                 <div class="core-header">
-                    <span class="core-name">C${i.toString().padStart(2, '0')}</span>
+                    <span class="core-name">C${id.toString().padStart(2, '0')}</span>
                     <span class="core-value" style="color: ${color}">${usage.toFixed(1)}%</span>
                 </div>
                 <div class="core-bar">
@@ -505,10 +537,29 @@ class SystemMonitor {
         
         const infoEl = document.createElement('div');
         infoEl.className = 'core-info';
-        infoEl.textContent = `Total: ${cores.length} cores`;
+        infoEl.textContent = online.length < cores.length ?
+            `Total: ${online.length} cores (${cores.length - online.length} offline)` :
+            `Total: ${online.length} cores`;
         container.appendChild(infoEl);
         
-        console.log(`Rendered ${cores.length} cores in container`);
+        console.log(`Rendered ${online.length} cores in container`);
+    }
+
+    updateTopology(topology) {
+        const container = document.getElementById('numaContainer');
+        if (!container) return;
+        
+        // на машине с одним узлом показывать нечего
+        const nodes = topology.nodes || [];
+        if (!topology.numa || nodes.length < 2) {
+            container.textContent = '';
+            return;
+        }
+        
+        container.textContent = nodes.map(node => {
+            const memory = node.memory ? `, mem ${node.memory.percentage.toFixed(1)}%` : '';
+            return `Node ${node.node}: ${node.usage.toFixed(1)}%${memory}`;
+        }).join(' · ');
     }
 
     updateMemory(mem) {
@@ -898,7 +949,7 @@ class SystemMonitor {
         const info = `
             <div class="server-info-modal">
                 <h3>Server Connection Info</h3>
-                <p><strong>Expected URL:</strong> http://localhost:8080</p>
+                <p><strong>Expected URL:</strong> ${this.serverUrl}</p>
                 <p><strong>API Endpoints:</strong></p>
                 <ul>
                     <li>GET /api/system - System data</li>
@@ -908,20 +959,20 @@ class SystemMonitor {
                 <p><strong>To start the server:</strong></p>
                 <pre>./monitor_server</pre>
                 <p><strong>Check if server is running:</strong></p>
-                <pre>curl http://localhost:8080/api/health</pre>
+                <pre>curl ${this.serverUrl}/api/health</pre>
             </div>
         `;
         
         this.showNotification('Check browser console for server info', 'info');
         console.info('Server Connection Info:', {
-            expectedUrl: 'http://localhost:8080',
+            expectedUrl: this.serverUrl,
             endpoints: [
                 'GET /api/system',
                 'GET /api/history', 
                 'GET /api/health'
             ],
             startCommand: './monitor_server',
-            testCommand: 'curl http://localhost:8080/api/health'
+            testCommand: `curl ${this.serverUrl}/api/health`
         });
     }
 
@@ -1314,6 +1365,32 @@ class SystemMonitor {
             
             console.log(`🎮 Updated GPU chart with ${this.historyData.timestamps.length} points`);
         }
+        
+        this.updateNetworkHistory();
+    }
+
+    updateNetworkHistory() {
+        if (typeof SystemCharts === 'undefined' || typeof Chart === 'undefined') return;
+        if (!this.historyData.net_rx || this.historyData.timestamps.length === 0) return;
+        
+        const networkData = this.historyData.timestamps.map((ts, i) => ({
+            time: new Date(ts * 1000).toLocaleTimeString([], { 
+                hour: '2-digit', 
+                minute: '2-digit' 
+            }),
+            rx_kb: this.historyData.net_rx[i] || 0,
+            tx_kb: this.historyData.net_tx[i] || 0
+        }));
+        
+        if (!this.systemCharts) {
+            this.systemCharts = new SystemCharts();
+        }
+        
+        if (this.systemCharts.charts.network) {
+            this.systemCharts.updateNetworkChart(networkData);
+        } else {
+            this.systemCharts.createNetworkChart('networkChart', networkData);
+        }
     }
 
     initializeGauges() {
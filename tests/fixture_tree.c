@@ -0,0 +1,353 @@
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fixture_tree.h"
+
+char fixture_dir[64];
+
+static const char *process_names[] = {"systemd", "nginx", "postgres", "java", "python3",
+                                      "node", "chrome", "bash", "sshd", "containerd"};
+
+static int make_dir(const char *root, const char *rel) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, rel);
+    if (mkdir(path, 0755) != 0 && access(path, F_OK) != 0) return -1;
+    return 0;
+}
+
+static FILE *open_file(const char *root, const char *rel) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, rel);
+    return fopen(path, "w");
+}
+
+static int write_text(const char *root, const char *rel, const char *text) {
+    FILE *f = open_file(root, rel);
+    if (!f) return -1;
+    fputs(text, f);
+    fclose(f);
+    return 0;
+}
+
+static int write_stat(const char *root, const FixtureSpec *spec, int tick) {
+    FILE *f = open_file(root, "proc/stat");
+    if (!f) return -1;
+
+    unsigned long long t = (unsigned long long)tick * 200;
+    fprintf(f, "cpu  %llu 120 %llu %llu 300 0 40 0 0 0\n",
+            10000ULL * spec->cores + t * spec->cores / 2, 5000ULL * spec->cores + t * spec->cores / 4,
+            90000ULL * spec->cores + t * spec->cores / 4);
+    for (int i = 0; i < spec->cores; i++) {
+        fprintf(f, "cpu%d %llu 1 %llu %llu 3 0 1 0 0 0\n",
+                i, 10000 + t / 2 + i, 5000 + t / 4, 90000 + t / 4 + i * 7);
+    }
+    fprintf(f, "intr 123456789 0 0 0\nctxt 987654321\nbtime 1760000000\n"
+               "processes %d\nprocs_running 3\nprocs_blocked 0\n"
+               "softirq 5555 0 1 2 3 4 5 6 7 8 9\n", spec->processes + 100);
+    fclose(f);
+    return 0;
+}
+
+static int write_meminfo(const char *root) {
+    return write_text(root, "proc/meminfo",
+        "MemTotal:       65536000 kB\n"
+        "MemFree:        20000000 kB\n"
+        "MemAvailable:   40000000 kB\n"
+        "Buffers:          500000 kB\n"
+        "Cached:         18000000 kB\n"
+        "SwapCached:            0 kB\n"
+        "Active:         22000000 kB\n"
+        "Inactive:       15000000 kB\n"
+        "Active(anon):   12000000 kB\n"
+        "Inactive(anon):   100000 kB\n"
+        "Active(file):   10000000 kB\n"
+        "Inactive(file): 14900000 kB\n"
+        "Unevictable:           0 kB\n"
+        "Mlocked:               0 kB\n"
+        "SwapTotal:       8000000 kB\n"
+        "SwapFree:        8000000 kB\n"
+        "Dirty:              1200 kB\n"
+        "Writeback:             0 kB\n"
+        "AnonPages:      12100000 kB\n"
+        "Mapped:          1500000 kB\n"
+        "Shmem:            200000 kB\n"
+        "KReclaimable:     900000 kB\n"
+        "Slab:            1400000 kB\n"
+        "SReclaimable:     900000 kB\n"
+        "SUnreclaim:       500000 kB\n"
+        "KernelStack:       30000 kB\n"
+        "PageTables:        90000 kB\n"
+        "CommitLimit:    40768000 kB\n"
+        "Committed_AS:   30000000 kB\n"
+        "VmallocTotal:   34359738367 kB\n"
+        "VmallocUsed:      100000 kB\n"
+        "HugePages_Total:       0\n"
+        "HugePages_Free:        0\n"
+        "Hugepagesize:       2048 kB\n");
+}
+
+static int write_cpuinfo(const char *root, const FixtureSpec *spec) {
+    FILE *f = open_file(root, "proc/cpuinfo");
+    if (!f) return -1;
+    for (int i = 0; i < spec->cores; i++) {
+        fprintf(f, "processor\t: %d\nvendor_id\t: GenuineIntel\ncpu family\t: 6\n"
+                   "model name\t: Synthetic CPU @ 3.00GHz\ncpu MHz\t\t: 3000.000\n"
+                   "cache size\t: 32768 KB\ncore id\t\t: %d\ncpu cores\t: %d\n\n",
+                i, i, spec->cores);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int write_process(const char *root, int index, int tick) {
+    char rel[128];
+    char text[2048];
+    int pid = 1000 + index;
+    const char *name = process_names[index % 10];
+    unsigned long utime = 100 + index % 50 + (unsigned long)tick * (index % 7);
+    unsigned long stime = 20 + index % 13 + (unsigned long)tick * (index % 3);
+    long rss_kb = 1024 + (index * 37) % 500000;
+
+    snprintf(rel, sizeof(rel), "proc/%d", pid);
+    if (make_dir(root, rel) != 0) return -1;
+
+    snprintf(rel, sizeof(rel), "proc/%d/stat", pid);
+    snprintf(text, sizeof(text),
+             "%d (%s) S 1 %d %d 0 -1 4194560 500 0 0 0 %lu %lu 0 0 20 0 1 0 %d "
+             "123456789 %ld 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 0 0 0 0 0 0\n",
+             pid, name, pid, pid, utime, stime, 5000 + index, rss_kb / 4);
+    if (write_text(root, rel, text) != 0) return -1;
+
+    snprintf(rel, sizeof(rel), "proc/%d/status", pid);
+    snprintf(text, sizeof(text),
+             "Name:\t%s\nUmask:\t0022\nState:\tS (sleeping)\nTgid:\t%d\nNgid:\t0\nPid:\t%d\n"
+             "PPid:\t1\nTracerPid:\t0\nUid:\t0\t0\t0\t0\nGid:\t0\t0\t0\t0\nFDSize:\t64\n"
+             "VmPeak:\t  200000 kB\nVmSize:\t  180000 kB\nVmHWM:\t  %ld kB\nVmRSS:\t  %ld kB\n"
+             "RssAnon:\t  %ld kB\nVmData:\t   50000 kB\nVmStk:\t     132 kB\nThreads:\t4\n"
+             "voluntary_ctxt_switches:\t%d\nnonvoluntary_ctxt_switches:\t%d\n",
+             name, pid, pid, rss_kb, rss_kb, rss_kb, 100 + tick * 10, 5 + tick);
+    if (write_text(root, rel, text) != 0) return -1;
+
+    snprintf(rel, sizeof(rel), "proc/%d/cmdline", pid);
+    FILE *f = open_file(root, rel);
+    if (!f) return -1;
+    fprintf(f, "/usr/bin/%s%c--worker=%d%c--config=/etc/%s.conf%c", name, 0, index, 0, name, 0);
+    fclose(f);
+
+    snprintf(rel, sizeof(rel), "proc/%d/schedstat", pid);
+    snprintf(text, sizeof(text), "%lu %d %d\n", (utime + stime) * 10000000UL, 5000 + index, 100 + tick);
+    if (write_text(root, rel, text) != 0) return -1;
+
+    snprintf(rel, sizeof(rel), "proc/%d/io", pid);
+    snprintf(text, sizeof(text),
+             "rchar: %d\nwchar: %d\nsyscr: 100\nsyscw: 50\nread_bytes: %d\nwrite_bytes: %d\n"
+             "cancelled_write_bytes: 0\n",
+             100000 + tick * 4096, 50000 + tick * 1024, tick * 4096, tick * 1024);
+    if (write_text(root, rel, text) != 0) return -1;
+
+    snprintf(rel, sizeof(rel), "proc/%d/cgroup", pid);
+    snprintf(text, sizeof(text), "0::/group%d.slice\n", index % 8);
+    return write_text(root, rel, text);
+}
+
+static int write_diskstats(const char *root, const FixtureSpec *spec, int tick) {
+    FILE *f = open_file(root, "proc/diskstats");
+    if (!f) return -1;
+    for (int i = 0; i < spec->disks; i++) {
+        unsigned long long t = (unsigned long long)tick;
+        fprintf(f, " 259 %7d nvme%dn1 %llu 0 %llu %llu %llu 0 %llu %llu 0 %llu %llu 0 0 0 0 0 0\n",
+                i * 16, i, 1000 + t * 50, 80000 + t * 800, 2000 + t * 20,
+                3000 + t * 30, 64000 + t * 640, 4000 + t * 40, 3000 + t * 400, 6000 + t * 60);
+        fprintf(f, " 259 %7d nvme%dn1p1 %llu 0 %llu 100 %llu 0 %llu 100 0 100 200 0 0 0 0 0 0\n",
+                i * 16 + 1, i, 900 + t * 50, 70000 + t * 800, 2900 + t * 30, 60000 + t * 640);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int write_net_dev(const char *root, const FixtureSpec *spec, int tick) {
+    FILE *f = open_file(root, "proc/net/dev");
+    if (!f) return -1;
+    fputs("Inter-|   Receive                                                |  Transmit\n"
+          " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n", f);
+    for (int i = 0; i < spec->interfaces; i++) {
+        unsigned long long t = (unsigned long long)tick;
+        char name[32];
+        if (i == 0) snprintf(name, sizeof(name), "lo");
+        else if (i == 1) snprintf(name, sizeof(name), "eth0");
+        else snprintf(name, sizeof(name), "veth%04x", i);
+        fprintf(f, "%6s: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n",
+                name, 1000000 + t * 125000, 1000 + t * 100, 500000 + t * 25000, 800 + t * 40);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int write_pressure(const char *root, int tick) {
+    char text[256];
+    const char *names[] = {"cpu", "memory", "io"};
+
+    for (int i = 0; i < 3; i++) {
+        char rel[64];
+        snprintf(rel, sizeof(rel), "proc/pressure/%s", names[i]);
+        snprintf(text, sizeof(text),
+                 "some avg10=1.50 avg60=1.20 avg300=0.90 total=%d\n"
+                 "full avg10=0.00 avg60=0.00 avg300=0.00 total=%d\n",
+                 1000000 + tick * 20000 * (i + 1), tick * 1000);
+        if (write_text(root, rel, text) != 0) return -1;
+    }
+    return 0;
+}
+
+static int write_cgroups(const char *root, const FixtureSpec *spec, int tick) {
+    char rel[128];
+    char text[512];
+
+    if (write_text(root, "sys/fs/cgroup/cgroup.controllers", "cpuset cpu io memory pids\n") != 0) {
+        return -1;
+    }
+    for (int i = 0; i < spec->cgroups; i++) {
+        snprintf(rel, sizeof(rel), "sys/fs/cgroup/group%d.slice", i);
+        if (make_dir(root, rel) != 0) return -1;
+
+        snprintf(rel, sizeof(rel), "sys/fs/cgroup/group%d.slice/cpu.stat", i);
+        snprintf(text, sizeof(text), "usage_usec %d\nuser_usec %d\nsystem_usec %d\n"
+                 "nr_periods 0\nnr_throttled 0\nthrottled_usec 0\n",
+                 1000000 + tick * 100000 * (i % 4), 800000, 200000);
+        write_text(root, rel, text);
+        snprintf(rel, sizeof(rel), "sys/fs/cgroup/group%d.slice/cpu.max", i);
+        write_text(root, rel, (i % 2) ? "max 100000\n" : "200000 100000\n");
+        snprintf(rel, sizeof(rel), "sys/fs/cgroup/group%d.slice/memory.current", i);
+        snprintf(text, sizeof(text), "%d\n", 100000000 + i * 4096);
+        write_text(root, rel, text);
+        snprintf(rel, sizeof(rel), "sys/fs/cgroup/group%d.slice/memory.stat", i);
+        write_text(root, rel, "anon 50000000\nfile 40000000\nkernel 1000000\nshmem 0\n");
+        snprintf(rel, sizeof(rel), "sys/fs/cgroup/group%d.slice/cpu.pressure", i);
+        write_text(root, rel, "some avg10=0.50 avg60=0.40 avg300=0.30 total=12345\n"
+                              "full avg10=0.10 avg60=0.05 avg300=0.01 total=2345\n");
+    }
+    return 0;
+}
+
+// Два сокета = два NUMA-узла по половине CPU, SMT-пары (2k, 2k+1)
+static int write_topology(const char *root, const FixtureSpec *spec) {
+    char rel[128], text[256];
+    int nodes = spec->cores >= 4 ? 2 : 1;
+    int per_node = spec->cores / nodes;
+
+    if (make_dir(root, "sys/devices/system/node") != 0) return -1;
+    write_text(root, "sys/devices/system/node/online", nodes == 2 ? "0-1\n" : "0\n");
+    for (int n = 0; n < nodes; n++) {
+        snprintf(rel, sizeof(rel), "sys/devices/system/node/node%d", n);
+        if (make_dir(root, rel) != 0) return -1;
+        snprintf(rel, sizeof(rel), "sys/devices/system/node/node%d/cpulist", n);
+        snprintf(text, sizeof(text), "%d-%d\n", n * per_node,
+                 n == nodes - 1 ? spec->cores - 1 : (n + 1) * per_node - 1);
+        write_text(root, rel, text);
+        snprintf(rel, sizeof(rel), "sys/devices/system/node/node%d/meminfo", n);
+        snprintf(text, sizeof(text),
+                 "Node %d MemTotal:       16000000 kB\nNode %d MemFree:        %d kB\n"
+                 "Node %d MemUsed:        %d kB\n", n, n, 8000000 - n * 4000000,
+                 n, 8000000 + n * 4000000);
+        write_text(root, rel, text);
+    }
+
+    for (int i = 0; i < spec->cores; i++) {
+        int sibling = i ^ 1;
+        snprintf(rel, sizeof(rel), "sys/devices/system/cpu/cpu%d", i);
+        if (make_dir(root, rel) != 0) return -1;
+        snprintf(rel, sizeof(rel), "sys/devices/system/cpu/cpu%d/topology", i);
+        if (make_dir(root, rel) != 0) return -1;
+        snprintf(rel, sizeof(rel), "sys/devices/system/cpu/cpu%d/topology/physical_package_id", i);
+        snprintf(text, sizeof(text), "%d\n", i / per_node < nodes ? i / per_node : nodes - 1);
+        write_text(root, rel, text);
+        snprintf(rel, sizeof(rel), "sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", i);
+        if (sibling < spec->cores) {
+            snprintf(text, sizeof(text), "%d-%d\n", i & ~1, (i & ~1) + 1);
+        } else {
+            snprintf(text, sizeof(text), "%d\n", i);
+        }
+        write_text(root, rel, text);
+    }
+    return 0;
+}
+
+static int write_sys(const char *root, const FixtureSpec *spec) {
+    const char *dirs[] = {"sys/class", "sys/class/thermal", "sys/class/thermal/thermal_zone0",
+                          "sys/devices", "sys/devices/system", "sys/devices/system/cpu",
+                          "sys/devices/system/cpu/cpu0", "sys/devices/system/cpu/cpu0/cpufreq",
+                          "sys/block", "sys/fs", "sys/fs/cgroup", NULL};
+    for (int i = 0; dirs[i]; i++) {
+        if (make_dir(root, dirs[i]) != 0) return -1;
+    }
+    write_text(root, "sys/class/thermal/thermal_zone0/temp", "52000\n");
+    write_text(root, "sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", "3000000\n");
+
+    for (int i = 0; i < spec->disks; i++) {
+        char rel[64];
+        snprintf(rel, sizeof(rel), "sys/block/nvme%dn1", i);
+        if (make_dir(root, rel) != 0) return -1;
+    }
+    return write_topology(root, spec);
+}
+
+// Перезаписывает счетчики так, как будто прошло tick интервалов
+int fixture_tree_tick(const char *root, const FixtureSpec *spec, int tick) {
+    if (write_stat(root, spec, tick) != 0) return -1;
+    for (int i = 0; i < spec->processes; i++) {
+        if (write_process(root, i, tick) != 0) return -1;
+    }
+    if (write_diskstats(root, spec, tick) != 0) return -1;
+    if (write_net_dev(root, spec, tick) != 0) return -1;
+    if (write_pressure(root, tick) != 0) return -1;
+    return write_cgroups(root, spec, tick);
+}
+
+// root - буфер под путь, заполняется mkdtemp
+int fixture_tree_create(char *root, int root_size, const FixtureSpec *spec) {
+    snprintf(root, root_size, "/tmp/fixture_tree_XXXXXX");
+    if (!mkdtemp(root)) return -1;
+
+    if (make_dir(root, "proc") != 0 || make_dir(root, "proc/net") != 0 ||
+        make_dir(root, "proc/pressure") != 0 || make_dir(root, "sys") != 0) {
+        return -1;
+    }
+    if (write_sys(root, spec) != 0) return -1;
+    if (write_meminfo(root) != 0) return -1;
+    if (write_cpuinfo(root, spec) != 0) return -1;
+
+    return fixture_tree_tick(root, spec, 0);
+}
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    (void)st;
+    (void)flag;
+    (void)ftw;
+    remove(path);
+    return 0;
+}
+
+void fixture_tree_remove(const char *root) {
+    if (strncmp(root, "/tmp/", 5) != 0) return;
+    nftw(root, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+int fixture_create(const char *name) {
+    snprintf(fixture_dir, sizeof(fixture_dir), "/tmp/test_%s_XXXXXX", name);
+    return mkdtemp(fixture_dir) ? 0 : -1;
+}
+
+int fixture_mkdir(const char *rel) {
+    return make_dir(fixture_dir, rel);
+}
+
+int fixture_write(const char *rel, const char *content) {
+    return write_text(fixture_dir, rel, content);
+}
+
+void fixture_remove(void) {
+    fixture_tree_remove(fixture_dir);
+}
@@ -0,0 +1,27 @@
+#ifndef FIXTURE_TREE_H
+#define FIXTURE_TREE_H
+
+// Синтетическое дерево procfs/sysfs для тестов и бенчмарков:
+// <root>/proc и <root>/sys в формате ядра 6.x
+typedef struct {
+    int processes;      // PID 1000..1000+processes-1
+    int cores;
+    int disks;
+    int interfaces;
+    int cgroups;        // дочерние группы под корнем cgroup v2
+} FixtureSpec;
+
+int fixture_tree_create(char *root, int root_size, const FixtureSpec *spec);
+int fixture_tree_tick(const char *root, const FixtureSpec *spec, int tick);
+// Удаляет каталог под /tmp со всем содержимым
+void fixture_tree_remove(const char *root);
+
+// Каталог фикстуры текущего теста ("/tmp/test_<name>_XXXXXX"): тесты идут
+// последовательно, пути rel - относительно него
+extern char fixture_dir[64];
+int fixture_create(const char *name);
+int fixture_mkdir(const char *rel);
+int fixture_write(const char *rel, const char *content);
+void fixture_remove(void);
+
+#endif
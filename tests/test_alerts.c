@@ -0,0 +1,204 @@
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "test_config.h"
+#include "../backend/src/alerts.h"
+
+static int test_alert_parse_rules() {
+    AlertRule r;
+
+    TEST_ASSERT_EQUAL(0, alert_parse_rule("   # комментарий\n", &r));
+    TEST_ASSERT_EQUAL(1, alert_parse_rule("cpu_hot: cpu.usage > 90 for 30s\n", &r));
+    TEST_ASSERT_STR_EQUAL("cpu_hot", r.name);
+    TEST_ASSERT_STR_EQUAL("cpu.usage > 90 for 30s", r.expr);
+    TEST_ASSERT(r.offset == offsetof(HistorySample, cpu_usage));
+    TEST_ASSERT_EQUAL(ALERT_GT, r.op);
+    TEST_ASSERT(r.threshold == 90.0);
+    TEST_ASSERT(r.for_ms == 30000);
+    TEST_ASSERT_EQUAL(0, r.rate);
+
+    TEST_ASSERT_EQUAL(1, alert_parse_rule("memory.percentage rate >= 5/min", &r));
+    TEST_ASSERT_STR_EQUAL("memory.percentage rate >= 5/min", r.name);
+    TEST_ASSERT_EQUAL(1, r.rate);
+    TEST_ASSERT(r.rate_unit_s == 60.0);
+    TEST_ASSERT_EQUAL(ALERT_GE, r.op);
+    TEST_ASSERT(r.for_ms == 0);
+
+    TEST_ASSERT_EQUAL(1, alert_parse_rule("psi.io < 1.5 for 2m", &r));
+    TEST_ASSERT(r.for_ms == 120000);
+
+    TEST_ASSERT_EQUAL(-1, alert_parse_rule("cpu.temp > 90", &r));
+    TEST_ASSERT_EQUAL(-1, alert_parse_rule("cpu.usage = 90", &r));
+    TEST_ASSERT_EQUAL(-1, alert_parse_rule("cpu.usage > 90/min", &r));
+    TEST_ASSERT_EQUAL(-1, alert_parse_rule("cpu.usage > 90 for", &r));
+    TEST_ASSERT_EQUAL(-1, alert_parse_rule("cpu.usage > 90 for 10x", &r));
+    TEST_ASSERT_EQUAL(-1, alert_parse_rule(": cpu.usage > 90", &r));
+    return 1;
+}
+
+// Нарушение короче for не срабатывает; firing и resolved - по одному событию
+static int test_alert_for_duration() {
+    AlertEngine a;
+    AlertEvent e;
+    HistorySample s = {0};
+
+    alerts_init(&a);
+    TEST_ASSERT_EQUAL(1, alert_parse_rule("hot: cpu.usage > 90 for 30s", &a.rules[0]));
+    a.count = 1;
+    TEST_ASSERT_EQUAL(0, alerts_set_webhook(&a, "http://127.0.0.1:9/hook"));
+    TEST_ASSERT_STR_EQUAL("/hook", a.path);
+
+    s.cpu_usage = 95;
+    alerts_evaluate(&a, &s, 0, 100);
+    alerts_evaluate(&a, &s, 20000, 120);
+    TEST_ASSERT_EQUAL(ALERT_PENDING, a.rules[0].state);
+    s.cpu_usage = 50;
+    alerts_evaluate(&a, &s, 25000, 125);
+    TEST_ASSERT_EQUAL(ALERT_OK, a.rules[0].state);
+    TEST_ASSERT_EQUAL(0, a.queued);
+
+    s.cpu_usage = 99;
+    for (long t = 30000; t <= 70000; t += 10000) alerts_evaluate(&a, &s, t, t / 1000);
+    TEST_ASSERT_EQUAL(ALERT_FIRING, a.rules[0].state);
+    TEST_ASSERT_EQUAL(1, a.queued);
+    TEST_ASSERT_EQUAL(1, alerts_take(&a, &e));
+    TEST_ASSERT_EQUAL(1, e.firing);
+    TEST_ASSERT_EQUAL(60, e.timestamp);
+    TEST_ASSERT(e.value == 99.0);
+
+    s.cpu_usage = 10;
+    alerts_evaluate(&a, &s, 80000, 80);
+    alerts_evaluate(&a, &s, 90000, 90);
+    TEST_ASSERT_EQUAL(1, alerts_take(&a, &e));
+    TEST_ASSERT_EQUAL(0, e.firing);
+    TEST_ASSERT_STR_EQUAL("hot", e.name);
+    TEST_ASSERT_EQUAL(0, alerts_take(&a, &e));
+
+    char buf[512];
+    JsonWriter w;
+    jw_init_fixed(&w, buf, sizeof(buf));
+    write_alert_event_json(&w, &a, &e);
+    TEST_ASSERT(!w.overflow);
+    buf[w.len] = '\0';
+    TEST_ASSERT(strstr(buf, "\"state\":\"resolved\",\"value\":10.00,\"threshold\":90.00") != NULL);
+
+    alerts_free(&a);
+    return 1;
+}
+
+// Скорость - EWMA по соседним точкам, в единицах правила
+static int test_alert_rate() {
+    AlertEngine a;
+    HistorySample s = {0};
+
+    alerts_init(&a);
+    TEST_ASSERT_EQUAL(1, alert_parse_rule("memory.percentage rate > 5/min", &a.rules[0]));
+    a.count = 1;
+
+    // +1% за 5 секунд = 12%/мин
+    for (int i = 0; i <= 4; i++) {
+        s.memory_usage = 40 + i;
+        alerts_evaluate(&a, &s, i * 5000L, i * 5);
+    }
+    TEST_ASSERT(fabs(a.rules[0].value - 12.0) < 1e-9);
+    TEST_ASSERT_EQUAL(ALERT_FIRING, a.rules[0].state);
+    TEST_ASSERT_EQUAL(1, a.events);
+
+    // рост остановился: сглаженная скорость падает не сразу
+    alerts_evaluate(&a, &s, 25000, 25);
+    TEST_ASSERT(fabs(a.rules[0].value - 12.0 * (1.0 - ALERT_RATE_ALPHA)) < 1e-9);
+    TEST_ASSERT_EQUAL(ALERT_FIRING, a.rules[0].state);
+    for (int i = 6; i < 12; i++) alerts_evaluate(&a, &s, i * 5000L, i * 5);
+    TEST_ASSERT_EQUAL(ALERT_OK, a.rules[0].state);
+    TEST_ASSERT_EQUAL(2, a.events);
+
+    alerts_free(&a);
+    return 1;
+}
+
+typedef struct {
+    int listener;
+    int statuses[4];
+    int count;
+    char body[1024];
+} FakeWebhook;
+
+static void *fake_webhook_thread(void *arg) {
+    FakeWebhook *f = arg;
+    char request[2048];
+
+    for (int i = 0; i < f->count; i++) {
+        int fd = accept(f->listener, NULL, NULL);
+        if (fd < 0) break;
+        size_t got = 0;
+        for (;;) {
+            ssize_t n = recv(fd, request + got, sizeof(request) - 1 - got, 0);
+            if (n <= 0) break;
+            got += n;
+            request[got] = '\0';
+            char *body = strstr(request, "\r\n\r\n");
+            const char *cl = strstr(request, "Content-Length: ");
+            if (body && cl && strlen(body + 4) >= (size_t)atoi(cl + 16)) {
+                snprintf(f->body, sizeof(f->body), "%s", body + 4);
+                break;
+            }
+        }
+        char reply[64];
+        int n = snprintf(reply, sizeof(reply), "HTTP/1.1 %d X\r\nContent-Length: 0\r\n\r\n", f->statuses[i]);
+        send(fd, reply, n, MSG_NOSIGNAL);
+        close(fd);
+    }
+    return NULL;
+}
+
+// 500 - повтор, затем 204 - доставлено
+static int test_alert_webhook_retry() {
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t addr_len = sizeof(addr);
+    FakeWebhook f = {.statuses = {500, 204}, .count = 2};
+    AlertEngine a;
+    HistorySample s = {.psi_io = 30};
+    char url[64];
+    pthread_t thread;
+
+    f.listener = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT(f.listener >= 0);
+    TEST_ASSERT(bind(f.listener, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    TEST_ASSERT(listen(f.listener, 4) == 0);
+    getsockname(f.listener, (struct sockaddr *)&addr, &addr_len);
+    TEST_ASSERT(pthread_create(&thread, NULL, fake_webhook_thread, &f) == 0);
+
+    alerts_init(&a);
+    a.retry_base_ms = 10;
+    TEST_ASSERT_EQUAL(1, alert_parse_rule("io: psi.io > 20", &a.rules[0]));
+    a.count = 1;
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/alerts", ntohs(addr.sin_port));
+    TEST_ASSERT_EQUAL(0, alerts_set_webhook(&a, url));
+    TEST_ASSERT_EQUAL(0, alerts_start(&a));
+
+    alerts_evaluate(&a, &s, 0, 1700000000);
+    for (int i = 0; i < 200 && __atomic_load_n(&a.sent, __ATOMIC_RELAXED) == 0; i++) usleep(10000);
+    alerts_stop(&a);
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT_EQUAL(1, a.sent);
+    TEST_ASSERT_EQUAL(1, a.retries);
+    TEST_ASSERT_EQUAL(0, a.failed);
+    TEST_ASSERT(strstr(f.body, "\"rule\":\"io\"") != NULL);
+    TEST_ASSERT(strstr(f.body, "\"state\":\"firing\"") != NULL);
+    TEST_ASSERT(strstr(f.body, "\"timestamp\":1700000000") != NULL);
+
+    alerts_free(&a);
+    close(f.listener);
+    return 1;
+}
+
+void test_alerts_suite() {
+    RUN_TEST(test_alert_parse_rules);
+    RUN_TEST(test_alert_for_duration);
+    RUN_TEST(test_alert_rate);
+    RUN_TEST(test_alert_webhook_retry);
+}
@@ -0,0 +1,140 @@
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "test_config.h"
+#include "../backend/src/asset_cache.h"
+
+static AssetCache cache;
+
+static const char *index_html =
+    "<link rel=\"stylesheet\" href=\"style.css\">\n"
+    "<script src=\"https://cdn.example.com/lib.js\"></script>\n"
+    "<script src=\"app.js\"></script>\n"
+    "<script src=\"missing.js\"></script>\n";
+
+static const char *style_css = "body { margin: 0; padding: 0; color: #222; }\n";
+
+static void write_file(const char *dir, const char *name, const void *data, size_t len) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        fwrite(data, 1, len, f);
+        fclose(f);
+    }
+}
+
+static void remove_dir(const char *dir) {
+    static const char *names[] = {"index.html", "app.js", "style.css", "notes.txt",
+                                  "app.js.gz", "style.css.gz"};
+    char path[320];
+    for (int i = 0; i < 6; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+// Заголовок gzip и трейлер с ISIZE: загрузчик проверяет только их
+static void write_fake_gzip(const char *dir, const char *name, unsigned isize) {
+    unsigned char gz[24] = {0x1f, 0x8b, 8};
+    gz[20] = isize & 0xff;
+    gz[21] = (isize >> 8) & 0xff;
+    gz[22] = (isize >> 16) & 0xff;
+    gz[23] = (isize >> 24) & 0xff;
+    write_file(dir, name, gz, sizeof(gz));
+}
+
+static int make_frontend(char *dir) {
+    char app[200];
+    memset(app, 'a', sizeof(app));
+
+    if (!mkdtemp(dir)) return -1;
+    write_file(dir, "index.html", index_html, strlen(index_html));
+    write_file(dir, "app.js", app, sizeof(app));
+    write_file(dir, "style.css", style_css, strlen(style_css));
+    write_file(dir, "notes.txt", "not served", 10);
+    write_fake_gzip(dir, "app.js.gz", sizeof(app));
+    write_fake_gzip(dir, "style.css.gz", 999);
+    return 0;
+}
+
+static int test_asset_cache_load() {
+    char dir[] = "/tmp/test_assets_XXXXXX";
+    TEST_ASSERT(make_frontend(dir) == 0);
+    TEST_ASSERT(asset_cache_load(&cache, dir) == 0);
+
+    // notes.txt и .gz не отдаются как отдельные файлы
+    TEST_ASSERT_EQUAL(3, cache.count);
+
+    const Asset *app = asset_cache_find(&cache, "/app.js");
+    TEST_ASSERT(app != NULL);
+    TEST_ASSERT_STR_EQUAL("application/javascript; charset=utf-8", app->content_type);
+    TEST_ASSERT_EQUAL(200, app->plain.len);
+    TEST_ASSERT(app->plain.fd < 0);
+    TEST_ASSERT(app->gzip.data != NULL);
+    TEST_ASSERT(strstr(app->gzip.etag, "-gz") != NULL);
+
+    // ISIZE не совпадает с длиной style.css
+    const Asset *css = asset_cache_find(&cache, "/style.css");
+    TEST_ASSERT(css != NULL);
+    TEST_ASSERT(css->gzip.data == NULL);
+
+    // ссылки на свои файлы получают версию из ETag, внешние не меняются
+    const Asset *index = asset_cache_find(&cache, "/");
+    char expected[64];
+    snprintf(expected, sizeof(expected), "src=\"app.js?v=%.8s\"", app->plain.etag + 1);
+    TEST_ASSERT(index != NULL);
+    TEST_ASSERT(strstr(index->plain.data, expected) != NULL);
+    TEST_ASSERT(strstr(index->plain.data, "href=\"style.css?v=") != NULL);
+    TEST_ASSERT(strstr(index->plain.data, "src=\"https://cdn.example.com/lib.js\"") != NULL);
+    TEST_ASSERT(strstr(index->plain.data, "src=\"missing.js\"") != NULL);
+
+    // ETag зависит только от содержимого
+    char etag[32];
+    snprintf(etag, sizeof(etag), "%s", app->plain.etag);
+    asset_cache_free(&cache);
+    TEST_ASSERT(asset_cache_load(&cache, dir) == 0);
+    TEST_ASSERT_STR_EQUAL(etag, asset_cache_find(&cache, "/app.js")->plain.etag);
+
+    asset_cache_free(&cache);
+    remove_dir(dir);
+    return 1;
+}
+
+static int test_asset_cache_find_paths() {
+    char dir[] = "/tmp/test_assets_XXXXXX";
+    TEST_ASSERT(make_frontend(dir) == 0);
+    TEST_ASSERT(asset_cache_load(&cache, dir) == 0);
+
+    TEST_ASSERT(asset_cache_find(&cache, "/") == asset_cache_find(&cache, "/index.html"));
+    TEST_ASSERT(asset_cache_find(&cache, "/app.js?v=12345678") != NULL);
+    TEST_ASSERT(asset_cache_find(&cache, "/../app.js") == NULL);
+    TEST_ASSERT(asset_cache_find(&cache, "/js/app.js") == NULL);
+    TEST_ASSERT(asset_cache_find(&cache, "app.js") == NULL);
+    TEST_ASSERT(asset_cache_find(&cache, "/notes.txt") == NULL);
+    TEST_ASSERT(asset_cache_find(&cache, "/api/system") == NULL);
+
+    asset_cache_free(&cache);
+    remove_dir(dir);
+    return 1;
+}
+
+static int test_asset_cache_requires_index() {
+    char dir[] = "/tmp/test_assets_XXXXXX";
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+    write_file(dir, "app.js", "1;", 2);
+
+    TEST_ASSERT(asset_cache_load(&cache, dir) != 0);
+    TEST_ASSERT_EQUAL(0, cache.count);
+    TEST_ASSERT(asset_cache_load(&cache, "/nonexistent/frontend") != 0);
+
+    remove_dir(dir);
+    return 1;
+}
+
+void test_asset_cache_suite() {
+    RUN_TEST(test_asset_cache_load);
+    RUN_TEST(test_asset_cache_find_paths);
+    RUN_TEST(test_asset_cache_requires_index);
+}
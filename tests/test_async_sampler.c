@@ -0,0 +1,108 @@
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/async_sampler.h"
+
+typedef struct {
+    int value;
+    int fail;
+    volatile int hold;          // замер висит, пока тест не отпустит
+    volatile int inside;
+} FakeSlow;
+
+static int fake_slow_sample(void *ctx, void *out) {
+    FakeSlow *f = ctx;
+    f->inside = 1;
+    while (f->hold) usleep(1000);
+    f->inside = 0;
+    if (f->fail) return -1;
+    *(int *)out = ++f->value;
+    return 0;
+}
+
+static long mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static int wait_idle(AsyncSampler *a) {
+    for (int i = 0; i < 500; i++) {
+        pthread_mutex_lock(&a->mutex);
+        int idle = !a->busy && !a->requested;
+        pthread_mutex_unlock(&a->mutex);
+        if (idle) return 1;
+        usleep(1000);
+    }
+    return 0;
+}
+
+static int test_async_sampler_results() {
+    AsyncSampler a;
+    FakeSlow f = {0};
+    int out = 0;
+    long at = 0;
+
+    TEST_ASSERT_EQUAL(0, async_sampler_start(&a, "test", fake_slow_sample, &f, sizeof(int), 1000));
+    TEST_ASSERT_EQUAL(0, async_sampler_take(&a, &out, &at));
+
+    TEST_ASSERT_EQUAL(1, async_sampler_request(&a));
+    TEST_ASSERT(wait_idle(&a));
+    TEST_ASSERT_EQUAL(1, async_sampler_take(&a, &out, &at));
+    TEST_ASSERT_EQUAL(1, out);
+    TEST_ASSERT(at > 0 && at <= mono_ms());
+
+    // неудачный замер не затирает последний удачный
+    f.fail = 1;
+    TEST_ASSERT_EQUAL(1, async_sampler_request(&a));
+    TEST_ASSERT(wait_idle(&a));
+    out = 0;
+    TEST_ASSERT_EQUAL(1, async_sampler_take(&a, &out, NULL));
+    TEST_ASSERT_EQUAL(1, out);
+    TEST_ASSERT_EQUAL(2, (int)a.runs);
+    TEST_ASSERT_EQUAL(1, (int)a.failures);
+
+    async_sampler_stop(&a);
+    return 1;
+}
+
+// Сторож: долгий замер помечается hung, новые не ставятся, тик не ждет
+static int test_async_sampler_watchdog() {
+    AsyncSampler a;
+    FakeSlow f = {.hold = 1};
+    int out = 0;
+
+    TEST_ASSERT_EQUAL(0, async_sampler_start(&a, "test", fake_slow_sample, &f, sizeof(int), 50));
+    TEST_ASSERT_EQUAL(1, async_sampler_request(&a));
+    for (int i = 0; i < 500 && !f.inside; i++) usleep(1000);
+    TEST_ASSERT(f.inside);
+
+    TEST_ASSERT_EQUAL(0, async_sampler_watchdog(&a, mono_ms()));
+    TEST_ASSERT_EQUAL(0, async_sampler_request(&a));
+    TEST_ASSERT_EQUAL(1, async_sampler_watchdog(&a, mono_ms() + 100));
+    TEST_ASSERT_EQUAL(1, async_sampler_watchdog(&a, mono_ms() + 200));
+    TEST_ASSERT_EQUAL(1, (int)a.watchdog_trips);
+    TEST_ASSERT_EQUAL(0, async_sampler_take(&a, &out, NULL));
+
+    JsonWriter w;
+    jw_init(&w, 256);
+    write_async_sampler_json(&w, &a);
+    TEST_ASSERT(strstr(w.data, "\"busy\":true,\"hung\":true") != NULL);
+    jw_free(&w);
+
+    f.hold = 0;
+    TEST_ASSERT(wait_idle(&a));
+    TEST_ASSERT_EQUAL(0, async_sampler_watchdog(&a, mono_ms() + 100));
+    TEST_ASSERT_EQUAL(1, async_sampler_take(&a, &out, NULL));
+    TEST_ASSERT_EQUAL(1, out);
+    TEST_ASSERT_EQUAL(1, async_sampler_request(&a));
+
+    async_sampler_stop(&a);
+    return 1;
+}
+
+void test_async_sampler_suite() {
+    RUN_TEST(test_async_sampler_results);
+    RUN_TEST(test_async_sampler_watchdog);
+}
@@ -0,0 +1,112 @@
+#include <math.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/capture.h"
+#include "../backend/src/proc_parser.h"
+#include "fixture_tree.h"
+
+static ProcessInfo processes[MAX_PROCESSES];
+
+static void use_roots(const char *root) {
+    char path[300];
+    snprintf(path, sizeof(path), "%s/proc", root);
+    set_proc_root(path);
+    snprintf(path, sizeof(path), "%s/sys", root);
+    set_sys_root(path);
+}
+
+// Процесс завершился: его каталог пропадает из /proc
+static void remove_pid(const char *root, int pid) {
+    static const char *files[] = {"stat", "status", "cmdline", "schedstat", "io", "cgroup"};
+    char path[320];
+    for (int i = 0; i < 6; i++) {
+        snprintf(path, sizeof(path), "%s/proc/%d/%s", root, pid, files[i]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/proc/%d", root, pid);
+    rmdir(path);
+}
+
+static int has_pid(int count, int pid) {
+    for (int i = 0; i < count; i++) {
+        if (processes[i].pid == pid) return 1;
+    }
+    return 0;
+}
+
+static int test_record_replay_roundtrip() {
+    FixtureSpec spec = {.processes = 12, .cores = 2, .disks = 1, .interfaces = 1, .cgroups = 1};
+    char root[256];
+    char capture[] = "/tmp/test_capture_XXXXXX";
+    MemoryInfo mem;
+    int count = 0;
+
+    int fd = mkstemp(capture);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+    unlink(capture);
+    TEST_ASSERT(fixture_tree_create(root, sizeof(root), &spec) == 0);
+
+    // запись: кадр 0 и два тика, на втором PID 1003 завершается
+    use_roots(root);
+    TEST_ASSERT(capture_record_open(capture) == 0);
+    get_processes(processes, &count);
+    capture_end_tick(0.0);
+    fixture_tree_tick(root, &spec, 1);
+    get_processes(processes, &count);
+    read_memory_info(&mem);
+    capture_end_tick(2.0);
+    remove_pid(root, 1003);
+    get_processes(processes, &count);
+    capture_end_tick(2.5);
+    capture_close();
+    set_proc_root(PROC_ROOT);
+    set_sys_root(SYS_ROOT);
+    fixture_tree_remove(root);
+
+    // воспроизведение идет через те же парсеры, реального /proc не касается
+    TEST_ASSERT(capture_replay_open(capture, 1000.0) == 0);
+    TEST_ASSERT(capture_replaying());
+    TEST_ASSERT(strcmp(get_proc_root(), PROC_ROOT) != 0);
+    get_processes(processes, &count);
+    TEST_ASSERT_EQUAL(12, count);
+
+    TEST_ASSERT_DOUBLE_EQUAL(2.0, capture_replay_next(), 0.001);
+    TEST_ASSERT(read_memory_info(&mem) == 0);
+    TEST_ASSERT(mem.total == 65536000ULL * 1024);
+    get_processes(processes, &count);
+    TEST_ASSERT_EQUAL(12, count);
+
+    TEST_ASSERT_DOUBLE_EQUAL(2.5, capture_replay_next(), 0.001);
+    get_processes(processes, &count);
+    TEST_ASSERT_EQUAL(11, count);
+    TEST_ASSERT(!has_pid(count, 1003));
+
+    // конец записи: воспроизведение начинается заново
+    TEST_ASSERT_DOUBLE_EQUAL(2.0, capture_replay_next(), 0.001);
+
+    capture_close();
+    TEST_ASSERT(!capture_replaying());
+    TEST_ASSERT_STR_EQUAL(PROC_ROOT, get_proc_root());
+    unlink(capture);
+    return 1;
+}
+
+static int test_replay_rejects_foreign_file() {
+    char path[] = "/tmp/test_capture_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT(write(fd, "not a capture", 13) == 13);
+    close(fd);
+
+    TEST_ASSERT(capture_replay_open(path, 1.0) != 0);
+    TEST_ASSERT(!capture_replaying());
+    TEST_ASSERT_STR_EQUAL(PROC_ROOT, get_proc_root());
+    unlink(path);
+    return 1;
+}
+
+void test_capture_suite() {
+    RUN_TEST(test_record_replay_roundtrip);
+    RUN_TEST(test_replay_rejects_foreign_file);
+}
@@ -0,0 +1,264 @@
+#include <math.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "fixture_tree.h"
+#include "../backend/src/cgroup_collector.h"
+#include "../backend/src/procfs.h"
+
+static CgroupCollector collector;
+
+// Фикстура: cg/ - иерархия cgroup v2, proc/ - файлы /proc/<pid>/cgroup
+static int create_fixture(void) {
+    if (fixture_create("cgroup") != 0) return -1;
+
+    fixture_mkdir("cg");
+    fixture_mkdir("cg/system.slice");
+    fixture_mkdir("cg/system.slice/web.service");
+    fixture_mkdir("cg/user.slice");
+    fixture_mkdir("proc");
+    fixture_mkdir("proc/100");
+    fixture_mkdir("proc/200");
+
+    fixture_write("cg/cgroup.controllers", "cpu io memory pids\n");
+    fixture_write("cg/cpu.stat", "usage_usec 10000000\nuser_usec 6000000\nsystem_usec 4000000\n");
+    fixture_write("cg/cpu.pressure",
+                  "some avg10=1.50 avg60=0.75 avg300=0.10 total=12345\n"
+                  "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+
+    fixture_write("cg/system.slice/cpu.stat", "usage_usec 4000000\n");
+    fixture_write("cg/system.slice/cpu.max", "max 100000\n");
+
+    fixture_write("cg/system.slice/web.service/cpu.stat", "usage_usec 1000000\nnr_periods 10\n");
+    fixture_write("cg/system.slice/web.service/cpu.max", "50000 100000\n");
+    fixture_write("cg/system.slice/web.service/memory.current", "104857600\n");
+    fixture_write("cg/system.slice/web.service/memory.stat",
+                  "anon 73400320\nfile 31457280\nkernel 0\nanon_thp 0\n");
+    fixture_write("cg/system.slice/web.service/memory.pressure",
+                  "some avg10=12.34 avg60=5.00 avg300=1.00 total=999\n"
+                  "full avg10=3.21 avg60=1.00 avg300=0.50 total=111\n");
+    fixture_write("cg/system.slice/web.service/cpu.pressure",
+                  "some avg10=0.50 avg60=0.25 avg300=0.00 total=10\n");
+
+    fixture_write("cg/user.slice/cpu.stat", "usage_usec 0\n");
+
+    fixture_write("proc/100/cgroup", "0::/system.slice/web.service\n");
+    fixture_write("proc/200/cgroup", "0::/user.slice/user-1000.slice/session-1.scope\n");
+
+    return 0;
+}
+
+static int init_fixture_collector(void) {
+    char cg[128], proc[128];
+    snprintf(cg, sizeof(cg), "%s/cg", fixture_dir);
+    snprintf(proc, sizeof(proc), "%s/proc", fixture_dir);
+    if (cgroup_collector_init(&collector, cg, proc) != 0) return -1;
+    collector.online_cpus = 4;
+    return 0;
+}
+
+static int test_procfs_parsers() {
+    PressureStats psi;
+    unsigned long long value = 0;
+
+    TEST_ASSERT(parse_pressure("some avg10=1.50 avg60=0.75 avg300=0.10 total=12345\n"
+                               "full avg10=0.25 avg60=0.00 avg300=0.00 total=7\n", &psi) == 0);
+    TEST_ASSERT_DOUBLE_EQUAL(1.5, psi.some_avg10, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.75, psi.some_avg60, 1e-9);
+    TEST_ASSERT_EQUAL(12345ULL, psi.some_total);
+    TEST_ASSERT_DOUBLE_EQUAL(0.25, psi.full_avg10, 1e-9);
+    TEST_ASSERT_EQUAL(7ULL, psi.full_total);
+    TEST_ASSERT(parse_pressure("garbage\n", &psi) != 0);
+
+    TEST_ASSERT(find_key_ull("anon_thp 5\nanon 42\nfile 7\n", "anon", &value) == 0);
+    TEST_ASSERT_EQUAL(42ULL, value);
+    TEST_ASSERT(find_key_ull("anon 42\n", "file", &value) != 0);
+
+    return 1;
+}
+
+static int test_cgroup_scan_tree() {
+    TEST_ASSERT(create_fixture() == 0);
+    TEST_ASSERT(init_fixture_collector() == 0);
+
+    TEST_ASSERT_EQUAL(4, collector.count);
+    int root = find_cgroup_node(&collector, "/");
+    int slice = find_cgroup_node(&collector, "/system.slice");
+    int web = find_cgroup_node(&collector, "/system.slice/web.service");
+    TEST_ASSERT(root >= 0 && slice >= 0 && web >= 0);
+    TEST_ASSERT(find_cgroup_node(&collector, "/user.slice") >= 0);
+
+    TEST_ASSERT_EQUAL(root, collector.nodes[slice].parent);
+    TEST_ASSERT_EQUAL(slice, collector.nodes[web].parent);
+    TEST_ASSERT_EQUAL(web, collector.nodes[slice].first_child);
+    TEST_ASSERT_EQUAL(2, collector.nodes[web].depth);
+
+    // группа исчезла, появилась новая - слот web.service освобождается
+    char web_dir[128];
+    snprintf(web_dir, sizeof(web_dir), "%s/cg/system.slice/web.service", fixture_dir);
+    fixture_tree_remove(web_dir);
+    fixture_mkdir("cg/user.slice/user-1000.slice");
+    TEST_ASSERT_EQUAL(4, cgroup_collector_scan(&collector));
+    TEST_ASSERT(find_cgroup_node(&collector, "/system.slice/web.service") < 0);
+    TEST_ASSERT(find_cgroup_node(&collector, "/user.slice/user-1000.slice") >= 0);
+    TEST_ASSERT_EQUAL(-1, collector.nodes[slice].first_child);
+    // слот, оставшийся без изменений, сохраняется
+    TEST_ASSERT_EQUAL(slice, find_cgroup_node(&collector, "/system.slice"));
+
+    cgroup_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_cgroup_cpu_memory_pressure() {
+    TEST_ASSERT(create_fixture() == 0);
+    TEST_ASSERT(init_fixture_collector() == 0);
+
+    cgroup_collector_sample(&collector, 2.0, 1000);
+
+    // второй тик: перезаписываем файлы, закешированные дескрипторы видят новое
+    fixture_write("cg/cpu.stat", "usage_usec 14000000\n");
+    fixture_write("cg/system.slice/cpu.stat", "usage_usec 6000000\n");
+    fixture_write("cg/system.slice/web.service/cpu.stat", "usage_usec 1500000\n");
+    cgroup_collector_sample(&collector, 2.0, 1002);
+
+    const CgroupNode *root = &collector.nodes[find_cgroup_node(&collector, "/")];
+    const CgroupNode *slice = &collector.nodes[find_cgroup_node(&collector, "/system.slice")];
+    const CgroupNode *web = &collector.nodes[find_cgroup_node(&collector, "/system.slice/web.service")];
+
+    // без квоты - доля от всех CPU
+    TEST_ASSERT_DOUBLE_EQUAL(2.0, root->cpu_cores, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, root->cpu_percent, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, slice->quota_cpus, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(25.0, slice->cpu_percent, 1e-9);
+
+    // квота 0.5 CPU, потрачено 0.25 CPU
+    TEST_ASSERT_DOUBLE_EQUAL(0.5, web->quota_cpus, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.25, web->cpu_cores, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, web->cpu_percent, 1e-9);
+
+    TEST_ASSERT(!root->has_memory);
+    TEST_ASSERT(web->has_memory);
+    TEST_ASSERT_EQUAL(104857600ULL, web->memory_current_bytes);
+    TEST_ASSERT_EQUAL(73400320ULL, web->memory_anon);
+    TEST_ASSERT_EQUAL(31457280ULL, web->memory_file);
+
+    TEST_ASSERT(root->has_pressure);
+    TEST_ASSERT_DOUBLE_EQUAL(1.5, root->cpu_psi.some_avg10, 1e-9);
+    TEST_ASSERT(web->has_pressure);
+    TEST_ASSERT_DOUBLE_EQUAL(12.34, web->memory_psi.some_avg10, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(3.21, web->memory_psi.full_avg10, 1e-9);
+    TEST_ASSERT(!slice->has_pressure);
+
+    // сброс счетчика (группа пересоздана) не дает отрицательной загрузки
+    fixture_write("cg/system.slice/web.service/cpu.stat", "usage_usec 100\n");
+    cgroup_collector_sample(&collector, 2.0, 1004);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, web->cpu_percent, 1e-9);
+
+    cgroup_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_cgroup_pid_attribution() {
+    ProcessInfo processes[3];
+
+    TEST_ASSERT(create_fixture() == 0);
+    TEST_ASSERT(init_fixture_collector() == 0);
+
+    memset(processes, 0, sizeof(processes));
+    processes[0].pid = 100;
+    processes[0].starttime = 5000;
+    processes[0].rss = 2048;
+    processes[0].cpu_usage = 12.5;
+    processes[1].pid = 200;
+    processes[1].starttime = 6000;
+    processes[1].rss = 1024;
+    processes[1].cpu_usage = 1.0;
+    processes[2].pid = 300;
+    processes[2].starttime = 7000;
+
+    cgroup_attribute_processes(&collector, processes, 3);
+
+    int web = find_cgroup_node(&collector, "/system.slice/web.service");
+    int user = find_cgroup_node(&collector, "/user.slice");
+    TEST_ASSERT_EQUAL(1, collector.nodes[web].process_count);
+    TEST_ASSERT_EQUAL(2048ULL * 1024, collector.nodes[web].process_rss);
+    TEST_ASSERT_DOUBLE_EQUAL(12.5, collector.nodes[web].process_cpu, 1e-9);
+    // session-1.scope не отсканирована - процесс относится к ближайшему предку
+    TEST_ASSERT_EQUAL(1, collector.nodes[user].process_count);
+
+    // тот же (pid, starttime) берется из кеша без чтения /proc
+    fixture_write("proc/100/cgroup", "0::/user.slice\n");
+    cgroup_attribute_processes(&collector, processes, 3);
+    TEST_ASSERT_EQUAL(1, collector.nodes[web].process_count);
+
+    // pid переиспользован другим процессом - перечитываем
+    processes[0].starttime = 9000;
+    cgroup_attribute_processes(&collector, processes, 3);
+    TEST_ASSERT_EQUAL(0, collector.nodes[web].process_count);
+    TEST_ASSERT_EQUAL(2, collector.nodes[user].process_count);
+
+    cgroup_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_cgroup_json() {
+    JsonWriter w;
+
+    TEST_ASSERT(create_fixture() == 0);
+    TEST_ASSERT(init_fixture_collector() == 0);
+    cgroup_collector_sample(&collector, 2.0, 1000);
+
+    jw_init(&w, 256);
+    write_cgroups_json(&w, &collector);
+    TEST_ASSERT(!w.overflow);
+
+    TEST_ASSERT(strstr(w.data, "\"timestamp\": 1000") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"count\": 4") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"tree\": {\"path\": \"/\", \"name\": \"/\"") != NULL);
+
+    const char *web = strstr(w.data, "{\"path\": \"/system.slice/web.service\", \"name\": \"web.service\"");
+    TEST_ASSERT(web != NULL);
+    TEST_ASSERT(strstr(web, "\"quota\": 0.5}") != NULL);
+    TEST_ASSERT(strstr(web, "\"memory\": {\"current\": 104857600, \"anon\": 73400320") != NULL);
+    TEST_ASSERT(strstr(web, "\"memory\": {\"some\": 12.3, \"full\": 3.2}") != NULL);
+
+    const char *root = strstr(w.data, "\"tree\": ");
+    TEST_ASSERT(strstr(root, "\"quota\": null}, \"memory\": null") != NULL);
+
+    // скобки сбалансированы
+    int depth = 0;
+    for (const char *p = w.data; *p; p++) {
+        if (*p == '{' || *p == '[') depth++;
+        if (*p == '}' || *p == ']') depth--;
+        TEST_ASSERT(depth >= 0);
+    }
+    TEST_ASSERT_EQUAL(0, depth);
+
+    jw_free(&w);
+    cgroup_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_cgroup_requires_v2() {
+    TEST_ASSERT(create_fixture() == 0);
+
+    char cg[128];
+    snprintf(cg, sizeof(cg), "%s/cg/system.slice", fixture_dir);
+    TEST_ASSERT(cgroup_collector_init(&collector, cg, "/proc") != 0);
+
+    fixture_remove();
+    return 1;
+}
+
+// Сьют тестов
+void test_cgroup_collector_suite() {
+    RUN_TEST(test_procfs_parsers);
+    RUN_TEST(test_cgroup_scan_tree);
+    RUN_TEST(test_cgroup_cpu_memory_pressure);
+    RUN_TEST(test_cgroup_pid_attribution);
+    RUN_TEST(test_cgroup_json);
+    RUN_TEST(test_cgroup_requires_v2);
+}
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/collector.h"
+#include "../backend/src/config_file.h"
+
+typedef struct {
+    int inits;
+    int samples;
+    int teardowns;
+    int fail_init;
+} FakeState;
+
+static int fake_init(Collector *c) {
+    FakeState *s = c->state;
+    s->inits++;
+    return s->fail_init ? -1 : 0;
+}
+
+static void fake_sample(Collector *c, double elapsed) {
+    FakeState *s = c->state;
+    (void)elapsed;
+    s->samples++;
+    usleep(2000);
+}
+
+static void fake_serialize(Collector *c, JsonWriter *w) {
+    FakeState *s = c->state;
+    jw_lit(w, "{\"inits\":");
+    jw_int(w, s->inits);
+    jw_char(w, '}');
+}
+
+static void fake_teardown(Collector *c) {
+    FakeState *s = c->state;
+    s->teardowns++;
+}
+
+static const CollectorOps base_ops = {"base", 1, NULL, fake_sample, NULL, NULL, 0};
+static const CollectorOps gpu_ops = {"gpu", 0, fake_init, fake_sample, fake_serialize, fake_teardown, 0};
+
+static int test_collector_enable_disable() {
+    CollectorRegistry r;
+    FakeState base = {0}, gpu = {0};
+    memset(&r, 0, sizeof(r));
+
+    Collector *b = collector_register(&r, &base_ops, &base);
+    Collector *g = collector_register(&r, &gpu_ops, &gpu);
+    TEST_ASSERT(b != NULL && g != NULL);
+    TEST_ASSERT(collector_register(&r, &gpu_ops, &gpu) == NULL);
+    TEST_ASSERT(collector_find(&r, "gpu") == g);
+
+    TEST_ASSERT_EQUAL(2, collectors_sync(&r));
+    TEST_ASSERT_EQUAL(1, collector_run(g, 1.0));
+    TEST_ASSERT_EQUAL(1, gpu.samples);
+
+    // выключенный не вызывается вовсе
+    TEST_ASSERT_EQUAL(0, collector_set_wanted(&r, "gpu", 0));
+    TEST_ASSERT_EQUAL(1, collectors_sync(&r));
+    TEST_ASSERT_EQUAL(1, gpu.teardowns);
+    TEST_ASSERT_EQUAL(0, collector_run(g, 1.0));
+    TEST_ASSERT_EQUAL(1, gpu.samples);
+
+    TEST_ASSERT_EQUAL(0, collector_set_wanted(&r, "gpu", 1));
+    TEST_ASSERT_EQUAL(1, collectors_sync(&r));
+    TEST_ASSERT_EQUAL(2, gpu.inits);
+
+    TEST_ASSERT_EQUAL(-2, collector_set_wanted(&r, "base", 0));
+    TEST_ASSERT_EQUAL(-1, collector_set_wanted(&r, "disks", 0));
+    TEST_ASSERT(b->active);
+
+    collectors_teardown(&r);
+    TEST_ASSERT_EQUAL(2, gpu.teardowns);
+    TEST_ASSERT(!g->active);
+    return 1;
+}
+
+// Недоступный пробуется один раз, пока его не включат заново
+static int test_collector_unavailable() {
+    CollectorRegistry r;
+    FakeState gpu = {.fail_init = 1};
+    memset(&r, 0, sizeof(r));
+
+    Collector *g = collector_register(&r, &gpu_ops, &gpu);
+    TEST_ASSERT_EQUAL(0, collectors_sync(&r));
+    TEST_ASSERT_EQUAL(0, collectors_sync(&r));
+    TEST_ASSERT_EQUAL(1, gpu.inits);
+    TEST_ASSERT(g->unavailable);
+    TEST_ASSERT_EQUAL(0, collector_run(g, 1.0));
+
+    JsonWriter w;
+    jw_init(&w, 1024);
+    write_collectors_json(&w, &r);
+    TEST_ASSERT(strstr(w.data, "\"state\":\"unavailable\"") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"details\"") == NULL);
+    jw_free(&w);
+
+    collector_set_wanted(&r, "gpu", 0);
+    collectors_sync(&r);
+    gpu.fail_init = 0;
+    collector_set_wanted(&r, "gpu", 1);
+    TEST_ASSERT_EQUAL(1, collectors_sync(&r));
+    TEST_ASSERT(g->active && !g->unavailable);
+    TEST_ASSERT_EQUAL(0, gpu.teardowns);
+
+    collectors_teardown(&r);
+    TEST_ASSERT_EQUAL(1, gpu.teardowns);
+    return 1;
+}
+
+static int test_collector_cost() {
+    CollectorRegistry r;
+    FakeState gpu = {0};
+    memset(&r, 0, sizeof(r));
+
+    Collector *g = collector_register(&r, &gpu_ops, &gpu);
+    collectors_sync(&r);
+    for (int i = 0; i < 3; i++) collector_run(g, 1.0);
+
+    TEST_ASSERT_EQUAL(3, (int)g->samples);
+    TEST_ASSERT(g->last_ms >= 2.0 && g->max_ms >= g->last_ms);
+    TEST_ASSERT(g->total_ms >= 6.0);
+    TEST_ASSERT(g->avg_ms >= 2.0 && g->avg_ms <= g->max_ms);
+
+    JsonWriter w;
+    jw_init(&w, 1024);
+    write_collectors_json(&w, &r);
+    TEST_ASSERT(strstr(w.data, "{\"name\":\"gpu\",\"state\":\"active\",\"samples\":3,") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"details\":{\"inits\":1}") != NULL);
+    jw_free(&w);
+
+    collectors_teardown(&r);
+    return 1;
+}
+
+static int test_config_file_args() {
+    char key[64], value[128];
+
+    TEST_ASSERT_EQUAL(1, config_file_parse_line("port = 9090\n", key, sizeof(key), value, sizeof(value)));
+    TEST_ASSERT_STR_EQUAL("port", key);
+    TEST_ASSERT_STR_EQUAL("9090", value);
+    TEST_ASSERT_EQUAL(1, config_file_parse_line("  disable gpu,processes # дорого", key, sizeof(key),
+                                                value, sizeof(value)));
+    TEST_ASSERT_STR_EQUAL("disable", key);
+    TEST_ASSERT_STR_EQUAL("gpu,processes", value);
+    TEST_ASSERT_EQUAL(1, config_file_parse_line("all-interfaces", key, sizeof(key), value, sizeof(value)));
+    TEST_ASSERT_STR_EQUAL("", value);
+    TEST_ASSERT_EQUAL(0, config_file_parse_line("   # комментарий", key, sizeof(key), value, sizeof(value)));
+    TEST_ASSERT_EQUAL(-1, config_file_parse_line("= 5", key, sizeof(key), value, sizeof(value)));
+
+    char path[] = "/tmp/test_config_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    FILE *f = fdopen(fd, "w");
+    fprintf(f, "# system_monitor\ninterval-ms = 500\n\nall-interfaces\nport 9090\n");
+    fclose(f);
+
+    char *argv[] = {"system_monitor", "--config", path, "--port", "8081", NULL};
+    int out_argc;
+    char **out_argv;
+    TEST_ASSERT_EQUAL(0, config_file_args(path, 5, argv, &out_argc, &out_argv));
+    TEST_ASSERT_EQUAL(10, out_argc);
+    TEST_ASSERT_STR_EQUAL("--interval-ms", out_argv[1]);
+    TEST_ASSERT_STR_EQUAL("500", out_argv[2]);
+    TEST_ASSERT_STR_EQUAL("--all-interfaces", out_argv[3]);
+    TEST_ASSERT_STR_EQUAL("--port", out_argv[4]);
+    // командная строка после файла и переопределяет его
+    TEST_ASSERT_STR_EQUAL("--port", out_argv[8]);
+    TEST_ASSERT_STR_EQUAL("8081", out_argv[9]);
+    TEST_ASSERT(out_argv[10] == NULL);
+
+    f = fopen(path, "w");
+    fprintf(f, "port = 9090\n--oops\n");
+    fclose(f);
+    TEST_ASSERT_EQUAL(-1, config_file_args(path, 5, argv, &out_argc, &out_argv));
+    unlink(path);
+    TEST_ASSERT_EQUAL(-1, config_file_args(path, 5, argv, &out_argc, &out_argv));
+    return 1;
+}
+
+void test_collector_suite() {
+    RUN_TEST(test_collector_enable_disable);
+    RUN_TEST(test_collector_unavailable);
+    RUN_TEST(test_collector_cost);
+    RUN_TEST(test_config_file_args);
+}
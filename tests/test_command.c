@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/command.h"
+
+static long elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000L + (now.tv_nsec - start->tv_nsec) / 1000000L;
+}
+
+// Убитый процесс либо уже убран, либо зомби у нового родителя
+static int process_gone(int pid) {
+    char path[64], state = 'Z';
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) return 1;
+    if (fscanf(f, "%*d %*s %c", &state) != 1) state = 'Z';
+    fclose(f);
+    return state == 'Z' || state == 'X';
+}
+
+static int test_command_output() {
+    char out[64];
+    char *argv[] = {"echo", "42, 8192, Fake GPU", NULL};
+
+    TEST_ASSERT_EQUAL(19, command_read(argv, out, sizeof(out), 1000));
+    TEST_ASSERT_STR_EQUAL("42, 8192, Fake GPU\n", out);
+
+    // длинный вывод обрезается, но дочитывается до конца
+    char small[8];
+    TEST_ASSERT_EQUAL(7, command_read_shell("seq 1 10000", small, sizeof(small), 1000));
+    TEST_ASSERT_STR_EQUAL("1\n2\n3\n4", small);
+
+    char *missing[] = {"no-such-command-for-test", NULL};
+    TEST_ASSERT_EQUAL(COMMAND_FAILED, command_read(missing, out, sizeof(out), 1000));
+    TEST_ASSERT_STR_EQUAL("", out);
+    return 1;
+}
+
+// Зависшая команда убивается по дедлайну вместе со своими детьми
+static int test_command_deadline() {
+    char out[64];
+    char pid_path[] = "/tmp/test_command_XXXXXX";
+    int fd = mkstemp(pid_path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+
+    char script[128];
+    snprintf(script, sizeof(script), "echo partial; sleep 30 & echo $! > %s; wait", pid_path);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL(COMMAND_TIMEOUT, command_read_shell(script, out, sizeof(out), 300));
+    long took = elapsed_ms(&start);
+    TEST_ASSERT(took >= 300 && took < 2000);
+    TEST_ASSERT_STR_EQUAL("", out);
+
+    int sleeper = 0;
+    FILE *f = fopen(pid_path, "r");
+    TEST_ASSERT(f != NULL);
+    TEST_ASSERT_EQUAL(1, fscanf(f, "%d", &sleeper));
+    fclose(f);
+    unlink(pid_path);
+    for (int i = 0; i < 50 && !process_gone(sleeper); i++) usleep(10000);
+    TEST_ASSERT(process_gone(sleeper));
+    TEST_ASSERT_EQUAL(0, command_stuck_count());
+    return 1;
+}
+
+void test_command_suite() {
+    RUN_TEST(test_command_output);
+    RUN_TEST(test_command_deadline);
+}
@@ -0,0 +1,114 @@
+#include <math.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/core_stats.h"
+
+static int test_core_stats_parse_and_compute() {
+    CoreStats c;
+
+    TEST_ASSERT_EQUAL(0, core_stats_init(&c, 4));
+    core_stats_begin(&c);
+    TEST_ASSERT_EQUAL(0, core_stats_parse_line(&c, "cpu0 100 0 100 800 0 0 0 0 0 0\n"));
+    TEST_ASSERT_EQUAL(0, core_stats_parse_line(&c, "cpu1 0 0 0 1000 0 0 0 0 0 0\n"));
+    TEST_ASSERT_EQUAL(-1, core_stats_parse_line(&c, "cpu  100 0 100 800 0 0 0 0 0 0\n"));
+    TEST_ASSERT_EQUAL(-1, core_stats_parse_line(&c, "cpu2 1 2\n"));
+    TEST_ASSERT_EQUAL(2, c.count);
+    TEST_ASSERT_EQUAL(2, c.online_count);
+    TEST_ASSERT(c.total[0] == 1000 && c.idle[0] == 800);
+    core_stats_rotate(&c);
+
+    // cpu0: 150 из 200 тиков занят; cpu1: простаивает; guest не входит в total
+    core_stats_begin(&c);
+    core_stats_parse_line(&c, "cpu0 200 0 150 850 0 0 0 0 40 0\n");
+    core_stats_parse_line(&c, "cpu1 0 0 0 1200 0 0 0 0 0 0\n");
+    core_stats_compute(&c);
+    TEST_ASSERT_DOUBLE_EQUAL(75.0, c.usage[0], 0.001);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, c.usage[1], 0.001);
+    core_stats_rotate(&c);
+
+    // счетчики ушли назад и CPU пропал из /proc/stat: 0, не мусор
+    core_stats_begin(&c);
+    core_stats_parse_line(&c, "cpu0 10 0 10 10 0 0 0 0 0 0\n");
+    core_stats_compute(&c);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, c.usage[0], 0.001);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, c.usage[1], 0.001);
+    TEST_ASSERT_EQUAL(0, c.online[1]);
+    TEST_ASSERT_EQUAL(1, c.online_count);
+    TEST_ASSERT_EQUAL(2, c.count);
+
+    core_stats_free(&c);
+    return 1;
+}
+
+// CPU, подключенный за пределами possible, расширяет колонки
+static int test_core_stats_grows() {
+    CoreStats c;
+
+    TEST_ASSERT_EQUAL(0, core_stats_init(&c, 2));
+    core_stats_begin(&c);
+    core_stats_parse_line(&c, "cpu0 1 0 1 8 0 0 0 0 0 0\n");
+    TEST_ASSERT_EQUAL(0, core_stats_parse_line(&c, "cpu511 5 0 5 90 0 0 0 0 0 0\n"));
+    TEST_ASSERT(c.capacity >= 512);
+    TEST_ASSERT_EQUAL(512, c.count);
+    TEST_ASSERT_EQUAL(2, c.online_count);
+    TEST_ASSERT(c.total[511] == 100);
+    TEST_ASSERT_EQUAL(0, c.online[100]);
+    TEST_ASSERT(c.total[0] == 10);
+
+    TEST_ASSERT_EQUAL(-1, core_stats_parse_line(&c, "cpu999999 1 0 1 8 0 0 0 0 0 0\n"));
+
+    core_stats_free(&c);
+    return 1;
+}
+
+static int test_cpulist_parse() {
+    unsigned char mask[16];
+
+    TEST_ASSERT_EQUAL(12, cpulist_parse("0-3,8,10-11\n", mask, sizeof(mask)));
+    TEST_ASSERT(mask[0] && mask[3] && !mask[4] && mask[8] && !mask[9] && mask[11]);
+    TEST_ASSERT_EQUAL(256, cpulist_parse("0-255", NULL, 0));
+    TEST_ASSERT_EQUAL(0, cpulist_parse("\n", mask, sizeof(mask)));
+    TEST_ASSERT_EQUAL(-1, cpulist_parse("3-1", mask, sizeof(mask)));
+    TEST_ASSERT_EQUAL(-1, cpulist_parse("a", mask, sizeof(mask)));
+    return 1;
+}
+
+static int test_core_stats_possible_from_sysfs() {
+    char root[] = "/tmp/test_cores_XXXXXX";
+    char path[256];
+
+    TEST_ASSERT(mkdtemp(root) != NULL);
+    TEST_ASSERT_EQUAL(0, core_stats_possible_cpus(root));
+
+    snprintf(path, sizeof(path), "%s/devices", root);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/devices/system", root);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/devices/system/cpu", root);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/possible", root);
+    FILE *f = fopen(path, "w");
+    TEST_ASSERT(f != NULL);
+    fputs("0-191\n", f);
+    fclose(f);
+
+    TEST_ASSERT_EQUAL(192, core_stats_possible_cpus(root));
+
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/devices/system/cpu", root);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/devices/system", root);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/devices", root);
+    rmdir(path);
+    rmdir(root);
+    return 1;
+}
+
+void test_core_stats_suite() {
+    RUN_TEST(test_core_stats_parse_and_compute);
+    RUN_TEST(test_core_stats_grows);
+    RUN_TEST(test_cpulist_parse);
+    RUN_TEST(test_core_stats_possible_from_sysfs);
+}
@@ -0,0 +1,96 @@
+#include <math.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/demand.h"
+
+static int test_demand_idle_cadence() {
+    DemandTracker d;
+    long now = 1000000;
+
+    TEST_ASSERT_EQUAL(0, demand_init(&d, 5000, 3));
+
+    // первый тик собирает все, дальше без клиентов - раз в 3 тика
+    TEST_ASSERT_EQUAL(1, demand_should_collect(&d, DEMAND_PROCESSES, 1, now));
+    demand_collected(&d, 1 << DEMAND_PROCESSES, 1, now);
+    TEST_ASSERT_EQUAL(0, demand_should_collect(&d, DEMAND_PROCESSES, 2, now + 2000));
+    TEST_ASSERT_EQUAL(0, demand_should_collect(&d, DEMAND_PROCESSES, 3, now + 4000));
+    TEST_ASSERT_EQUAL(1, demand_should_collect(&d, DEMAND_PROCESSES, 4, now + 6000));
+    TEST_ASSERT_EQUAL(2, d.skipped[DEMAND_PROCESSES]);
+
+    // с idle_ms = 0 ленивого режима нет
+    d.idle_ms = 0;
+    TEST_ASSERT_EQUAL(1, demand_should_collect(&d, DEMAND_PROCESSES, 2, now));
+
+    demand_free(&d);
+    return 1;
+}
+
+static int test_demand_request_activates() {
+    DemandTracker d;
+
+    TEST_ASSERT_EQUAL(0, demand_init(&d, 5000, 100));
+    long now = demand_now_ms();
+    demand_collected(&d, DEMAND_ALL, 1, now);
+
+    // данные свежие: сбор не будится, но секция становится активной
+    TEST_ASSERT_EQUAL(0, demand_request(&d, 1 << DEMAND_GPU, 1000));
+    TEST_ASSERT_EQUAL(0, d.wakeups);
+    TEST_ASSERT_EQUAL(1, demand_should_collect(&d, DEMAND_GPU, 2, now));
+    TEST_ASSERT_EQUAL(0, demand_should_collect(&d, DEMAND_PROCESSES, 2, now));
+
+    // через idle_ms без запросов секция снова ленивая
+    TEST_ASSERT_EQUAL(0, demand_should_collect(&d, DEMAND_GPU, 3, now + 6000));
+
+    demand_free(&d);
+    return 1;
+}
+
+static int test_demand_stale_request_wakes() {
+    DemandTracker d;
+
+    TEST_ASSERT_EQUAL(0, demand_init(&d, 5000, 100));
+    demand_collected(&d, DEMAND_ALL, 1, demand_now_ms() - 60000);
+
+    // устаревшие данные будят сбор, но воркер не ждет тика
+    long start = demand_now_ms();
+    TEST_ASSERT_EQUAL(1, demand_request(&d, 1 << DEMAND_PROCESSES, 1000));
+    TEST_ASSERT_EQUAL(1, demand_request(&d, DEMAND_ALL, 1000));
+    TEST_ASSERT(demand_now_ms() - start < 100);
+    TEST_ASSERT_EQUAL(2, d.wakeups);
+
+    // два запроса - одно пробуждение потока сбора
+    uint64_t value;
+    struct pollfd pfd = {.fd = d.wake_fd, .events = POLLIN};
+    TEST_ASSERT_EQUAL(1, poll(&pfd, 1, 0));
+    TEST_ASSERT(read(d.wake_fd, &value, sizeof(value)) == sizeof(value));
+    TEST_ASSERT(read(d.wake_fd, &value, sizeof(value)) < 0);
+
+    // после тика те же запросы свежие и сбор не будят
+    demand_collected(&d, DEMAND_ALL, 2, demand_now_ms());
+    TEST_ASSERT_EQUAL(0, demand_request(&d, DEMAND_ALL, 1000));
+    TEST_ASSERT_EQUAL(2, d.wakeups);
+    TEST_ASSERT_EQUAL(2, d.collections[DEMAND_GPU]);
+
+    demand_free(&d);
+    return 1;
+}
+
+static int test_demand_sections_query() {
+    TEST_ASSERT_EQUAL(DEMAND_ALL, demand_parse_sections(NULL));
+    TEST_ASSERT_EQUAL(DEMAND_ALL, demand_parse_sections("?top=5"));
+    TEST_ASSERT_EQUAL(0, demand_parse_sections("?sections=none"));
+    TEST_ASSERT_EQUAL(1 << DEMAND_GPU, demand_parse_sections("?x=1&sections=gpu&y=2"));
+    TEST_ASSERT_EQUAL(DEMAND_ALL, demand_parse_sections("?sections=gpu,processes"));
+    // не параметр sections, а часть чужого значения
+    TEST_ASSERT_EQUAL(DEMAND_ALL, demand_parse_sections("?filter=xsections=gpu"));
+    return 1;
+}
+
+void test_demand_suite() {
+    RUN_TEST(test_demand_idle_cadence);
+    RUN_TEST(test_demand_request_activates);
+    RUN_TEST(test_demand_stale_request_wakes);
+    RUN_TEST(test_demand_sections_query);
+}
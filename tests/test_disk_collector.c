@@ -0,0 +1,190 @@
+#include <math.h>
+#include "test_config.h"
+#include "fixture_tree.h"
+#include "../backend/src/disk_collector.h"
+
+static DiskCollector collector;
+
+// Записано с реальной машины (ядро 6.x, 17+ полей), счетчики урезаны
+static const char *diskstats_tick1 =
+    "   7       0 loop0 120 0 2400 30 0 0 0 0 0 40 30 0 0 0 0\n"
+    "   8       0 sda 1000 20 2048 500 50 10 800 100 0 1000 600 0 0 0 0 0 0\n"
+    "   8       1 sda1 900 20 1900 450 40 10 700 90 0 900 540 0 0 0 0 0 0\n"
+    "   8       2 sda2 100 0 148 50 10 0 100 10 0 100 60 0 0 0 0 0 0\n"
+    " 259       0 nvme0n1 5000 0 80000 2000 3000 0 64000 4000 2 4294967000 6000 0 0 0 0 0 0\n"
+    " 259       1 nvme0n1p1 5000 0 80000 2000 3000 0 64000 4000 2 3000 6000 0 0 0 0 0 0\n"
+    " 253       0 dm-0 10 0 80 4294967290 0 0 0 0 0 5 5 0 0 0 0 0 0\n"
+    "  11       0 sr0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+
+static const char *diskstats_tick2 =
+    "   7       0 loop0 5000 0 99999 30 0 0 0 0 0 40 30 0 0 0 0\n"
+    "   8       0 sda 1200 20 6144 900 150 10 800 600 0 2000 1500 0 0 0 0 0 0\n"
+    "   8       1 sda1 1100 20 5996 850 140 10 700 590 0 1900 1440 0 0 0 0 0 0\n"
+    "   8       2 sda2 100 0 148 50 10 0 100 10 0 100 60 0 0 0 0 0 0\n"
+    " 259       0 nvme0n1 5000 0 80000 2000 3000 0 64000 4000 0 704 6000 0 0 0 0 0 0\n"
+    " 259       1 nvme0n1p1 5000 0 80000 2000 3000 0 64000 4000 0 3000 6000 0 0 0 0 0 0\n"
+    " 253       0 dm-0 20 0 160 10 0 0 0 0 0 6 6 0 0 0 0 0 0\n"
+    "  11       0 sr0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+
+// Фикстура /sys/block: целые устройства без sr0
+static int init_fixture_collector(void) {
+    char diskstats[128], sys_block[128];
+
+    if (fixture_create("disk") != 0) return -1;
+    fixture_mkdir("block");
+    fixture_mkdir("block/loop0");
+    fixture_mkdir("block/sda");
+    fixture_mkdir("block/nvme0n1");
+    fixture_mkdir("block/dm-0");
+    fixture_mkdir("block/dm-0/slaves");
+    fixture_mkdir("block/dm-0/slaves/sda2");
+    fixture_mkdir("block/nvme0n1/slaves");
+
+    snprintf(diskstats, sizeof(diskstats), "%s/diskstats", fixture_dir);
+    snprintf(sys_block, sizeof(sys_block), "%s/block", fixture_dir);
+    disk_collector_init(&collector, diskstats, sys_block);
+    return 0;
+}
+
+static const DiskDevice *find_device(const char *name) {
+    for (int i = 0; i < collector.count; i++) {
+        if (strcmp(collector.devices[i].name, name) == 0) return &collector.devices[i];
+    }
+    return NULL;
+}
+
+static int test_disk_filters_partitions() {
+    TEST_ASSERT(init_fixture_collector() == 0);
+
+    disk_collector_update(&collector, diskstats_tick1, 0.0);
+
+    TEST_ASSERT_EQUAL(3, collector.count);
+    TEST_ASSERT_STR_EQUAL("sda", collector.devices[0].name);
+    TEST_ASSERT_STR_EQUAL("nvme0n1", collector.devices[1].name);
+    TEST_ASSERT_STR_EQUAL("dm-0", collector.devices[2].name);
+    TEST_ASSERT(find_device("loop0") == NULL);
+    TEST_ASSERT(find_device("sda1") == NULL);
+    TEST_ASSERT(find_device("sr0") == NULL);
+
+    // первый тик - только базовые значения
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, collector.devices[0].read_iops, 1e-9);
+
+    disk_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_disk_rates() {
+    TEST_ASSERT(init_fixture_collector() == 0);
+
+    disk_collector_update(&collector, diskstats_tick1, 0.0);
+    disk_collector_update(&collector, diskstats_tick2, 2.0);
+
+    const DiskDevice *sda = find_device("sda");
+    TEST_ASSERT(sda != NULL);
+    TEST_ASSERT_DOUBLE_EQUAL(100.0, sda->read_iops, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, sda->write_iops, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(1024.0 * 1024.0, sda->read_bytes, 1e-6);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, sda->write_bytes, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(2.0, sda->read_await, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(5.0, sda->write_await, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, sda->utilization, 1e-9);
+
+    // dm-0 собран поверх sda2: его чтения уже учтены в sda, в сумму он не входит
+    const DiskDevice *dm = find_device("dm-0");
+    TEST_ASSERT(dm != NULL && dm->stacked);
+    TEST_ASSERT(!sda->stacked);
+    TEST_ASSERT(!find_device("nvme0n1")->stacked);
+    TEST_ASSERT_DOUBLE_EQUAL(20480.0, dm->read_bytes, 1e-6);
+
+    double read_bytes, write_bytes;
+    disk_collector_totals(&collector, &read_bytes, &write_bytes);
+    TEST_ASSERT_DOUBLE_EQUAL(1024.0 * 1024.0, read_bytes, 1e-6);
+
+    disk_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_disk_counter_wraparound() {
+    TEST_ASSERT_EQUAL(10ULL, counter_delta(5, 15));
+    TEST_ASSERT_EQUAL(1000ULL, counter_delta(4294967000ULL, 704));
+    // 64-битный счетчик уменьшился - это сброс, а не переполнение
+    TEST_ASSERT_EQUAL(0ULL, counter_delta(5000000000ULL, 10));
+
+    TEST_ASSERT(init_fixture_collector() == 0);
+    disk_collector_update(&collector, diskstats_tick1, 0.0);
+    disk_collector_update(&collector, diskstats_tick2, 2.0);
+
+    // io_ms перешел через 2^32: 296 + 704 = 1000 мс за 2 с
+    const DiskDevice *nvme = find_device("nvme0n1");
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, nvme->utilization, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, nvme->read_iops, 1e-9);
+
+    // read_ms перешел через 2^32: (6 + 10) мс на 10 чтений
+    const DiskDevice *dm = find_device("dm-0");
+    TEST_ASSERT_DOUBLE_EQUAL(1.6, dm->read_await, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(5.0, dm->read_iops, 1e-9);
+
+    disk_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_disk_persistent_fd() {
+    TEST_ASSERT(init_fixture_collector() == 0);
+
+    TEST_ASSERT(disk_collector_sample(&collector, 0.0) != 0);
+
+    fixture_write("diskstats", diskstats_tick1);
+    // отсутствующий файл запомнен - повторно не открывается
+    TEST_ASSERT(disk_collector_sample(&collector, 0.0) != 0);
+    collector.file.missing = 0;
+    TEST_ASSERT(disk_collector_sample(&collector, 0.0) == 0);
+    int fd = collector.file.fd;
+    TEST_ASSERT(fd >= 0);
+
+    // устройство пропало из diskstats
+    fixture_write("diskstats",
+                  "   8       0 sda 1200 20 6144 900 150 10 800 600 0 2000 1500 0 0 0 0 0 0\n");
+    TEST_ASSERT(disk_collector_sample(&collector, 2.0) == 0);
+    TEST_ASSERT_EQUAL(fd, collector.file.fd);
+    TEST_ASSERT_EQUAL(1, collector.count);
+    TEST_ASSERT_DOUBLE_EQUAL(100.0, collector.devices[0].read_iops, 1e-9);
+
+    disk_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_disk_json() {
+    JsonWriter w;
+
+    TEST_ASSERT(init_fixture_collector() == 0);
+    disk_collector_update(&collector, diskstats_tick1, 0.0);
+    disk_collector_update(&collector, diskstats_tick2, 2.0);
+
+    jw_init(&w, 64);
+    write_disks_json(&w, &collector);
+
+    TEST_ASSERT(w.data[0] == '[');
+    TEST_ASSERT(strstr(w.data, "{\"device\": \"sda\", \"read_iops\": 100.0, \"write_iops\": 50.0, "
+                               "\"read_mb\": 1.0, \"write_mb\": 0.0, \"read_bytes\": 1048576") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"utilization\": 50.0}") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"stacked\": true}") != NULL);
+    TEST_ASSERT(w.data[w.len - 1] == ']');
+
+    jw_free(&w);
+    disk_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+// Сьют тестов
+void test_disk_collector_suite() {
+    RUN_TEST(test_disk_filters_partitions);
+    RUN_TEST(test_disk_rates);
+    RUN_TEST(test_disk_counter_wraparound);
+    RUN_TEST(test_disk_persistent_fd);
+    RUN_TEST(test_disk_json);
+}
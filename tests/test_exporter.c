@@ -0,0 +1,179 @@
+#include <math.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "test_config.h"
+#include "../backend/src/exporter.h"
+
+static int test_exporter_targets() {
+    Exporter e;
+
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, "udp://127.0.0.1:8094", EXPORT_INFLUX));
+    TEST_ASSERT_EQUAL(EXPORT_UDP, e.transport);
+    TEST_ASSERT_EQUAL(AF_INET, e.addr.ss_family);
+    TEST_ASSERT_EQUAL(8094, ntohs(((struct sockaddr_in *)&e.addr)->sin_port));
+    exporter_free(&e);
+
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, "unixgram:///run/telegraf.sock", EXPORT_STATSD));
+    TEST_ASSERT_EQUAL(EXPORT_UNIXGRAM, e.transport);
+    TEST_ASSERT_EQUAL(AF_UNIX, e.addr.ss_family);
+    exporter_free(&e);
+
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, "unix:///tmp/collector.sock", EXPORT_INFLUX));
+    TEST_ASSERT_EQUAL(EXPORT_UNIX, e.transport);
+    exporter_free(&e);
+
+    TEST_ASSERT_EQUAL(-1, exporter_init(&e, "tcp://127.0.0.1:8094", EXPORT_INFLUX));
+    TEST_ASSERT_EQUAL(-1, exporter_init(&e, "udp://127.0.0.1", EXPORT_INFLUX));
+    TEST_ASSERT_EQUAL(-1, exporter_init(&e, "unix://relative.sock", EXPORT_INFLUX));
+    return 1;
+}
+
+static int test_exporter_influx_lines() {
+    Exporter e;
+    ExportBatch *b = malloc(sizeof(ExportBatch));
+    ExportField cpu[] = {{"usage", 12.5}, {"cores", 4}};
+    ExportField net[] = {{"rx_bytes", 1234567890123.0}};
+
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, "udp://127.0.0.1:8094", EXPORT_INFLUX));
+    snprintf(e.host, sizeof(e.host), "web 1");
+
+    exporter_begin(&e, 1700000000000000000LL);
+    exporter_add(&e, "cpu", NULL, NULL, cpu, 2);
+    exporter_add(&e, "net", "interface", "eth0,a=b", net, 1);
+    exporter_commit(&e);
+
+    TEST_ASSERT_EQUAL(1, exporter_take(&e, b));
+    b->data[b->len] = '\0';
+    TEST_ASSERT_STR_EQUAL("cpu,host=web\\ 1 usage=12.500,cores=4 1700000000000000000\n"
+                          "net,host=web\\ 1,interface=eth0\\,a\\=b rx_bytes=1234567890123 1700000000000000000\n",
+                          b->data);
+    TEST_ASSERT_EQUAL(0, exporter_take(&e, b));
+
+    exporter_free(&e);
+    free(b);
+    return 1;
+}
+
+static int test_exporter_statsd_lines() {
+    Exporter e;
+    ExportBatch *b = malloc(sizeof(ExportBatch));
+    ExportField mem[] = {{"percent", 42.0}, {"used", NAN}};
+
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, "udp://127.0.0.1:8125", EXPORT_STATSD));
+    snprintf(e.host, sizeof(e.host), "db.local");
+
+    exporter_begin(&e, 0);
+    exporter_add(&e, "disk", "device", "nvme0n1", mem, 1);
+    exporter_add(&e, "memory", NULL, NULL, mem, 2);
+    exporter_commit(&e);
+
+    TEST_ASSERT_EQUAL(1, exporter_take(&e, b));
+    b->data[b->len] = '\0';
+    // точка в имени хоста - разделитель statsd, поэтому заменяется
+    TEST_ASSERT_STR_EQUAL("system_monitor.db_local.disk.nvme0n1.percent:42|g\n"
+                          "system_monitor.db_local.memory.percent:42|g\n"
+                          "system_monitor.db_local.memory.used:0|g\n",
+                          b->data);
+
+    exporter_free(&e);
+    free(b);
+    return 1;
+}
+
+static int test_exporter_drops_oldest() {
+    Exporter e;
+    ExportBatch *b = malloc(sizeof(ExportBatch));
+    ExportField f[1] = {{"tick", 0}};
+
+    // поток отправки не запущен: очередь переполняется
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, "udp://127.0.0.1:9", EXPORT_STATSD));
+    snprintf(e.host, sizeof(e.host), "h");
+    for (int i = 0; i < EXPORT_QUEUE_SLOTS + 3; i++) {
+        f[0].value = i;
+        exporter_begin(&e, 0);
+        exporter_add(&e, "t", NULL, NULL, f, 1);
+        exporter_commit(&e);
+    }
+    TEST_ASSERT_EQUAL(EXPORT_QUEUE_SLOTS + 3, e.batches);
+    TEST_ASSERT_EQUAL(3, e.dropped);
+
+    TEST_ASSERT_EQUAL(1, exporter_take(&e, b));
+    b->data[b->len] = '\0';
+    TEST_ASSERT_STR_EQUAL("system_monitor.h.t.tick:3|g\n", b->data);
+
+    exporter_free(&e);
+    free(b);
+    return 1;
+}
+
+static int test_exporter_datagram_split() {
+    const char *data = "aaaa\nbbbb\ncccccccccccc\ndd\n";
+
+    TEST_ASSERT_EQUAL(10, exporter_next_datagram(data, strlen(data), 12));
+    TEST_ASSERT_EQUAL(5, exporter_next_datagram(data, strlen(data), 5));
+    // строка длиннее max уходит отдельной датаграммой
+    TEST_ASSERT_EQUAL(13, exporter_next_datagram(data + 10, strlen(data) - 10, 12));
+    TEST_ASSERT_EQUAL(3, exporter_next_datagram("dd\n", 3, 12));
+    return 1;
+}
+
+static int test_exporter_udp_send() {
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t addr_len = sizeof(addr);
+    char url[64];
+    char datagram[EXPORT_DATAGRAM_MAX + 64];
+    ExportField f[4] = {{"a", 1.5}, {"b", 2}, {"c", 3}, {"d", 4}};
+    Exporter e;
+
+    int listener = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT(listener >= 0);
+    TEST_ASSERT(bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    getsockname(listener, (struct sockaddr *)&addr, &addr_len);
+    struct timeval timeout = {.tv_sec = 2, .tv_usec = 0};
+    setsockopt(listener, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    snprintf(url, sizeof(url), "udp://127.0.0.1:%d", ntohs(addr.sin_port));
+    TEST_ASSERT_EQUAL(0, exporter_init(&e, url, EXPORT_INFLUX));
+    TEST_ASSERT_EQUAL(0, exporter_start(&e));
+
+    // ~100 строк: больше одной датаграммы
+    exporter_begin(&e, 1);
+    for (int i = 0; i < 100; i++) {
+        char tag[16];
+        snprintf(tag, sizeof(tag), "dev%d", i);
+        exporter_add(&e, "disk", "device", tag, f, 4);
+    }
+    size_t total = e.scratch.len;
+    exporter_commit(&e);
+
+    size_t received = 0;
+    int lines = 0;
+    while (received < total) {
+        ssize_t n = recv(listener, datagram, sizeof(datagram), 0);
+        if (n <= 0) break;
+        TEST_ASSERT(n <= EXPORT_DATAGRAM_MAX);
+        TEST_ASSERT(datagram[n - 1] == '\n');
+        for (ssize_t i = 0; i < n; i++) lines += datagram[i] == '\n';
+        received += n;
+    }
+    exporter_stop(&e);
+
+    TEST_ASSERT_EQUAL(total, received);
+    TEST_ASSERT_EQUAL(100, lines);
+    TEST_ASSERT(e.datagrams > 1);
+    TEST_ASSERT_EQUAL(0, e.errors);
+
+    exporter_free(&e);
+    close(listener);
+    return 1;
+}
+
+void test_exporter_suite() {
+    RUN_TEST(test_exporter_targets);
+    RUN_TEST(test_exporter_influx_lines);
+    RUN_TEST(test_exporter_statsd_lines);
+    RUN_TEST(test_exporter_drops_oldest);
+    RUN_TEST(test_exporter_datagram_split);
+    RUN_TEST(test_exporter_udp_send);
+}
@@ -0,0 +1,342 @@
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "test_config.h"
+#include "../backend/src/fleet.h"
+#include "../backend/src/json_formatter.h"
+
+static int test_fleet_host_lines() {
+    char host[128], name[64];
+    int port = 0;
+
+    TEST_ASSERT_EQUAL(1, fleet_parse_host_line("10.0.0.5:9000 db-1\n", host, sizeof(host), &port,
+                                               name, sizeof(name)));
+    TEST_ASSERT_STR_EQUAL("10.0.0.5", host);
+    TEST_ASSERT_EQUAL(9000, port);
+    TEST_ASSERT_STR_EQUAL("db-1", name);
+
+    // без порта - порт по умолчанию, имя из адреса
+    TEST_ASSERT_EQUAL(1, fleet_parse_host_line("  web.local  # front\n", host, sizeof(host), &port,
+                                               name, sizeof(name)));
+    TEST_ASSERT_STR_EQUAL("web.local", host);
+    TEST_ASSERT_EQUAL(PORT, port);
+    TEST_ASSERT_STR_EQUAL("web.local:8080", name);
+
+    TEST_ASSERT_EQUAL(0, fleet_parse_host_line("# comment\n", host, sizeof(host), &port,
+                                               name, sizeof(name)));
+    TEST_ASSERT_EQUAL(0, fleet_parse_host_line("\n", host, sizeof(host), &port, name, sizeof(name)));
+    TEST_ASSERT_EQUAL(-1, fleet_parse_host_line("host:99999\n", host, sizeof(host), &port,
+                                                name, sizeof(name)));
+    TEST_ASSERT_EQUAL(-1, fleet_parse_host_line(":8080\n", host, sizeof(host), &port,
+                                                name, sizeof(name)));
+    return 1;
+}
+
+// Строк больше FLEET_MAX_HOSTS: лишние отбрасываются, массив не переполняется
+static int test_fleet_host_limit() {
+    char hosts[] = "/tmp/test_fleet_XXXXXX";
+    int fd = mkstemp(hosts);
+    TEST_ASSERT(fd >= 0);
+    for (int i = 0; i < FLEET_MAX_HOSTS + 6; i++) {
+        dprintf(fd, "10.0.%d.%d:9000 host-%d\n", i / 250, i % 250, i);
+    }
+    close(fd);
+
+    Fleet f;
+    TEST_ASSERT(fleet_load_hosts(&f, hosts) == 0);
+    TEST_ASSERT_EQUAL(FLEET_MAX_HOSTS, f.count);
+    TEST_ASSERT_STR_EQUAL("host-1023", f.hosts[FLEET_MAX_HOSTS - 1].name);
+    TEST_ASSERT_EQUAL(-1, f.hosts[FLEET_MAX_HOSTS - 1].fd);
+    // IP-адреса разобраны при загрузке, резолвер им не нужен
+    TEST_ASSERT(f.hosts[FLEET_MAX_HOSTS - 1].addr_len > 0);
+
+    fleet_free(&f);
+    unlink(hosts);
+    return 1;
+}
+
+static int test_fleet_top_query() {
+    TEST_ASSERT_EQUAL(0, parse_fleet_top(""));
+    TEST_ASSERT_EQUAL(5, parse_fleet_top("top=5"));
+    TEST_ASSERT_EQUAL(3, parse_fleet_top("format=json&top=3"));
+    // только целый ключ: stop= и laptop= - не top=
+    TEST_ASSERT_EQUAL(0, parse_fleet_top("stop=7&laptop=9"));
+    TEST_ASSERT_EQUAL(-1, parse_fleet_top("top=0"));
+    TEST_ASSERT_EQUAL(-1, parse_fleet_top("top=5x"));
+    return 1;
+}
+
+static int test_fleet_parse_response() {
+    FleetResponse r;
+    const char *ok =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "ETag: \"5f-12s\"\r\n"
+        "Content-Length: 4\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n"
+        "{}\r\n";
+
+    // заголовки пришли не целиком, затем тело не целиком
+    TEST_ASSERT_EQUAL(0, fleet_parse_response(ok, 40, &r));
+    TEST_ASSERT_EQUAL(0, fleet_parse_response(ok, strlen(ok) - 1, &r));
+
+    TEST_ASSERT_EQUAL(1, fleet_parse_response(ok, strlen(ok), &r));
+    TEST_ASSERT_EQUAL(200, r.status);
+    TEST_ASSERT_EQUAL(4, r.content_length);
+    TEST_ASSERT_EQUAL(strlen(ok) - 4, r.header_len);
+    TEST_ASSERT_STR_EQUAL("\"5f-12s\"", r.etag);
+    TEST_ASSERT_EQUAL(0, r.close);
+
+    const char *not_modified = "HTTP/1.1 304 Not Modified\r\nConnection: close\r\n\r\n";
+    TEST_ASSERT_EQUAL(1, fleet_parse_response(not_modified, strlen(not_modified), &r));
+    TEST_ASSERT_EQUAL(304, r.status);
+    TEST_ASSERT_EQUAL(0, r.content_length);
+    TEST_ASSERT_EQUAL(1, r.close);
+
+    TEST_ASSERT_EQUAL(-1, fleet_parse_response("garbage\r\n\r\n", 11, &r));
+    return 1;
+}
+
+static int test_fleet_parse_agent_json() {
+    CPUStats cpu = {0};
+    CoreStats cores;
+    MemoryInfo mem = {.total = 8000000000ULL, .used = 2000000000ULL, .percentage = 25.0};
+    GPUInfo gpu = {.usage = 40.0};
+    char buffer[16384];
+    FleetMetrics m;
+
+    // разбор идет по выводу того же форматтера, что отдает агент
+    cpu.usage_percent = 37.5;
+    core_stats_init(&cores, 2);
+    cores.count = cores.online_count = 2;
+    cores.online[0] = cores.online[1] = 1;
+    format_system_info_json(buffer, sizeof(buffer), &cpu, &cores, &mem, &gpu, NULL, 0, NULL);
+    core_stats_free(&cores);
+
+    TEST_ASSERT_EQUAL(0, fleet_parse_system_json(buffer, &m));
+    TEST_ASSERT_DOUBLE_EQUAL(37.5, m.cpu_usage, 0.05);
+    TEST_ASSERT_EQUAL(2, m.cores);
+    TEST_ASSERT_DOUBLE_EQUAL(25.0, m.memory_percent, 0.05);
+    TEST_ASSERT(m.memory_total == 8000000000ULL);
+    TEST_ASSERT(m.memory_used == 2000000000ULL);
+    TEST_ASSERT_DOUBLE_EQUAL(40.0, m.gpu_usage, 0.05);
+    TEST_ASSERT(m.timestamp > 0);
+
+    TEST_ASSERT_EQUAL(-1, fleet_parse_system_json("{\"error\":\"Data not ready yet\",\"timestamp\":0}", &m));
+    return 1;
+}
+
+static void add_host(Fleet *f, const char *name, double cpu, double memory, long last_ok_ms) {
+    FleetHost *h = &f->hosts[f->count++];
+    snprintf(h->name, sizeof(h->name), "%s", name);
+    snprintf(h->host, sizeof(h->host), "10.0.0.%d", f->count);
+    h->port = PORT;
+    h->fd = -1;
+    h->has_data = last_ok_ms > 0;
+    h->last_ok_ms = last_ok_ms;
+    h->errors = last_ok_ms > 0 ? 0 : 3;
+    h->metrics.cpu_usage = cpu;
+    h->metrics.memory_percent = memory;
+    h->metrics.memory_total = 1000;
+    h->metrics.memory_used = (unsigned long long)(memory * 10);
+    h->metrics.cores = 4;
+}
+
+static int test_fleet_rollup_and_top() {
+    Fleet f;
+    JsonWriter w;
+    long now = 1000000;
+
+    memset(&f, 0, sizeof(f));
+    pthread_mutex_init(&f.mutex, NULL);
+    f.hosts = calloc(4, sizeof(FleetHost));
+    f.epfd = f.wake = -1;
+    f.interval_ms = UPDATE_INTERVAL_MS;
+    add_host(&f, "a", 10.0, 90.0, now - 500);
+    add_host(&f, "b", 80.0, 20.0, now - 1000);
+    add_host(&f, "c", 95.0, 50.0, now - FLEET_STALE_INTERVALS * UPDATE_INTERVAL_MS - 1000);
+    add_host(&f, "d", 0.0, 0.0, 0);
+
+    TEST_ASSERT_EQUAL(FLEET_OK, fleet_host_state(&f, &f.hosts[0], now));
+    TEST_ASSERT_EQUAL(FLEET_STALE, fleet_host_state(&f, &f.hosts[2], now));
+    TEST_ASSERT_EQUAL(FLEET_DOWN, fleet_host_state(&f, &f.hosts[3], now));
+    TEST_ASSERT_EQUAL(FLEET_DOWN, fleet_host_state(&f, &f.hosts[0], now + FLEET_DOWN_MS + 1000));
+
+    // пороги - от интервала опроса: при 20 с stale через 60 с, down через 120 с
+    f.interval_ms = 20000;
+    TEST_ASSERT_EQUAL(FLEET_OK, fleet_host_state(&f, &f.hosts[2], now));
+    TEST_ASSERT_EQUAL(FLEET_STALE, fleet_host_state(&f, &f.hosts[0], now + 70000));
+    TEST_ASSERT_EQUAL(FLEET_DOWN, fleet_host_state(&f, &f.hosts[0], now + 130000));
+    f.interval_ms = UPDATE_INTERVAL_MS;
+
+    jw_init(&w, 4096);
+    write_fleet_json(&w, &f, 2, now);
+    jw_char(&w, '\0');
+
+    TEST_ASSERT(strstr(w.data, "\"hosts_ok\": 2") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"hosts_stale\": 1") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"hosts_down\": 1") != NULL);
+    // сводка только по свежим хостам: a и b
+    TEST_ASSERT(strstr(w.data, "\"cpu_avg\": 45.0") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"cpu_max\": 80.0") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"memory_percent\": 55.0") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"cores\": 8}") != NULL);
+
+    // top 2 по CPU: устаревший c первым (с пометкой), затем b; a не попадает
+    const char *top_cpu = strstr(w.data, "\"top_cpu\"");
+    const char *top_memory = strstr(w.data, "\"top_memory\"");
+    TEST_ASSERT(top_cpu && top_memory);
+    const char *c = strstr(top_cpu, "\"name\": \"c\", \"state\": \"stale\"");
+    const char *b = strstr(top_cpu, "\"name\": \"b\"");
+    TEST_ASSERT(c && b && c < b && b < top_memory);
+    TEST_ASSERT(strstr(top_memory, "\"name\": \"a\"") < strstr(top_memory, "\"name\": \"c\""));
+
+    jw_free(&w);
+    fleet_free(&f);
+    return 1;
+}
+
+typedef struct {
+    int listen_fd;
+    char request[1024];
+    char revalidate[1024];
+} FakeAgent;
+
+// Агент на два запроса по одному keep-alive соединению: снимок с ETag,
+// затем 304 на If-None-Match с тем же ETag
+static void *fake_agent(void *arg) {
+    FakeAgent *a = arg;
+    const char *body = "{\"timestamp\": 1, \"cpu\": {\"usage\": 12.5, \"cores_count\": 2}, "
+                       "\"memory\": {\"total\": 100, \"used\": 40, \"percentage\": 40.0}}";
+    char response[512];
+
+    int fd = accept(a->listen_fd, NULL, NULL);
+    if (fd < 0) return NULL;
+    ssize_t n = recv(fd, a->request, sizeof(a->request) - 1, 0);
+    a->request[n > 0 ? n : 0] = '\0';
+
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 200 OK\r\nETag: \"abc-1s\"\r\nContent-Length: %zu\r\n"
+                       "Connection: keep-alive\r\n\r\n%s", strlen(body), body);
+    send(fd, response, len, 0);
+
+    n = recv(fd, a->revalidate, sizeof(a->revalidate) - 1, 0);
+    a->revalidate[n > 0 ? n : 0] = '\0';
+    if (strstr(a->revalidate, "If-None-Match: \"abc-1s\"")) {
+        len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 304 Not Modified\r\nETag: \"abc-1s\"\r\n"
+                       "Connection: keep-alive\r\n\r\n");
+        send(fd, response, len, 0);
+    }
+    usleep(300000);
+    close(fd);
+    return NULL;
+}
+
+static int test_fleet_polls_agent() {
+    FakeAgent agent = {0};
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t addr_len = sizeof(addr);
+    pthread_t thread;
+    Fleet f;
+
+    agent.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT(agent.listen_fd >= 0);
+    TEST_ASSERT(bind(agent.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    TEST_ASSERT(listen(agent.listen_fd, 4) == 0);
+    getsockname(agent.listen_fd, (struct sockaddr *)&addr, &addr_len);
+
+    char hosts[] = "/tmp/test_fleet_XXXXXX";
+    int fd = mkstemp(hosts);
+    TEST_ASSERT(fd >= 0);
+    dprintf(fd, "# test\n127.0.0.1:%d agent\n", ntohs(addr.sin_port));
+    close(fd);
+
+    TEST_ASSERT(pthread_create(&thread, NULL, fake_agent, &agent) == 0);
+    TEST_ASSERT(fleet_load_hosts(&f, hosts) == 0);
+    TEST_ASSERT_EQUAL(1, f.count);
+    TEST_ASSERT_EQUAL(UPDATE_INTERVAL_MS, f.interval_ms);
+    f.interval_ms = 200;
+    TEST_ASSERT(fleet_start(&f) == 0);
+
+    // первый опрос идет сразу после старта, второй - через интервал
+    int has_data = 0;
+    unsigned long not_modified = 0;
+    double cpu = 0.0;
+    for (int i = 0; i < 100 && not_modified == 0; i++) {
+        usleep(10000);
+        pthread_mutex_lock(&f.mutex);
+        has_data = f.hosts[0].has_data;
+        not_modified = f.hosts[0].not_modified;
+        cpu = f.hosts[0].metrics.cpu_usage;
+        pthread_mutex_unlock(&f.mutex);
+    }
+
+    fleet_stop(&f);
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT(has_data);
+    // 304 не сбрасывает данные хоста и считается удачным опросом
+    TEST_ASSERT_EQUAL(1, (int)not_modified);
+    TEST_ASSERT_EQUAL(2, (int)f.hosts[0].polls);
+    TEST_ASSERT_DOUBLE_EQUAL(12.5, cpu, 0.01);
+    TEST_ASSERT_EQUAL(FLEET_OK, fleet_host_state(&f, &f.hosts[0], fleet_now_ms()));
+    TEST_ASSERT_STR_EQUAL("\"abc-1s\"", f.hosts[0].etag);
+    TEST_ASSERT(strstr(agent.request, "GET /api/system?sections=none HTTP/1.1") != NULL);
+    TEST_ASSERT(strstr(agent.request, "Connection: keep-alive") != NULL);
+    TEST_ASSERT(strstr(agent.request, "If-None-Match") == NULL);
+    TEST_ASSERT(strstr(agent.revalidate, "If-None-Match: \"abc-1s\"") != NULL);
+
+    fleet_free(&f);
+    close(agent.listen_fd);
+    unlink(hosts);
+    return 1;
+}
+
+// Неразрешимое имя: каждый раунд опроса - ошибка, но getaddrinfo идет
+// в потоке резолвера и повторяется не чаще FLEET_RESOLVE_RETRY_MS
+static int test_fleet_resolve_backoff() {
+    char hosts[] = "/tmp/test_fleet_XXXXXX";
+    int fd = mkstemp(hosts);
+    TEST_ASSERT(fd >= 0);
+    dprintf(fd, "no-such-agent.invalid:9000 lost\n");
+    close(fd);
+
+    Fleet f;
+    TEST_ASSERT(fleet_load_hosts(&f, hosts) == 0);
+    TEST_ASSERT_EQUAL(0, (int)f.hosts[0].addr_len);
+    f.interval_ms = 50;
+    TEST_ASSERT(fleet_start(&f) == 0);
+
+    unsigned long errors = 0;
+    for (int i = 0; i < 200 && errors < 3; i++) {
+        usleep(10000);
+        pthread_mutex_lock(&f.mutex);
+        errors = f.hosts[0].errors;
+        pthread_mutex_unlock(&f.mutex);
+    }
+    fleet_stop(&f);
+
+    TEST_ASSERT(errors >= 3);
+    TEST_ASSERT_EQUAL(1, f.hosts[0].resolve_failures);
+    TEST_ASSERT_STR_EQUAL("cannot resolve", f.hosts[0].error);
+    TEST_ASSERT_EQUAL(FLEET_DOWN, fleet_host_state(&f, &f.hosts[0], fleet_now_ms()));
+
+    fleet_free(&f);
+    unlink(hosts);
+    return 1;
+}
+
+void test_fleet_suite() {
+    RUN_TEST(test_fleet_host_lines);
+    RUN_TEST(test_fleet_host_limit);
+    RUN_TEST(test_fleet_top_query);
+    RUN_TEST(test_fleet_parse_response);
+    RUN_TEST(test_fleet_parse_agent_json);
+    RUN_TEST(test_fleet_rollup_and_top);
+    RUN_TEST(test_fleet_polls_agent);
+    RUN_TEST(test_fleet_resolve_backoff);
+}
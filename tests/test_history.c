@@ -1,6 +1,7 @@
 #include "test_config.h"
 #include "../backend/src/history.h"
 #include "../backend/src/config.h"
+#include "../backend/src/lttb.h"
 
 static int test_history_init() {
     HistoryData history;
@@ -57,10 +58,104 @@ static int test_history_json() {
     return 1;
 }
 
+static int test_history_disk_series() {
+    HistoryData history;
+    init_history(&history);
+    char buffer[4096];
+    
+    HistorySample sample = {.cpu_usage = 10.0, .disk_read = 1.5, .disk_write = 20.3,
+                            .psi_memory = 37.5};
+    add_history_sample(&history, &sample);
+    add_to_history(&history, 20.0, 0, 0, 0, 0);
+    
+    get_history_json(buffer, sizeof(buffer), &history);
+    
+    TEST_ASSERT(strstr(buffer, "\"disk_read\": [1.5,0.0]") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"disk_write\": [20.3,0.0]") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"cpu\": [10.0,20.0]") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"psi_memory\": [37.5,0.0]") != NULL);
+    
+    return 1;
+}
+
+// Одиночный пик и провал среди шума должны пережить прореживание 1000 -> 50
+static int test_history_lttb_peaks() {
+    static long x[1000];
+    static double y[1000];
+    int out[50];
+    unsigned int seed = 1;
+
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        x[i] = i;
+        y[i] = 20.0 + (seed >> 16) % 100 / 100.0;
+    }
+    y[337] = 95.0;
+    y[731] = 0.0;
+
+    int n = lttb_select(x, y, 1000, 0, 1000, 50, out);
+    TEST_ASSERT_EQUAL(50, n);
+    TEST_ASSERT_EQUAL(0, out[0]);
+    TEST_ASSERT_EQUAL(999, out[49]);
+
+    int peak = 0, dip = 0;
+    for (int i = 0; i < n; i++) {
+        if (i > 0) TEST_ASSERT(out[i] > out[i - 1]);
+        peak |= out[i] == 337;
+        dip |= out[i] == 731;
+    }
+    TEST_ASSERT(peak);
+    TEST_ASSERT(dip);
+
+    // меньше точек, чем просят - все как есть
+    TEST_ASSERT_EQUAL(10, lttb_select(x, y, 1000, 0, 10, 50, out));
+    TEST_ASSERT_EQUAL(9, out[9]);
+    return 1;
+}
+
+// Кольцо истории после переноса дает те же точки, что и линейный массив
+static int test_history_downsampled_json() {
+    HistoryData history;
+    static char buffer[16384];
+    JsonWriter w;
+
+    init_history(&history);
+    for (int i = 0; i < HISTORY_SIZE + 17; i++) {
+        double cpu = (i == 40) ? 99.0 : 10.0 + (i % 3);
+        add_to_history(&history, cpu, 50.0, 0, 0, 0);
+        history.timestamps[(history.index + HISTORY_SIZE - 1) % HISTORY_SIZE] = 1000 + i;
+    }
+    TEST_ASSERT(history.index != 0);
+
+    TEST_ASSERT_EQUAL(8, parse_history_points("points=8"));
+    TEST_ASSERT_EQUAL(8, parse_history_points("x=1&points=8"));
+    TEST_ASSERT_EQUAL(0, parse_history_points(""));
+    TEST_ASSERT_EQUAL(-1, parse_history_points("points=0"));
+    TEST_ASSERT_EQUAL(-1, parse_history_points("points=8x"));
+
+    jw_init_fixed(&w, buffer, sizeof(buffer) - 1);
+    write_history_downsampled_json(&w, &history, 8);
+    TEST_ASSERT(!w.overflow);
+    buffer[w.len] = '\0';
+
+    TEST_ASSERT(strstr(buffer, "\"count\": 60,\n  \"points\": 8") != NULL);
+    const char *cpu = strstr(buffer, "\"cpu\": {\"timestamps\": [1017,");
+    TEST_ASSERT(cpu != NULL);
+    const char *values = strstr(cpu, "\"values\": [");
+    TEST_ASSERT(values != NULL);
+    TEST_ASSERT(strstr(values, "99.0") != NULL && strstr(values, "99.0") < strstr(values, "]"));
+    TEST_ASSERT(strstr(cpu, ",1076], \"values\"") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"psi_io\": {") != NULL);
+    return 1;
+}
+
 // Сьют тестов
 void test_history_suite() {
     RUN_TEST(test_history_init);
     RUN_TEST(test_history_add);
     RUN_TEST(test_history_wrap);
     RUN_TEST(test_history_json);
+    RUN_TEST(test_history_disk_series);
+    RUN_TEST(test_history_lttb_peaks);
+    RUN_TEST(test_history_downsampled_json);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "test_config.h"
 #include "../backend/src/json_formatter.h"
 #include "../backend/src/config.h"
+#include "../backend/src/string_arena.h"
 
 // Моковые данные
 static void mock_cpu_stats(CPUStats *cpu) {
@@ -9,11 +10,12 @@ static void mock_cpu_stats(CPUStats *cpu) {
     cpu->frequency = 2400;
 }
 
-static void mock_cores(CPUStats *cores, int count) {
+static void mock_cores(CoreStats *cores, int count) {
+    core_stats_init(cores, count);
+    cores->count = cores->online_count = count;
     for (int i = 0; i < count; i++) {
-        cores[i].usage_percent = 20.0 + i * 5.0;
-        cores[i].temperature = 45.0 + i * 2.0;
-        cores[i].frequency = 2400 + i * 100;
+        cores->online[i] = 1;
+        cores->usage[i] = 20.0 + i * 5.0;
     }
 }
 
@@ -35,14 +37,21 @@ static void mock_gpu(GPUInfo *gpu) {
     strcpy(gpu->name, "Test GPU");
 }
 
+static StringArena strings;
+
 static void mock_processes(ProcessInfo *processes, int count) {
+    char text[64];
+    if (!strings.slots) string_arena_init(&strings);
     for (int i = 0; i < count; i++) {
+        memset(&processes[i], 0, sizeof(ProcessInfo));
         processes[i].pid = 1000 + i;
-        sprintf(processes[i].name, "test%d", i);
+        snprintf(text, sizeof(text), "test%d", i);
+        processes[i].name = string_arena_intern(&strings, text, strlen(text));
         processes[i].state = 'R';
         processes[i].rss = 1024 * (i + 1);
         processes[i].cpu_usage = 5.0 * (i + 1);
-        sprintf(processes[i].command_line, "/bin/test%d --option", i);
+        snprintf(text, sizeof(text), "/bin/test%d --option", i);
+        processes[i].command_line = string_arena_intern(&strings, text, strlen(text));
     }
 }
 
@@ -50,20 +59,20 @@ static int test_json_basic_structure() {
     char buffer[8192];
     
     CPUStats cpu;
-    CPUStats cores[4];
+    CoreStats cores;
     MemoryInfo mem;
     GPUInfo gpu;
     ProcessInfo processes[2];
     
     mock_cpu_stats(&cpu);
-    mock_cores(cores, 4);
+    mock_cores(&cores, 4);
     mock_memory(&mem);
     mock_gpu(&gpu);
     mock_processes(processes, 2);
     
     format_system_info_json(buffer, sizeof(buffer), 
-                           &cpu, cores, 4,
-                           &mem, &gpu, processes, 2);
+                           &cpu, &cores,
+                           &mem, &gpu, processes, 2, NULL);
     
     TEST_ASSERT(strstr(buffer, "timestamp") != NULL);
     TEST_ASSERT(strstr(buffer, "cpu") != NULL);
@@ -71,10 +80,65 @@ static int test_json_basic_structure() {
     TEST_ASSERT(strstr(buffer, "gpu") != NULL);
     TEST_ASSERT(strstr(buffer, "processes") != NULL);
     
+    core_stats_free(&cores);
+    return 1;
+}
+
+// Выключенный CPU остается в массиве со своим номером, но не в cores_count
+static int test_json_offline_core() {
+    static char buffer[65536];
+    CPUStats cpu;
+    CoreStats cores;
+    MemoryInfo mem;
+    GPUInfo gpu;
+    
+    mock_cpu_stats(&cpu);
+    mock_cores(&cores, 300);
+    cores.online[2] = 0;
+    cores.online_count--;
+    mock_memory(&mem);
+    mock_gpu(&gpu);
+    
+    format_system_info_json(buffer, sizeof(buffer), &cpu, &cores, &mem, &gpu, NULL, 0, NULL);
+    
+    TEST_ASSERT(strstr(buffer, "\"cores_count\": 299") != NULL);
+    TEST_ASSERT(strstr(buffer, "{\"core\": 2, \"usage\": 0.0, \"online\": false}") != NULL);
+    TEST_ASSERT(strstr(buffer, "{\"core\": 3, \"usage\": 35.0}") != NULL);
+    TEST_ASSERT(strstr(buffer, "{\"core\": 299, ") != NULL);
+    
+    core_stats_free(&cores);
+    return 1;
+}
+
+// Возраст секций: отставший gpu помечен stale, остальной снимок свежий
+static int test_json_section_ages() {
+    char buffer[8192];
+    CPUStats cpu;
+    CoreStats cores;
+    MemoryInfo mem;
+    GPUInfo gpu;
+    SectionAge sections[] = {{"cpu", 3, 0}, {"gpu", 9500, 1}, {"processes", -1, 1}};
+    SnapshotExtras extras = {.sections = sections, .section_count = 3};
+    
+    mock_cpu_stats(&cpu);
+    mock_cores(&cores, 2);
+    mock_memory(&mem);
+    mock_gpu(&gpu);
+    
+    format_system_info_json(buffer, sizeof(buffer), &cpu, &cores, &mem, &gpu, NULL, 0, &extras);
+    
+    TEST_ASSERT(strstr(buffer, "\"cpu\": {\"age_ms\": 3, \"stale\": false}") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"gpu\": {\"age_ms\": 9500, \"stale\": true}") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"processes\": {\"age_ms\": -1, \"stale\": true}\n  },") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"processes\": [") != NULL);
+    
+    core_stats_free(&cores);
     return 1;
 }
 
 // Сьют тестов
 void test_json_formatter_suite() {
     RUN_TEST(test_json_basic_structure);
+    RUN_TEST(test_json_offline_core);
+    RUN_TEST(test_json_section_ages);
 }
\ No newline at end of file
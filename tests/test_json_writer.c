@@ -0,0 +1,92 @@
+#include "test_config.h"
+#include "../backend/src/json_writer.h"
+
+static int test_json_writer_numbers() {
+    JsonWriter w;
+    jw_init(&w, 16);
+
+    jw_int(&w, 0);
+    jw_char(&w, ' ');
+    jw_int(&w, -1234567890123LL);
+    jw_char(&w, ' ');
+    jw_uint(&w, 18446744073709551615ULL);
+    TEST_ASSERT_STR_EQUAL("0 -1234567890123 18446744073709551615", w.data);
+
+    jw_free(&w);
+    return 1;
+}
+
+static int test_json_writer_fixed1_matches_printf() {
+    char expected[64];
+    JsonWriter w;
+    jw_init(&w, 64);
+
+    srand(42);
+    for (int i = 0; i < 100000; i++) {
+        double v;
+        switch (i % 4) {
+            case 0: v = i * 0.05; break;
+            case 1: v = -(i * 0.15); break;
+            case 2: v = (rand() % 1000000) / 1000.0; break;
+            default: v = ((double)rand() / RAND_MAX) * 1e9; break;
+        }
+
+        jw_reset(&w);
+        jw_fixed1(&w, v);
+        snprintf(expected, sizeof(expected), "%.1f", v);
+        TEST_ASSERT_STR_EQUAL(expected, w.data);
+    }
+
+    jw_free(&w);
+    return 1;
+}
+
+static int test_json_writer_escaping() {
+    JsonWriter w;
+    jw_init(&w, 0);
+
+    jw_string(&w, "a\"b\\c\nd\re\tf\x01g\x7fh\xc3\xa9");
+    TEST_ASSERT_STR_EQUAL("\"a\\\"b\\\\c\\nd\\re\\tfgh\xc3\xa9\"", w.data);
+
+    jw_free(&w);
+    return 1;
+}
+
+static int test_json_writer_growth() {
+    JsonWriter w;
+    jw_init(&w, 4);
+
+    for (int i = 0; i < 10000; i++) {
+        jw_lit(&w, "0123456789");
+    }
+
+    TEST_ASSERT_EQUAL(100000, w.len);
+    TEST_ASSERT(w.overflow == 0);
+    TEST_ASSERT(w.data[w.len] == '\0');
+
+    jw_free(&w);
+    return 1;
+}
+
+static int test_json_writer_fixed_overflow() {
+    char buffer[8];
+    JsonWriter w;
+    jw_init_fixed(&w, buffer, sizeof(buffer));
+
+    jw_lit(&w, "abcd");
+    jw_lit(&w, "efgh");
+
+    TEST_ASSERT(w.overflow == 1);
+    TEST_ASSERT_STR_EQUAL("abcd", buffer);
+
+    return 1;
+}
+
+// Сьют тестов
+void test_json_writer_suite() {
+    RUN_TEST(test_json_writer_numbers);
+    RUN_TEST(test_json_writer_fixed1_matches_printf);
+    RUN_TEST(test_json_writer_escaping);
+    RUN_TEST(test_json_writer_growth);
+    RUN_TEST(test_json_writer_fixed_overflow);
+}
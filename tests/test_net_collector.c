@@ -0,0 +1,186 @@
+#include <math.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "../backend/src/net_collector.h"
+
+static NetCollector collector;
+
+#define NET_DEV_HEADER \
+    "Inter-|   Receive                                                |  Transmit\n" \
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+
+// Записано с хоста с docker (имена и счетчики сокращены)
+static const char *net_dev_tick1 = NET_DEV_HEADER
+    "    lo: 1000000    1000    0    0    0     0          0         0  1000000    1000    0    0    0     0       0          0\n"
+    "  eth0: 5000000    4000    1    2    0     0          0        10   800000    3000    0    0    0     0       0          0\n"
+    "docker0:  20000     100    0    0    0     0          0         0    30000     120    0    0    0     0       0          0\n"
+    "veth1a2b3c:  7000      50    0    0    0     0          0         0     9000      60    0    0    0     0       0          0\n"
+    "br-5f1e2d:     0       0    0    0    0     0          0         0        0       0    0    0    0     0       0          0\n"
+    " wlan0: 4294967000  100    0    0    0     0          0         0      500      10    0    0    0     0       0          0\n";
+
+static const char *net_dev_tick2 = NET_DEV_HEADER
+    "    lo: 3000000    3000    0    0    0     0          0         0  3000000    3000    0    0    0     0       0          0\n"
+    "  eth0: 7048000    6000    3    2    0     0          0        10   820480    3100    0    4    0     0       0          0\n"
+    "docker0:  20000     100    0    0    0     0          0         0    30000     120    0    0    0     0       0          0\n"
+    "veth1a2b3c:  9048     50    0    0    0     0          0         0     9000      60    0    0    0     0       0          0\n"
+    "br-5f1e2d:     0       0    0    0    0     0          0         0        0       0    0    0    0     0       0          0\n"
+    " wlan0:   1000     110    0    0    0     0          0         0      500      10    0    0    0     0       0          0\n";
+
+static const NetInterface *find_interface(const char *name) {
+    for (int i = 0; i < collector.count; i++) {
+        if (strcmp(collector.interfaces[i].name, name) == 0) return &collector.interfaces[i];
+    }
+    return NULL;
+}
+
+static int test_net_rates() {
+    net_collector_init(&collector, "/nonexistent", 1);
+    net_collector_update(&collector, net_dev_tick1, 0.0);
+    net_collector_update(&collector, net_dev_tick2, 2.0);
+
+    TEST_ASSERT_EQUAL(3, collector.count);
+
+    const NetInterface *eth0 = find_interface("eth0");
+    TEST_ASSERT(eth0 != NULL);
+    TEST_ASSERT_DOUBLE_EQUAL(1024000.0, eth0->rx_bytes_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(10240.0, eth0->tx_bytes_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(1000.0, eth0->rx_packets_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, eth0->tx_packets_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(1.0, eth0->rx_errors_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, eth0->rx_drops_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(2.0, eth0->tx_drops_rate, 1e-9);
+    TEST_ASSERT_EQUAL(7048000ULL, eth0->rx_bytes);
+    TEST_ASSERT_EQUAL(3ULL, eth0->rx_errors);
+
+    // 32-битный счетчик байт перешел через 2^32: 296 + 1000 байт за 2 с
+    const NetInterface *wlan0 = find_interface("wlan0");
+    TEST_ASSERT_DOUBLE_EQUAL(648.0, wlan0->rx_bytes_rate, 1e-9);
+
+    // lo не входит в сумму
+    double rx, tx;
+    net_collector_totals(&collector, &rx, &tx);
+    TEST_ASSERT_DOUBLE_EQUAL(1024000.0 + 648.0, rx, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(10240.0, tx, 1e-9);
+
+    net_collector_free(&collector);
+    return 1;
+}
+
+static int test_net_virtual_filter() {
+    TEST_ASSERT(net_is_virtual_interface("veth1a2b3c"));
+    TEST_ASSERT(net_is_virtual_interface("docker0"));
+    TEST_ASSERT(net_is_virtual_interface("br-5f1e2d"));
+    TEST_ASSERT(!net_is_virtual_interface("eth0"));
+    TEST_ASSERT(!net_is_virtual_interface("lo"));
+
+    net_collector_init(&collector, "/nonexistent", 1);
+    net_collector_update(&collector, net_dev_tick1, 0.0);
+    TEST_ASSERT(find_interface("veth1a2b3c") == NULL);
+    TEST_ASSERT(find_interface("docker0") == NULL);
+    TEST_ASSERT(find_interface("lo") != NULL);
+
+    net_collector_init(&collector, "/nonexistent", 0);
+    net_collector_update(&collector, net_dev_tick1, 0.0);
+    net_collector_update(&collector, net_dev_tick2, 2.0);
+    TEST_ASSERT_EQUAL(6, collector.count);
+    TEST_ASSERT_DOUBLE_EQUAL(1024.0, find_interface("veth1a2b3c")->rx_bytes_rate, 1e-9);
+
+    return 1;
+}
+
+static int test_net_interface_churn() {
+    net_collector_init(&collector, "/nonexistent", 0);
+    net_collector_update(&collector, NET_DEV_HEADER
+        "    lo: 100 1 0 0 0 0 0 0 100 1 0 0 0 0 0 0\n"
+        "  eth0: 100 1 0 0 0 0 0 0 100 1 0 0 0 0 0 0\n"
+        "  eth1: 100 1 0 0 0 0 0 0 100 1 0 0 0 0 0 0\n", 0.0);
+
+    // eth1 пропал, в середине появился новый интерфейс, порядок поменялся
+    net_collector_update(&collector, NET_DEV_HEADER
+        "  eth0: 300 3 0 0 0 0 0 0 100 1 0 0 0 0 0 0\n"
+        "  tun0: 500 5 0 0 0 0 0 0 100 1 0 0 0 0 0 0\n"
+        "    lo: 200 2 0 0 0 0 0 0 100 1 0 0 0 0 0 0\n", 1.0);
+
+    TEST_ASSERT_EQUAL(3, collector.count);
+    TEST_ASSERT_STR_EQUAL("eth0", collector.interfaces[0].name);
+    TEST_ASSERT_STR_EQUAL("tun0", collector.interfaces[1].name);
+    TEST_ASSERT_STR_EQUAL("lo", collector.interfaces[2].name);
+    TEST_ASSERT(find_interface("eth1") == NULL);
+    TEST_ASSERT_DOUBLE_EQUAL(200.0, find_interface("eth0")->rx_bytes_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(100.0, find_interface("lo")->rx_bytes_rate, 1e-9);
+    // новый интерфейс - без скорости до следующего тика
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, find_interface("tun0")->rx_bytes_rate, 1e-9);
+
+    return 1;
+}
+
+static int test_net_many_veth() {
+    static char text[NET_DEV_BUFFER_SIZE];
+    int len = snprintf(text, sizeof(text), "%s", NET_DEV_HEADER);
+
+    len += snprintf(text + len, sizeof(text) - len, "  eth0: 1 1 0 0 0 0 0 0 1 1 0 0 0 0 0 0\n");
+    for (int i = 0; i < 400; i++) {
+        len += snprintf(text + len, sizeof(text) - len,
+                        "veth%06x: %d 1 0 0 0 0 0 0 1 1 0 0 0 0 0 0\n", i, i);
+    }
+
+    net_collector_init(&collector, "/nonexistent", 1);
+    net_collector_update(&collector, text, 0.0);
+    TEST_ASSERT_EQUAL(1, collector.count);
+    TEST_ASSERT_EQUAL(0, collector.dropped);
+
+    net_collector_init(&collector, "/nonexistent", 0);
+    net_collector_update(&collector, text, 0.0);
+    net_collector_update(&collector, text, 1.0);
+    TEST_ASSERT_EQUAL(MAX_NET_INTERFACES, collector.count);
+    TEST_ASSERT_EQUAL(401 - MAX_NET_INTERFACES, collector.dropped);
+    TEST_ASSERT_STR_EQUAL("veth000000", collector.interfaces[1].name);
+    TEST_ASSERT(collector.interfaces[1].has_prev);
+
+    return 1;
+}
+
+static int test_net_persistent_fd_and_json() {
+    char path[] = "/tmp/test_net_dev_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+
+    FILE *f = fopen(path, "w");
+    fputs(net_dev_tick1, f);
+    fclose(f);
+
+    net_collector_init(&collector, path, 1);
+    TEST_ASSERT(net_collector_sample(&collector, 0.0) == 0);
+    int cached_fd = collector.file.fd;
+
+    f = fopen(path, "w");
+    fputs(net_dev_tick2, f);
+    fclose(f);
+    TEST_ASSERT(net_collector_sample(&collector, 2.0) == 0);
+    TEST_ASSERT_EQUAL(cached_fd, collector.file.fd);
+    TEST_ASSERT_DOUBLE_EQUAL(1024000.0, find_interface("eth0")->rx_bytes_rate, 1e-9);
+
+    JsonWriter w;
+    jw_init(&w, 64);
+    write_network_json(&w, &collector);
+    TEST_ASSERT(w.data[0] == '[');
+    TEST_ASSERT(strstr(w.data, "{\"interface\": \"eth0\", \"rx_kb\": 1000.0, \"tx_kb\": 10.0, "
+                               "\"rx_packets_rate\": 1000.0") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"rx_bytes\": 7048000") != NULL);
+    TEST_ASSERT(w.data[w.len - 1] == ']');
+    jw_free(&w);
+
+    net_collector_free(&collector);
+    unlink(path);
+    return 1;
+}
+
+// Сьют тестов
+void test_net_collector_suite() {
+    RUN_TEST(test_net_rates);
+    RUN_TEST(test_net_virtual_filter);
+    RUN_TEST(test_net_interface_churn);
+    RUN_TEST(test_net_many_veth);
+    RUN_TEST(test_net_persistent_fd_and_json);
+}
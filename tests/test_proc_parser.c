@@ -1,5 +1,9 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "test_config.h"
 #include "backend/src/proc_parser.h"
+#include "tests/fixture_tree.h"
 
 static int test_cpu_cores_count() {
     int cores = get_cpu_cores_count();
@@ -56,6 +60,112 @@ static int test_processes() {
     return 1;
 }
 
+
+// Парсеры читают синтетическое дерево через --proc-root/--sys-root
+static int test_fixture_tree_roots() {
+    FixtureSpec spec = {.processes = 20, .cores = 6, .disks = 1, .interfaces = 1, .cgroups = 2};
+    static ProcessInfo processes[MAX_PROCESSES];
+    CPUStats cpu;
+    CoreStats cores;
+    MemoryInfo mem;
+    char root[256], path[300];
+    int count = 0;
+
+    TEST_ASSERT(fixture_tree_create(root, sizeof(root), &spec) == 0);
+    snprintf(path, sizeof(path), "%s/proc", root);
+    set_proc_root(path);
+    snprintf(path, sizeof(path), "%s/sys", root);
+    set_sys_root(path);
+
+    core_stats_init(&cores, 2);
+    int cpu_result = read_cpu_stats(&cpu, &cores);
+    int mem_result = read_memory_info(&mem);
+    int proc_result = get_processes(processes, &count);
+
+    set_proc_root(PROC_ROOT);
+    set_sys_root(SYS_ROOT);
+    fixture_tree_remove(root);
+
+    TEST_ASSERT(cpu_result == 0);
+    TEST_ASSERT_EQUAL(6, cores.online_count);
+    TEST_ASSERT_EQUAL(6, cores.count);
+    TEST_ASSERT(cores.total[5] > cores.idle[5]);
+    core_stats_free(&cores);
+    TEST_ASSERT(mem_result == 0);
+    TEST_ASSERT(mem.total == 65536000ULL * 1024);
+    TEST_ASSERT(proc_result == 0);
+    TEST_ASSERT_EQUAL(20, count);
+
+    int found_nginx = 0;
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT(processes[i].pid >= 1000 && processes[i].pid < 1020);
+        if (processes[i].pid == 1001 && strcmp(processes[i].name, "nginx") == 0) found_nginx = 1;
+    }
+    TEST_ASSERT(found_nginx);
+
+    return 1;
+}
+
+static int count_lines(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    int lines = 0, c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    fclose(f);
+    return lines;
+}
+
+// Без sysfs/cpuinfo sensors и lscpu запускаются один раз, а не на каждом тике
+static int test_shell_fallback_probed_once() {
+    char dir[] = "/tmp/test_fallback_XXXXXX", script[300], log[300], path[1300];
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+    snprintf(log, sizeof(log), "%s/calls", dir);
+
+    const char *tools[] = {"sensors", "lscpu"};
+    for (int i = 0; i < 2; i++) {
+        snprintf(script, sizeof(script), "%s/%s", dir, tools[i]);
+        FILE *f = fopen(script, "w");
+        TEST_ASSERT(f != NULL);
+        fprintf(f, "#!/bin/sh\necho %s >> %s\n", tools[i], log);
+        fclose(f);
+        chmod(script, 0755);
+    }
+    const char *old_path = getenv("PATH");
+    char *saved = strdup(old_path ? old_path : "/usr/bin:/bin");
+    snprintf(path, sizeof(path), "%s:%s", dir, saved);
+    setenv("PATH", path, 1);
+    set_sys_root(dir);
+    set_proc_root(dir);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(get_cpu_temperature() == 45.0);
+        TEST_ASSERT(get_cpu_frequency() == 2400);
+    }
+    int calls = count_lines(log);
+
+    // смена корня - новая проверка
+    set_sys_root(dir);
+    get_cpu_temperature();
+    int reprobed = count_lines(log);
+
+    setenv("PATH", saved, 1);
+    free(saved);
+    set_proc_root(PROC_ROOT);
+    set_sys_root(SYS_ROOT);
+    for (int i = 0; i < 2; i++) {
+        snprintf(script, sizeof(script), "%s/%s", dir, tools[i]);
+        unlink(script);
+    }
+    unlink(log);
+    rmdir(dir);
+
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_EQUAL(3, reprobed);
+    return 1;
+}
+
 // Сьют тестов - ОПРЕДЕЛЯЕМ ТОЛЬКО ЗДЕСЬ!
 void test_proc_parser_suite() {
     RUN_TEST(test_cpu_cores_count);
@@ -63,4 +173,6 @@ void test_proc_parser_suite() {
     RUN_TEST(test_memory_info);
     RUN_TEST(test_gpu_info);
     RUN_TEST(test_processes);
+    RUN_TEST(test_fixture_tree_roots);
+    RUN_TEST(test_shell_fallback_probed_once);
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <math.h>
+#include "test_config.h"
+#include "../backend/src/proc_parser.h"
+#include "../backend/src/process_cache.h"
+#include "tests/fixture_tree.h"
+
+static ProcessInfo processes[MAX_PROCESSES];
+
+static const ProcessInfo *find_pid(int count, int pid) {
+    for (int i = 0; i < count; i++) {
+        if (processes[i].pid == pid) return &processes[i];
+    }
+    return NULL;
+}
+
+static void write_file(const char *root, const char *rel, const char *data, size_t len) {
+    char path[400];
+    snprintf(path, sizeof(path), "%s/%s", root, rel);
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fwrite(data, 1, len, f);
+    fclose(f);
+}
+
+// cmdline читается на первом проходе и после exec, остальные - только stat
+static int test_cmdline_read_once_per_exec() {
+    FixtureSpec spec = {.processes = 8, .cores = 2, .disks = 0, .interfaces = 0, .cgroups = 0};
+    char root[256], path[300];
+    int count = 0;
+
+    TEST_ASSERT(fixture_tree_create(root, sizeof(root), &spec) == 0);
+    snprintf(path, sizeof(path), "%s/proc", root);
+    set_proc_root(path);
+
+    get_processes(processes, &count);
+    const ProcessCache *c = get_process_cache();
+    TEST_ASSERT(c != NULL);
+    unsigned long hits = c->hits, misses = c->misses;
+    const ProcessInfo *p = find_pid(count, 1002);
+    TEST_ASSERT(p != NULL);
+    const char *cmd = p->command_line;
+    TEST_ASSERT(strstr(cmd, "--worker=2") != NULL);
+
+    // cmdline поменялся без exec - не перечитывается
+    write_file(root, "proc/1002/cmdline", "changed", 7);
+    fixture_tree_tick(root, &spec, 1);
+    write_file(root, "proc/1002/cmdline", "changed", 7);
+    get_processes(processes, &count);
+    TEST_ASSERT_EQUAL(8, count);
+    TEST_ASSERT(c->hits - hits == 8);
+    TEST_ASSERT(c->misses == misses);
+    TEST_ASSERT(find_pid(count, 1002)->command_line == cmd);
+    TEST_ASSERT(find_pid(count, 1002)->cpu_usage != 0.1);
+
+    // exec: тот же pid и starttime, другой comm
+    const char *stat = "1002 (python3) R 1 1002 1002 0 -1 4194560 500 0 0 0 500 60 0 0 20 0 1 0 5002 "
+                       "123456789 300 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 0 0 0 0 0 0\n";
+    write_file(root, "proc/1002/stat", stat, strlen(stat));
+    write_file(root, "proc/1002/cmdline", "python3\0app.py\0", 15);
+    get_processes(processes, &count);
+    p = find_pid(count, 1002);
+    TEST_ASSERT(c->misses == misses + 1);
+    TEST_ASSERT_STR_EQUAL("python3", p->name);
+    TEST_ASSERT_STR_EQUAL("python3 app.py", p->command_line);
+    TEST_ASSERT_EQUAL('R', p->state);
+    TEST_ASSERT(p->rss == 300 * 4);
+
+    // pid переиспользован другим процессом: загрузка CPU неизвестна до второго замера
+    stat = "1002 (worker) R 1 1002 1002 0 -1 4194560 500 0 0 0 900 90 0 0 20 0 1 0 9002 "
+           "123456789 300 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 0 0 0 0 0 0\n";
+    write_file(root, "proc/1002/stat", stat, strlen(stat));
+    fixture_tree_tick(root, &spec, 2);
+    write_file(root, "proc/1002/stat", stat, strlen(stat));
+    get_processes(processes, &count);
+    p = find_pid(count, 1002);
+    TEST_ASSERT_STR_EQUAL("worker", p->name);
+    TEST_ASSERT(p->cpu_usage == 0.0);
+
+    set_proc_root(PROC_ROOT);
+    fixture_tree_remove(root);
+    return 1;
+}
+
+// Строки завершившихся процессов выбрасываются переездом во вторую арену
+static int test_process_cache_compaction() {
+    ProcessCache c;
+    char text[600];
+
+    TEST_ASSERT_EQUAL(0, process_cache_init(&c));
+    process_cache_begin(&c);
+    for (int pid = 1; pid <= 500; pid++) {
+        int len = snprintf(text, sizeof(text), "/usr/bin/job --id=%d %0500d", pid, 0);
+        ProcessCacheEntry *e = process_cache_insert(&c, pid);
+        TEST_ASSERT(e != NULL);
+        e->starttime = pid;
+        e->name = process_cache_intern(&c, "job", 3);
+        e->command_line = process_cache_intern(&c, text, len);
+    }
+    process_cache_end(&c);
+    TEST_ASSERT_EQUAL(0, c.compactions);
+
+    // из 500 остался один, и строк еще больше мегабайта
+    for (int round = 0; round < 2; round++) {
+        process_cache_begin(&c);
+        for (int pid = 1000 * (round + 1); pid < 1000 * (round + 2); pid++) {
+            int len = snprintf(text, sizeof(text), "/usr/bin/job --id=%d %0500d", pid, 0);
+            process_cache_intern(&c, text, len);
+        }
+        const ProcessCacheEntry *old = process_cache_lookup(&c, 7, 7);
+        TEST_ASSERT(old != NULL);
+        ProcessCacheEntry *e = process_cache_insert(&c, 7);
+        *e = *old;
+        process_cache_end(&c);
+    }
+
+    process_cache_begin(&c);
+    TEST_ASSERT_EQUAL(1, c.compactions);
+    TEST_ASSERT_EQUAL(1, c.active);
+    const ProcessCacheEntry *e = process_cache_lookup(&c, 7, 7);
+    TEST_ASSERT(e != NULL);
+    TEST_ASSERT(strncmp(e->command_line, "/usr/bin/job --id=7 ", 20) == 0);
+    TEST_ASSERT(c.arenas[1].bytes < 1024);
+    TEST_ASSERT(process_cache_lookup(&c, 8, 8) == NULL);
+
+    process_cache_free(&c);
+    return 1;
+}
+
+void test_process_cache_suite() {
+    RUN_TEST(test_cmdline_read_once_per_exec);
+    RUN_TEST(test_process_cache_compaction);
+}
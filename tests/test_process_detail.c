@@ -0,0 +1,172 @@
+#include <math.h>
+#include "test_config.h"
+#include "fixture_tree.h"
+#include "../backend/src/process_detail.h"
+
+static ProcessDetailCollector collector;
+
+static void write_proc_file(int pid, const char *file, const char *content) {
+    char rel[64];
+    snprintf(rel, sizeof(rel), "%d", pid);
+    fixture_mkdir(rel);
+    snprintf(rel, sizeof(rel), "%d/%s", pid, file);
+    fixture_write(rel, content);
+}
+
+// Счетчики одного процесса в формате ядра
+static void write_proc(int pid, unsigned long long run_ns, unsigned long long read_bytes,
+                       unsigned long long write_bytes, int voluntary, int involuntary) {
+    char text[512];
+
+    snprintf(text, sizeof(text), "%llu 5000 12\n", run_ns);
+    write_proc_file(pid, "schedstat", text);
+
+    snprintf(text, sizeof(text),
+             "rchar: 9000\nwchar: 100\nsyscr: 8\nsyscw: 1\n"
+             "read_bytes: %llu\nwrite_bytes: %llu\ncancelled_write_bytes: 4096\n",
+             read_bytes, write_bytes);
+    write_proc_file(pid, "io", text);
+
+    snprintf(text, sizeof(text),
+             "Name:\tworker\nState:\tS (sleeping)\nVmRSS:\t  1024 kB\n"
+             "voluntary_ctxt_switches:\t%d\nnonvoluntary_ctxt_switches:\t%d\n",
+             voluntary, involuntary);
+    write_proc_file(pid, "status", text);
+}
+
+static void fill_rows(ProcessInfo *rows, const int *pids, int count) {
+    for (int i = 0; i < count; i++) {
+        memset(&rows[i], 0, sizeof(ProcessInfo));
+        rows[i].pid = pids[i];
+        rows[i].starttime = 100;
+    }
+}
+
+static int test_detail_parsers() {
+    unsigned long long value = 0;
+
+    TEST_ASSERT(parse_schedstat("123456789 5000 12\n", &value) == 0);
+    TEST_ASSERT_EQUAL(123456789ULL, value);
+    TEST_ASSERT(parse_schedstat("", &value) != 0);
+
+    TEST_ASSERT(find_key_ull("Name:\tbash\nvoluntary_ctxt_switches:\t42\n",
+                             "voluntary_ctxt_switches:", &value) == 0);
+    TEST_ASSERT_EQUAL(42ULL, value);
+    // nonvoluntary_ не должен совпасть с voluntary_
+    TEST_ASSERT(find_key_ull("nonvoluntary_ctxt_switches:\t7\n",
+                             "voluntary_ctxt_switches:", &value) != 0);
+    return 1;
+}
+
+static int test_detail_rates() {
+    ProcessInfo rows[3];
+    int pids[] = {10, 20, 30};
+
+    TEST_ASSERT(fixture_create("detail") == 0);
+    write_proc(10, 1000000000ULL, 0, 0, 10, 1);
+    write_proc(20, 0, 4096, 8192, 0, 0);
+    write_proc(30, 0, 0, 0, 0, 0);
+
+    process_detail_init(&collector, fixture_dir, 2);
+    fill_rows(rows, pids, 3);
+    process_detail_sample(&collector, rows, 3, 0.0);
+    TEST_ASSERT_EQUAL(2, collector.count);
+    TEST_ASSERT(rows[0].has_detail);
+    TEST_ASSERT(!rows[2].has_detail);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, rows[0].cpu_time_percent, 1e-9);
+
+    // 0.5 с CPU за 2 с - 25% одного ядра, даже если jiffies этого не видят
+    write_proc(10, 1500000000ULL, 0, 0, 30, 5);
+    write_proc(20, 0, 4096 + 2 * 1048576, 8192 + 4096, 0, 0);
+    fill_rows(rows, pids, 3);
+    process_detail_sample(&collector, rows, 3, 2.0);
+
+    TEST_ASSERT_DOUBLE_EQUAL(25.0, rows[0].cpu_time_percent, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(10.0, rows[0].ctx_voluntary_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(2.0, rows[0].ctx_involuntary_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(1048576.0, rows[1].io_read_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(2048.0, rows[1].io_write_rate, 1e-9);
+
+    // скан по спросу пропустил 3 тика: делитель - 8 с с прошлого скана, а не 2 с
+    for (int i = 0; i < 3; i++) process_detail_skip(&collector, 2.0);
+    write_proc(10, 3500000000ULL, 0, 0, 30, 5);
+    write_proc(20, 0, 4096 + 10 * 1048576, 8192 + 4096, 0, 0);
+    fill_rows(rows, pids, 3);
+    process_detail_sample(&collector, rows, 3, 2.0);
+
+    TEST_ASSERT_DOUBLE_EQUAL(25.0, rows[0].cpu_time_percent, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(1048576.0, rows[1].io_read_rate, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, collector.skipped_sec, 1e-9);
+
+    process_detail_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_detail_pid_reuse_and_watch() {
+    ProcessInfo rows[3];
+    int pids[] = {10, 20, 30};
+
+    TEST_ASSERT(fixture_create("detail") == 0);
+    write_proc(10, 1000000000ULL, 0, 0, 0, 0);
+    write_proc(20, 0, 0, 0, 0, 0);
+    write_proc(30, 2000000000ULL, 0, 0, 0, 0);
+
+    process_detail_init(&collector, fixture_dir, 1);
+    TEST_ASSERT(process_detail_watch(&collector, 30) == 0);
+    TEST_ASSERT(process_detail_watch(&collector, 0) != 0);
+
+    fill_rows(rows, pids, 3);
+    process_detail_sample(&collector, rows, 3, 0.0);
+    TEST_ASSERT_EQUAL(2, collector.count);
+    TEST_ASSERT(rows[0].has_detail);
+    TEST_ASSERT(!rows[1].has_detail);
+    TEST_ASSERT(rows[2].has_detail);
+
+    // PID 10 переиспользован другим процессом - прошлое значение не годится
+    write_proc(10, 1200000000ULL, 0, 0, 0, 0);
+    write_proc(30, 3000000000ULL, 0, 0, 0, 0);
+    fill_rows(rows, pids, 3);
+    rows[0].starttime = 999;
+    process_detail_sample(&collector, rows, 3, 1.0);
+
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, rows[0].cpu_time_percent, 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(100.0, rows[2].cpu_time_percent, 1e-9);
+
+    // процесс завершился: файлы пропали, строка остается без скоростей
+    fill_rows(rows, pids, 3);
+    rows[0].starttime = 999;
+    fixture_remove();
+    process_detail_sample(&collector, rows, 3, 1.0);
+    TEST_ASSERT(rows[2].has_detail);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, rows[2].cpu_time_percent, 1e-9);
+
+    process_detail_free(&collector);
+    return 1;
+}
+
+static int test_detail_json() {
+    ProcessInfo p;
+    JsonWriter w;
+
+    memset(&p, 0, sizeof(ProcessInfo));
+    p.has_detail = 1;
+    p.cpu_time_percent = 25.0;
+    p.io_read_rate = 1048576.0;
+    p.ctx_voluntary_rate = 10.0;
+
+    jw_init(&w, 64);
+    write_process_detail_json(&w, &p);
+    TEST_ASSERT_STR_EQUAL("{\"cpu_time\": 25.0, \"io_read\": 1048576.0, \"io_write\": 0.0, "
+                          "\"ctx_voluntary\": 10.0, \"ctx_involuntary\": 0.0}", w.data);
+    jw_free(&w);
+    return 1;
+}
+
+// Сьют тестов
+void test_process_detail_suite() {
+    RUN_TEST(test_detail_parsers);
+    RUN_TEST(test_detail_rates);
+    RUN_TEST(test_detail_pid_reuse_and_watch);
+    RUN_TEST(test_detail_json);
+}
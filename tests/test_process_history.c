@@ -0,0 +1,153 @@
+#include "test_config.h"
+#include "../backend/src/process_history.h"
+#include "../backend/src/config.h"
+#include "../backend/src/string_arena.h"
+
+static ProcessHistoryStore store;
+static StringArena strings;
+
+static void mock_process(ProcessInfo *p, int pid, unsigned long long starttime, double cpu) {
+    memset(p, 0, sizeof(ProcessInfo));
+    p->pid = pid;
+    p->starttime = starttime;
+    char name[32];
+    snprintf(name, sizeof(name), "proc%d", pid);
+    if (!strings.slots) string_arena_init(&strings);
+    p->name = string_arena_intern(&strings, name, strlen(name));
+    p->command_line = p->name;
+    p->state = 'R';
+    p->rss = 1024;
+    p->cpu_usage = cpu;
+}
+
+static int count_chained(ProcessHistoryStore *s) {
+    int total = 0;
+    for (int b = 0; b < PROC_HISTORY_BUCKETS; b++) {
+        for (int idx = s->buckets[b]; idx >= 0; idx = s->slots[idx].hash_next) {
+            total++;
+        }
+    }
+    return total;
+}
+
+static int test_process_history_tracks_top() {
+    ProcessInfo processes[3];
+    init_process_history(&store);
+
+    mock_process(&processes[0], 100, 5000, 90.0);
+    mock_process(&processes[1], 200, 6000, 50.0);
+    mock_process(&processes[2], 300, 7000, 1.0);
+
+    for (int t = 0; t < 5; t++) {
+        update_process_history(&store, processes, 3, 2, 1000 + t * 2);
+    }
+
+    TEST_ASSERT(store.used == 2);
+    TEST_ASSERT(find_process_series(&store, 300) == NULL);
+
+    ProcessSeries *s = find_process_series(&store, 100);
+    TEST_ASSERT(s != NULL);
+    TEST_ASSERT_EQUAL(5, s->count);
+    TEST_ASSERT_EQUAL(5000, s->starttime);
+
+    return 1;
+}
+
+static int test_process_history_keeps_former_top() {
+    ProcessInfo processes[2];
+    init_process_history(&store);
+
+    mock_process(&processes[0], 100, 1, 90.0);
+    mock_process(&processes[1], 200, 1, 10.0);
+    update_process_history(&store, processes, 2, 1, 1000);
+
+    // 200 становится top, 100 продолжает писать историю внутри окна хранения
+    mock_process(&processes[0], 200, 1, 95.0);
+    mock_process(&processes[1], 100, 1, 5.0);
+    update_process_history(&store, processes, 2, 1, 1002);
+
+    ProcessSeries *s = find_process_series(&store, 100);
+    TEST_ASSERT(s != NULL);
+    TEST_ASSERT_EQUAL(2, s->count);
+
+    update_process_history(&store, processes, 2, 1, 1002 + PROC_HISTORY_RETENTION_SEC + 1);
+    TEST_ASSERT(find_process_series(&store, 100) == NULL);
+    TEST_ASSERT(find_process_series(&store, 200) != NULL);
+
+    return 1;
+}
+
+static int test_process_history_pid_reuse() {
+    ProcessInfo p;
+    init_process_history(&store);
+
+    mock_process(&p, 4242, 100, 80.0);
+    update_process_history(&store, &p, 1, 1, 1000);
+    mock_process(&p, 4242, 900, 70.0);
+    update_process_history(&store, &p, 1, 1, 1002);
+
+    TEST_ASSERT(store.used == 2);
+    ProcessSeries *s = find_process_series(&store, 4242);
+    TEST_ASSERT(s != NULL);
+    TEST_ASSERT_EQUAL(900, s->starttime);
+    TEST_ASSERT_EQUAL(1, s->count);
+
+    return 1;
+}
+
+static int test_process_history_churn() {
+    ProcessInfo processes[PROC_HISTORY_TOP_N];
+    init_process_history(&store);
+
+    // 5000 тиков короткоживущих процессов: каждый появляется в top N один раз
+    int pid = 10000;
+    for (int tick = 0; tick < 5000; tick++) {
+        for (int i = 0; i < PROC_HISTORY_TOP_N; i++) {
+            mock_process(&processes[i], pid++, tick, 100.0 - i);
+        }
+        update_process_history(&store, processes, PROC_HISTORY_TOP_N, PROC_HISTORY_TOP_N, tick);
+
+        if (store.used > PROC_HISTORY_SLOTS) {
+            return 0;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(PROC_HISTORY_SLOTS, store.used);
+    TEST_ASSERT_EQUAL(PROC_HISTORY_SLOTS, count_chained(&store));
+    TEST_ASSERT(store.evictions == 5000UL * PROC_HISTORY_TOP_N - PROC_HISTORY_SLOTS);
+
+    // самые свежие процессы остались, старые вытеснены
+    TEST_ASSERT(find_process_series(&store, pid - 1) != NULL);
+    TEST_ASSERT(find_process_series(&store, 10000) == NULL);
+
+    return 1;
+}
+
+static int test_process_history_json() {
+    ProcessInfo p;
+    char buffer[4096];
+    init_process_history(&store);
+
+    mock_process(&p, 555, 1, 12.5);
+    update_process_history(&store, &p, 1, 1, 1000);
+    update_process_history(&store, &p, 1, 1, 1002);
+
+    TEST_ASSERT(get_process_history_json(buffer, sizeof(buffer), &store, 555, 30000, 1) == 0);
+    TEST_ASSERT(strstr(buffer, "\"pid\": 555") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"age_ms\": 30000,\n  \"stale\": true") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"cpu\": [12.5,12.5]") != NULL);
+    TEST_ASSERT(strstr(buffer, "\"memory\": [1048576,1048576]") != NULL);
+
+    TEST_ASSERT(get_process_history_json(buffer, sizeof(buffer), &store, 556, 0, 0) != 0);
+
+    return 1;
+}
+
+// Сьют тестов
+void test_process_history_suite() {
+    RUN_TEST(test_process_history_tracks_top);
+    RUN_TEST(test_process_history_keeps_former_top);
+    RUN_TEST(test_process_history_pid_reuse);
+    RUN_TEST(test_process_history_churn);
+    RUN_TEST(test_process_history_json);
+}
@@ -0,0 +1,133 @@
+#include "test_config.h"
+#include "../backend/src/process_table.h"
+#include "../backend/src/config.h"
+
+static ProcessTable table;
+
+static void add_row(int pid, const char *name, char state, long rss, double cpu, const char *cmd) {
+    ProcessInfo *p = &table.rows[table.count++];
+    memset(p, 0, sizeof(ProcessInfo));
+    p->pid = pid;
+    p->name = name;
+    p->state = state;
+    p->rss = rss;
+    p->cpu_usage = cpu;
+    p->command_line = cmd;
+}
+
+static int setup_table() {
+    if (process_table_init(&table, 16) != 0) return 0;
+    add_row(300, "nginx", 'S', 5000, 2.5, "/usr/sbin/nginx -g daemon off;");
+    add_row(100, "chrome", 'R', 90000, 40.0, "/opt/google/chrome --type=renderer");
+    add_row(200, "bash", 'S', 1200, 0.0, "-bash");
+    add_row(400, "chrome", 'S', 70000, 40.0, "/opt/google/chrome --type=gpu");
+    add_row(50, "postgres", 'D', 120000, 7.5, "postgres: writer");
+    process_table_build_indices(&table);
+    return 1;
+}
+
+static int row_pid(ProcessSortKey key, int i) {
+    return table.rows[table.order[key][i]].pid;
+}
+
+static int test_process_table_sort_cpu() {
+    TEST_ASSERT(setup_table());
+    // одинаковый CPU - порядок по pid
+    TEST_ASSERT_EQUAL(100, row_pid(PROCESS_SORT_CPU, 0));
+    TEST_ASSERT_EQUAL(400, row_pid(PROCESS_SORT_CPU, 1));
+    TEST_ASSERT_EQUAL(50, row_pid(PROCESS_SORT_CPU, 2));
+    TEST_ASSERT_EQUAL(200, row_pid(PROCESS_SORT_CPU, 4));
+    process_table_free(&table);
+    return 1;
+}
+
+static int test_process_table_sort_rss() {
+    TEST_ASSERT(setup_table());
+    TEST_ASSERT_EQUAL(50, row_pid(PROCESS_SORT_RSS, 0));
+    TEST_ASSERT_EQUAL(100, row_pid(PROCESS_SORT_RSS, 1));
+    TEST_ASSERT_EQUAL(400, row_pid(PROCESS_SORT_RSS, 2));
+    TEST_ASSERT_EQUAL(200, row_pid(PROCESS_SORT_RSS, 4));
+    process_table_free(&table);
+    return 1;
+}
+
+static int test_process_table_sort_pid() {
+    TEST_ASSERT(setup_table());
+    int expected[] = {50, 100, 200, 300, 400};
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL(expected[i], row_pid(PROCESS_SORT_PID, i));
+    }
+    process_table_free(&table);
+    return 1;
+}
+
+static int test_process_table_sort_name() {
+    TEST_ASSERT(setup_table());
+    int expected[] = {200, 100, 400, 300, 50};
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL(expected[i], row_pid(PROCESS_SORT_NAME, i));
+    }
+    process_table_free(&table);
+    return 1;
+}
+
+static int test_process_query_parse() {
+    ProcessQuery q;
+
+    TEST_ASSERT(parse_process_query("", &q) == 0);
+    TEST_ASSERT(q.sort == PROCESS_SORT_CPU);
+    TEST_ASSERT(q.limit > 0);
+
+    const char *encoded = "sort=name&limit=3&filter=web%20app+x&state=R";
+    TEST_ASSERT(parse_process_query(encoded, &q) == 0);
+    TEST_ASSERT(q.sort == PROCESS_SORT_NAME);
+    TEST_ASSERT_EQUAL(3, q.limit);
+    TEST_ASSERT_STR_EQUAL("web app x", q.filter);
+    TEST_ASSERT(q.state == 'R');
+
+    TEST_ASSERT(parse_process_query("sort=memory", &q) != 0);
+    TEST_ASSERT(parse_process_query("limit=0", &q) != 0);
+    TEST_ASSERT(parse_process_query("limit=abc", &q) != 0);
+    TEST_ASSERT(parse_process_query("state=RS", &q) != 0);
+
+    return 1;
+}
+
+static int test_process_query_json() {
+    ProcessQuery q;
+    JsonWriter w;
+    TEST_ASSERT(setup_table());
+    jw_init(&w, 256);
+
+    TEST_ASSERT(parse_process_query("sort=rss&limit=2", &q) == 0);
+    TEST_ASSERT_EQUAL(5, write_processes_json(&w, &table, &q, 1500, 0));
+    TEST_ASSERT(strstr(w.data, "\"age_ms\": 1500,\n  \"stale\": false") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"pid\": 50") < strstr(w.data, "\"pid\": 100"));
+    TEST_ASSERT(strstr(w.data, "\"pid\": 400") == NULL);
+
+    jw_reset(&w);
+    TEST_ASSERT(parse_process_query("filter=CHROME&state=S", &q) == 0);
+    TEST_ASSERT_EQUAL(1, write_processes_json(&w, &table, &q, 45000, 1));
+    TEST_ASSERT(strstr(w.data, "\"stale\": true") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"pid\": 400") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"matched\": 1") != NULL);
+
+    jw_reset(&w);
+    TEST_ASSERT(parse_process_query("filter=writer", &q) == 0);
+    TEST_ASSERT_EQUAL(1, write_processes_json(&w, &table, &q, 0, 0));
+    TEST_ASSERT(strstr(w.data, "\"name\": \"postgres\"") != NULL);
+
+    jw_free(&w);
+    process_table_free(&table);
+    return 1;
+}
+
+// Сьют тестов
+void test_process_table_suite() {
+    RUN_TEST(test_process_table_sort_cpu);
+    RUN_TEST(test_process_table_sort_rss);
+    RUN_TEST(test_process_table_sort_pid);
+    RUN_TEST(test_process_table_sort_name);
+    RUN_TEST(test_process_query_parse);
+    RUN_TEST(test_process_query_json);
+}
@@ -0,0 +1,144 @@
+#include <math.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "test_config.h"
+#include "fixture_tree.h"
+#include "../backend/src/psi_collector.h"
+
+static PsiCollector collector;
+
+// Записано с хоста под нагрузкой (ядро 6.x)
+static const char *cpu_pressure =
+    "some avg10=2.82 avg60=3.73 avg300=3.95 total=66393387\n"
+    "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+static const char *memory_pressure =
+    "some avg10=0.00 avg60=0.00 avg300=0.00 total=1603134\n"
+    "full avg10=0.00 avg60=0.00 avg300=0.00 total=1405502\n";
+
+// io.pressure нет - как на ядрах без блочного учета
+static int init_fixture_collector(void) {
+    if (fixture_create("psi") != 0) return -1;
+    fixture_write("cpu", cpu_pressure);
+    fixture_write("memory", memory_pressure);
+    return psi_collector_init(&collector, fixture_dir);
+}
+
+static int test_psi_stall_and_peaks() {
+    TEST_ASSERT(init_fixture_collector() == 0);
+    TEST_ASSERT(collector.available[PSI_CPU]);
+    TEST_ASSERT(collector.available[PSI_MEMORY]);
+    TEST_ASSERT(!collector.available[PSI_IO]);
+    TEST_ASSERT_DOUBLE_EQUAL(3.73, collector.stats[PSI_CPU].some_avg60, 1e-9);
+
+    // 0.5 с простоя за 2 с
+    psi_collector_update(&collector, PSI_CPU,
+                         "some avg10=3.00 avg60=3.80 avg300=3.95 total=66893387\n"
+                         "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n", 2.0);
+    TEST_ASSERT_DOUBLE_EQUAL(25.0, collector.stall[PSI_CPU], 1e-9);
+
+    // короткий всплеск: 0.2 с из 0.25 с - пик держится до take_peaks
+    psi_collector_update(&collector, PSI_CPU,
+                         "some avg10=9.00 avg60=4.00 avg300=3.95 total=67093387\n", 0.25);
+    psi_collector_update(&collector, PSI_CPU,
+                         "some avg10=9.00 avg60=4.00 avg300=3.95 total=67093387\n", 1.75);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, collector.stall[PSI_CPU], 1e-9);
+
+    double peaks[PSI_RESOURCES];
+    psi_collector_take_peaks(&collector, peaks);
+    TEST_ASSERT_DOUBLE_EQUAL(80.0, peaks[PSI_CPU], 1e-9);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, peaks[PSI_MEMORY], 1e-9);
+    psi_collector_take_peaks(&collector, peaks);
+    TEST_ASSERT_DOUBLE_EQUAL(0.0, peaks[PSI_CPU], 1e-9);
+
+    psi_collector_free(&collector);
+    fixture_remove();
+    return 1;
+}
+
+static int test_psi_missing_and_wait_timeout() {
+    TEST_ASSERT(psi_collector_init(&collector, "/nonexistent/pressure") != 0);
+    TEST_ASSERT_EQUAL(0, collector.trigger_count);
+
+    // без триггеров wait - просто сон до таймаута
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL(0, psi_collector_wait(&collector, 30, -1));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double waited_ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    TEST_ASSERT(waited_ms >= 25.0);
+
+    psi_collector_free(&collector);
+    return 1;
+}
+
+// wake_fd прерывает ожидание без замера давления
+static int test_psi_wait_wake_fd() {
+    TEST_ASSERT(psi_collector_init(&collector, "/nonexistent/pressure") != 0);
+    int wake = eventfd(1, EFD_NONBLOCK);
+    TEST_ASSERT(wake >= 0);
+
+    TEST_ASSERT_EQUAL(PSI_WAKE, psi_collector_wait(&collector, 1000, wake));
+    // счетчик вычитан: следующее ожидание идет до таймаута
+    TEST_ASSERT_EQUAL(0, psi_collector_wait(&collector, 10, wake));
+    TEST_ASSERT_EQUAL(0UL, collector.wakeups);
+
+    close(wake);
+    psi_collector_free(&collector);
+    return 1;
+}
+
+// Ядерный триггер выставляет POLLPRI; в тесте его изображает
+// unix-сокет с out-of-band байтом
+static int test_psi_trigger_wakeup() {
+    int sv[2];
+
+    TEST_ASSERT(init_fixture_collector() == 0);
+    TEST_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    if (send(sv[1], "!", 1, MSG_OOB) != 1) {
+        printf("   (MSG_OOB on unix sockets unsupported, skipping wakeup check)\n");
+        close(sv[0]);
+        close(sv[1]);
+        psi_collector_free(&collector);
+        fixture_remove();
+        return 1;
+    }
+
+    collector.triggers[PSI_MEMORY] = sv[0];
+    collector.trigger_count = 1;
+    fixture_write("memory",
+                  "some avg10=5.00 avg60=1.00 avg300=0.20 total=1703134\n"
+                  "full avg10=4.00 avg60=1.00 avg300=0.20 total=1455502\n");
+
+    int mask = psi_collector_wait(&collector, 1000, -1);
+    TEST_ASSERT_EQUAL(1 << PSI_MEMORY, mask);
+    TEST_ASSERT_EQUAL(1UL, collector.wakeups);
+    TEST_ASSERT_EQUAL(1, collector.event_count);
+    TEST_ASSERT_EQUAL(PSI_MEMORY, collector.events[0].resource);
+    TEST_ASSERT(collector.events[0].stall > 0.0);
+    TEST_ASSERT_EQUAL(1703134ULL, collector.stats[PSI_MEMORY].some_total);
+
+    JsonWriter w;
+    jw_init(&w, 64);
+    write_pressure_json(&w, &collector);
+    TEST_ASSERT(strstr(w.data, "\"cpu\": {\"some_avg10\": 2.8, \"some_avg60\": 3.7") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"io\": null") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"triggers\": 1") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"resource\": \"memory\"") != NULL);
+    jw_free(&w);
+
+    psi_collector_free(&collector);
+    close(sv[1]);
+    fixture_remove();
+    return 1;
+}
+
+// Сьют тестов
+void test_psi_collector_suite() {
+    RUN_TEST(test_psi_stall_and_peaks);
+    RUN_TEST(test_psi_missing_and_wait_timeout);
+    RUN_TEST(test_psi_wait_wake_fd);
+    RUN_TEST(test_psi_trigger_wakeup);
+}
@@ -0,0 +1,183 @@
+#include <math.h>
+#include <stdlib.h>
+#include "test_config.h"
+#include "../backend/src/quantile.h"
+
+#define TRACE_POINTS (3600 * 1000 / UPDATE_INTERVAL_MS)
+
+static unsigned int trace_seed;
+
+static double trace_uniform(void) {
+    trace_seed = trace_seed * 1103515245u + 12345u;
+    return ((trace_seed >> 8) + 0.5) / 16777216.0;
+}
+
+// CPU: простой 2-10% с всплесками 70-100% на десятки тиков
+static void trace_cpu(double *out, int n) {
+    int burst = 0;
+    trace_seed = 42;
+    for (int i = 0; i < n; i++) {
+        if (burst == 0 && trace_uniform() < 0.02) burst = 10 + (int)(trace_uniform() * 40);
+        if (burst > 0) {
+            out[i] = 70.0 + trace_uniform() * 30.0;
+            burst--;
+        } else {
+            out[i] = 2.0 + trace_uniform() * 8.0;
+        }
+    }
+}
+
+// Сеть, КБ/с: логнормальный фон и редкие передачи до сотен МБ/с
+static void trace_net(double *out, int n) {
+    trace_seed = 7;
+    for (int i = 0; i < n; i++) {
+        double z = sqrt(-2.0 * log(trace_uniform())) * cos(2.0 * M_PI * trace_uniform());
+        out[i] = exp(3.0 + 1.5 * z);
+        if (trace_uniform() < 0.01) out[i] = 1e5 + trace_uniform() * 4e5;
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double exact_quantile(const double *sorted, int n, double q) {
+    return sorted[(int)(q * (n - 1))];
+}
+
+static int check_quantiles(const QuantileSketch *s, double *values, int n) {
+    static const double qs[] = {0.5, 0.9, 0.99};
+
+    qsort(values, n, sizeof(double), compare_double);
+    TEST_ASSERT_EQUAL(n, (int)s->count);
+    TEST_ASSERT(s->max == values[n - 1]);
+    for (int i = 0; i < 3; i++) {
+        double exact = exact_quantile(values, n, qs[i]);
+        double estimate = quantile_sketch_value(s, qs[i]);
+        TEST_ASSERT(fabs(estimate - exact) <= exact * QUANTILE_ACCURACY + 1e-9);
+    }
+    return 1;
+}
+
+static int test_quantile_sketch_accuracy() {
+    static double trace[TRACE_POINTS];
+    QuantileSketch *s = malloc(sizeof(QuantileSketch));
+    TEST_ASSERT(s != NULL);
+
+    trace_cpu(trace, TRACE_POINTS);
+    quantile_sketch_reset(s);
+    for (int i = 0; i < TRACE_POINTS; i++) quantile_sketch_add(s, trace[i]);
+    TEST_ASSERT(check_quantiles(s, trace, TRACE_POINTS));
+
+    trace_net(trace, TRACE_POINTS);
+    quantile_sketch_reset(s);
+    for (int i = 0; i < TRACE_POINTS; i++) quantile_sketch_add(s, trace[i]);
+    TEST_ASSERT(check_quantiles(s, trace, TRACE_POINTS));
+
+    // нули - отдельный счетчик
+    quantile_sketch_reset(s);
+    for (int i = 0; i < 10; i++) quantile_sketch_add(s, i < 6 ? 0.0 : 50.0);
+    TEST_ASSERT(quantile_sketch_value(s, 0.5) == 0.0);
+    TEST_ASSERT(fabs(quantile_sketch_value(s, 0.9) - 50.0) <= 0.5);
+
+    free(s);
+    return 1;
+}
+
+// Окно - сумма минутных скетчей: точность та же, память меньше сырых точек
+static int test_quantile_store_windows() {
+    static double cpu[TRACE_POINTS * 2], net[TRACE_POINTS * 2], window[TRACE_POINTS * 2];
+    int total = (int)(90 * 60 * 1000L / UPDATE_INTERVAL_MS);
+    long start = 1700000000;
+    QuantileStore store;
+    QuantileSketch *s = malloc(sizeof(QuantileSketch));
+    TEST_ASSERT(s != NULL);
+
+    TEST_ASSERT((sizeof(MinuteSketch) + QUANTILE_MINUTE_BINS(UPDATE_INTERVAL_MS) * sizeof(QuantileBin)) *
+                STATS_WINDOW_MINUTES < sizeof(double) * TRACE_POINTS);
+
+    TEST_ASSERT_EQUAL(0, quantile_store_init(&store, UPDATE_INTERVAL_MS));
+    trace_cpu(cpu, total);
+    trace_net(net, total);
+    for (int i = 0; i < total; i++) {
+        HistorySample sample = {.cpu_usage = cpu[i], .net_rx = net[i]};
+        quantile_store_add(&store, &sample, start + i * (UPDATE_INTERVAL_MS / 1000));
+    }
+    long now = start + (total - 1) * (UPDATE_INTERVAL_MS / 1000);
+
+    int windows[] = {60, 5, 1};
+    for (int w = 0; w < 3; w++) {
+        long first_minute = now / 60 - windows[w] + 1;
+        for (int m = 0; m < 2; m++) {
+            const double *trace = m == 0 ? cpu : net;
+            int n = 0;
+            for (int i = 0; i < total; i++) {
+                if ((start + i * (UPDATE_INTERVAL_MS / 1000)) / 60 >= first_minute) window[n++] = trace[i];
+            }
+            int found = quantile_store_window(&store, quantile_metric_index(m == 0 ? "cpu" : "net_rx"),
+                                              windows[w], now, s);
+            TEST_ASSERT_EQUAL(windows[w], found);
+            TEST_ASSERT(check_quantiles(s, window, n));
+        }
+    }
+
+    // через час без точек окно пустое
+    TEST_ASSERT_EQUAL(0, quantile_store_window(&store, 0, 60, now + 3600, s));
+    TEST_ASSERT(s->count == 0);
+
+    quantile_store_free(&store);
+    free(s);
+    return 1;
+}
+
+// Корзины минуты выделяются под --interval-ms: при тике 250 мс точки не сливаются
+static int test_quantile_store_interval() {
+    int intervals[] = {250, UPDATE_INTERVAL_MS};
+    long start = 1700000040;
+
+    for (int t = 0; t < 2; t++) {
+        QuantileStore store;
+        int points = 60000 / intervals[t];
+        TEST_ASSERT_EQUAL(0, quantile_store_init(&store, intervals[t]));
+        TEST_ASSERT_EQUAL(points + 2, store.minute_bins);
+
+        // 240 разных корзин за одну минуту
+        for (int i = 0; i < 240; i++) {
+            HistorySample sample = {.cpu_usage = pow(1.05, i)};
+            quantile_store_add(&store, &sample, start + i / 5);
+        }
+        const MinuteSketch *m = &store.minutes[quantile_metric_index("cpu") * STATS_WINDOW_MINUTES +
+                                               (start / 60) % STATS_WINDOW_MINUTES];
+        TEST_ASSERT_EQUAL(240 < store.minute_bins ? 240 : store.minute_bins, m->bin_count);
+        TEST_ASSERT(m->count == 240);
+        quantile_store_free(&store);
+    }
+    return 1;
+}
+
+static int test_stats_query() {
+    int metric, minutes;
+
+    TEST_ASSERT_EQUAL(0, parse_stats_query("metric=cpu&window=1h", &metric, &minutes));
+    TEST_ASSERT_EQUAL(0, metric);
+    TEST_ASSERT_EQUAL(60, minutes);
+    TEST_ASSERT_EQUAL(0, parse_stats_query("window=90s&metric=psi_io", &metric, &minutes));
+    TEST_ASSERT_EQUAL(quantile_metric_index("psi_io"), metric);
+    TEST_ASSERT_EQUAL(2, minutes);
+    TEST_ASSERT_EQUAL(0, parse_stats_query("metric=net_rx&window=15m", &metric, &minutes));
+    TEST_ASSERT_EQUAL(15, minutes);
+
+    TEST_ASSERT_EQUAL(-1, parse_stats_query("window=1h", &metric, &minutes));
+    TEST_ASSERT_EQUAL(-1, parse_stats_query("metric=load", &metric, &minutes));
+    TEST_ASSERT_EQUAL(-1, parse_stats_query("metric=cpu&window=2h", &metric, &minutes));
+    TEST_ASSERT_EQUAL(-1, parse_stats_query("metric=cpu&window=5d", &metric, &minutes));
+    return 1;
+}
+
+void test_quantile_suite() {
+    RUN_TEST(test_quantile_sketch_accuracy);
+    RUN_TEST(test_quantile_store_windows);
+    RUN_TEST(test_quantile_store_interval);
+    RUN_TEST(test_stats_query);
+}
@@ -3,8 +3,31 @@
 // Объявления внешних функций (они определены в других файлах)
 extern void test_proc_parser_suite(void);
 extern void test_json_formatter_suite(void);
+extern void test_json_writer_suite(void);
 extern void test_history_suite(void);
+extern void test_process_history_suite(void);
 extern void test_server_mock_suite(void);
+extern void test_snapshot_binary_suite(void);
+extern void test_process_table_suite(void);
+extern void test_cgroup_collector_suite(void);
+extern void test_disk_collector_suite(void);
+extern void test_net_collector_suite(void);
+extern void test_process_detail_suite(void);
+extern void test_psi_collector_suite(void);
+extern void test_capture_suite(void);
+extern void test_asset_cache_suite(void);
+extern void test_fleet_suite(void);
+extern void test_exporter_suite(void);
+extern void test_demand_suite(void);
+extern void test_core_stats_suite(void);
+extern void test_topology_suite(void);
+extern void test_string_arena_suite(void);
+extern void test_process_cache_suite(void);
+extern void test_alerts_suite(void);
+extern void test_quantile_suite(void);
+extern void test_collector_suite(void);
+extern void test_command_suite(void);
+extern void test_async_sampler_suite(void);
 
 // Глобальные переменные
 int tests_run = 0;
@@ -19,8 +42,31 @@ int main() {
     // Запуск тестов
     RUN_SUITE(test_proc_parser_suite);
     RUN_SUITE(test_json_formatter_suite);
+    RUN_SUITE(test_json_writer_suite);
     RUN_SUITE(test_history_suite);
+    RUN_SUITE(test_process_history_suite);
     RUN_SUITE(test_server_mock_suite);
+    RUN_SUITE(test_snapshot_binary_suite);
+    RUN_SUITE(test_process_table_suite);
+    RUN_SUITE(test_cgroup_collector_suite);
+    RUN_SUITE(test_disk_collector_suite);
+    RUN_SUITE(test_net_collector_suite);
+    RUN_SUITE(test_process_detail_suite);
+    RUN_SUITE(test_psi_collector_suite);
+    RUN_SUITE(test_capture_suite);
+    RUN_SUITE(test_asset_cache_suite);
+    RUN_SUITE(test_fleet_suite);
+    RUN_SUITE(test_exporter_suite);
+    RUN_SUITE(test_demand_suite);
+    RUN_SUITE(test_core_stats_suite);
+    RUN_SUITE(test_topology_suite);
+    RUN_SUITE(test_string_arena_suite);
+    RUN_SUITE(test_process_cache_suite);
+    RUN_SUITE(test_alerts_suite);
+    RUN_SUITE(test_quantile_suite);
+    RUN_SUITE(test_collector_suite);
+    RUN_SUITE(test_command_suite);
+    RUN_SUITE(test_async_sampler_suite);
     
     // Итоги
     printf("\n" COLOR_BLUE "══════════════════════════════════════════\n" COLOR_RESET);
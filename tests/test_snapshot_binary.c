@@ -0,0 +1,220 @@
+#include <math.h>
+#include "test_config.h"
+#include "../backend/src/snapshot_binary.h"
+#include "../backend/src/json_formatter.h"
+#include "../backend/src/config.h"
+#include "../backend/src/string_arena.h"
+
+static CPUStats cpu;
+static CoreStats cores;
+static MemoryInfo mem;
+static GPUInfo gpu;
+static ProcessInfo processes[TOP_PROCESSES + 5];
+static char json[131072];
+static unsigned char bin[65536];
+static StringArena strings;
+
+static void mock_snapshot(int cores_count, int process_count) {
+    char text[64];
+    if (!strings.slots) string_arena_init(&strings);
+    memset(&cpu, 0, sizeof(cpu));
+    cpu.usage_percent = 45.56;
+    cpu.temperature = 52.3;
+    cpu.frequency = 2400;
+
+    core_stats_free(&cores);
+    core_stats_init(&cores, cores_count);
+    cores.count = cores.online_count = cores_count;
+    for (int i = 0; i < cores_count; i++) {
+        cores.online[i] = 1;
+        cores.usage[i] = (i * 37 % 1000) / 9.0;
+    }
+    // один выключенный CPU в середине
+    if (cores_count > 8) {
+        cores.online[5] = 0;
+        cores.online_count--;
+    }
+
+    mem.total = 16ULL * 1024 * 1024 * 1024;
+    mem.used = 8ULL * 1024 * 1024 * 1024 + 12345;
+    mem.free = 6ULL * 1024 * 1024 * 1024;
+    mem.cached = 2ULL * 1024 * 1024 * 1024;
+    mem.percentage = 50.04;
+
+    memset(&gpu, 0, sizeof(gpu));
+    gpu.usage = 45.5;
+    gpu.memory_total = 8ULL * 1024 * 1024 * 1024;
+    gpu.memory_used = 4ULL * 1024 * 1024 * 1024;
+    gpu.temperature = 65.0;
+    gpu.power = 120.5;
+    gpu.clock = 1800;
+    strcpy(gpu.name, "Test \"GPU\"");
+
+    for (int i = 0; i < process_count; i++) {
+        memset(&processes[i], 0, sizeof(ProcessInfo));
+        processes[i].pid = 1000 + i;
+        snprintf(text, sizeof(text), "test%d", i);
+        processes[i].name = string_arena_intern(&strings, text, strlen(text));
+        processes[i].command_line = "";
+        processes[i].state = (i % 2) ? 'S' : 'R';
+        processes[i].rss = 1024 * (i + 1);
+        processes[i].cpu_usage = 5.0 * (i + 1) + 0.04;
+        if (i != 3) {
+            snprintf(text, sizeof(text), "/bin/test%d --path=\"C:\\\\x\"\t", i);
+            processes[i].command_line = string_arena_intern(&strings, text, strlen(text));
+        }
+    }
+}
+
+// Указатель на значение первого ключа key после from
+static const char *json_value(const char *from, const char *key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *p = strstr(from, pattern);
+    return p ? p + strlen(pattern) : NULL;
+}
+
+static void json_unescape(const char *p, char *out, size_t size) {
+    size_t n = 0;
+    p++;
+    while (*p && *p != '"' && n + 1 < size) {
+        if (*p == '\\') {
+            p++;
+            switch (*p) {
+                case 'n': out[n++] = '\n'; break;
+                case 'r': out[n++] = '\r'; break;
+                case 't': out[n++] = '\t'; break;
+                default: out[n++] = *p; break;
+            }
+        } else {
+            out[n++] = *p;
+        }
+        p++;
+    }
+    out[n] = '\0';
+}
+
+static int roundtrip(int cores_count, int process_count) {
+    SnapshotView view;
+    char text[1024];
+
+    mock_snapshot(cores_count, process_count);
+    format_system_info_json(json, sizeof(json), &cpu, &cores, &mem, &gpu,
+                            processes, process_count, NULL);
+    int len = encode_system_info_binary(bin, sizeof(bin), &cpu, &cores, &mem, &gpu,
+                                        processes, process_count);
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT((len & 7) == 0);
+    TEST_ASSERT(decode_system_info_binary(bin, len, &view) == 0);
+
+    TEST_ASSERT(llabs(view.timestamp - atoll(json_value(json, "timestamp"))) <= 1);
+    TEST_ASSERT_EQUAL(atoi(json_value(json, "cores_count")), view.cores_count);
+    TEST_ASSERT_DOUBLE_EQUAL(atof(json_value(json, "usage")), view.cpu_usage, 0.05);
+    TEST_ASSERT_DOUBLE_EQUAL(atof(json_value(json, "temperature")), view.cpu_temperature, 0.05);
+    TEST_ASSERT_EQUAL(strtoull(json_value(json, "frequency"), NULL, 10), view.cpu_frequency);
+
+    const char *p = json;
+    int json_cores = 0;
+    while ((p = strstr(p, "{\"core\": ")) != NULL) {
+        const char *usage = json_value(p, "usage");
+        TEST_ASSERT(json_cores < view.core_usage_count);
+        if (strncmp(strchr(usage, ','), ", \"online\": false", 17) == 0) {
+            TEST_ASSERT(snapshot_core_usage(&view, json_cores) < 0);
+        } else {
+            TEST_ASSERT_DOUBLE_EQUAL(atof(usage), snapshot_core_usage(&view, json_cores), 0.05);
+        }
+        json_cores++;
+        p = usage;
+    }
+    TEST_ASSERT_EQUAL(json_cores, view.core_usage_count);
+
+    const char *memory = strstr(json, "\"memory\": {");
+    TEST_ASSERT_EQUAL(strtoull(json_value(memory, "total"), NULL, 10), view.memory.total);
+    TEST_ASSERT_EQUAL(strtoull(json_value(memory, "used"), NULL, 10), view.memory.used);
+    TEST_ASSERT_EQUAL(strtoull(json_value(memory, "free"), NULL, 10), view.memory.free);
+    TEST_ASSERT_EQUAL(strtoull(json_value(memory, "cached"), NULL, 10), view.memory.cached);
+    TEST_ASSERT_DOUBLE_EQUAL(atof(json_value(memory, "percentage")), view.memory.percentage, 0.05);
+
+    const char *g = strstr(json, "\"gpu\": {");
+    TEST_ASSERT_DOUBLE_EQUAL(atof(json_value(g, "usage")), view.gpu_usage, 0.05);
+    TEST_ASSERT_EQUAL(strtoull(json_value(g, "memory_total"), NULL, 10), view.gpu_memory_total);
+    TEST_ASSERT_EQUAL(strtoull(json_value(g, "memory_used"), NULL, 10), view.gpu_memory_used);
+    TEST_ASSERT_DOUBLE_EQUAL(atof(json_value(g, "power")), view.gpu_power, 0.05);
+    TEST_ASSERT_EQUAL(strtoull(json_value(g, "clock"), NULL, 10), view.gpu_clock);
+    json_unescape(json_value(g, "name"), text, sizeof(text));
+    TEST_ASSERT_STR_EQUAL(text, view.gpu_name);
+
+    p = strstr(json, "\"processes\": [");
+    int json_processes = 0;
+    while ((p = strstr(p, "\"pid\": ")) != NULL) {
+        SnapshotProcess *sp = &view.processes[json_processes];
+        TEST_ASSERT(json_processes < view.process_count);
+        TEST_ASSERT_EQUAL(atoi(json_value(p, "pid")), sp->pid);
+        json_unescape(json_value(p, "name"), text, sizeof(text));
+        TEST_ASSERT_STR_EQUAL(text, sp->name);
+        TEST_ASSERT(json_value(p, "state")[1] == sp->state);
+        TEST_ASSERT_EQUAL(strtoull(json_value(p, "memory"), NULL, 10), sp->memory);
+        TEST_ASSERT_DOUBLE_EQUAL(atof(json_value(p, "cpu")), sp->cpu, 0.05);
+        json_unescape(json_value(p, "command"), text, sizeof(text));
+        TEST_ASSERT_STR_EQUAL(text, sp->command);
+        json_processes++;
+        p += 7;
+    }
+    TEST_ASSERT_EQUAL(json_processes, view.process_count);
+
+    return 1;
+}
+
+static int test_snapshot_binary_roundtrip() {
+    TEST_ASSERT(roundtrip(4, 2));
+    TEST_ASSERT(roundtrip(512, TOP_PROCESSES + 5));
+    TEST_ASSERT(roundtrip(0, 0));
+    return 1;
+}
+
+static int test_snapshot_binary_rejects_corrupt() {
+    SnapshotView view;
+
+    mock_snapshot(4, 4);
+    int len = encode_system_info_binary(bin, sizeof(bin), &cpu, &cores, &mem, &gpu, processes, 4);
+    TEST_ASSERT(len > 0);
+
+    TEST_ASSERT(decode_system_info_binary(bin, len - 8, &view) != 0);
+
+    bin[0] = 'X';
+    TEST_ASSERT(decode_system_info_binary(bin, len, &view) != 0);
+    bin[0] = 'S';
+
+    // смещение секции за пределами снимка
+    bin[16 + 8] = 0xff;
+    bin[16 + 9] = 0xff;
+    TEST_ASSERT(decode_system_info_binary(bin, len, &view) != 0);
+
+    TEST_ASSERT(encode_system_info_binary(bin, 64, &cpu, &cores, &mem, &gpu, processes, 4) < 0);
+
+    return 1;
+}
+
+static int test_snapshot_binary_skips_unknown_sections() {
+    SnapshotView view;
+
+    mock_snapshot(4, 2);
+    int len = encode_system_info_binary(bin, sizeof(bin), &cpu, &cores, &mem, &gpu, processes, 2);
+    TEST_ASSERT(len > 0);
+
+    // CORES (третья запись каталога) превращаем в секцию с неизвестным id
+    bin[16 + 2 * 12] = 99;
+    TEST_ASSERT(decode_system_info_binary(bin, len, &view) == 0);
+    TEST_ASSERT_EQUAL(0, view.core_usage_count);
+    TEST_ASSERT_EQUAL(2, view.process_count);
+    TEST_ASSERT_STR_EQUAL("test1", view.processes[1].name);
+
+    return 1;
+}
+
+// Сьют тестов
+void test_snapshot_binary_suite() {
+    RUN_TEST(test_snapshot_binary_roundtrip);
+    RUN_TEST(test_snapshot_binary_rejects_corrupt);
+    RUN_TEST(test_snapshot_binary_skips_unknown_sections);
+}
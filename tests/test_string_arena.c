@@ -0,0 +1,55 @@
+#include <math.h>
+#include "test_config.h"
+#include "../backend/src/string_arena.h"
+
+static int test_string_arena_intern() {
+    StringArena a;
+    char text[32];
+
+    TEST_ASSERT_EQUAL(0, string_arena_init(&a));
+    const char *bash = string_arena_intern(&a, "bash", 4);
+    TEST_ASSERT_STR_EQUAL("bash", bash);
+    TEST_ASSERT(string_arena_intern(&a, "bash --login", 4) == bash);
+    TEST_ASSERT(string_arena_intern(&a, "bas", 3) != bash);
+    TEST_ASSERT_EQUAL(2, a.count);
+
+    // рост хеша не перемещает уже выданные строки
+    for (int i = 0; i < 5000; i++) {
+        int len = snprintf(text, sizeof(text), "worker-%d", i);
+        string_arena_intern(&a, text, len);
+    }
+    TEST_ASSERT(a.slot_count >= 10002);
+    TEST_ASSERT(string_arena_intern(&a, "bash", 4) == bash);
+    TEST_ASSERT_STR_EQUAL("worker-4999", string_arena_intern(&a, "worker-4999", 11));
+
+    string_arena_reset(&a);
+    TEST_ASSERT_EQUAL(0, a.count);
+    TEST_ASSERT(a.bytes == 0);
+    TEST_ASSERT_STR_EQUAL("sshd", string_arena_intern(&a, "sshd", 4));
+
+    string_arena_free(&a);
+    return 1;
+}
+
+static int test_string_arena_long_string() {
+    StringArena a;
+    static char big[STRING_ARENA_BLOCK + 100];
+
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+
+    TEST_ASSERT_EQUAL(0, string_arena_init(&a));
+    const char *small = string_arena_intern(&a, "init", 4);
+    const char *p = string_arena_intern(&a, big, sizeof(big) - 1);
+    TEST_ASSERT(p != NULL);
+    TEST_ASSERT(strlen(p) == sizeof(big) - 1);
+    TEST_ASSERT_STR_EQUAL("init", small);
+
+    string_arena_free(&a);
+    return 1;
+}
+
+void test_string_arena_suite() {
+    RUN_TEST(test_string_arena_intern);
+    RUN_TEST(test_string_arena_long_string);
+}
@@ -0,0 +1,137 @@
+#include <math.h>
+#include "test_config.h"
+#include "../backend/src/topology.h"
+#include "tests/fixture_tree.h"
+
+static Topology topo;
+
+static void set_core(CoreStats *c, int i, uint64_t total, uint64_t idle) {
+    c->prev_total[i] = c->total[i];
+    c->prev_idle[i] = c->idle[i];
+    c->total[i] = total;
+    c->idle[i] = idle;
+}
+
+static int test_node_meminfo() {
+    TopologyNode node = {0};
+    const char *text =
+        "Node 1 MemTotal:       16318284 kB\n"
+        "Node 1 MemFree:         4079571 kB\n"
+        "Node 1 MemUsed:        12238713 kB\n"
+        "Node 1 Active:          6000000 kB\n";
+
+    TEST_ASSERT_EQUAL(0, parse_node_meminfo(text, &node));
+    TEST_ASSERT(node.mem_total == 16318284ULL * 1024);
+    TEST_ASSERT(node.mem_free == 4079571ULL * 1024);
+    TEST_ASSERT(node.mem_used == 12238713ULL * 1024);
+    TEST_ASSERT_DOUBLE_EQUAL(75.0, node.mem_percentage, 0.01);
+
+    // без MemUsed - total минус free
+    TEST_ASSERT_EQUAL(0, parse_node_meminfo("Node 0 MemTotal: 1000 kB\nNode 0 MemFree: 250 kB\n", &node));
+    TEST_ASSERT(node.mem_used == 750ULL * 1024);
+    TEST_ASSERT_EQUAL(-1, parse_node_meminfo("Node 0 Active: 1 kB\n", &node));
+    return 1;
+}
+
+// Фикстура: 8 CPU, два узла/сокета по 4, SMT-пары (0,1) (2,3) ...
+static int test_topology_scan_and_hotplug() {
+    FixtureSpec spec = {.processes = 1, .cores = 8, .disks = 0, .interfaces = 0, .cgroups = 0};
+    CoreStats cores;
+    char root[256], sys[300];
+
+    TEST_ASSERT(fixture_tree_create(root, sizeof(root), &spec) == 0);
+    snprintf(sys, sizeof(sys), "%s/sys", root);
+
+    core_stats_init(&cores, 8);
+    cores.count = cores.online_count = 8;
+    for (int i = 0; i < 8; i++) cores.online[i] = 1;
+
+    topology_init(&topo, sys);
+    TEST_ASSERT_EQUAL(0, topology_scan(&topo, &cores));
+    TEST_ASSERT_EQUAL(1, topo.numa);
+    TEST_ASSERT_EQUAL(2, topo.node_count);
+    TEST_ASSERT_EQUAL(2, topo.package_count);
+    TEST_ASSERT_EQUAL(4, topo.physical_cores);
+    TEST_ASSERT_EQUAL(2, topo.smt);
+    TEST_ASSERT_EQUAL(0, topo.cpu_node[3]);
+    TEST_ASSERT_EQUAL(1, topo.cpu_node[4]);
+    TEST_ASSERT_EQUAL(2, topo.packages[1].cores);
+    TEST_ASSERT_EQUAL(4, topo.packages[1].threads);
+
+    // память узла через закешированный дескриптор
+    topology_update(&topo, &cores);
+    TEST_ASSERT_EQUAL(1, topo.scans);
+    TEST_ASSERT(topo.nodes[1].has_memory);
+    TEST_ASSERT_DOUBLE_EQUAL(75.0, topo.nodes[1].mem_percentage, 0.01);
+    TEST_ASSERT(topo.nodes[0].meminfo.fd >= 0);
+
+    // выключили CPU 2 и 3: пересканирование без перезапуска, дескриптор тот же
+    int fd = topo.nodes[0].meminfo.fd;
+    cores.online[2] = cores.online[3] = 0;
+    cores.online_count = 6;
+    topology_update(&topo, &cores);
+    TEST_ASSERT_EQUAL(2, topo.scans);
+    TEST_ASSERT_EQUAL(2, topo.nodes[0].cpus);
+    TEST_ASSERT_EQUAL(3, topo.physical_cores);
+    TEST_ASSERT_EQUAL(fd, topo.nodes[0].meminfo.fd);
+
+    // без изменений - без сканирования
+    topology_update(&topo, &cores);
+    TEST_ASSERT_EQUAL(2, topo.scans);
+
+    topology_free(&topo);
+    core_stats_free(&cores);
+    fixture_tree_remove(root);
+    return 1;
+}
+
+static int test_topology_aggregate() {
+    CoreStats cores;
+    JsonWriter w;
+
+    // без /sys/devices/system/node: один узел, пакет 0
+    core_stats_init(&cores, 4);
+    cores.count = cores.online_count = 4;
+    for (int i = 0; i < 4; i++) cores.online[i] = 1;
+    topology_init(&topo, "/nonexistent");
+    TEST_ASSERT_EQUAL(0, topology_scan(&topo, &cores));
+    TEST_ASSERT_EQUAL(0, topo.numa);
+    TEST_ASSERT_EQUAL(1, topo.node_count);
+
+    for (int i = 0; i < 4; i++) set_core(&cores, i, 1000, 1000);
+    // 300 тиков занято из 400 на cpu0, 0 из 100 на cpu1 (только что включен),
+    // остальные простаивают: взвешенно 300 / 1000, а не среднее процентов
+    set_core(&cores, 0, 1400, 1100);
+    set_core(&cores, 1, 1100, 1100);
+    set_core(&cores, 2, 1250, 1250);
+    set_core(&cores, 3, 1250, 1250);
+    topology_aggregate(&topo, &cores);
+    TEST_ASSERT_DOUBLE_EQUAL(30.0, topo.nodes[0].usage, 0.01);
+    TEST_ASSERT_DOUBLE_EQUAL(30.0, topo.packages[0].usage, 0.01);
+
+    // выключенный CPU и счетчик, ушедший назад, не учитываются
+    cores.online[3] = 0;
+    set_core(&cores, 0, 1500, 1100);
+    set_core(&cores, 1, 1000, 1000);
+    set_core(&cores, 2, 1350, 1350);
+    topology_aggregate(&topo, &cores);
+    TEST_ASSERT_DOUBLE_EQUAL(50.0, topo.nodes[0].usage, 0.01);
+
+    jw_init(&w, 1024);
+    write_topology_json(&w, &topo);
+    jw_char(&w, '\0');
+    TEST_ASSERT(strstr(w.data, "\"numa\": false") != NULL);
+    TEST_ASSERT(strstr(w.data, "{\"node\": 0, \"cpus\": 4, \"usage\": 50.0}") != NULL);
+    TEST_ASSERT(strstr(w.data, "\"cpu_imbalance\": 0.0") != NULL);
+    jw_free(&w);
+
+    topology_free(&topo);
+    core_stats_free(&cores);
+    return 1;
+}
+
+void test_topology_suite() {
+    RUN_TEST(test_node_meminfo);
+    RUN_TEST(test_topology_scan_and_hotplug);
+    RUN_TEST(test_topology_aggregate);
+}